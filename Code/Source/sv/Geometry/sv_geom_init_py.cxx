@@ -34,6 +34,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 #include "sv_Repository.h"
 #include "sv_RepositoryData.h"
 #include "sv_PolyData.h"
@@ -146,6 +147,10 @@ PyObject* Geom_InterpolateScalarCmd(PyObject* self, PyObject* args);
 
 PyObject* Geom_InterpolateVectorCmd(PyObject* self, PyObject* args);
 
+PyObject* Geom_InterpolateScalarsCmd(PyObject* self, PyObject* args);
+
+PyObject* Geom_InterpolateVectorsCmd(PyObject* self, PyObject* args);
+
 PyObject* Geom_IntersectWithLineCmd(PyObject* self, PyObject* args);
 
 PyObject* Geom_AddPointDataCmd(PyObject* self, PyObject* args);
@@ -263,6 +268,8 @@ PyMethodDef pyGeom_methods[] =
   {"FindDistance", Geom_FindDistanceCmd, METH_VARARGS, NULL},
   {"InterpolateScalar", Geom_InterpolateScalarCmd, METH_VARARGS, NULL},
   {"InterpolateVector", Geom_InterpolateVectorCmd, METH_VARARGS, NULL},
+  {"InterpolateScalars", Geom_InterpolateScalarsCmd, METH_VARARGS, NULL},
+  {"InterpolateVectors", Geom_InterpolateVectorsCmd, METH_VARARGS, NULL},
   {"IntersectWithLine", Geom_IntersectWithLineCmd, METH_VARARGS, NULL},
   {"AddPointData", Geom_AddPointDataCmd, METH_VARARGS, NULL},
   {"SubtractPointData", Geom_SubtractPointDataCmd, METH_VARARGS, NULL},
@@ -4010,6 +4017,143 @@ PyObject* Geom_InterpolateVectorCmd(PyObject* self, PyObject* args)
 
 
 
+// --------------------
+// Geom_ParsePointsList
+// --------------------
+// Reads a list of [x,y,z] lists into consecutive xyz triples. Returns
+// SV_ERROR with no Python error set if an entry is not a number, callers
+// raise their own message.
+
+static int Geom_ParsePointsList(PyObject* ptsList, std::vector<double> &pts)
+{
+  if (!PyList_Check(ptsList)) {
+    return SV_ERROR;
+  }
+
+  int numPts = PyList_Size(ptsList);
+  pts.resize(3*numPts);
+  for (int i = 0; i < numPts; i++) {
+    PyObject* ptList = PyList_GetItem(ptsList,i);
+    if (!PyList_Check(ptList) || PyList_Size(ptList) != 3) {
+      return SV_ERROR;
+    }
+    for (int j = 0; j < 3; j++) {
+      pts[3*i+j] = PyFloat_AsDouble(PyList_GetItem(ptList,j));
+      if (PyErr_Occurred()) {
+        PyErr_Clear();
+        return SV_ERROR;
+      }
+    }
+  }
+  return SV_OK;
+}
+
+
+// --------------------------
+// Geom_InterpolateScalarsCmd
+// --------------------------
+// Batch version of InterpolateScalar for a list of points, returns a list
+// of scalars.
+
+PyObject* Geom_InterpolateScalarsCmd(PyObject* self, PyObject* args)
+{
+  char *objName;
+  cvRepositoryData *obj;
+  PyObject* ptsList;
+  std::vector<double> pts;
+
+  if (!PyArg_ParseTuple(args,"sO", &objName,&ptsList))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import one char, one list, objName, ptsList");
+    return SV_PYTHON_ERROR;
+  }
+
+  if ( Geom_ParsePointsList(ptsList, pts) != SV_OK ) {
+    PyErr_SetString(PyRunTimeErr, "points must be a list of 3d points");
+    return SV_PYTHON_ERROR;
+  }
+
+  // Retrieve object:
+  obj = gRepository->GetObject( objName );
+  if ( obj == NULL ) {
+    PyErr_SetString(PyRunTimeErr,  "couldn't find object" );
+    return SV_PYTHON_ERROR;
+  }
+
+  if ( obj->GetType() != POLY_DATA_T ) {
+    PyErr_SetString(PyRunTimeErr,  "object not of type cvPolyData" );
+    return SV_PYTHON_ERROR;
+  }
+
+  int numPts = pts.size()/3;
+  std::vector<double> scalars(numPts);
+  if ( sys_geom_InterpolateScalars((cvPolyData*)obj, numPts, pts.data(), scalars.data()) != SV_OK ) {
+    PyErr_SetString(PyRunTimeErr, "error interpolating scalars");
+    return SV_PYTHON_ERROR;
+  }
+
+  PyObject* pList = PyList_New(numPts);
+  for (int i = 0; i < numPts; i++)
+    PyList_SetItem(pList,i,PyFloat_FromDouble(scalars[i]));
+  return pList;
+}
+
+
+// --------------------------
+// Geom_InterpolateVectorsCmd
+// --------------------------
+// Batch version of InterpolateVector for a list of points, returns a list
+// of vectors.
+
+PyObject* Geom_InterpolateVectorsCmd(PyObject* self, PyObject* args)
+{
+  char *objName;
+  cvRepositoryData *obj;
+  PyObject* ptsList;
+  std::vector<double> pts;
+
+  if (!PyArg_ParseTuple(args,"sO", &objName,&ptsList))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import one char, one list, objName, ptsList");
+    return SV_PYTHON_ERROR;
+  }
+
+  if ( Geom_ParsePointsList(ptsList, pts) != SV_OK ) {
+    PyErr_SetString(PyRunTimeErr, "points must be a list of 3d points");
+    return SV_PYTHON_ERROR;
+  }
+
+  // Retrieve object:
+  obj = gRepository->GetObject( objName );
+  if ( obj == NULL ) {
+    PyErr_SetString(PyRunTimeErr,  "couldn't find object" );
+    return SV_PYTHON_ERROR;
+  }
+
+  if ( obj->GetType() != POLY_DATA_T ) {
+    PyErr_SetString(PyRunTimeErr,  "object not of type cvPolyData" );
+    return SV_PYTHON_ERROR;
+  }
+
+  int numPts = pts.size()/3;
+  std::vector<double> vects(3*numPts);
+  if ( sys_geom_InterpolateVectors((cvPolyData*)obj, numPts, pts.data(), vects.data()) != SV_OK ) {
+    PyErr_SetString(PyRunTimeErr, "error interpolating vectors");
+    return SV_PYTHON_ERROR;
+  }
+
+  PyObject* pList = PyList_New(numPts);
+  for (int i = 0; i < numPts; i++) {
+    PyObject* vList = PyList_New(3);
+    for (int j = 0; j < 3; j++)
+      PyList_SetItem(vList,j,PyFloat_FromDouble(vects[3*i+j]));
+    PyList_SetItem(pList,i,vList);
+  }
+  return pList;
+}
+
+
+
 // -------------------------
 // Geom_IntersectWithLineCmd
 // -------------------------
@@ -34,10 +34,16 @@
 #include <stdio.h>
 #include <assert.h>
 #include <math.h>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <vector>
 #include "sv_sys_geom.h"
 #include "sv_VTK.h"
 
 #include "sv_vtk_utils.h"
+#include "sv_parallel_utils.h"
 #include "sv_misc_utils.h"
 #include "sv_ggems.h"
 #include "sv_Math.h"
@@ -2659,167 +2665,164 @@ int sys_geom_AvgPt( cvPolyData *src, double pt[] )
 
 
 // --------------------------
-// sys_geom_interpolateScalar
+// sys_geom_InterpolatePoints
 // --------------------------
-
-int sys_geom_InterpolateScalar( cvPolyData *src, double pt[], double *scalar )
+// Interpolates the point scalars and/or vectors of src at the query points
+// from the closest cell. Queries are split into one chunk per worker thread
+// and each chunk uses its own cached cell locator. Points whose position
+// cannot be evaluated in the closest cell get the average of its values if
+// average is set, and are an error otherwise.
+
+static int sys_geom_InterpolatePoints( cvPolyData *src, int numPts, double pts[],
+                                       vtkDataArray *srcScalars, vtkDataArray *srcVectors,
+                                       int average, double scalars[], double vects[] )
 {
-  // return value
-  double s = 0.0;
-  *scalar = s;
-
-  vtkFloatingPointType x[3];
-  vtkFloatingPointType closestPoint[3];
-  vtkIdType cellId = 0;
-  int subId = 0;
-  vtkFloatingPointType dist2 = 0;
-  vtkFloatingPointType pcoords[3];
-  vtkFloatingPointType weights[10];
-  vtkFloatingPointType *weightsPtr;
-  vtkFloatingPointType *closestPointPtr;
-
-  vtkPolyData *pd;
-  pd = src->GetVtkPolyData();
-
-  x[0]=pt[0];x[1]=pt[1];x[2]=pt[2];
+  vtkPolyData *pd = src->GetVtkPolyData();
 
-  vtkCellLocator *locator = vtkCellLocator::New();
-  vtkGenericCell *cell = vtkGenericCell::New();
+  if ( numPts <= 0 ) {
+    return SV_OK;
+  }
+  if ( pd->GetNumberOfCells() == 0 ) {
+    fprintf(stderr,"ERROR:  No cells on vtkPolyData!\n");
+    return SV_ERROR;
+  }
 
-  locator->SetDataSet(pd);
-  locator->BuildLocator();
+  // Small batches are not worth starting threads for
+  int numChunks = std::min( ParallelUtils_GetNumberOfThreads(), numPts / 256 );
+  numChunks = std::max( numChunks, 1 );
 
-  locator->FindClosestPoint(x, closestPoint, cell, cellId, subId, dist2);
-  closestPointPtr = closestPoint;
-  weightsPtr = weights;
-  if (cell->EvaluatePosition (x,closestPointPtr,subId,pcoords,dist2,weightsPtr) == 0) {
-      fprintf(stderr,"ERROR:  Point is not inside of generic cell!\n");
-      locator->Delete();
-      cell->Delete();
+  // The locator cache itself is not thread safe, fill it up front
+  std::vector<vtkCellLocator*> locators( numChunks );
+  for ( int c = 0; c < numChunks; c++ ) {
+    locators[c] = src->GetCellLocator( c );
+    if ( locators[c] == NULL ) {
       return SV_ERROR;
+    }
   }
+  int maxCellSize = pd->GetMaxCellSize();
 
-  //fprintf(stdout,"pcoords: %f %f %f cellId: %i subId; %i dist: %f\n",
-  //        pcoords[0],pcoords[1],pcoords[2],cellId,subId,sqrt(dist2));
+  std::vector<int> status( numChunks, SV_OK );
+  ParallelUtils_For( numChunks, [&]( int c ) {
+    int begin = (int) ( ( (long long) numPts * c ) / numChunks );
+    int end = (int) ( ( (long long) numPts * ( c + 1 ) ) / numChunks );
 
-  vtkIdList *ids = vtkIdList::New();
-  ids->Allocate(10,10);
-  ids->Initialize();
+    vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+    std::vector<double> weights( maxCellSize );
+    double closestPoint[3], pcoords[3], tuple[3];
+    double dist2 = 0.0;
+    vtkIdType cellId = 0;
+    int subId = 0;
+    vtkIdType npts, *ptIds;
 
-  pd->GetCellPoints(cellId,ids);
+    for ( int i = begin; i < end; i++ ) {
+      double *x = &pts[3*i];
+      locators[c]->FindClosestPoint( x, closestPoint, cell, cellId, subId, dist2 );
 
-  if (ids->GetNumberOfIds() == 0) {
-      fprintf(stderr,"ERROR:  No id's found for cell %i.\n",cellId);
-      ids->Delete();
-      locator->Delete();
-      cell->Delete();
-      return SV_ERROR;
-  }
+      pd->GetCellPoints( cellId, npts, ptIds );
+      if ( npts == 0 ) {
+        fprintf(stderr,"ERROR:  No id's found for cell %i.\n",(int)cellId);
+        status[c] = SV_ERROR;
+        return;
+      }
 
-  vtkDataArray *vScalars = pd->GetPointData()->GetScalars();
+      if ( cell->EvaluatePosition( x, closestPoint, subId, pcoords, dist2, &weights[0] ) == 0 ) {
+        if ( !average ) {
+          fprintf(stderr,"ERROR:  Point is not inside of generic cell!\n");
+          status[c] = SV_ERROR;
+          return;
+        }
+        fprintf(stderr,"Warning:  Point is not inside of generic cell!\n");
+        fprintf(stderr,"          using average value for cell.\n");
+        for ( int j = 0; j < npts; j++ ) {
+          weights[j] = 1.0/npts;
+        }
+      }
 
-  vtkFloatingPointType nodeScalar = 0.0;
-  int numIds = ids->GetNumberOfIds();
+      if ( scalars != NULL ) {
+        double s = 0.0;
+        for ( int j = 0; j < npts; j++ ) {
+          s += weights[j]*srcScalars->GetComponent( ptIds[j], 0 );
+        }
+        scalars[i] = s;
+      }
+      if ( vects != NULL ) {
+        double v[3] = {0.0, 0.0, 0.0};
+        for ( int j = 0; j < npts; j++ ) {
+          srcVectors->GetTuple( ptIds[j], tuple );
+          v[0] += weights[j]*tuple[0];
+          v[1] += weights[j]*tuple[1];
+          v[2] += weights[j]*tuple[2];
+        }
+        vects[3*i+0] = v[0];
+        vects[3*i+1] = v[1];
+        vects[3*i+2] = v[2];
+      }
+    }
+  } );
 
-  for (int i = 0; i < numIds; i++) {
-    nodeScalar = vScalars->GetTuple1(ids->GetId(i));
-    s += weights[i]*nodeScalar;
-    //fprintf(stdout,"%i: weight: %f value: %f\n", i,weights[i],nodeScalar);
+  for ( int c = 0; c < numChunks; c++ ) {
+    if ( status[c] != SV_OK ) {
+      return SV_ERROR;
+    }
   }
-
-  ids->Delete();
-  locator->Delete();
-  cell->Delete();
-
-  *scalar = s;
-
   return SV_OK;
 }
 
 
-
 // --------------------------
-// sys_geom_InterpolateVector
+// sys_geom_interpolateScalar
 // --------------------------
 
-int sys_geom_InterpolateVector( cvPolyData *src, double pt[], double vect[] )
+int sys_geom_InterpolateScalar( cvPolyData *src, double pt[], double *scalar )
 {
-  // return value
-  double vx = 0.0;
-  double vy = 0.0;
-  double vz = 0.0;
-
-  vect[0] = vx;
-  vect[1] = vy;
-  vect[2] = vz;
+  *scalar = 0.0;
+  return sys_geom_InterpolateScalars( src, 1, pt, scalar );
+}
 
-  vtkFloatingPointType x[3];
-  vtkFloatingPointType closestPoint[3];
-  vtkIdType cellId = 0;
-  int subId = 0;
-  vtkFloatingPointType dist2 = 0;
-  vtkFloatingPointType pcoords[3];
-  vtkFloatingPointType weights[10];
-  vtkFloatingPointType *weightsPtr;
-  vtkFloatingPointType *closestPointPtr;
 
-  vtkPolyData *pd;
-  pd = src->GetVtkPolyData();
+// ---------------------------
+// sys_geom_InterpolateScalars
+// ---------------------------
 
-  x[0]=pt[0];x[1]=pt[1];x[2]=pt[2];
+int sys_geom_InterpolateScalars( cvPolyData *src, int numPts, double pts[], double scalars[] )
+{
+  vtkDataArray *vScalars = src->GetVtkPolyData()->GetPointData()->GetScalars();
+  if ( vScalars == NULL ) {
+    fprintf(stderr,"ERROR:  No scalars on vtkPolyData!\n");
+    return SV_ERROR;
+  }
 
-  vtkCellLocator *locator = vtkCellLocator::New();
-  vtkGenericCell *cell = vtkGenericCell::New();
+  return sys_geom_InterpolatePoints( src, numPts, pts, vScalars, NULL, 0, scalars, NULL );
+}
 
-  locator->SetDataSet(pd);
-  locator->BuildLocator();
 
-  locator->FindClosestPoint(x, closestPoint, cell, cellId, subId, dist2);
 
-  closestPointPtr = closestPoint;
-  weightsPtr = weights;
-  if (cell->EvaluatePosition (x,closestPointPtr,subId,pcoords,dist2,weightsPtr) == 0) {
-     fprintf(stderr,"ERROR:  Point is not inside of generic cell!\n");
-     locator->Delete();
-     cell->Delete();
-     return SV_ERROR;
-  }
+// --------------------------
+// sys_geom_InterpolateVector
+// --------------------------
 
-  //  fprintf(stdout,"pcoords: %f %f %f cellId: %i subId; %i dist: %f\n",
-  //      pcoords[0],pcoords[1],pcoords[2],cellId,subId,sqrt(dist2));
+int sys_geom_InterpolateVector( cvPolyData *src, double pt[], double vect[] )
+{
+  vect[0] = 0.0;
+  vect[1] = 0.0;
+  vect[2] = 0.0;
+  return sys_geom_InterpolateVectors( src, 1, pt, vect );
+}
 
-  vtkIdList *ids = vtkIdList::New();
-  ids->Allocate(10,10);
-  ids->Initialize();
 
-  pd->GetCellPoints(cellId,ids);
+// ---------------------------
+// sys_geom_InterpolateVectors
+// ---------------------------
 
-  if (ids->GetNumberOfIds() == 0) {
-      fprintf(stderr,"ERROR:  No id's found for cell %i.\n",cellId);
-      ids->Delete();
-      locator->Delete();
-      cell->Delete();
-      return SV_ERROR;
+int sys_geom_InterpolateVectors( cvPolyData *src, int numPts, double pts[], double vects[] )
+{
+  vtkDataArray *vVectors = src->GetVtkPolyData()->GetPointData()->GetVectors();
+  if ( vVectors == NULL ) {
+    fprintf(stderr,"ERROR:  No vectors on vtkPolyData!\n");
+    return SV_ERROR;
   }
-  vtkDataArray *vVectors= pd->GetPointData()->GetVectors();
-
-  vtkFloatingPointType *nodeVector;
 
-  int numIds = ids->GetNumberOfIds();
-  for (int i = 0; i < numIds; i++) {
-    nodeVector = vVectors->GetTuple(ids->GetId(i));
-    vx += weights[i]*nodeVector[0];
-    vy += weights[i]*nodeVector[1];
-    vz += weights[i]*nodeVector[2];
-    //    fprintf(stdout,"%i: weight: %f value: %f %f %f\n", i,weights[i],nodeVector[0], nodeVector[1], nodeVector[2]);
-  }
-  ids->Delete();
-  locator->Delete();
-  cell->Delete();
-  vect[0] = vx;
-  vect[1] = vy;
-  vect[2] = vz;
-  return SV_OK;
+  return sys_geom_InterpolatePoints( src, numPts, pts, NULL, vVectors, 0, NULL, vects );
 }
 
 
@@ -2830,56 +2833,62 @@ int sys_geom_InterpolateVector( cvPolyData *src, double pt[], double vect[] )
 
 int sys_geom_IntersectWithLine( cvPolyData *src, double p0[], double p1[], double intersect[] )
 {
-  // return value
-  intersect[0] = 0.0;
-  intersect[1] = 0.0;
-  intersect[2] = 0.0;
-
-  vtkFloatingPointType a0[3];
-  vtkFloatingPointType a1[3];
-  vtkFloatingPointType tol = 0.001;
-  vtkFloatingPointType t = 0.0;
-  vtkFloatingPointType x[3];
-  vtkFloatingPointType pcoords[3];
-  int subId = 0;
-  vtkIdType cellId = 0;
+  int found = 0;
 
-  vtkPolyData *pd;
-  pd = src->GetVtkPolyData();
-
-  for (int i=0; i < 3; i++) {
-      a0[i]=p0[i];
-      a1[i]=p1[i];
+  if ( sys_geom_IntersectWithLines( src, 1, p0, p1, intersect, &found ) != SV_OK ) {
+    return SV_ERROR;
+  }
+  if ( !found ) {
+    fprintf(stderr,"ERROR:  Line does not intersect vtkPolyData!\n");
+    return SV_ERROR;
   }
 
-  vtkOBBTree *locator = vtkOBBTree::New();
-  //vtkCellLocator *locator = vtkCellLocator::New();
-  vtkGenericCell *cell = vtkGenericCell::New();
+  return SV_OK;
+}
 
-  locator->SetDataSet(pd);
-  locator->BuildLocator();
 
-  //fprintf(stdout,"a0: %f %f %f\n",a0[0],a0[1],a0[2]);
-  //fprintf(stdout,"a1: %f %f %f\n",a1[0],a1[1],a1[2]);
-  //fprintf(stdout,"tol: %f\n",tol);
+// ---------------------------
+// sys_geom_IntersectWithLines
+// ---------------------------
+// First intersection of each line with src, found[i] is zero and the
+// intersection is the origin if line i misses it.
 
-  vtkSmartPointer<vtkPoints> intersectionPoints =
-    vtkSmartPointer<vtkPoints>::New();
-  x[0]=0;x[1]=0;x[2]=0;
-  locator->IntersectWithLine(a0, a1, intersectionPoints,NULL);
-  if (intersectionPoints->GetNumberOfPoints() == 0) {
-  //if (locator->IntersectWithLine(a0,a1,tol,t,x,pcoords,subId,cellId,cell) == 0) {
-      fprintf(stderr,"ERROR:  Line does not intersect vtkPolyData!\n");
-      locator->Delete();
-      cell->Delete();
+int sys_geom_IntersectWithLines( cvPolyData *src, int numLines, double p0s[], double p1s[],
+                                 double intersects[], int found[] )
+{
+  if ( numLines <= 0 ) {
+    return SV_OK;
+  }
+
+  int numChunks = std::min( ParallelUtils_GetNumberOfThreads(), numLines / 256 );
+  numChunks = std::max( numChunks, 1 );
+
+  std::vector<vtkOBBTree*> locators( numChunks );
+  for ( int c = 0; c < numChunks; c++ ) {
+    locators[c] = src->GetOBBTree( c );
+    if ( locators[c] == NULL ) {
       return SV_ERROR;
+    }
   }
-  intersectionPoints->GetPoint(0,x);
 
-  locator->Delete();
-  cell->Delete();
+  ParallelUtils_For( numChunks, [&]( int c ) {
+    int begin = (int) ( ( (long long) numLines * c ) / numChunks );
+    int end = (int) ( ( (long long) numLines * ( c + 1 ) ) / numChunks );
 
-  intersect[0]=x[0];intersect[1]=x[1];intersect[2]=x[2];
+    vtkSmartPointer<vtkPoints> intersectionPoints =
+      vtkSmartPointer<vtkPoints>::New();
+    for ( int i = begin; i < end; i++ ) {
+      double *x = &intersects[3*i];
+      x[0]=0;x[1]=0;x[2]=0;
+
+      intersectionPoints->Reset();
+      locators[c]->IntersectWithLine( &p0s[3*i], &p1s[3*i], intersectionPoints, NULL );
+      found[i] = intersectionPoints->GetNumberOfPoints() > 0;
+      if ( found[i] ) {
+        intersectionPoints->GetPoint( 0, x );
+      }
+    }
+  } );
 
   return SV_OK;
 }
@@ -3064,119 +3073,72 @@ int sys_geom_Project( cvPolyData *srcA, cvPolyData *srcB, sys_geom_math_scalar s
                             sys_geom_math_vector vflag, cvPolyData **dst ) {
 
     int i = 0;
-    int j = 0;
 
-    vtkFloatingPointType s=0;
     vtkFloatingPointArrayType *scalar = NULL;
     vtkFloatingPointArrayType *vec = NULL;
 
-    double vx = 0.0;
-    double vy = 0.0;
-    double vz = 0.0;
-
-    vtkFloatingPointType x[3];
-    vtkFloatingPointType closestPoint[3];
-    vtkIdType cellId = 0;
-    int subId = 0;
-    vtkFloatingPointType dist2 = 0;
-    vtkFloatingPointType pcoords[3];
-    vtkFloatingPointType weights[10];
-    vtkFloatingPointType *weightsPtr;
-    vtkFloatingPointType *closestPointPtr;
-
     vtkPolyData *pdA = srcA->GetVtkPolyData();
     vtkPolyData *pdB = srcB->GetVtkPolyData();
 
-    // all of the pds must have the same num pts
-    int numPtsA = pdA->GetNumberOfPoints();
     int numPtsB = pdB->GetNumberOfPoints();
 
     if (scflag == SYS_GEOM_NO_SCALAR && vflag == SYS_GEOM_NO_VECTOR) {
         return SV_ERROR;
     }
 
-    // build a locator to find closest points in A
-    vtkCellLocator *locator = vtkCellLocator::New();
-    vtkGenericCell *cell = vtkGenericCell::New();
+    vtkDataArray *scalarsA = NULL;
+    vtkDataArray *vectorsA = NULL;
+    std::vector<double> scalarsB;
+    std::vector<double> vectorsB;
 
-    locator->SetDataSet(pdA);
-    locator->BuildLocator();
+    // get pointers to data and create return objects
+    if (scflag != SYS_GEOM_NO_SCALAR) {
+      scalarsA=pdA->GetPointData()->GetScalars();
+      if (scalarsA == NULL) {
+        fprintf(stderr,"ERROR:  no scalars on srcA!\n");
+        return SV_ERROR;
+      }
+      scalarsB.resize(numPtsB);
+    }
+    if (vflag != SYS_GEOM_NO_VECTOR) {
+      vectorsA=pdA->GetPointData()->GetVectors();
+      if (vectorsA == NULL) {
+        fprintf(stderr,"ERROR:  no vectors on srcA!\n");
+        return SV_ERROR;
+      }
+      vectorsB.resize(3*numPtsB);
+    }
 
-    vtkDataArray *scalarsA;
-    vtkDataArray *vectorsA;
+    // interpolate at the points of B from the closest cells in A, using the
+    // locators cached on A
+    std::vector<double> ptsB(3*numPtsB);
+    for (i = 0; i < numPtsB; i++) {
+      pdB->GetPoint(i,&ptsB[3*i]);
+    }
+
+    if (sys_geom_InterpolatePoints(srcA, numPtsB, ptsB.data(), scalarsA, vectorsA, 1,
+                                   scalarsA != NULL ? scalarsB.data() : NULL,
+                                   vectorsA != NULL ? vectorsB.data() : NULL) != SV_OK) {
+      return SV_ERROR;
+    }
 
-    // get pointers to data and create return objects
     if (scflag != SYS_GEOM_NO_SCALAR) {
-      scalarsA=srcA->GetVtkPolyData()->GetPointData()->GetScalars();
       // create return vtk scalar array
       scalar = vtkFloatingPointArrayType::New();
       scalar->SetNumberOfComponents(1);
-      scalar->Allocate(numPtsB,1000);
-      scalar->Initialize();
+      scalar->SetNumberOfTuples(numPtsB);
+      for (i = 0; i < numPtsB; i++) {
+        scalar->SetTuple1(i,scalarsB[i]);
+      }
     }
     if (vflag != SYS_GEOM_NO_VECTOR) {
-      vectorsA=srcA->GetVtkPolyData()->GetPointData()->GetVectors();
       // create return vtk vector array
       vec = vtkFloatingPointArrayType::New();
       vec->SetNumberOfComponents(3);
-      vec->Allocate(numPtsB,1000);
-      vec->Initialize();
-    }
-
-    vtkIdList *ids = vtkIdList::New();
-    ids->Allocate(10,10);
-    ids->Initialize();
-
-    for (i = 0; i < numPtsB; i++) {
-
-      pdB->GetPoint(i,x);
-
-      locator->FindClosestPoint(x, closestPoint, cell, cellId, subId, dist2);
-      closestPointPtr = closestPoint;
-      weightsPtr = weights;
-
-      if (cell->EvaluatePosition (x,closestPointPtr,subId,pcoords,dist2,weightsPtr) == 0) {
-        fprintf(stderr,"Warning:  Point is not inside of generic cell!\n");
-        fprintf(stderr,"          using average value for cell.\n");
-        weights[0]=1.0/3.0;
-        weights[1]=1.0/3.0;
-        weights[2]=1.0/3.0;
+      vec->SetNumberOfTuples(numPtsB);
+      for (i = 0; i < numPtsB; i++) {
+        vec->SetTuple(i,&vectorsB[3*i]);
       }
-
-      pdA->GetCellPoints(cellId,ids);
-      if (ids->GetNumberOfIds() == 0) {
-        fprintf(stderr,"ERROR:  No id's found for cell %i.\n",cellId);
-        ids->Delete();
-        locator->Delete();
-        cell->Delete();
-        if (scalar != NULL) {
-          scalar->Delete();
-        }
-        if (vec != NULL) {
-          vec->Delete();
-        }
-        return SV_ERROR;
-      }
-
-      vtkFloatingPointType *nodeVector;
-      vtkFloatingPointType nodeScalar;
-      int numIds = ids->GetNumberOfIds();
-      vx = 0.0; vy = 0.0; vz = 0.0; s = 0.0;
-      for (int i = 0; i < numIds; i++) {
-        if (scflag != SYS_GEOM_NO_SCALAR) {
-          nodeScalar = scalarsA->GetTuple1(ids->GetId(i));
-          s += weights[i]*nodeScalar;
-        }
-        if (vflag != SYS_GEOM_NO_VECTOR) {
-          nodeVector = vectorsA->GetTuple(ids->GetId(i));
-          vx += weights[i]*nodeVector[0];
-          vy += weights[i]*nodeVector[1];
-          vz += weights[i]*nodeVector[2];
-          //  fprintf(stdout,"%i: weight: %f value: %f %f %f\n", i,weights[i],nodeVector[0], nodeVector[1], nodeVector[2]);
-        }
-      }
-      if (scflag != SYS_GEOM_NO_SCALAR) scalar->InsertNextTuple1(s);
-      if (vflag != SYS_GEOM_NO_VECTOR) vec->InsertNextTuple3(vx,vy,vz);
     }
 
     // create cvPolyData object to return
@@ -3194,9 +3156,6 @@ int sys_geom_Project( cvPolyData *srcA, cvPolyData *srcB, sys_geom_math_scalar s
     pd->Delete();
 
     // clean up
-    ids->Delete();
-    locator->Delete();
-    cell->Delete();
     if (scalar != NULL) scalar->Delete();
     if (vec != NULL) vec->Delete();
 
@@ -3713,6 +3672,382 @@ int sys_geom_set_array_for_local_op_face_blend( cvPolyData *pd,cvPolyData **outp
 }
 
 
+/* -------------- */
+/* sys_geom_local_op_on_patches */
+/* -------------- */
+
+// Rings of cells around the active region that are extracted with each
+// patch. Enough to cover the stencils of the local filters, which freeze
+// everything beyond them.
+#define SYS_GEOM_LOCAL_OP_RINGS 3
+
+// Source arrays of src matching the arrays of dst by name and number of
+// components, NULL where src has no such array.
+static void sys_geom_MatchArrays( vtkFieldData *src, vtkFieldData *dst,
+                                  std::vector<vtkDataArray*> &srcArrays )
+{
+  srcArrays.assign( dst->GetNumberOfArrays(), NULL );
+  for ( int a = 0; a < dst->GetNumberOfArrays(); a++ ) {
+    vtkDataArray *dstArray = dst->GetArray( a );
+    if ( dstArray == NULL || dstArray->GetName() == NULL ) {
+      continue;
+    }
+    vtkDataArray *srcArray = src->GetArray( dstArray->GetName() );
+    if ( srcArray != NULL &&
+         srcArray->GetNumberOfComponents() == dstArray->GetNumberOfComponents() ) {
+      srcArrays[a] = srcArray;
+    }
+  }
+}
+
+// Appends tuple srcId of the matched source arrays to dst, arrays without a
+// match get zeros.
+static void sys_geom_CopyMatchedTuple( std::vector<vtkDataArray*> &srcArrays, vtkIdType srcId,
+                                       vtkFieldData *dst, vtkIdType dstId )
+{
+  double zeros[16] = {0.0};
+  for ( int a = 0; a < dst->GetNumberOfArrays(); a++ ) {
+    vtkDataArray *dstArray = dst->GetArray( a );
+    if ( dstArray == NULL ) {
+      continue;
+    }
+    if ( srcArrays[a] != NULL ) {
+      dstArray->InsertTuple( dstId, srcId, srcArrays[a] );
+    } else if ( dstArray->GetNumberOfComponents() <= 16 ) {
+      dstArray->InsertTuple( dstId, zeros );
+    }
+  }
+}
+
+/** @brief Runs a local operation separately on each independent patch of
+ *  the active region and splices the results back into the surface.
+ *  @details The active region are the points with a value of 1 in the point
+ *  array and the points of cells with a value of 1 in the cell array. Each
+ *  patch is a connected set of cells within numrings rings of the active
+ *  region, so the outer rings are frozen by the local filters and the cells
+ *  they touch are exactly those of a pass over the whole surface. Patches
+ *  are processed concurrently. Cells outside of the patches and their data,
+ *  e.g. ModelFaceID, are copied unchanged.
+ *  @note Only for operations whose result does not depend on the rest of
+ *  the surface, i.e. Laplacian smoothing and subdivision. Decimation is not
+ *  run this way, since its target reduction is measured against all input
+ *  polygons, and neither is constrained smoothing, since it solves one
+ *  least-squares system over all points with a fixed number of conjugate
+ *  gradient iterations.
+ *  @param *geom The input surface, must only contain polygons
+ *  @param op The operation, fills its second argument from its first
+ *  @param *output The spliced surface
+ *  @return SV_OK if the patches were processed and spliced, SV_ERROR if the
+ *  surface could not be split or a patch boundary was not kept frozen, in
+ *  which case op should be run on the whole surface instead.
+ */
+
+static int sys_geom_local_op_on_patches( vtkPolyData *geom, char *pointarrayname,
+                                         char *cellarrayname, int numrings,
+                                         const std::function<int(vtkPolyData*, vtkPolyData*)> &op,
+                                         vtkPolyData *output )
+{
+  int numPts = geom->GetNumberOfPoints();
+  int numCells = geom->GetNumberOfCells();
+  if ( numCells == 0 || geom->GetNumberOfPolys() != numCells ) {
+    return SV_ERROR;
+  }
+
+  vtkDataArray *pointArray = NULL;
+  vtkDataArray *cellArray = NULL;
+  if ( pointarrayname != 0 ) {
+    pointArray = geom->GetPointData()->GetArray( pointarrayname );
+    if ( pointArray == NULL ) {
+      return SV_ERROR;
+    }
+  }
+  if ( cellarrayname != 0 ) {
+    cellArray = geom->GetCellData()->GetArray( cellarrayname );
+    if ( cellArray == NULL ) {
+      return SV_ERROR;
+    }
+  }
+
+  vtkNew(vtkPolyData,mesh);
+  mesh->ShallowCopy( geom );
+  mesh->BuildLinks();
+
+  vtkIdType npts, *pts;
+  unsigned short ncells;
+  vtkIdType *cells;
+
+  // Active points
+  std::vector<int> pointMark( numPts, 0 );
+  for ( int i = 0; i < numPts; i++ ) {
+    if ( pointArray != NULL && pointArray->GetTuple1( i ) == 1 ) {
+      pointMark[i] = 1;
+    }
+  }
+  for ( int i = 0; i < numCells && cellArray != NULL; i++ ) {
+    if ( cellArray->GetTuple1( i ) == 1 ) {
+      mesh->GetCellPoints( i, npts, pts );
+      for ( int j = 0; j < npts; j++ ) {
+        pointMark[pts[j]] = 1;
+      }
+    }
+  }
+
+  // Grow the patches by rings of cells around the active points
+  std::vector<int> inPatch( numCells, 0 );
+  for ( int r = 0; r < numrings; r++ ) {
+    for ( int i = 0; i < numPts; i++ ) {
+      if ( !pointMark[i] ) {
+        continue;
+      }
+      mesh->GetPointCells( i, ncells, cells );
+      for ( int j = 0; j < ncells; j++ ) {
+        inPatch[cells[j]] = 1;
+      }
+    }
+    for ( int i = 0; i < numCells; i++ ) {
+      if ( inPatch[i] ) {
+        mesh->GetCellPoints( i, npts, pts );
+        for ( int j = 0; j < npts; j++ ) {
+          pointMark[pts[j]] = 1;
+        }
+      }
+    }
+  }
+
+  int numPatchCells = 0;
+  for ( int i = 0; i < numCells; i++ ) {
+    numPatchCells += inPatch[i];
+  }
+  if ( numPatchCells == 0 ) {
+    output->DeepCopy( geom );
+    return SV_OK;
+  }
+  if ( numPatchCells == numCells ) {
+    return SV_ERROR;
+  }
+
+  // Points shared with cells outside of the patches must stay put
+  std::vector<int> keepPoint( numPts, 0 );
+  std::vector<int> onPatch( numPts, 0 );
+  for ( int i = 0; i < numCells; i++ ) {
+    mesh->GetCellPoints( i, npts, pts );
+    for ( int j = 0; j < npts; j++ ) {
+      if ( inPatch[i] ) {
+        onPatch[pts[j]] = 1;
+      } else {
+        keepPoint[pts[j]] = 1;
+      }
+    }
+  }
+
+  // Split the patch cells into connected patches
+  std::vector<int> patchId( numCells, -1 );
+  int numPatches = 0;
+  std::vector<vtkIdType> stack;
+  for ( int i = 0; i < numCells; i++ ) {
+    if ( !inPatch[i] || patchId[i] != -1 ) {
+      continue;
+    }
+    patchId[i] = numPatches;
+    stack.push_back( i );
+    while ( !stack.empty() ) {
+      vtkIdType cellId = stack.back();
+      stack.pop_back();
+      mesh->GetCellPoints( cellId, npts, pts );
+      for ( int j = 0; j < npts; j++ ) {
+        mesh->GetPointCells( pts[j], ncells, cells );
+        for ( int k = 0; k < ncells; k++ ) {
+          if ( inPatch[cells[k]] && patchId[cells[k]] == -1 ) {
+            patchId[cells[k]] = numPatches;
+            stack.push_back( cells[k] );
+          }
+        }
+      }
+    }
+    numPatches++;
+  }
+
+  // Extract each patch with all of its data
+  std::vector<vtkSmartPointer<vtkPolyData> > patchIn( numPatches );
+  std::vector<vtkSmartPointer<vtkPolyData> > patchOut( numPatches );
+  std::vector<std::vector<vtkIdType> > patchPointIds( numPatches );
+  std::vector<vtkIdType> localId( numPts, -1 );
+  for ( int p = 0; p < numPatches; p++ ) {
+    vtkSmartPointer<vtkPolyData> patch = vtkSmartPointer<vtkPolyData>::New();
+    vtkNew(vtkPoints,patchPts);
+    patchPts->SetDataType( geom->GetPoints()->GetDataType() );
+    vtkNew(vtkCellArray,patchPolys);
+    patch->GetPointData()->CopyAllocate( geom->GetPointData() );
+    patch->GetCellData()->CopyAllocate( geom->GetCellData() );
+
+    std::vector<vtkIdType> &pointIds = patchPointIds[p];
+    std::vector<vtkIdType> cellPts;
+    for ( int i = 0; i < numCells; i++ ) {
+      if ( patchId[i] != p ) {
+        continue;
+      }
+      mesh->GetCellPoints( i, npts, pts );
+      cellPts.resize( npts );
+      for ( int j = 0; j < npts; j++ ) {
+        if ( localId[pts[j]] == -1 ) {
+          localId[pts[j]] = pointIds.size();
+          pointIds.push_back( pts[j] );
+          patchPts->InsertNextPoint( geom->GetPoint( pts[j] ) );
+          patch->GetPointData()->CopyData( geom->GetPointData(), pts[j], localId[pts[j]] );
+        }
+        cellPts[j] = localId[pts[j]];
+      }
+      vtkIdType newCellId = patchPolys->InsertNextCell( npts, &cellPts[0] );
+      patch->GetCellData()->CopyData( geom->GetCellData(), i, newCellId );
+    }
+    for ( int j = 0; j < pointIds.size(); j++ ) {
+      localId[pointIds[j]] = -1;
+    }
+
+    patch->SetPoints( patchPts );
+    patch->SetPolys( patchPolys );
+    patchIn[p] = patch;
+    patchOut[p] = vtkSmartPointer<vtkPolyData>::New();
+  }
+
+  std::vector<int> status( numPatches, SV_OK );
+  ParallelUtils_For( numPatches, [&]( int p ) {
+    try {
+      status[p] = op( patchIn[p], patchOut[p] );
+    }
+    catch (...) {
+      status[p] = SV_ERROR;
+    }
+  } );
+
+  // Map the frozen points of every patch output back to the surface by their
+  // unchanged coordinates, and check that its free edges are those frozen
+  // points only
+  std::vector<std::vector<vtkIdType> > outToGlobal( numPatches );
+  for ( int p = 0; p < numPatches; p++ ) {
+    if ( status[p] != SV_OK ) {
+      return SV_ERROR;
+    }
+    vtkPolyData *out = patchOut[p];
+    if ( out->GetNumberOfCells() != out->GetNumberOfPolys() ) {
+      return SV_ERROR;
+    }
+
+    std::map<std::array<double,3>, vtkIdType> frozen;
+    for ( int j = 0; j < patchPointIds[p].size(); j++ ) {
+      vtkIdType ptId = patchPointIds[p][j];
+      if ( keepPoint[ptId] ) {
+        std::array<double,3> x;
+        geom->GetPoint( ptId, x.data() );
+        frozen[x] = ptId;
+      }
+    }
+
+    std::vector<vtkIdType> &toGlobal = outToGlobal[p];
+    toGlobal.assign( out->GetNumberOfPoints(), -1 );
+    int numFound = 0;
+    for ( int j = 0; j < out->GetNumberOfPoints(); j++ ) {
+      std::array<double,3> x;
+      out->GetPoint( j, x.data() );
+      std::map<std::array<double,3>, vtkIdType>::iterator it = frozen.find( x );
+      if ( it != frozen.end() ) {
+        toGlobal[j] = it->second;
+        numFound++;
+      }
+    }
+    if ( numFound != frozen.size() ) {
+      return SV_ERROR;
+    }
+
+    std::map<std::pair<vtkIdType,vtkIdType>, int> edgeCount;
+    vtkCellArray *outPolys = out->GetPolys();
+    outPolys->InitTraversal();
+    while ( outPolys->GetNextCell( npts, pts ) ) {
+      for ( int j = 0; j < npts; j++ ) {
+        vtkIdType p0 = pts[j];
+        vtkIdType p1 = pts[(j+1)%npts];
+        edgeCount[std::make_pair( std::min( p0, p1 ), std::max( p0, p1 ) )]++;
+      }
+    }
+    std::map<std::pair<vtkIdType,vtkIdType>, int>::iterator eit;
+    for ( eit = edgeCount.begin(); eit != edgeCount.end(); ++eit ) {
+      if ( eit->second == 1 &&
+           ( toGlobal[eit->first.first] == -1 || toGlobal[eit->first.second] == -1 ) ) {
+        return SV_ERROR;
+      }
+    }
+  }
+
+  // Splice: untouched points and cells keep their order, the patch outputs
+  // follow
+  vtkNew(vtkPoints,outPts);
+  outPts->SetDataType( geom->GetPoints()->GetDataType() );
+  vtkNew(vtkCellArray,outPolys);
+  vtkPointData *outPD = output->GetPointData();
+  vtkCellData *outCD = output->GetCellData();
+  outPD->CopyAllocate( geom->GetPointData() );
+  outCD->CopyAllocate( geom->GetCellData() );
+
+  std::vector<vtkDataArray*> srcArrays;
+  std::vector<vtkIdType> newId( numPts, -1 );
+  sys_geom_MatchArrays( geom->GetPointData(), outPD, srcArrays );
+  for ( int i = 0; i < numPts; i++ ) {
+    if ( keepPoint[i] || !onPatch[i] ) {
+      newId[i] = outPts->InsertNextPoint( geom->GetPoint( i ) );
+      sys_geom_CopyMatchedTuple( srcArrays, i, outPD, newId[i] );
+    }
+  }
+
+  std::vector<vtkIdType> cellPts;
+  sys_geom_MatchArrays( geom->GetCellData(), outCD, srcArrays );
+  for ( int i = 0; i < numCells; i++ ) {
+    if ( inPatch[i] ) {
+      continue;
+    }
+    mesh->GetCellPoints( i, npts, pts );
+    cellPts.resize( npts );
+    for ( int j = 0; j < npts; j++ ) {
+      cellPts[j] = newId[pts[j]];
+    }
+    vtkIdType newCellId = outPolys->InsertNextCell( npts, &cellPts[0] );
+    sys_geom_CopyMatchedTuple( srcArrays, i, outCD, newCellId );
+  }
+
+  for ( int p = 0; p < numPatches; p++ ) {
+    vtkPolyData *out = patchOut[p];
+    std::vector<vtkIdType> &toGlobal = outToGlobal[p];
+    std::vector<vtkIdType> outId( out->GetNumberOfPoints() );
+
+    sys_geom_MatchArrays( out->GetPointData(), outPD, srcArrays );
+    for ( int j = 0; j < out->GetNumberOfPoints(); j++ ) {
+      if ( toGlobal[j] != -1 ) {
+        outId[j] = newId[toGlobal[j]];
+      } else {
+        outId[j] = outPts->InsertNextPoint( out->GetPoint( j ) );
+        sys_geom_CopyMatchedTuple( srcArrays, j, outPD, outId[j] );
+      }
+    }
+
+    sys_geom_MatchArrays( out->GetCellData(), outCD, srcArrays );
+    vtkCellArray *patchPolys = out->GetPolys();
+    vtkIdType cellId = 0;
+    patchPolys->InitTraversal();
+    while ( patchPolys->GetNextCell( npts, pts ) ) {
+      cellPts.resize( npts );
+      for ( int j = 0; j < npts; j++ ) {
+        cellPts[j] = outId[pts[j]];
+      }
+      vtkIdType newCellId = outPolys->InsertNextCell( npts, &cellPts[0] );
+      sys_geom_CopyMatchedTuple( srcArrays, cellId++, outCD, newCellId );
+    }
+  }
+
+  output->SetPoints( outPts );
+  output->SetPolys( outPolys );
+
+  return SV_OK;
+}
+
 /* -------------- */
 /* sys_geom_local_decimation */
 /* -------------- */
@@ -3805,24 +4140,37 @@ int sys_geom_local_laplacian_smooth( cvPolyData *pd,cvPolyData **outpd, int numi
   fprintf(stdout,"Point Array Name: %s\n",pointarrayname);
   fprintf(stdout,"Cell Array Name: %s\n",cellarrayname);
   try {
-    vtkNew(vtkSVLocalSmoothPolyDataFilter,smoother);
-    smoother->SetInputData(geom);
-    if (pointarrayname != 0)
-    {
-      smoother->SetSmoothPointArrayName(pointarrayname);
-      smoother->UsePointArrayOn();
-    }
-    if (cellarrayname != 0)
+    // Independent patches of the active region are processed concurrently
+    std::function<int(vtkPolyData*, vtkPolyData*)> smooth =
+      [&]( vtkPolyData *input, vtkPolyData *output ) -> int {
+      vtkNew(vtkSVLocalSmoothPolyDataFilter,smoother);
+      smoother->SetInputData(input);
+      if (pointarrayname != 0)
+      {
+        smoother->SetSmoothPointArrayName(pointarrayname);
+        smoother->UsePointArrayOn();
+      }
+      if (cellarrayname != 0)
+      {
+        smoother->SetSmoothCellArrayName(cellarrayname);
+        smoother->UseCellArrayOn();
+      }
+      smoother->SetNumberOfIterations(numiters);
+      smoother->SetRelaxationFactor(relax);
+      smoother->Update();
+      output->DeepCopy(smoother->GetOutput());
+      return SV_OK;
+    };
+
+    vtkNew(vtkPolyData,smoothed);
+    if (sys_geom_local_op_on_patches(geom,pointarrayname,cellarrayname,
+                                     SYS_GEOM_LOCAL_OP_RINGS,smooth,smoothed) != SV_OK)
     {
-      smoother->SetSmoothCellArrayName(cellarrayname);
-      smoother->UseCellArrayOn();
+      smooth(geom,smoothed);
     }
-    smoother->SetNumberOfIterations(numiters);
-    smoother->SetRelaxationFactor(relax);
-    smoother->Update();
 
     vtkNew(vtkPolyDataNormals,normaler);
-    normaler->SetInputData(smoother->GetOutput());
+    normaler->SetInputData(smoothed);
     normaler->ComputePointNormalsOff();
     normaler->ComputeCellNormalsOn();
     normaler->SplittingOff();
@@ -3944,22 +4292,35 @@ int sys_geom_local_linear_subdivision( cvPolyData *pd,cvPolyData **outpd, int nu
   fprintf(stdout,"Point Array Name: %s\n",pointarrayname);
   fprintf(stdout,"Cell Array Name: %s\n",cellarrayname);
   try {
-    vtkNew(vtkSVLocalLinearSubdivisionFilter,subdivider);
-    subdivider->SetInputData(geom);
-    if (pointarrayname != 0)
-    {
-      subdivider->SetSubdividePointArrayName(pointarrayname);
-      subdivider->UsePointArrayOn();
-    }
-    if (cellarrayname != 0)
+    // Independent patches of the active region are processed concurrently
+    std::function<int(vtkPolyData*, vtkPolyData*)> subdivide =
+      [&]( vtkPolyData *input, vtkPolyData *output ) -> int {
+      vtkNew(vtkSVLocalLinearSubdivisionFilter,subdivider);
+      subdivider->SetInputData(input);
+      if (pointarrayname != 0)
+      {
+        subdivider->SetSubdividePointArrayName(pointarrayname);
+        subdivider->UsePointArrayOn();
+      }
+      if (cellarrayname != 0)
+      {
+        subdivider->SetSubdivideCellArrayName(cellarrayname);
+        subdivider->UseCellArrayOn();
+      }
+      subdivider->SetNumberOfSubdivisions(numiters);
+      subdivider->Update();
+      output->DeepCopy(subdivider->GetOutput());
+      return SV_OK;
+    };
+
+    vtkNew(vtkPolyData,subdivided);
+    if (sys_geom_local_op_on_patches(geom,pointarrayname,cellarrayname,
+                                     SYS_GEOM_LOCAL_OP_RINGS+numiters,subdivide,subdivided) != SV_OK)
     {
-      subdivider->SetSubdivideCellArrayName(cellarrayname);
-      subdivider->UseCellArrayOn();
+      subdivide(geom,subdivided);
     }
-    subdivider->SetNumberOfSubdivisions(numiters);
-    subdivider->Update();
 
-    result = new cvPolyData( subdivider->GetOutput());
+    result = new cvPolyData( subdivided );
     *outpd = result;
   }
   catch (...) {
@@ -4003,22 +4364,35 @@ int sys_geom_local_butterfly_subdivision( cvPolyData *pd,cvPolyData **outpd, int
   fprintf(stdout,"Point Array Name: %s\n",pointarrayname);
   fprintf(stdout,"Cell Array Name: %s\n",cellarrayname);
   try {
-    vtkNew(vtkSVLocalButterflySubdivisionFilter,subdivider);
-    subdivider->SetInputData(geom);
-    if (pointarrayname != 0)
-    {
-      subdivider->SetSubdividePointArrayName(pointarrayname);
-      subdivider->UsePointArrayOn();
-    }
-    if (cellarrayname != 0)
+    // Independent patches of the active region are processed concurrently
+    std::function<int(vtkPolyData*, vtkPolyData*)> subdivide =
+      [&]( vtkPolyData *input, vtkPolyData *output ) -> int {
+      vtkNew(vtkSVLocalButterflySubdivisionFilter,subdivider);
+      subdivider->SetInputData(input);
+      if (pointarrayname != 0)
+      {
+        subdivider->SetSubdividePointArrayName(pointarrayname);
+        subdivider->UsePointArrayOn();
+      }
+      if (cellarrayname != 0)
+      {
+        subdivider->SetSubdivideCellArrayName(cellarrayname);
+        subdivider->UseCellArrayOn();
+      }
+      subdivider->SetNumberOfSubdivisions(numiters);
+      subdivider->Update();
+      output->DeepCopy(subdivider->GetOutput());
+      return SV_OK;
+    };
+
+    vtkNew(vtkPolyData,subdivided);
+    if (sys_geom_local_op_on_patches(geom,pointarrayname,cellarrayname,
+                                     SYS_GEOM_LOCAL_OP_RINGS+numiters,subdivide,subdivided) != SV_OK)
     {
-      subdivider->SetSubdivideCellArrayName(cellarrayname);
-      subdivider->UseCellArrayOn();
+      subdivide(geom,subdivided);
     }
-    subdivider->SetNumberOfSubdivisions(numiters);
-    subdivider->Update();
 
-    result = new cvPolyData( subdivider->GetOutput());
+    result = new cvPolyData( subdivided );
     *outpd = result;
   }
   catch (...) {
@@ -4062,22 +4436,35 @@ int sys_geom_local_loop_subdivision( cvPolyData *pd,cvPolyData **outpd, int numi
   fprintf(stdout,"Point Array Name: %s\n",pointarrayname);
   fprintf(stdout,"Cell Array Name: %s\n",cellarrayname);
   try {
-    vtkNew(vtkSVLocalLoopSubdivisionFilter,subdivider);
-    subdivider->SetInputData(geom);
-    if (pointarrayname != 0)
-    {
-      subdivider->SetSubdividePointArrayName(pointarrayname);
-      subdivider->UsePointArrayOn();
-    }
-    if (cellarrayname != 0)
+    // Independent patches of the active region are processed concurrently
+    std::function<int(vtkPolyData*, vtkPolyData*)> subdivide =
+      [&]( vtkPolyData *input, vtkPolyData *output ) -> int {
+      vtkNew(vtkSVLocalLoopSubdivisionFilter,subdivider);
+      subdivider->SetInputData(input);
+      if (pointarrayname != 0)
+      {
+        subdivider->SetSubdividePointArrayName(pointarrayname);
+        subdivider->UsePointArrayOn();
+      }
+      if (cellarrayname != 0)
+      {
+        subdivider->SetSubdivideCellArrayName(cellarrayname);
+        subdivider->UseCellArrayOn();
+      }
+      subdivider->SetNumberOfSubdivisions(numiters);
+      subdivider->Update();
+      output->DeepCopy(subdivider->GetOutput());
+      return SV_OK;
+    };
+
+    vtkNew(vtkPolyData,subdivided);
+    if (sys_geom_local_op_on_patches(geom,pointarrayname,cellarrayname,
+                                     SYS_GEOM_LOCAL_OP_RINGS+numiters,subdivide,subdivided) != SV_OK)
     {
-      subdivider->SetSubdivideCellArrayName(cellarrayname);
-      subdivider->UseCellArrayOn();
+      subdivide(geom,subdivided);
     }
-    subdivider->SetNumberOfSubdivisions(numiters);
-    subdivider->Update();
 
-    result = new cvPolyData( subdivider->GetOutput());
+    result = new cvPolyData( subdivided );
     *outpd = result;
   }
   catch (...) {
@@ -148,6 +148,15 @@ SV_EXPORT_SYSGEOM int sys_geom_InterpolateVector( cvPolyData *src, double pt[],
 
 SV_EXPORT_SYSGEOM int sys_geom_IntersectWithLine( cvPolyData *src, double p0[], double p1[], double intersect[] );
 
+// Batch versions of the above. Points and line end points are consecutive
+// xyz triples, and queries run in parallel against the locators cached on src.
+SV_EXPORT_SYSGEOM int sys_geom_InterpolateScalars( cvPolyData *src, int numPts, double pts[], double scalars[] );
+
+SV_EXPORT_SYSGEOM int sys_geom_InterpolateVectors( cvPolyData *src, int numPts, double pts[], double vects[] );
+
+SV_EXPORT_SYSGEOM int sys_geom_IntersectWithLines( cvPolyData *src, int numLines, double p0s[], double p1s[],
+                                                   double intersects[], int found[] );
+
 SV_EXPORT_SYSGEOM cvPolyData* sys_geom_warp3dPts( cvPolyData *src, double scale );
 
 enum sys_geom_math_scalar {
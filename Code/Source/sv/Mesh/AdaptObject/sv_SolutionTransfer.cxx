@@ -0,0 +1,416 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @file sv_SolutionTransfer.cxx
+ *  @brief The implementations of functions in cvSolutionTransfer
+ */
+
+#include "SimVascular.h"
+
+#include "sv_SolutionTransfer.h"
+
+#include "vtkCellLocator.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <stdio.h>
+
+namespace {
+
+// Locates the source cell containing each target point. FindCell is only
+// handed thread local scratch objects so the locator can be shared.
+class StencilFunctor
+{
+public:
+  vtkCellLocator *Locator;
+  vtkPointSet *Target;
+  int Stride;
+  vtkIdType *Ids;
+  double *Weights;
+  char *Found;
+
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+  vtkSMPThreadLocal<std::vector<double> > Scratch;
+
+  void Initialize()
+  {
+    this->Scratch.Local().resize(this->Stride);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell *cell = this->Cell.Local();
+    std::vector<double> &w = this->Scratch.Local();
+    double x[3], pcoords[3];
+
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+    {
+      this->Target->GetPoint(ptId, x);
+      vtkIdType cellId = this->Locator->FindCell(x, 0.0, cell, pcoords, &w[0]);
+      if (cellId < 0)
+      {
+        this->Found[ptId] = 0;
+        continue;
+      }
+      this->Found[ptId] = 1;
+
+      vtkIdType offset = ptId*this->Stride;
+      int npts = cell->GetNumberOfPoints();
+      for (int i=0; i<npts; i++)
+      {
+        this->Ids[offset+i] = cell->GetPointId(i);
+        this->Weights[offset+i] = w[i];
+      }
+    }
+  }
+
+  void Reduce() {}
+};
+
+// Applies the stencil to every component of one array.
+class InterpolateFunctor
+{
+public:
+  vtkDataArray *In;
+  int NumComps;
+  int Stride;
+  const vtkIdType *Ids;
+  const double *Weights;
+  double *Out;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+    {
+      double *val = this->Out + ptId*this->NumComps;
+      for (int j=0; j<this->NumComps; j++)
+        val[j] = 0.0;
+
+      vtkIdType offset = ptId*this->Stride;
+      for (int i=0; i<this->Stride; i++)
+      {
+        vtkIdType id = this->Ids[offset+i];
+        if (id < 0)
+          break;
+        double weight = this->Weights[offset+i];
+        for (int j=0; j<this->NumComps; j++)
+          val[j] += weight*this->In->GetComponent(id, j);
+      }
+    }
+  }
+};
+
+} // namespace
+
+cvSolutionTransfer::cvSolutionTransfer()
+{
+  source_ = NULL;
+  target_ = NULL;
+  sourceTime_ = 0;
+  targetTime_ = 0;
+  numSourceCells_ = 0;
+  numOutside_ = 0;
+  stride_ = 0;
+}
+
+cvSolutionTransfer::~cvSolutionTransfer()
+{
+  this->Reset();
+}
+
+void cvSolutionTransfer::Reset()
+{
+  source_ = NULL;
+  target_ = NULL;
+  sourceTime_ = 0;
+  targetTime_ = 0;
+  numSourceCells_ = 0;
+  numOutside_ = 0;
+  stride_ = 0;
+  pointIds_.clear();
+  weights_.clear();
+}
+
+int cvSolutionTransfer::IsBuiltFor(vtkPointSet *source, vtkPointSet *target) const
+{
+  if (source == NULL || target == NULL)
+    return 0;
+  if (source != source_ || target != target_)
+    return 0;
+  if (source->GetPoints() == NULL || target->GetPoints() == NULL)
+    return 0;
+  if (source->GetPoints()->GetMTime() != sourceTime_ ||
+      target->GetPoints()->GetMTime() != targetTime_)
+    return 0;
+  if (source->GetNumberOfCells() != numSourceCells_)
+    return 0;
+  if ((vtkIdType) pointIds_.size() != target->GetNumberOfPoints()*stride_)
+    return 0;
+
+  return 1;
+}
+
+// -----------------------
+//  BuildStencil
+// -----------------------
+/**
+ * @brief Finds the source cell and interpolation weights of every target
+ * point
+ * @param source The mesh holding the data, typically the original mesh
+ * @param target The mesh receiving the data, typically the adapted mesh
+ * @note Target points outside of the source (e.g. on curved walls) take the
+ * weights of the closest point on the closest source cell.
+ */
+int cvSolutionTransfer::BuildStencil(vtkPointSet *source, vtkPointSet *target)
+{
+  this->Reset();
+
+  if (source == NULL || target == NULL)
+  {
+    fprintf(stderr,"Source and target meshes must be given\n");
+    return SV_ERROR;
+  }
+  if (source->GetNumberOfCells() == 0 || source->GetPoints() == NULL)
+  {
+    fprintf(stderr,"Source mesh has no cells\n");
+    return SV_ERROR;
+  }
+  if (target->GetPoints() == NULL)
+  {
+    fprintf(stderr,"Target mesh has no points\n");
+    return SV_ERROR;
+  }
+
+  vtkIdType numPts = target->GetNumberOfPoints();
+  stride_ = source->GetMaxCellSize();
+  pointIds_.assign(numPts*stride_, -1);
+  weights_.assign(numPts*stride_, 0.0);
+  std::vector<char> found(numPts, 0);
+
+  vtkSmartPointer<vtkCellLocator> locator =
+    vtkSmartPointer<vtkCellLocator>::New();
+  locator->SetDataSet(source);
+  locator->CacheCellBoundsOn();
+  locator->BuildLocator();
+
+  // Build anything the source computes lazily before threads share it
+  vtkSmartPointer<vtkGenericCell> cell =
+    vtkSmartPointer<vtkGenericCell>::New();
+  source->GetCell(0, cell);
+
+  if (numPts > 0)
+  {
+    StencilFunctor stencil;
+    stencil.Locator = locator;
+    stencil.Target  = target;
+    stencil.Stride  = stride_;
+    stencil.Ids     = &pointIds_[0];
+    stencil.Weights = &weights_[0];
+    stencil.Found   = &found[0];
+    vtkSMPTools::For(0, numPts, stencil);
+  }
+
+  // The closest point search keeps internal state, so the few points that
+  // are outside the source are handled serially.
+  std::vector<double> w(stride_);
+  double x[3], closestPt[3], pcoords[3], dist2;
+  int subId;
+  vtkIdType cellId;
+  for (vtkIdType ptId=0; ptId<numPts; ptId++)
+  {
+    if (found[ptId])
+      continue;
+
+    target->GetPoint(ptId, x);
+    locator->FindClosestPoint(x, closestPt, cell, cellId, subId, dist2);
+    if (cellId < 0)
+    {
+      fprintf(stderr,"Could not find a source cell for point %lld\n",
+        (long long) ptId);
+      this->Reset();
+      return SV_ERROR;
+    }
+    cell->EvaluatePosition(closestPt, NULL, subId, pcoords, dist2, &w[0]);
+
+    vtkIdType offset = ptId*stride_;
+    int npts = cell->GetNumberOfPoints();
+    for (int i=0; i<npts; i++)
+    {
+      pointIds_[offset+i] = cell->GetPointId(i);
+      weights_[offset+i] = w[i];
+    }
+    numOutside_++;
+  }
+
+  source_ = source;
+  target_ = target;
+  sourceTime_ = source->GetPoints()->GetMTime();
+  targetTime_ = target->GetPoints()->GetMTime();
+  numSourceCells_ = source->GetNumberOfCells();
+
+  return SV_OK;
+}
+
+// -----------------------
+//  TransferArray
+// -----------------------
+/**
+ * @brief Interpolates a source point array onto the target points with the
+ * cached stencil
+ * @param inArray Array with one tuple per source point
+ * @param outArray Array that is resized and filled, one tuple per target
+ * point
+ */
+int cvSolutionTransfer::TransferArray(vtkDataArray *inArray, vtkDataArray *outArray)
+{
+  if (source_ == NULL || target_ == NULL)
+  {
+    fprintf(stderr,"Stencil must be built before transferring data\n");
+    return SV_ERROR;
+  }
+  if (inArray == NULL || outArray == NULL)
+  {
+    fprintf(stderr,"Arrays must be given for transfer\n");
+    return SV_ERROR;
+  }
+  if (inArray->GetNumberOfTuples() != source_->GetNumberOfPoints())
+  {
+    fprintf(stderr,"Array %s does not match the source mesh\n",
+      inArray->GetName() ? inArray->GetName() : "");
+    return SV_ERROR;
+  }
+
+  int numComps = inArray->GetNumberOfComponents();
+  vtkIdType numPts = target_->GetNumberOfPoints();
+
+  outArray->SetNumberOfComponents(numComps);
+  outArray->SetNumberOfTuples(numPts);
+  if (outArray->GetName() == NULL)
+    outArray->SetName(inArray->GetName());
+  if (numPts == 0)
+    return SV_OK;
+
+  // Double arrays are written in place, anything else goes through a buffer
+  vtkDoubleArray *outDouble = vtkDoubleArray::SafeDownCast(outArray);
+  std::vector<double> buffer;
+  double *out;
+  if (outDouble != NULL)
+    out = outDouble->GetPointer(0);
+  else
+  {
+    buffer.resize(numPts*numComps);
+    out = &buffer[0];
+  }
+
+  InterpolateFunctor interpolate;
+  interpolate.In       = inArray;
+  interpolate.NumComps = numComps;
+  interpolate.Stride   = stride_;
+  interpolate.Ids      = &pointIds_[0];
+  interpolate.Weights  = &weights_[0];
+  interpolate.Out      = out;
+  vtkSMPTools::For(0, numPts, interpolate);
+
+  if (outDouble == NULL)
+  {
+    for (vtkIdType ptId=0; ptId<numPts; ptId++)
+      for (int j=0; j<numComps; j++)
+        outArray->SetComponent(ptId, j, buffer[ptId*numComps+j]);
+  }
+  outArray->Modified();
+
+  return SV_OK;
+}
+
+int cvSolutionTransfer::TransferArray(const char *name)
+{
+  if (source_ == NULL || target_ == NULL)
+  {
+    fprintf(stderr,"Stencil must be built before transferring data\n");
+    return SV_ERROR;
+  }
+
+  vtkDataArray *inArray = source_->GetPointData()->GetArray(name);
+  if (inArray == NULL)
+  {
+    fprintf(stderr,"Array %s does not exist on mesh\n",name);
+    return SV_ERROR;
+  }
+
+  vtkDataArray *outArray = inArray->NewInstance();
+  outArray->SetName(name);
+  int status = this->TransferArray(inArray, outArray);
+  if (status == SV_OK)
+    target_->GetPointData()->AddArray(outArray);
+  outArray->Delete();
+
+  return status;
+}
+
+// -----------------------
+//  TransferAllArrays
+// -----------------------
+/**
+ * @brief Transfers all floating point arrays of the source point data.
+ * @note Integer arrays such as ids can not be interpolated and are skipped.
+ */
+int cvSolutionTransfer::TransferAllArrays()
+{
+  if (source_ == NULL || target_ == NULL)
+  {
+    fprintf(stderr,"Stencil must be built before transferring data\n");
+    return SV_ERROR;
+  }
+
+  vtkPointData *pd = source_->GetPointData();
+  int numArrays = pd->GetNumberOfArrays();
+  for (int i=0; i<numArrays; i++)
+  {
+    vtkDataArray *inArray = pd->GetArray(i);
+    if (inArray == NULL || inArray->GetName() == NULL)
+      continue;
+    int type = inArray->GetDataType();
+    if (type != VTK_DOUBLE && type != VTK_FLOAT)
+      continue;
+
+    if (this->TransferArray(inArray->GetName()) != SV_OK)
+      return SV_ERROR;
+  }
+
+  return SV_OK;
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @file sv_SolutionTransfer.h
+ *  @brief Cached interpolation of point data from one mesh onto another
+ *  @details The source mesh is searched only once.  Every target node is
+ *  mapped to the source cell that contains it along with its
+ *  interpolation weights, and that stencil is then reused for every
+ *  array (time step, restart field, ...) that is transferred.
+ */
+
+#ifndef __CVSOLUTIONTRANSFER_H
+#define __CVSOLUTIONTRANSFER_H
+
+#include "SimVascular.h"
+#include "svAdaptorExports.h" // For exports
+
+#include "vtkDataArray.h"
+#include "vtkPointSet.h"
+
+#include <vector>
+
+class SV_EXPORT_ADAPTOR cvSolutionTransfer {
+
+public:
+  cvSolutionTransfer();
+  ~cvSolutionTransfer();
+
+  /** @brief Map every point of target to a cell of source. Must be called
+   *  before any Transfer* method and again whenever either mesh changes. */
+  int BuildStencil(vtkPointSet *source, vtkPointSet *target);
+
+  /** @brief Drop the stencil and references to the meshes. */
+  void Reset();
+
+  /** @brief Whether the stencil maps target onto source and neither mesh
+   *  has been moved or reconnected since it was built. */
+  int IsBuiltFor(vtkPointSet *source, vtkPointSet *target) const;
+
+  /** @brief Number of target points that fell outside the source mesh and
+   *  were instead mapped to the closest source cell. */
+  vtkIdType GetNumberOfOutsidePoints() const {return numOutside_;}
+
+  /** @brief Interpolate inArray (sized to the source points) into outArray
+   *  (resized to the target points). Components and type follow inArray. */
+  int TransferArray(vtkDataArray *inArray, vtkDataArray *outArray);
+
+  /** @brief Interpolate the named source point data array and add it to the
+   *  target point data under the same name. */
+  int TransferArray(const char *name);
+
+  /** @brief Transfer every point data array of the source mesh. */
+  int TransferAllArrays();
+
+private:
+  cvSolutionTransfer(const cvSolutionTransfer&);
+  cvSolutionTransfer& operator=(const cvSolutionTransfer&);
+
+  vtkPointSet *source_;
+  vtkPointSet *target_;
+  vtkMTimeType sourceTime_;
+  vtkMTimeType targetTime_;
+  vtkIdType numSourceCells_;
+  vtkIdType numOutside_;
+
+  // Fixed-stride stencil, stride_ entries per target point. Unused entries
+  // have a point id of -1 and a weight of zero.
+  int stride_;
+  std::vector<vtkIdType> pointIds_;
+  std::vector<double> weights_;
+};
+
+#endif // __CVSOLUTIONTRANSFER_H
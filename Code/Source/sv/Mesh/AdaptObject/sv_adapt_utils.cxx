@@ -485,23 +485,23 @@ int AdaptUtils_getAttachedArray( double *&valueArray,
  * new mesh
  * @param inmesh This is the original mesh
  * @param outmesh This is the new adapted mesh that needs solution information
- * @param nVar This is the number of components in the solutions array
- * @note This takes the solution from the closest node
+ * @param outstep This is the step of the velocity and pressure arrays to use
+ * @param transfer Optional cached stencil, reused if it is already built for
+ * these meshes
+ * @note This interpolates within the enclosing element of the original mesh
  */
-int AdaptUtils_fix4SolutionTransfer(vtkUnstructuredGrid *inmesh,vtkUnstructuredGrid *outmesh,int outstep)
+int AdaptUtils_fix4SolutionTransfer(vtkUnstructuredGrid *inmesh,vtkUnstructuredGrid *outmesh,int outstep,
+                                    cvSolutionTransfer *transfer)
 {
   int i;
   int numVerts;
-  double xyz[3];
-//  double solution[nVar];
   vtkIdType pointId;
-  vtkIdType closestPoint;
-  vtkDoubleArray *inVel;
-  vtkDoubleArray *inPress;
   vtkSmartPointer<vtkDoubleArray> outSol =
     vtkSmartPointer<vtkDoubleArray>::New();
-  vtkSmartPointer<vtkPointLocator> locator =
-    vtkSmartPointer<vtkPointLocator>::New();
+  vtkSmartPointer<vtkDoubleArray> outVel =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  vtkSmartPointer<vtkDoubleArray> outPress =
+    vtkSmartPointer<vtkDoubleArray>::New();
 
   numVerts = outmesh->GetNumberOfPoints();
 
@@ -519,30 +519,35 @@ int AdaptUtils_fix4SolutionTransfer(vtkUnstructuredGrid *inmesh,vtkUnstructuredG
     fprintf(stderr,"Array %s does not exist on mesh\n",press);
     return SV_ERROR;
   }
+
+  cvSolutionTransfer localTransfer;
+  if (transfer == NULL)
+    transfer = &localTransfer;
+  if (!transfer->IsBuiltFor(inmesh,outmesh))
+  {
+    if (transfer->BuildStencil(inmesh,outmesh) != SV_OK)
+      return SV_ERROR;
+  }
+
+  if (transfer->TransferArray(inmesh->GetPointData()->GetArray(vel),outVel) != SV_OK)
+    return SV_ERROR;
+  if (transfer->TransferArray(inmesh->GetPointData()->GetArray(press),outPress) != SV_OK)
+    return SV_ERROR;
+
   outSol->SetNumberOfComponents(5);
-  outSol->Allocate(numVerts,10000);
   outSol->SetNumberOfTuples(numVerts);
   outSol->SetName("solution");
 
-  inVel = vtkDoubleArray::SafeDownCast(inmesh->GetPointData()->GetArray(vel));
-  inPress = vtkDoubleArray::SafeDownCast(inmesh->GetPointData()->GetArray(press));
-
-  locator->SetDataSet(inmesh);
-  locator->BuildLocator();
-
   for (pointId=0;pointId<numVerts;pointId++)
   {
-    outmesh->GetPoint(pointId,xyz);
-    closestPoint = locator->FindClosestPoint(xyz);
-
-    double vel[3];
+    double v[3];
     for (i=0;i<3;i++)
     {
-      vel[i] = inVel->GetComponent(closestPoint,i);
-      outSol->SetComponent(pointId,i,vel[i]);
+      v[i] = outVel->GetComponent(pointId,i);
+      outSol->SetComponent(pointId,i,v[i]);
     }
-    outSol->SetComponent(pointId,3,inPress->GetValue(closestPoint));
-    outSol->SetComponent(pointId,4,sqrt(pow(vel[0],2)+pow(vel[1],2)+pow(vel[2],2)));
+    outSol->SetComponent(pointId,3,outPress->GetValue(pointId));
+    outSol->SetComponent(pointId,4,sqrt(pow(v[0],2)+pow(v[1],2)+pow(v[2],2)));
   }
 
   outmesh->GetPointData()->AddArray(outSol);
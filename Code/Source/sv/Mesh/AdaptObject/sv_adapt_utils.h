@@ -49,6 +49,7 @@
 #include "SimVascular.h"
 #include "svAdaptorExports.h" // For exports
 #include "sv_misc_utils.h"
+#include "sv_SolutionTransfer.h"
 
 #include "vtkUnstructuredGrid.h"
 #include "vtkPolyData.h"
@@ -128,8 +129,11 @@ SV_EXPORT_ADAPTOR int AdaptUtils_attachArray ( double *valueArray, vtkUnstructur
 SV_EXPORT_ADAPTOR int AdaptUtils_getAttachedArray ( double *&valueArray, vtkUnstructuredGrid *mesh,
                        std::string dataName, int nVar, int poly, bool for_restart=false);
 
-// just take the value from any adjacent vertex
-SV_EXPORT_ADAPTOR int AdaptUtils_fix4SolutionTransfer (vtkUnstructuredGrid *inmesh,vtkUnstructuredGrid *outmesh,int outstep);
+// interpolate the solution at outstep onto the new mesh
+// `transfer' is rebuilt only if it was built for other meshes, so
+// passing the same one for several steps locates the nodes once
+SV_EXPORT_ADAPTOR int AdaptUtils_fix4SolutionTransfer (vtkUnstructuredGrid *inmesh,vtkUnstructuredGrid *outmesh,int outstep,
+    cvSolutionTransfer *transfer=NULL);
 
 SV_EXPORT_ADAPTOR int AdaptUtils_modelFaceIDTransfer(vtkPolyData *inpd,vtkPolyData *outpd);
 
@@ -35,6 +35,8 @@
 #include "vtkDataSetSurfaceFilter.h"
 #include "vtkEdgeTable.h"
 #include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkPointLocator.h"
 #include "vtkPoints.h"
 #include "vtkSmartPointer.h"
 #include "vtkSVFindSeparateRegions.h"
@@ -43,9 +45,15 @@
 #include "sv_mmg_mesh_utils.h"
 #include "sv_polydatasolid_utils.h"
 #include "sv_vtk_utils.h"
+#include "sv_parallel_utils.h"
+#include "sv_geometry_cache.h"
 
 #include "mmg/mmgs/libmmgs.h"
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 int MMGUtils_ConvertToMMG(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatasolid,
     double hmin, double hmax, double hausd, double angle, double hgrad,
     int useSizingFunction, vtkDoubleArray *meshSizingFunction, int numAddedRefines)
@@ -61,6 +69,11 @@ int MMGUtils_ConvertToMMG(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatas
     return SV_OK;
   }
   boundaryScalars = vtkIntArray::SafeDownCast(polydatasolid->GetCellData()->GetArray("ModelFaceID"));
+  if (boundaryScalars == NULL)
+  {
+    fprintf(stderr,"Array 'ModelFaceID' must be an integer array\n");
+    return SV_ERROR;
+  }
   double minmax[2];
   boundaryScalars->GetRange(minmax, 0);
   int range = minmax[1] - minmax[0];
@@ -242,7 +255,8 @@ int MMGUtils_ConvertToMMG(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatas
   return SV_OK;
 }
 
-int MMGUtils_ConvertToVTK(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatasolid)
+int MMGUtils_ConvertToVTK(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatasolid,
+    std::string solArrayName, double solScale)
 {
   MMG5_pPoint ppt;
   vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
@@ -283,6 +297,20 @@ int MMGUtils_ConvertToVTK(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatas
   polydatasolid->SetPolys(faces);
   polydatasolid->GetCellData()->AddArray(outScalars);
 
+  //The metric is kept on the output vertices, so it can be passed back
+  //directly by index rather than searched for on the original surface
+  if (solArrayName != "" && sol != NULL && sol->m != NULL && sol->np == mesh->np)
+  {
+    vtkSmartPointer<vtkDoubleArray> solArray =
+      vtkSmartPointer<vtkDoubleArray>::New();
+    solArray->SetNumberOfComponents(1);
+    solArray->SetNumberOfTuples(mesh->np);
+    solArray->SetName(solArrayName.c_str());
+    for (int i=0;i<mesh->np;i++)
+      solArray->SetValue(i,solScale*sol->m[i+1]);
+    polydatasolid->GetPointData()->AddArray(solArray);
+  }
+
   vtkSmartPointer<vtkCleanPolyData> cleaner =
     vtkSmartPointer<vtkCleanPolyData>::New();
   cleaner->SetInputData(polydatasolid);
@@ -309,6 +337,25 @@ int MMGUtils_ConvertToVTK(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatas
 
 int MMGUtils_SurfaceRemeshing(vtkPolyData *surface, double hmin, double hmax, double hausd, double angle, double hgrad, int useSizingFunction, vtkDoubleArray *meshSizingFunction, int numAddedRefines)
 {
+  //The same surface remeshed with the same parameters comes from the
+  //geometry cache
+  bool useCache = GeometryCache_IsEnabled();
+  vtkTypeUInt64 cacheKey = 0;
+  if (useCache)
+  {
+    double params[5] = {hmin, hmax, hausd, angle, hgrad};
+    int options[2] = {useSizingFunction, numAddedRefines};
+    cacheKey = GeometryCache_GetSeed("mmgremesh");
+    cacheKey = VtkUtils_HashBytes(params, sizeof(params), cacheKey);
+    cacheKey = VtkUtils_HashBytes(options, sizeof(options), cacheKey);
+    if (useSizingFunction && meshSizingFunction != NULL)
+      cacheKey = VtkUtils_HashDataArray(meshSizingFunction, cacheKey);
+    cacheKey = VtkUtils_HashDataSet(surface, cacheKey);
+
+    if (GeometryCache_Get("mmgremesh", cacheKey, surface) == SV_OK)
+      return SV_OK;
+  }
+
   vtkSmartPointer<vtkCleanPolyData> cleaner =
     vtkSmartPointer<vtkCleanPolyData>::New();
   cleaner->SetInputData(surface);
@@ -399,7 +446,7 @@ int MMGUtils_SurfaceRemeshing(vtkPolyData *surface, double hmin, double hmax, do
   }
   if (VtkUtils_PDCheckArrayName(surface,1,"WallID"))
   {
-    if (MMGUtils_PassCellArray(pd,surface,"WallID","WallID") != SV_OK)
+    if (MMGUtils_PassCellArrayByRegion(pd,surface,"WallID","ModelFaceID") != SV_OK)
     {
       fprintf(stderr,"Error passing walls\n");
       MMGS_Free_all(MMG5_ARG_start,
@@ -445,6 +492,433 @@ int MMGUtils_SurfaceRemeshing(vtkPolyData *surface, double hmin, double hmax, do
         	MMG5_ARG_ppMesh,&mesh,MMG5_ARG_ppMet,&sol,
         	MMG5_ARG_end);
 
+  if (useCache)
+    GeometryCache_Put("mmgremesh", cacheKey, surface);
+
+  return SV_OK;
+}
+
+namespace {
+
+// One face region remeshed on its own, with its boundary held fixed
+struct MMGFacePatch
+{
+  int faceId;
+  std::vector<vtkIdType> ptIds;
+  std::vector<double> coords;
+  std::vector<double> sizes;
+  std::vector<int> onBoundary;
+  std::vector<int> tris;
+  std::vector<int> edges;
+
+  std::vector<double> outCoords;
+  std::vector<vtkIdType> outPtIds;
+  std::vector<int> outTris;
+  int status;
+};
+
+// Remesh a single patch. Only touches the patch and its own MMG structures
+// so several patches can be remeshed at the same time.
+int MMGUtils_RemeshFacePatch(MMGFacePatch *patch, double hmin, double hmax,
+    double hausd)
+{
+  int numPts   = patch->ptIds.size();
+  int numTris  = patch->tris.size()/3;
+  int numEdges = patch->edges.size()/2;
+
+  MMG5_pMesh mesh = NULL;
+  MMG5_pSol  sol = NULL;
+  MMGS_Init_mesh(MMG5_ARG_start,
+        	 MMG5_ARG_ppMesh,&mesh,MMG5_ARG_ppMet,&sol,
+        	 MMG5_ARG_end);
+
+  int ok = 1;
+  ok = ok && MMGS_Set_iparameter(mesh, sol, MMGS_IPARAM_verbose, -1);
+  ok = ok && MMGS_Set_iparameter(mesh, sol, MMGS_IPARAM_angle, 0);
+  ok = ok && MMGS_Set_dparameter(mesh, sol, MMGS_DPARAM_hmin, hmin);
+  ok = ok && MMGS_Set_dparameter(mesh, sol, MMGS_DPARAM_hmax, hmax);
+  ok = ok && MMGS_Set_dparameter(mesh, sol, MMGS_DPARAM_hausd, hausd);
+  ok = ok && MMGS_Set_meshSize(mesh, numPts, numTris, numEdges);
+  ok = ok && MMGS_Set_solSize(mesh, sol, MMG5_Vertex, numPts, MMG5_Scalar);
+
+  for (int i=0;i<numPts && ok;i++)
+  {
+    // Boundary vertices carry their local id as reference so they can be
+    // matched back after MMG renumbers the points
+    int ref = patch->onBoundary[i] ? i+1 : 0;
+    ok = ok && MMGS_Set_vertex(mesh, patch->coords[3*i], patch->coords[3*i+1],
+                               patch->coords[3*i+2], ref, i+1);
+    ok = ok && MMGS_Set_scalarSol(sol, patch->sizes[i], i+1);
+    if (patch->onBoundary[i])
+      ok = ok && MMGS_Set_requiredVertex(mesh, i+1);
+  }
+  for (int i=0;i<numTris && ok;i++)
+  {
+    ok = ok && MMGS_Set_triangle(mesh, patch->tris[3*i]+1, patch->tris[3*i+1]+1,
+                                 patch->tris[3*i+2]+1, patch->faceId, i+1);
+  }
+  for (int i=0;i<numEdges && ok;i++)
+  {
+    ok = ok && MMGS_Set_edge(mesh, patch->edges[2*i]+1, patch->edges[2*i+1]+1,
+                             patch->faceId, i+1);
+    ok = ok && MMGS_Set_requiredEdge(mesh, i+1);
+  }
+
+  if (!ok || MMGS_Chk_meshData(mesh,sol) != 1 ||
+      MMGS_mmgslib(mesh, sol) == MMG5_STRONGFAILURE)
+  {
+    MMGS_Free_all(MMG5_ARG_start,
+		  MMG5_ARG_ppMesh,&mesh,MMG5_ARG_ppMet,&sol,
+		  MMG5_ARG_end);
+    return SV_ERROR;
+  }
+
+  // Required vertices keep their reference, which gives the original point
+  // id. MMG scales and unscales the coordinates, so they are only compared
+  // within a tolerance, and a required vertex whose reference does not
+  // match is looked up among the boundary points by distance.
+  double tol2 = 1.0e-6*hmin*hmin;
+  std::vector<int> boundaryPts;
+  for (int i=0;i<numPts;i++)
+  {
+    if (patch->onBoundary[i])
+      boundaryPts.push_back(i);
+  }
+
+  int np, nt, na;
+  MMGS_Get_meshSize(mesh, &np, &nt, &na);
+  patch->outCoords.resize(3*np);
+  patch->outPtIds.assign(np, -1);
+  for (int i=0;i<np;i++)
+  {
+    double *c = &patch->outCoords[3*i];
+    int ref, isCorner, isRequired;
+    MMGS_Get_vertex(mesh, &c[0], &c[1], &c[2], &ref, &isCorner, &isRequired);
+    if (!isRequired)
+      continue;
+
+    int local = -1;
+    if (ref >= 1 && ref <= numPts && patch->onBoundary[ref-1] &&
+        vtkMath::Distance2BetweenPoints(c, &patch->coords[3*(ref-1)]) <= tol2)
+      local = ref-1;
+    for (int j=0;j<boundaryPts.size() && local == -1;j++)
+    {
+      if (vtkMath::Distance2BetweenPoints(c, &patch->coords[3*boundaryPts[j]]) <= tol2)
+        local = boundaryPts[j];
+    }
+    if (local != -1)
+      patch->outPtIds[i] = patch->ptIds[local];
+  }
+
+  patch->outTris.resize(3*nt);
+  for (int i=0;i<nt;i++)
+  {
+    MMG5_pTria tria = &mesh->tria[i+1];
+    for (int j=0;j<3;j++)
+      patch->outTris[3*i+j] = tria->v[j] - 1;
+  }
+
+  MMGS_Free_all(MMG5_ARG_start,
+        	MMG5_ARG_ppMesh,&mesh,MMG5_ARG_ppMet,&sol,
+        	MMG5_ARG_end);
+
+  return SV_OK;
+}
+
+}
+
+/**
+ * @brief Remesh all faces that are not excluded, each face on its own
+ * @param *surface surface with 'ModelFaceID' that is remeshed in place
+ * @param *excluded face ids that are left untouched; can be NULL
+ * @param *meshSizingFunction point sizes on the surface when
+ * useSizingFunction is set
+ * @note The edges a face shares with its neighbours are kept fixed, so
+ * the faces are independent and are remeshed concurrently. Cell data is
+ * passed to the new triangles by index from a cell of the same face.
+ * Original points keep their sizing function value and new points take
+ * the value of the closest original point.
+ * @return SV_OK if executed correctly
+ */
+int MMGUtils_SurfaceRemeshingFaces(vtkPolyData *surface, vtkIdList *excluded, double hmin, double hmax, double hausd, int useSizingFunction, vtkDoubleArray *meshSizingFunction)
+{
+  if (hmax < hmin)
+  {
+    fprintf(stderr,"Max edge size is smaller than min edge size!\n");
+    return SV_ERROR;
+  }
+  if (VtkUtils_PDCheckArrayName(surface,1,"ModelFaceID") != SV_OK)
+  {
+    fprintf(stderr,"Array name 'ModelFaceID' does not exist. Regions must be identified");
+    fprintf(stderr," and named 'ModelFaceID' prior to this function call\n");
+    return SV_ERROR;
+  }
+  if (useSizingFunction &&
+      (meshSizingFunction == NULL ||
+       meshSizingFunction->GetNumberOfTuples() != surface->GetNumberOfPoints()))
+  {
+    fprintf(stderr,"Sizing function must be given for every surface point!\n");
+    return SV_ERROR;
+  }
+
+  surface->BuildLinks();
+  vtkIntArray *faceIds = vtkIntArray::SafeDownCast(
+    surface->GetCellData()->GetArray("ModelFaceID"));
+  if (faceIds == NULL)
+  {
+    fprintf(stderr,"Array 'ModelFaceID' must be an integer array\n");
+    return SV_ERROR;
+  }
+
+  int numPts = surface->GetNumberOfPoints();
+  int numCells = surface->GetNumberOfCells();
+
+  // Gather the cells of every face that is remeshed
+  std::map<int, int> patchIndex;
+  std::vector<MMGFacePatch> patches;
+  std::vector<std::vector<vtkIdType> > patchCells;
+  std::map<int, vtkIdType> faceCell;
+  for (vtkIdType cellId=0;cellId<numCells;cellId++)
+  {
+    int faceId = faceIds->GetValue(cellId);
+    if (faceCell.count(faceId) == 0)
+      faceCell[faceId] = cellId;
+    if (excluded != NULL && excluded->IsId(faceId) != -1)
+      continue;
+    if (surface->GetCellType(cellId) != VTK_TRIANGLE)
+    {
+      fprintf(stderr,"Surface must be all triangles to remesh faces\n");
+      return SV_ERROR;
+    }
+    if (patchIndex.count(faceId) == 0)
+    {
+      patchIndex[faceId] = patches.size();
+      patches.push_back(MMGFacePatch());
+      patches.back().faceId = faceId;
+      patches.back().status = SV_ERROR;
+      patchCells.push_back(std::vector<vtkIdType>());
+    }
+    patchCells[patchIndex[faceId]].push_back(cellId);
+  }
+
+  double meshFactor = 0.8;
+  std::vector<double> patchMin(patches.size(), hmin);
+  std::vector<double> patchMax(patches.size(), hmax);
+  for (int p=0;p<patches.size();p++)
+  {
+    MMGFacePatch *patch = &patches[p];
+    std::map<vtkIdType, int> localIds;
+    std::map<std::pair<int,int>, int> edgeUses;
+    vtkIdType npts, *pts;
+    for (int c=0;c<patchCells[p].size();c++)
+    {
+      surface->GetCellPoints(patchCells[p][c],npts,pts);
+      int local[3];
+      for (int j=0;j<3;j++)
+      {
+        std::map<vtkIdType, int>::iterator it = localIds.find(pts[j]);
+        if (it == localIds.end())
+        {
+          local[j] = patch->ptIds.size();
+          localIds[pts[j]] = local[j];
+          patch->ptIds.push_back(pts[j]);
+          double pt[3];
+          surface->GetPoint(pts[j],pt);
+          patch->coords.insert(patch->coords.end(), pt, pt+3);
+          double ptsize = (hmax+hmin)/2;
+          if (useSizingFunction && meshSizingFunction->GetValue(pts[j]) != 0)
+            ptsize = meshFactor*meshSizingFunction->GetValue(pts[j]);
+          patch->sizes.push_back(ptsize);
+        }
+        else
+          local[j] = it->second;
+        patch->tris.push_back(local[j]);
+      }
+      for (int j=0;j<3;j++)
+      {
+        int p1 = local[j], p2 = local[(j+1)%3];
+        edgeUses[std::make_pair(std::min(p1,p2),std::max(p1,p2))]++;
+      }
+    }
+
+    // Edges used once lie on the face boundary and are frozen
+    patch->onBoundary.assign(patch->ptIds.size(), 0);
+    for (std::map<std::pair<int,int>, int>::iterator it = edgeUses.begin();
+         it != edgeUses.end(); ++it)
+    {
+      if (it->second != 1)
+        continue;
+      patch->edges.push_back(it->first.first);
+      patch->edges.push_back(it->first.second);
+      patch->onBoundary[it->first.first] = 1;
+      patch->onBoundary[it->first.second] = 1;
+    }
+
+    if (useSizingFunction)
+    {
+      double minSize = *std::min_element(patch->sizes.begin(), patch->sizes.end());
+      double maxSize = *std::max_element(patch->sizes.begin(), patch->sizes.end());
+      patchMin[p] = 0.5*minSize;
+      patchMax[p] = 1.5*maxSize;
+    }
+  }
+
+  fprintf(stderr,"Remeshing %d faces with MMG...\n",(int) patches.size());
+  ParallelUtils_For(patches.size(), [&](int p)
+  {
+    patches[p].status = MMGUtils_RemeshFacePatch(&patches[p], patchMin[p],
+      patchMax[p], hausd);
+  });
+
+  for (int p=0;p<patches.size();p++)
+  {
+    if (patches[p].status != SV_OK)
+    {
+      fprintf(stderr,"Remeshing of face %d failed\n",patches[p].faceId);
+      return SV_ERROR;
+    }
+  }
+
+  // Original points stay where they are; points no longer used are
+  // dropped by the cleaner below
+  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+  newPoints->DeepCopy(surface->GetPoints());
+  vtkSmartPointer<vtkDoubleArray> newSizes =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  vtkSmartPointer<vtkPointLocator> locator =
+    vtkSmartPointer<vtkPointLocator>::New();
+  if (useSizingFunction)
+  {
+    newSizes->DeepCopy(meshSizingFunction);
+    locator->SetDataSet(surface);
+    locator->BuildLocator();
+  }
+  newSizes->SetName("MeshSizingFunction");
+
+  vtkSmartPointer<vtkCellArray> newPolys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+  pd->GetCellData()->CopyAllocate(surface->GetCellData(), numCells);
+
+  vtkIdType npts, *pts;
+  for (vtkIdType cellId=0;cellId<numCells;cellId++)
+  {
+    if (patchIndex.count(faceIds->GetValue(cellId)))
+      continue;
+    surface->GetCellPoints(cellId,npts,pts);
+    vtkIdType newId = newPolys->InsertNextCell(npts,pts);
+    pd->GetCellData()->CopyData(surface->GetCellData(),cellId,newId);
+  }
+
+  for (int p=0;p<patches.size();p++)
+  {
+    MMGFacePatch *patch = &patches[p];
+    std::vector<vtkIdType> globalIds(patch->outPtIds);
+    for (int i=0;i<globalIds.size();i++)
+    {
+      if (globalIds[i] != -1)
+        continue;
+      globalIds[i] = newPoints->InsertNextPoint(&patch->outCoords[3*i]);
+      if (useSizingFunction)
+        newSizes->InsertNextValue(meshSizingFunction->GetValue(
+          locator->FindClosestPoint(&patch->outCoords[3*i])));
+    }
+
+    vtkIdType sourceCell = faceCell[patch->faceId];
+    for (int i=0;i<patch->outTris.size()/3;i++)
+    {
+      vtkIdType tri[3];
+      for (int j=0;j<3;j++)
+        tri[j] = globalIds[patch->outTris[3*i+j]];
+      vtkIdType newId = newPolys->InsertNextCell(3,tri);
+      pd->GetCellData()->CopyData(surface->GetCellData(),sourceCell,newId);
+    }
+  }
+  pd->SetPoints(newPoints);
+  pd->SetPolys(newPolys);
+  pd->GetCellData()->Squeeze();
+  if (useSizingFunction)
+    pd->GetPointData()->AddArray(newSizes);
+
+  vtkSmartPointer<vtkCleanPolyData> cleaner =
+    vtkSmartPointer<vtkCleanPolyData>::New();
+  cleaner->SetInputData(pd);
+  cleaner->PointMergingOff();
+  cleaner->Update();
+
+  vtkSmartPointer<vtkPolyDataNormals> normaler =
+    vtkSmartPointer<vtkPolyDataNormals>::New();
+  normaler->SetInputData(cleaner->GetOutput());
+  normaler->ConsistencyOn();
+  normaler->AutoOrientNormalsOn();
+  normaler->FlipNormalsOff();
+  normaler->ComputePointNormalsOff();
+  normaler->ComputeCellNormalsOn();
+  normaler->SplittingOff();
+  normaler->Update();
+
+  surface->DeepCopy(normaler->GetOutput());
+  surface->BuildLinks();
+
+  return SV_OK;
+}
+
+/**
+ * @brief Pass a cell array that is constant over each region
+ * @param *newgeom remeshed surface carrying the region array
+ * @param *originalgeom surface the array is taken from
+ * @param arrayName name of the cell array to pass
+ * @param regionName name of the region array on both surfaces
+ * @note The value is looked up by region id. If the array is not constant
+ * per region, or a region is missing, MMGUtils_PassCellArray is used.
+ * @return SV_OK if executed correctly
+ */
+int MMGUtils_PassCellArrayByRegion(vtkPolyData *newgeom,
+    vtkPolyData *originalgeom,std::string arrayName,
+    std::string regionName)
+{
+  if (VtkUtils_PDCheckArrayName(originalgeom,1,arrayName) != SV_OK ||
+      VtkUtils_PDCheckArrayName(originalgeom,1,regionName) != SV_OK ||
+      VtkUtils_PDCheckArrayName(newgeom,1,regionName) != SV_OK)
+    return MMGUtils_PassCellArray(newgeom,originalgeom,arrayName,arrayName);
+
+  vtkIntArray *inArray = vtkIntArray::SafeDownCast(
+    originalgeom->GetCellData()->GetArray(arrayName.c_str()));
+  vtkIntArray *inRegions = vtkIntArray::SafeDownCast(
+    originalgeom->GetCellData()->GetArray(regionName.c_str()));
+  vtkIntArray *outRegions = vtkIntArray::SafeDownCast(
+    newgeom->GetCellData()->GetArray(regionName.c_str()));
+  if (inArray == NULL || inRegions == NULL || outRegions == NULL)
+    return MMGUtils_PassCellArray(newgeom,originalgeom,arrayName,arrayName);
+
+  std::map<int, int> regionValue;
+  for (vtkIdType cellId=0;cellId<originalgeom->GetNumberOfCells();cellId++)
+  {
+    int region = inRegions->GetValue(cellId);
+    int value  = inArray->GetValue(cellId);
+    std::map<int, int>::iterator it = regionValue.find(region);
+    if (it == regionValue.end())
+      regionValue[region] = value;
+    else if (it->second != value)
+      return MMGUtils_PassCellArray(newgeom,originalgeom,arrayName,arrayName);
+  }
+
+  int numCells = newgeom->GetNumberOfCells();
+  vtkSmartPointer<vtkIntArray> outArray = vtkSmartPointer<vtkIntArray>::New();
+  outArray->SetNumberOfTuples(numCells);
+  for (vtkIdType cellId=0;cellId<numCells;cellId++)
+  {
+    std::map<int, int>::iterator it =
+      regionValue.find(outRegions->GetValue(cellId));
+    if (it == regionValue.end())
+      return MMGUtils_PassCellArray(newgeom,originalgeom,arrayName,arrayName);
+    outArray->SetValue(cellId,it->second);
+  }
+
+  newgeom->GetCellData()->RemoveArray(arrayName.c_str());
+  outArray->SetName(arrayName.c_str());
+  newgeom->GetCellData()->AddArray(outArray);
+  newgeom->GetCellData()->SetActiveScalars(arrayName.c_str());
+
   return SV_OK;
 }
 
@@ -36,6 +36,7 @@
 #include "svMMGExports.h" // For exports
 
 #include "sv_PolyData.h"
+#include "vtkIdList.h"
 #include "vtkPolyData.h"
 #include "vtkUnstructuredGrid.h"
 
@@ -45,10 +46,16 @@ SV_EXPORT_MMG int MMGUtils_ConvertToMMG(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyD
     double hmin, double hmax, double hausd, double angle, double hgrad,
     int useSizingFunction, vtkDoubleArray *meshSizingFunction, int numAddedRefines);
 
-SV_EXPORT_MMG int MMGUtils_ConvertToVTK(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatasolid);
+SV_EXPORT_MMG int MMGUtils_ConvertToVTK(MMG5_pMesh mesh, MMG5_pSol sol, vtkPolyData *polydatasolid,
+    std::string solArrayName = "", double solScale = 1.0);
 
 SV_EXPORT_MMG int MMGUtils_SurfaceRemeshing(vtkPolyData *surface, double hmin, double hmax, double hausd, double angle, double hgrad, int useSizingFunction, vtkDoubleArray *meshSizingFunction, int numAddedRefines);
 
+SV_EXPORT_MMG int MMGUtils_SurfaceRemeshingFaces(vtkPolyData *surface, vtkIdList *excluded, double hmin, double hmax, double hausd, int useSizingFunction, vtkDoubleArray *meshSizingFunction);
+
+SV_EXPORT_MMG int MMGUtils_PassCellArrayByRegion(vtkPolyData *newgeom,
+    vtkPolyData *originalgeom,std::string arrayName,std::string regionName);
+
 SV_EXPORT_MMG int MMGUtils_PassCellArray(vtkPolyData *newgeom,
     vtkPolyData *originalgeom,std::string newName,std::string originalName);
 
@@ -97,6 +97,24 @@ cvMeshObject::KernelType cvMeshObject::GetKernelType( const char* kernel_name )
 }
 
 
+// ----------------
+// ComputeQuality
+// ----------------
+
+int cvMeshObject::ComputeQuality(cvMeshQuality *quality) {
+
+  cvUnstructuredGrid *ug = this->GetUnstructuredGrid();
+  if (ug == NULL) {
+    fprintf(stderr,"Mesh must be created before computing its quality\n");
+    return SV_ERROR;
+  }
+
+  int status = quality->Compute(ug->GetVtkUnstructuredGrid());
+  delete ug;
+
+  return status;
+}
+
 int cvMeshObject::openOutputFile(char* filename) {
   fp_ = NULL;
   // open the output file
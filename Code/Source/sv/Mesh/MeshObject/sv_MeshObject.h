@@ -41,6 +41,7 @@
 #include "sv_RepositoryData.h"
 #include "sv_UnstructuredGrid.h"
 #include "sv_SolidModel.h"
+#include "sv_MeshQuality.h"
 
 #ifdef SV_USE_ZLIB
   #ifdef SV_USE_SYSTEM_ZLIB
@@ -126,6 +127,10 @@ public:
   virtual int WriteMesh(char *filename, int smsver) = 0;
   virtual int WriteStats(char *filename) = 0;
 
+  //Element quality of the volume mesh; uses GetUnstructuredGrid unless
+  //the kernel can hand over its mesh directly
+  virtual int ComputeQuality(cvMeshQuality *quality);
+
   //Not necessary anymore, but leaving for now
   virtual int WriteMetisAdjacency (char *filename) = 0;
 
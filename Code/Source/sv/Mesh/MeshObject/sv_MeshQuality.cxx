@@ -0,0 +1,685 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "SimVascular.h"
+
+#include "sv_MeshQuality.h"
+
+#include "vtkCellType.h"
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+const int kNumMetrics = cvMeshQuality::NUM_METRICS;
+
+// Fixed histogram ranges. The volume range is measured from the mesh.
+const double kHistogramRange[kNumMetrics][2] = {
+  {1.0, 11.0},
+  {1.0, 11.0},
+  {0.0, 180.0},
+  {0.0, 180.0},
+  {0.0, 0.0},
+  {0.0, 3.0}
+};
+
+const int kEdges[6][2] = {{0,1},{0,2},{0,3},{1,2},{1,3},{2,3}};
+
+struct WorstEntry
+{
+  double badness;
+  double value;
+  vtkIdType id;
+  bool operator>(const WorstEntry &other) const
+  {
+    if (badness != other.badness)
+      return badness > other.badness;
+    return id < other.id;
+  }
+};
+
+// Larger is worse for every metric
+double QualityBadness(int metric, double value)
+{
+  switch (metric)
+  {
+    case cvMeshQuality::MIN_DIHEDRAL:
+    case cvMeshQuality::VOLUME:
+      return -value;
+    case cvMeshQuality::EDGE_SIZE_RATIO:
+      return value > 0.0 ? std::max(value, 1.0/value) : VTK_DOUBLE_MAX;
+    default:
+      return value;
+  }
+}
+
+// Keep the numWorst worst entries with the least bad one on top
+void QualityPushWorst(std::vector<WorstEntry> &heap, int numWorst,
+                      const WorstEntry &entry)
+{
+  if (numWorst <= 0)
+    return;
+  if ((int) heap.size() < numWorst)
+  {
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+  }
+  else if (entry > heap.front())
+  {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+    heap.back() = entry;
+    std::push_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+  }
+}
+
+double QualityTetVolume(const double p[4][3])
+{
+  double e1[3], e2[3], e3[3], c[3];
+  for (int i=0; i<3; i++)
+  {
+    e1[i] = p[1][i] - p[0][i];
+    e2[i] = p[2][i] - p[0][i];
+    e3[i] = p[3][i] - p[0][i];
+  }
+  vtkMath::Cross(e2, e3, c);
+  return vtkMath::Dot(e1, c)/6.0;
+}
+
+// Shape metrics of one tetrahedron. Returns 0 for a degenerate element,
+// in which case only the volume is set.
+int QualityMeasureTet(const double p[4][3], double values[kNumMetrics])
+{
+  double signedVolume = QualityTetVolume(p);
+  double volume = fabs(signedVolume);
+  values[cvMeshQuality::VOLUME] = volume;
+
+  double lengths[6];
+  double maxLength = 0.0;
+  for (int e=0; e<6; e++)
+  {
+    lengths[e] = sqrt(vtkMath::Distance2BetweenPoints(p[kEdges[e][0]], p[kEdges[e][1]]));
+    maxLength = std::max(maxLength, lengths[e]);
+  }
+  if (volume <= 1.0e-14*maxLength*maxLength*maxLength)
+    return 0;
+
+  double area = 0.0;
+  for (int f=0; f<4; f++)
+  {
+    const double *a = p[(f+1)%4], *b = p[(f+2)%4], *c = p[(f+3)%4];
+    double ab[3], ac[3], n[3];
+    for (int i=0; i<3; i++)
+    {
+      ab[i] = b[i] - a[i];
+      ac[i] = c[i] - a[i];
+    }
+    vtkMath::Cross(ab, ac, n);
+    area += 0.5*vtkMath::Norm(n);
+  }
+  double inradius = 3.0*volume/area;
+
+  // Products of opposite edges give the circumradius
+  double a = lengths[0]*lengths[5];
+  double b = lengths[1]*lengths[4];
+  double c = lengths[2]*lengths[3];
+  double prod = (a+b+c)*(a+b-c)*(a-b+c)*(-a+b+c);
+  double circumradius = sqrt(std::max(prod, 0.0))/(24.0*volume);
+
+  values[cvMeshQuality::ASPECT_RATIO] = maxLength/(2.0*sqrt(6.0)*inradius);
+  values[cvMeshQuality::RADIUS_RATIO] = circumradius/(3.0*inradius);
+
+  // Dihedral angle along each edge between the two faces sharing it
+  double minAngle = 180.0, maxAngle = 0.0;
+  for (int e=0; e<6; e++)
+  {
+    int i = kEdges[e][0], j = kEdges[e][1];
+    int k = -1, l = -1;
+    for (int m=0; m<4; m++)
+    {
+      if (m == i || m == j)
+        continue;
+      if (k == -1)
+        k = m;
+      else
+        l = m;
+    }
+    double edge[3], ek[3], el[3], n1[3], n2[3];
+    for (int d=0; d<3; d++)
+    {
+      edge[d] = p[j][d] - p[i][d];
+      ek[d]   = p[k][d] - p[i][d];
+      el[d]   = p[l][d] - p[i][d];
+    }
+    vtkMath::Cross(edge, ek, n1);
+    vtkMath::Cross(edge, el, n2);
+    double denom = vtkMath::Norm(n1)*vtkMath::Norm(n2);
+    double cosAngle = denom > 0.0 ? vtkMath::Dot(n1, n2)/denom : 1.0;
+    cosAngle = std::min(1.0, std::max(-1.0, cosAngle));
+    double angle = vtkMath::DegreesFromRadians(acos(cosAngle));
+    minAngle = std::min(minAngle, angle);
+    maxAngle = std::max(maxAngle, angle);
+  }
+  values[cvMeshQuality::MIN_DIHEDRAL] = minAngle;
+  values[cvMeshQuality::MAX_DIHEDRAL] = maxAngle;
+
+  return 1;
+}
+
+int QualityGetTet(vtkUnstructuredGrid *mesh, vtkIdType cellId, double p[4][3],
+                  vtkIdType ptIds[4])
+{
+  int type = mesh->GetCellType(cellId);
+  if (type != VTK_TETRA && type != VTK_QUADRATIC_TETRA)
+    return 0;
+
+  vtkIdType npts, *pts;
+  mesh->GetCellPoints(cellId, npts, pts);
+  for (int i=0; i<4; i++)
+  {
+    ptIds[i] = pts[i];
+    mesh->GetPoint(pts[i], p[i]);
+  }
+  return 1;
+}
+
+class VolumeRangeFunctor
+{
+public:
+  vtkUnstructuredGrid *Mesh;
+  vtkSMPThreadLocal<double> Min;
+  vtkSMPThreadLocal<double> Max;
+  double Range[2];
+
+  VolumeRangeFunctor()
+  {
+    this->Mesh = NULL;
+    this->Range[0] = VTK_DOUBLE_MAX;
+    this->Range[1] = 0.0;
+  }
+
+  void Initialize()
+  {
+    this->Min.Local() = VTK_DOUBLE_MAX;
+    this->Max.Local() = 0.0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double &min = this->Min.Local();
+    double &max = this->Max.Local();
+    double p[4][3];
+    vtkIdType ptIds[4];
+    for (vtkIdType cellId=begin; cellId<end; cellId++)
+    {
+      if (!QualityGetTet(this->Mesh, cellId, p, ptIds))
+        continue;
+      double volume = fabs(QualityTetVolume(p));
+      if (volume > 0.0)
+        min = std::min(min, volume);
+      max = std::max(max, volume);
+    }
+  }
+
+  void Reduce()
+  {
+    this->Range[0] = VTK_DOUBLE_MAX;
+    this->Range[1] = 0.0;
+    vtkSMPThreadLocal<double>::iterator it;
+    for (it = this->Min.begin(); it != this->Min.end(); ++it)
+      this->Range[0] = std::min(this->Range[0], *it);
+    for (it = this->Max.begin(); it != this->Max.end(); ++it)
+      this->Range[1] = std::max(this->Range[1], *it);
+  }
+};
+
+struct QualityLocal
+{
+  vtkIdType elements;
+  vtkIdType skipped;
+  vtkIdType positive;
+  vtkIdType negative;
+  vtkIdType degenerate;
+  double min[kNumMetrics];
+  double max[kNumMetrics];
+  double sum[kNumMetrics];
+  vtkIdType count[kNumMetrics];
+  std::vector<vtkIdType> histograms[kNumMetrics];
+  std::vector<WorstEntry> worst[kNumMetrics];
+};
+
+class QualityFunctor
+{
+public:
+  vtkUnstructuredGrid *Mesh;
+  vtkDataArray *Sizing;
+  int NumBins;
+  int NumWorst;
+  double Range[kNumMetrics][2];
+  vtkSMPThreadLocal<QualityLocal> Local;
+
+  void Initialize()
+  {
+    QualityLocal &local = this->Local.Local();
+    local.elements = local.skipped = 0;
+    local.positive = local.negative = local.degenerate = 0;
+    for (int m=0; m<kNumMetrics; m++)
+    {
+      local.min[m] = VTK_DOUBLE_MAX;
+      local.max[m] = -VTK_DOUBLE_MAX;
+      local.sum[m] = 0.0;
+      local.count[m] = 0;
+      local.histograms[m].assign(this->NumBins, 0);
+      local.worst[m].clear();
+    }
+  }
+
+  void Add(QualityLocal &local, int metric, double value, vtkIdType cellId)
+  {
+    local.min[metric] = std::min(local.min[metric], value);
+    local.max[metric] = std::max(local.max[metric], value);
+    local.sum[metric] += value;
+    local.count[metric]++;
+
+    double binValue = value;
+    if (metric == cvMeshQuality::VOLUME)
+      binValue = value > 0.0 ? log10(value) : this->Range[metric][0];
+    double width = this->Range[metric][1] - this->Range[metric][0];
+    int bin = (int) floor((binValue - this->Range[metric][0])/width*this->NumBins);
+    bin = std::min(this->NumBins-1, std::max(0, bin));
+    local.histograms[metric][bin]++;
+
+    WorstEntry entry = {QualityBadness(metric, value), value, cellId};
+    QualityPushWorst(local.worst[metric], this->NumWorst, entry);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    QualityLocal &local = this->Local.Local();
+    double p[4][3];
+    vtkIdType ptIds[4];
+    double values[kNumMetrics];
+    for (vtkIdType cellId=begin; cellId<end; cellId++)
+    {
+      if (!QualityGetTet(this->Mesh, cellId, p, ptIds))
+      {
+        local.skipped++;
+        continue;
+      }
+      local.elements++;
+
+      double signedVolume = QualityTetVolume(p);
+      if (signedVolume > 0.0)
+        local.positive++;
+      else if (signedVolume < 0.0)
+        local.negative++;
+
+      if (QualityMeasureTet(p, values))
+      {
+        for (int m=0; m<=cvMeshQuality::MAX_DIHEDRAL; m++)
+          this->Add(local, m, values[m], cellId);
+      }
+      else
+      {
+        local.degenerate++;
+        WorstEntry entry = {VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, cellId};
+        QualityPushWorst(local.worst[cvMeshQuality::ASPECT_RATIO], this->NumWorst, entry);
+        QualityPushWorst(local.worst[cvMeshQuality::RADIUS_RATIO], this->NumWorst, entry);
+      }
+      this->Add(local, cvMeshQuality::VOLUME, values[cvMeshQuality::VOLUME], cellId);
+
+      if (this->Sizing != NULL)
+      {
+        double length = 0.0, size = 0.0;
+        int numSizes = 0;
+        for (int e=0; e<6; e++)
+          length += sqrt(vtkMath::Distance2BetweenPoints(p[kEdges[e][0]], p[kEdges[e][1]]));
+        for (int i=0; i<4; i++)
+        {
+          double ptSize = this->Sizing->GetComponent(ptIds[i], 0);
+          if (ptSize > 0.0)
+          {
+            size += ptSize;
+            numSizes++;
+          }
+        }
+        if (numSizes > 0)
+          this->Add(local, cvMeshQuality::EDGE_SIZE_RATIO,
+                    (length/6.0)/(size/numSizes), cellId);
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+}
+
+// ----------------
+// cvMeshQuality
+// ----------------
+
+cvMeshQuality::cvMeshQuality()
+{
+  numBins_ = 50;
+  numWorst_ = 10;
+  sizingName_ = "MeshSizingFunction";
+  this->Reset();
+}
+
+cvMeshQuality::~cvMeshQuality()
+{
+}
+
+void cvMeshQuality::Reset()
+{
+  numNodes_ = 0;
+  numElements_ = 0;
+  numSkipped_ = 0;
+  numInverted_ = 0;
+  numDegenerate_ = 0;
+  for (int m=0; m<NUM_METRICS; m++)
+  {
+    min_[m] = 0.0;
+    max_[m] = 0.0;
+    sum_[m] = 0.0;
+    count_[m] = 0;
+    range_[m][0] = kHistogramRange[m][0];
+    range_[m][1] = kHistogramRange[m][1];
+    histograms_[m].clear();
+    worst_[m].clear();
+  }
+}
+
+const char* cvMeshQuality::GetMetricName(int metric)
+{
+  switch (metric)
+  {
+    case ASPECT_RATIO:    return "AspectRatio";
+    case RADIUS_RATIO:    return "RadiusRatio";
+    case MIN_DIHEDRAL:    return "MinDihedralAngle";
+    case MAX_DIHEDRAL:    return "MaxDihedralAngle";
+    case VOLUME:          return "Volume";
+    case EDGE_SIZE_RATIO: return "EdgeSizeRatio";
+    default:              return "Invalid";
+  }
+}
+
+int cvMeshQuality::HasMetric(int metric) const
+{
+  if (metric < 0 || metric >= NUM_METRICS)
+    return 0;
+  return count_[metric] > 0;
+}
+
+double cvMeshQuality::GetMean(int metric) const
+{
+  if (count_[metric] == 0)
+    return 0.0;
+  return sum_[metric]/count_[metric];
+}
+
+void cvMeshQuality::GetHistogramRange(int metric, double range[2]) const
+{
+  range[0] = range_[metric][0];
+  range[1] = range_[metric][1];
+}
+
+// ----------------
+// Compute
+// ----------------
+/**
+ * @brief Measure every tetrahedron in the mesh
+ * @param *mesh volume mesh; the sizing function is read from its point data
+ * @param *sizing sizing function on the mesh points, for meshes that do not
+ * carry it as point data
+ * @note Orientation is judged against the mesh itself: the elements whose
+ * volume sign is in the minority are reported as inverted, since meshers
+ * differ in which winding they call positive.
+ * @return SV_OK if executed correctly
+ */
+int cvMeshQuality::Compute(vtkUnstructuredGrid *mesh, vtkDataArray *sizing)
+{
+  this->Reset();
+  if (mesh == NULL)
+  {
+    fprintf(stderr,"No mesh to compute quality of\n");
+    return SV_ERROR;
+  }
+
+  vtkIdType numCells = mesh->GetNumberOfCells();
+  numNodes_ = mesh->GetNumberOfPoints();
+
+  VolumeRangeFunctor volumeRange;
+  volumeRange.Mesh = mesh;
+  vtkSMPTools::For(0, numCells, volumeRange);
+
+  QualityFunctor quality;
+  quality.Mesh = mesh;
+  quality.Sizing = mesh->GetPointData()->GetArray(sizingName_.c_str());
+  if (sizing != NULL && sizing->GetNumberOfTuples() == numNodes_)
+    quality.Sizing = sizing;
+  quality.NumBins = numBins_;
+  quality.NumWorst = numWorst_;
+  for (int m=0; m<NUM_METRICS; m++)
+  {
+    quality.Range[m][0] = kHistogramRange[m][0];
+    quality.Range[m][1] = kHistogramRange[m][1];
+  }
+  if (volumeRange.Range[0] <= volumeRange.Range[1])
+  {
+    quality.Range[VOLUME][0] = log10(volumeRange.Range[0]);
+    quality.Range[VOLUME][1] = log10(volumeRange.Range[1]);
+  }
+  if (quality.Range[VOLUME][1] - quality.Range[VOLUME][0] < 1.0e-6)
+  {
+    quality.Range[VOLUME][0] -= 0.5;
+    quality.Range[VOLUME][1] += 0.5;
+  }
+  vtkSMPTools::For(0, numCells, quality);
+
+  // Combine the thread results
+  vtkIdType positive = 0, negative = 0;
+  std::vector<WorstEntry> worst[NUM_METRICS];
+  for (int m=0; m<NUM_METRICS; m++)
+  {
+    min_[m] = VTK_DOUBLE_MAX;
+    max_[m] = -VTK_DOUBLE_MAX;
+    range_[m][0] = quality.Range[m][0];
+    range_[m][1] = quality.Range[m][1];
+    histograms_[m].assign(numBins_, 0);
+  }
+  vtkSMPThreadLocal<QualityLocal>::iterator it;
+  for (it = quality.Local.begin(); it != quality.Local.end(); ++it)
+  {
+    numElements_ += it->elements;
+    numSkipped_ += it->skipped;
+    numDegenerate_ += it->degenerate;
+    positive += it->positive;
+    negative += it->negative;
+    for (int m=0; m<NUM_METRICS; m++)
+    {
+      min_[m] = std::min(min_[m], it->min[m]);
+      max_[m] = std::max(max_[m], it->max[m]);
+      sum_[m] += it->sum[m];
+      count_[m] += it->count[m];
+      for (int b=0; b<numBins_; b++)
+        histograms_[m][b] += it->histograms[m][b];
+      worst[m].insert(worst[m].end(), it->worst[m].begin(), it->worst[m].end());
+    }
+  }
+  numInverted_ = std::min(positive, negative);
+
+  for (int m=0; m<NUM_METRICS; m++)
+  {
+    if (count_[m] == 0)
+    {
+      min_[m] = max_[m] = 0.0;
+      histograms_[m].clear();
+    }
+    std::sort(worst[m].begin(), worst[m].end(), std::greater<WorstEntry>());
+    if ((int) worst[m].size() > numWorst_)
+      worst[m].resize(numWorst_);
+    for (int i=0; i<worst[m].size(); i++)
+      worst_[m].push_back(std::make_pair(worst[m][i].value, worst[m][i].id));
+  }
+
+  return SV_OK;
+}
+
+// ----------------
+// Write
+// ----------------
+
+int cvMeshQuality::Write(const char *filename) const
+{
+  int len = strlen(filename);
+  if (len > 4 && !strcmp(filename+len-4, ".bin"))
+    return this->WriteBinary(filename);
+  return this->WriteJSON(filename);
+}
+
+int cvMeshQuality::WriteJSON(const char *filename) const
+{
+  FILE *fp = fopen(filename, "w");
+  if (fp == NULL)
+  {
+    fprintf(stderr,"Could not open %s for writing\n",filename);
+    return SV_ERROR;
+  }
+
+  fprintf(fp,"{\n");
+  fprintf(fp,"  \"numberOfNodes\": %lld,\n",(long long) numNodes_);
+  fprintf(fp,"  \"numberOfElements\": %lld,\n",(long long) numElements_);
+  fprintf(fp,"  \"numberOfSkippedElements\": %lld,\n",(long long) numSkipped_);
+  fprintf(fp,"  \"numberOfInvertedElements\": %lld,\n",(long long) numInverted_);
+  fprintf(fp,"  \"numberOfDegenerateElements\": %lld,\n",(long long) numDegenerate_);
+  fprintf(fp,"  \"metrics\": {");
+
+  int first = 1;
+  for (int m=0; m<NUM_METRICS; m++)
+  {
+    if (!this->HasMetric(m))
+      continue;
+    fprintf(fp,"%s\n    \"%s\": {\n",first ? "" : ",",GetMetricName(m));
+    first = 0;
+    fprintf(fp,"      \"min\": %.17g,\n",min_[m]);
+    fprintf(fp,"      \"max\": %.17g,\n",max_[m]);
+    fprintf(fp,"      \"mean\": %.17g,\n",this->GetMean(m));
+    fprintf(fp,"      \"count\": %lld,\n",(long long) count_[m]);
+    fprintf(fp,"      \"histogramScale\": \"%s\",\n",m == VOLUME ? "log10" : "linear");
+    fprintf(fp,"      \"histogramRange\": [%.17g, %.17g],\n",range_[m][0],range_[m][1]);
+    fprintf(fp,"      \"histogram\": [");
+    for (int b=0; b<histograms_[m].size(); b++)
+      fprintf(fp,"%s%lld",b ? ", " : "",(long long) histograms_[m][b]);
+    fprintf(fp,"],\n");
+    fprintf(fp,"      \"worst\": [");
+    for (int i=0; i<worst_[m].size(); i++)
+      fprintf(fp,"%s[%lld, %.17g]",i ? ", " : "",
+        (long long) worst_[m][i].second,worst_[m][i].first);
+    fprintf(fp,"]\n    }");
+  }
+  fprintf(fp,"\n  }\n}\n");
+
+  fclose(fp);
+  return SV_OK;
+}
+
+/**
+ * @brief Write the summary as a little binary file
+ * @note Layout, in host byte order: "SVMQ", int32 version, int32 number of
+ * metrics, int32 number of bins, five int64 counts (nodes, elements,
+ * skipped, inverted, degenerate), then per metric: int32 present, doubles
+ * min, max, mean and histogram range, int64 bin counts, int32 number of
+ * worst elements and that many (int64 id, double value) pairs.
+ */
+int cvMeshQuality::WriteBinary(const char *filename) const
+{
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL)
+  {
+    fprintf(stderr,"Could not open %s for writing\n",filename);
+    return SV_ERROR;
+  }
+
+  int version = 1;
+  int numMetrics = NUM_METRICS;
+  long long counts[5] = {numNodes_, numElements_, numSkipped_, numInverted_,
+                         numDegenerate_};
+  fwrite("SVMQ", 1, 4, fp);
+  fwrite(&version, sizeof(int), 1, fp);
+  fwrite(&numMetrics, sizeof(int), 1, fp);
+  fwrite(&numBins_, sizeof(int), 1, fp);
+  fwrite(counts, sizeof(long long), 5, fp);
+
+  for (int m=0; m<NUM_METRICS; m++)
+  {
+    int present = this->HasMetric(m);
+    double values[5] = {min_[m], max_[m], this->GetMean(m), range_[m][0],
+                        range_[m][1]};
+    fwrite(&present, sizeof(int), 1, fp);
+    fwrite(values, sizeof(double), 5, fp);
+
+    std::vector<long long> bins(numBins_, 0);
+    for (int b=0; b<histograms_[m].size() && b<numBins_; b++)
+      bins[b] = histograms_[m][b];
+    fwrite(&bins[0], sizeof(long long), numBins_, fp);
+
+    int numWorst = worst_[m].size();
+    fwrite(&numWorst, sizeof(int), 1, fp);
+    for (int i=0; i<numWorst; i++)
+    {
+      long long id = worst_[m][i].second;
+      fwrite(&id, sizeof(long long), 1, fp);
+      fwrite(&worst_[m][i].first, sizeof(double), 1, fp);
+    }
+  }
+
+  int ok = !ferror(fp);
+  fclose(fp);
+  if (!ok)
+  {
+    fprintf(stderr,"Error writing %s\n",filename);
+    return SV_ERROR;
+  }
+  return SV_OK;
+}
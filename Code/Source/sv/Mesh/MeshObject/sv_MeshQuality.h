@@ -0,0 +1,143 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @file sv_MeshQuality.h
+ *  @brief Element quality statistics of a tetrahedral mesh
+ *  @details Every tetrahedron is measured once, in parallel, and only the
+ *  histograms, summary values and a short list of the worst elements are
+ *  kept for each metric. Shape metrics are normalized so that a regular
+ *  tetrahedron scores one.
+ */
+
+#ifndef __CVMESHQUALITY_H
+#define __CVMESHQUALITY_H
+
+#include "SimVascular.h"
+#include "svMeshObjectExports.h" // For exports
+
+#include "vtkDataArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class SV_EXPORT_MESH cvMeshQuality {
+
+public:
+  enum MetricType {
+    ASPECT_RATIO = 0,  // longest edge over inradius, one when regular
+    RADIUS_RATIO,      // circumradius over three times the inradius
+    MIN_DIHEDRAL,      // smallest dihedral angle in degrees
+    MAX_DIHEDRAL,      // largest dihedral angle in degrees
+    VOLUME,            // absolute element volume
+    EDGE_SIZE_RATIO,   // mean edge length over the sizing function
+    NUM_METRICS
+  };
+
+  cvMeshQuality();
+  ~cvMeshQuality();
+
+  static const char* GetMetricName(int metric);
+
+  void SetNumberOfBins(int bins) {numBins_ = bins > 0 ? bins : 1;}
+  int GetNumberOfBins() const {return numBins_;}
+  void SetNumberOfWorstElements(int num) {numWorst_ = num >= 0 ? num : 0;}
+  int GetNumberOfWorstElements() const {return numWorst_;}
+
+  /** @brief Point data array compared against edge lengths. The edge size
+   *  ratio is only computed when the mesh carries this array. */
+  void SetSizingFunctionName(const char *name) {sizingName_ = name;}
+  const char* GetSizingFunctionName() const {return sizingName_.c_str();}
+
+  /** @brief Measure every tetrahedron of mesh. Other cell types are
+   *  counted as skipped. Quadratic tetrahedra use their corner nodes.
+   *  sizing, if given, is used instead of the named point data array. */
+  int Compute(vtkUnstructuredGrid *mesh, vtkDataArray *sizing = NULL);
+
+  vtkIdType GetNumberOfNodes() const {return numNodes_;}
+  vtkIdType GetNumberOfElements() const {return numElements_;}
+  vtkIdType GetNumberOfSkippedElements() const {return numSkipped_;}
+
+  /** @brief Elements oriented against the rest of the mesh. */
+  vtkIdType GetNumberOfInvertedElements() const {return numInverted_;}
+
+  /** @brief Elements with no volume. They have no shape metrics and head
+   *  the worst element lists. */
+  vtkIdType GetNumberOfDegenerateElements() const {return numDegenerate_;}
+
+  int HasMetric(int metric) const;
+  double GetMinimum(int metric) const {return min_[metric];}
+  double GetMaximum(int metric) const {return max_[metric];}
+  double GetMean(int metric) const;
+
+  /** @brief Counts per bin. Values outside the range go into the end bins.
+   *  Shape metrics use fixed ranges so sweeps compare directly; the volume
+   *  histogram is of log10(volume) over the measured range. */
+  const std::vector<vtkIdType>& GetHistogram(int metric) const {return histograms_[metric];}
+  void GetHistogramRange(int metric, double range[2]) const;
+
+  /** @brief (value, element id) pairs, worst first. */
+  const std::vector<std::pair<double,vtkIdType> >& GetWorstElements(int metric) const {return worst_[metric];}
+
+  /** @brief Write a binary summary if filename ends in ".bin" and JSON
+   *  otherwise. */
+  int Write(const char *filename) const;
+  int WriteJSON(const char *filename) const;
+  int WriteBinary(const char *filename) const;
+
+private:
+  cvMeshQuality(const cvMeshQuality&);
+  cvMeshQuality& operator=(const cvMeshQuality&);
+
+  void Reset();
+
+  int numBins_;
+  int numWorst_;
+  std::string sizingName_;
+
+  vtkIdType numNodes_;
+  vtkIdType numElements_;
+  vtkIdType numSkipped_;
+  vtkIdType numInverted_;
+  vtkIdType numDegenerate_;
+
+  double min_[NUM_METRICS];
+  double max_[NUM_METRICS];
+  double sum_[NUM_METRICS];
+  vtkIdType count_[NUM_METRICS];
+  double range_[NUM_METRICS][2];
+  std::vector<vtkIdType> histograms_[NUM_METRICS];
+  std::vector<std::pair<double,vtkIdType> > worst_[NUM_METRICS];
+};
+
+#endif // __CVMESHQUALITY_H
@@ -105,6 +105,7 @@ static PyObject* cvMesh_NewMeshMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_GenerateMeshMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_WriteMeshMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_WriteStatsMtd( pyMeshObject* self, PyObject* args);
+static PyObject* cvMesh_GetQualityStatsMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_SetMeshOptionsMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_SetCylinderRefinementMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_SetSphereRefinementMtd( pyMeshObject* self, PyObject* args);
@@ -175,6 +176,7 @@ static PyMethodDef pyMeshObject_methods[]={
   { "GetFacePolyData", (PyCFunction)cvMesh_GetFacePolyDataMtd,METH_VARARGS,NULL},
   { "WriteMesh", (PyCFunction)cvMesh_WriteMeshMtd,METH_VARARGS,NULL},
   { "WriteStats",(PyCFunction)cvMesh_WriteStatsMtd,METH_VARARGS,NULL},
+  { "GetQualityStats",(PyCFunction)cvMesh_GetQualityStatsMtd,METH_VARARGS,NULL},
   { "Adapt",  (PyCFunction)cvMesh_AdaptMtd,METH_VARARGS,NULL},
   {NULL,NULL}
 };
@@ -529,6 +531,7 @@ static void MeshPrintMethods()
   PySys_WriteStdout( "GenerateMesh\n");
   PySys_WriteStdout( "WriteMesh\n");
   PySys_WriteStdout( "WriteStats\n");
+  PySys_WriteStdout( "GetQualityStats\n");
   PySys_WriteStdout( "Adapt\n");
   PySys_WriteStdout( "SetSolidKernel\n");
   PySys_WriteStdout( "GetModelFaceInfo\n");
@@ -1372,3 +1375,96 @@ static PyObject* cvMesh_GetModelFaceInfoMtd( pyMeshObject* self, PyObject* args)
 
   return Py_BuildValue("s",info);
 }
+
+// --------------------------
+// cvMesh_GetQualityStatsMtd
+// --------------------------
+// Returns a dict with the element counts and, per metric, the summary
+// values, histogram and worst elements as (element id, value) tuples.
+
+static PyObject* cvMesh_GetQualityStatsMtd( pyMeshObject* self, PyObject* args)
+{
+  cvMeshObject *geom = self->geom;
+  int numBins = 50;
+  int numWorst = 10;
+  char *sizingName = NULL;
+
+  if(!PyArg_ParseTuple(args,"|iis",&numBins,&numWorst,&sizingName))
+  {
+    PyErr_SetString(PyRunTimeErr,"Could not import optional int numBins, int numWorst, char sizingFunctionName");
+    return NULL;
+  }
+
+  if (geom->GetMeshLoaded() == 0)
+  {
+    if (geom->Update() == SV_ERROR)
+    {
+      PyErr_SetString(PyRunTimeErr, "error update.");
+      return NULL;
+    }
+  }
+
+  cvMeshQuality quality;
+  quality.SetNumberOfBins(numBins);
+  quality.SetNumberOfWorstElements(numWorst);
+  if (sizingName != NULL)
+    quality.SetSizingFunctionName(sizingName);
+
+  if (geom->ComputeQuality(&quality) != SV_OK) {
+    PyErr_SetString(PyRunTimeErr, "error computing mesh quality");
+    return NULL;
+  }
+
+  PyObject *stats = PyDict_New();
+  PyObject *item;
+  item = PyLong_FromLongLong(quality.GetNumberOfNodes());
+  PyDict_SetItemString(stats, "numberOfNodes", item);
+  Py_DECREF(item);
+  item = PyLong_FromLongLong(quality.GetNumberOfElements());
+  PyDict_SetItemString(stats, "numberOfElements", item);
+  Py_DECREF(item);
+  item = PyLong_FromLongLong(quality.GetNumberOfSkippedElements());
+  PyDict_SetItemString(stats, "numberOfSkippedElements", item);
+  Py_DECREF(item);
+  item = PyLong_FromLongLong(quality.GetNumberOfInvertedElements());
+  PyDict_SetItemString(stats, "numberOfInvertedElements", item);
+  Py_DECREF(item);
+  item = PyLong_FromLongLong(quality.GetNumberOfDegenerateElements());
+  PyDict_SetItemString(stats, "numberOfDegenerateElements", item);
+  Py_DECREF(item);
+
+  PyObject *metrics = PyDict_New();
+  for (int m=0; m<cvMeshQuality::NUM_METRICS; m++)
+  {
+    if (!quality.HasMetric(m))
+      continue;
+
+    double range[2];
+    quality.GetHistogramRange(m, range);
+    const std::vector<vtkIdType> &bins = quality.GetHistogram(m);
+    PyObject *histogram = PyList_New(bins.size());
+    for (int b=0; b<bins.size(); b++)
+      PyList_SetItem(histogram, b, PyLong_FromLongLong(bins[b]));
+
+    const std::vector<std::pair<double,vtkIdType> > &worst =
+      quality.GetWorstElements(m);
+    PyObject *worstList = PyList_New(worst.size());
+    for (int i=0; i<worst.size(); i++)
+      PyList_SetItem(worstList, i, Py_BuildValue("(Ld)",
+        (long long) worst[i].second, worst[i].first));
+
+    PyObject *metric = Py_BuildValue("{s:d,s:d,s:d,s:(dd),s:N,s:N}",
+      "min", quality.GetMinimum(m),
+      "max", quality.GetMaximum(m),
+      "mean", quality.GetMean(m),
+      "histogramRange", range[0], range[1],
+      "histogram", histogram,
+      "worst", worstList);
+    PyDict_SetItemString(metrics, cvMeshQuality::GetMetricName(m), metric);
+    Py_DECREF(metric);
+  }
+  PyDict_SetItemString(stats, "metrics", metrics);
+  Py_DECREF(metrics);
+
+  return stats;
+}
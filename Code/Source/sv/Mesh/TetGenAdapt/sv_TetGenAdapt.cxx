@@ -78,6 +78,7 @@ cvTetGenAdapt::cvTetGenAdapt()
   insurface_mesh_ = NULL;
   outmesh_ = NULL;
   outsurface_mesh_ = NULL;
+  soltransfer_ = NULL;
 
   options.poly_ = 1;
   options.metric_option_ = 1;
@@ -104,6 +105,7 @@ cvTetGenAdapt::cvTetGenAdapt()
 cvTetGenAdapt::cvTetGenAdapt( const cvTetGenAdapt& Adapt)
   : cvAdaptObject( KERNEL_TETGEN)
 {
+  soltransfer_ = NULL;
   Copy(Adapt);
 }
 
@@ -123,6 +125,9 @@ cvTetGenAdapt::~cvTetGenAdapt()
   if (outsurface_mesh_ != NULL)
     outsurface_mesh_->Delete();
 
+  if (soltransfer_ != NULL)
+    delete soltransfer_;
+
   if (sol_ != NULL)
     delete [] sol_;
   if (avgspeed_ != NULL)
@@ -1063,8 +1068,12 @@ int cvTetGenAdapt::TransferSolution()
     fprintf(stderr,"Outmesh is NULL!\n");
     return SV_ERROR;
   }
+  if (soltransfer_ == NULL)
+    soltransfer_ = new cvSolutionTransfer;
+
   int nVar = 5;// Number of variables in sol
-  if (AdaptUtils_fix4SolutionTransfer(inmesh_,outmesh_,options.outstep_) != SV_OK)
+  if (AdaptUtils_fix4SolutionTransfer(inmesh_,outmesh_,options.outstep_,
+        soltransfer_) != SV_OK)
   {
     fprintf(stderr,"ERROR: Solution was not transferred\n");
   }
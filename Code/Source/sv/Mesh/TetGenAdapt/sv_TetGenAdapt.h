@@ -51,6 +51,8 @@
 #include "sv_AdaptObject.h"
 //#include "sv_RepositoryData.h"
 
+class cvSolutionTransfer;
+
 #ifdef SV_USE_ZLIB
   #ifdef SV_USE_SYSTEM_ZLIB
     #include <zlib.h>
@@ -153,6 +155,9 @@ private:
   vtkUnstructuredGrid *outmesh_;
   vtkPolyData *outsurface_mesh_;
 
+  // Node to element map between inmesh_ and outmesh_, kept across transfers
+  cvSolutionTransfer *soltransfer_;
+
   double *sol_;
   double *ybar_;
   double *avgspeed_;
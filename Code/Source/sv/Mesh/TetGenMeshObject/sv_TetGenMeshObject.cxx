@@ -47,6 +47,8 @@
 #include "sv_polydatasolid_utils.h"
 
 #include "sv_tetgenmesh_utils.h"
+#include "sv_vtk_utils.h"
+#include "sv_parallel_utils.h"
 
 #include "sv_sys_geom.h"
 #ifdef SV_USE_PYTHON
@@ -67,6 +69,10 @@
 #include "vtkXMLUnstructuredGridWriter.h"
 #include "vtkDataSetSurfaceFilter.h"
 #include "vtkAppendPolyData.h"
+#include "vtkPlaneCollection.h"
+#include "vtkPointData.h"
+#include "vtkPointLocator.h"
+#include "vtkMath.h"
 
 #ifdef SV_USE_VMTK
   #include "sv_vmtk_utils.h"
@@ -77,6 +83,41 @@
   #include "sv_mmg_mesh_utils.h"
 #endif
 
+#include <list>
+#include <mutex>
+
+// Boundary layer meshes shared by all mesh objects, most recent first.
+// Only a few are kept since each holds a full boundary layer mesh, and
+// they are released with the last mesh object.
+namespace {
+
+struct BoundaryLayerCacheEntry {
+  vtkTypeUInt64 key;
+  vtkSmartPointer<vtkUnstructuredGrid> boundarylayermesh;
+  vtkSmartPointer<vtkUnstructuredGrid> innerblmesh;
+  vtkSmartPointer<vtkPolyData> cappedsurface;
+};
+
+const size_t boundaryLayerCacheSize = 2;
+std::list<BoundaryLayerCacheEntry> boundaryLayerCache;
+int boundaryLayerCacheUsers = 0;
+std::mutex boundaryLayerCacheMutex;
+
+void BoundaryLayerCache_AddUser()
+{
+  std::lock_guard<std::mutex> lock(boundaryLayerCacheMutex);
+  boundaryLayerCacheUsers++;
+}
+
+void BoundaryLayerCache_RemoveUser()
+{
+  std::lock_guard<std::mutex> lock(boundaryLayerCacheMutex);
+  if (--boundaryLayerCacheUsers == 0)
+    boundaryLayerCache.clear();
+}
+
+}
+
 // -----------
 // cvTetGenMeshObject
 // -----------
@@ -87,6 +128,7 @@
 cvTetGenMeshObject::cvTetGenMeshObject(Tcl_Interp *interp)
   : cvMeshObject()
 {
+  BoundaryLayerCache_AddUser();
   interp_ = interp;
   inmesh_ = NULL;
   outmesh_ = NULL;
@@ -102,6 +144,7 @@ cvTetGenMeshObject::cvTetGenMeshObject(Tcl_Interp *interp)
   volumemesh_ = NULL;
   boundarylayermesh_ = NULL;
   innerblmesh_ = NULL;
+  subdomainplanes_ = NULL;
   holelist_ = NULL;
   regionlist_ = NULL;
   regionsizelist_ = NULL;
@@ -173,6 +216,7 @@ cvTetGenMeshObject::cvTetGenMeshObject(Tcl_Interp *interp)
 cvTetGenMeshObject::cvTetGenMeshObject()
 : cvMeshObject()
 {
+  BoundaryLayerCache_AddUser();
   inmesh_ = NULL;
   outmesh_ = NULL;
   polydatasolid_ = NULL;
@@ -187,6 +231,7 @@ cvTetGenMeshObject::cvTetGenMeshObject()
   volumemesh_ = NULL;
   boundarylayermesh_ = NULL;
   innerblmesh_ = NULL;
+  subdomainplanes_ = NULL;
   holelist_ = NULL;
   regionlist_ = NULL;
   regionsizelist_ = NULL;
@@ -254,6 +299,7 @@ cvTetGenMeshObject::cvTetGenMeshObject()
 cvTetGenMeshObject::cvTetGenMeshObject( const cvTetGenMeshObject& sm )
   : cvMeshObject()
 {
+  BoundaryLayerCache_AddUser();
 
   // Copy( sm );   // relying on automatic upcast to cvMeshObject*
 
@@ -303,6 +349,11 @@ cvTetGenMeshObject::~cvTetGenMeshObject()
 
   if (regionsizelist_ != NULL)
     regionsizelist_->Delete();
+
+  if (subdomainplanes_ != NULL)
+    subdomainplanes_->Delete();
+
+  BoundaryLayerCache_RemoveUser();
 }
 
 int cvTetGenMeshObject::SetMeshFileName( const char* meshFileName )
@@ -1137,6 +1188,14 @@ int cvTetGenMeshObject::SetMeshOptions(char *flags,int numValues,double *values)
       return SV_ERROR;
     meshoptions_.boundarylayerdirection=values[0];
   }
+  else if (!strncmp(flags,"SubDomainPlane",14)) {
+    if (numValues < 6)
+    {
+      fprintf(stderr,"Must provide x,y,z origin and x,y,z normal of plane\n");
+      return SV_ERROR;
+    }
+    return AddSubDomainPlane(&values[0], &values[3]);
+  }
   else if (!strncmp(flags,"AllowMultipleRegions",20)) {
       meshoptions_.allowMultipleRegions = (int(values[0]) == 1);
   }
@@ -1386,13 +1445,17 @@ int cvTetGenMeshObject::SetSizeFunctionBasedMesh(double size,char *sizefunctionn
 
 int cvTetGenMeshObject::GenerateMesh() {
 
+  int subdomainmeshed = 0;
+
   if (surfacemesh_ != NULL)
   {
     surfacemesh_->Delete();
+    surfacemesh_ = NULL;
   }
   if (volumemesh_ != NULL)
   {
     volumemesh_->Delete();
+    volumemesh_ = NULL;
   }
 
 //All these complicated options exist if using VMTK. Should be stopped prior
@@ -1408,13 +1471,21 @@ int cvTetGenMeshObject::GenerateMesh() {
     if (meshoptions_.volumemeshflag)
     {
       //If we are doing boundary layer mesh, it gets complicated!
+      //Re-meshing with only TetGen fill options changed reuses the last
+      //boundary layer built from this remeshed surface.
       if (meshoptions_.boundarylayermeshflag)
       {
-        if (GenerateBoundaryLayerMesh() != SV_OK)
-          return SV_ERROR;
+        vtkTypeUInt64 blkey = GetBoundaryLayerCacheKey();
+        if (RestoreBoundaryLayerFromCache(blkey) != SV_OK)
+        {
+          if (GenerateBoundaryLayerMesh() != SV_OK)
+            return SV_ERROR;
 
-        if (GenerateAndMeshCaps() != SV_OK)
-          return SV_ERROR;
+          if (GenerateAndMeshCaps() != SV_OK)
+            return SV_ERROR;
+
+          StoreBoundaryLayerInCache(blkey);
+        }
       }
 
       if (meshoptions_.boundarylayermeshflag || meshoptions_.functionbasedmeshing
@@ -1576,19 +1647,31 @@ int cvTetGenMeshObject::GenerateMesh() {
 	  be run.\n");
     }
 
-    fprintf(stdout,"TetGen Meshing Started...\n");
-    try
+    //Sub-domain meshing does not handle boundary layers, holes or regions
+    if (subdomainplanes_ != NULL && subdomainplanes_->GetNumberOfItems() > 0 &&
+        !meshoptions_.boundarylayermeshflag &&
+        meshoptions_.numberofholes == 0 && meshoptions_.numberofregions == 0)
     {
-//      std::freopen("mesh_stats.txt","w",stdout);
-      tetrahedralize(tgb, inmesh_, outmesh_);
-//      std::fclose(stdout);
+      if (GenerateSubDomainMesh(tgb) != SV_OK)
+        return SV_ERROR;
+      subdomainmeshed = 1;
     }
-    catch (int r)
+    else
     {
-      fprintf(stderr,"ERROR: TetGen quit and returned error code %d\n",r);
-      return SV_ERROR;
+      fprintf(stdout,"TetGen Meshing Started...\n");
+      try
+      {
+//        std::freopen("mesh_stats.txt","w",stdout);
+        tetrahedralize(tgb, inmesh_, outmesh_);
+//        std::fclose(stdout);
+      }
+      catch (int r)
+      {
+        fprintf(stderr,"ERROR: TetGen quit and returned error code %d\n",r);
+        return SV_ERROR;
+      }
+      fprintf(stdout,"TetGen Meshing Finished...\n");
     }
-    fprintf(stdout,"TetGen Meshing Finished...\n");
   }
 
   else
@@ -1606,7 +1689,8 @@ int cvTetGenMeshObject::GenerateMesh() {
 #endif
 
   // must have created mesh
-  if (meshoptions_.volumemeshflag && !meshoptions_.boundarylayermeshflag)
+  if (meshoptions_.volumemeshflag && !meshoptions_.boundarylayermeshflag &&
+      !subdomainmeshed)
   {
     if (outmesh_ == NULL) {
       return SV_ERROR;
@@ -1646,12 +1730,66 @@ int cvTetGenMeshObject::WriteMesh(char *filename, int smsver) {
   return SV_OK;
 }
 
+/**
+ * @brief Function to write element quality statistics of the volume mesh
+ * @param *filename file to write; binary if it ends in ".bin", else JSON
+ * @return SV_OK if executed correctly
+ */
 int cvTetGenMeshObject::WriteStats(char *filename) {
   // must have created mesh
-  if (inmesh_ == NULL) {
+  if (volumemesh_ == NULL) {
+    fprintf(stderr,"Volume mesh must be created to write stats\n");
     return SV_ERROR;
   }
-  return SV_OK;
+
+  cvMeshQuality quality;
+  if (ComputeQuality(&quality) != SV_OK)
+    return SV_ERROR;
+
+  fprintf(stdout,"Mesh has %lld nodes and %lld elements, %lld inverted\n",
+    (long long) quality.GetNumberOfNodes(),
+    (long long) quality.GetNumberOfElements(),
+    (long long) quality.GetNumberOfInvertedElements());
+
+  return quality.Write(filename);
+}
+
+/**
+ * @brief Function to compute element quality statistics of the volume mesh
+ * @param *quality holds the options and receives the statistics
+ * @note The sizing function only exists on the surface, so each volume
+ * node takes the value of the closest surface point
+ * @return SV_OK if executed correctly
+ */
+int cvTetGenMeshObject::ComputeQuality(cvMeshQuality *quality) {
+  if (volumemesh_ == NULL) {
+    fprintf(stderr,"Volume mesh must be created before computing its quality\n");
+    return SV_ERROR;
+  }
+
+  const char *sizingName = quality->GetSizingFunctionName();
+  if (volumemesh_->GetPointData()->GetArray(sizingName) != NULL ||
+      polydatasolid_ == NULL ||
+      polydatasolid_->GetPointData()->GetArray(sizingName) == NULL)
+    return quality->Compute(volumemesh_);
+
+  vtkDataArray *surfaceSizing = polydatasolid_->GetPointData()->GetArray(sizingName);
+  vtkSmartPointer<vtkPointLocator> locator =
+    vtkSmartPointer<vtkPointLocator>::New();
+  locator->SetDataSet(polydatasolid_);
+  locator->BuildLocator();
+
+  vtkIdType numPts = volumemesh_->GetNumberOfPoints();
+  vtkSmartPointer<vtkDoubleArray> sizing =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  sizing->SetNumberOfTuples(numPts);
+  for (vtkIdType i=0; i<numPts; i++)
+  {
+    vtkIdType closestPt = locator->FindClosestPoint(volumemesh_->GetPoint(i));
+    sizing->SetValue(i, closestPt >= 0 ? surfaceSizing->GetComponent(closestPt, 0) : 0.0);
+  }
+
+  return quality->Compute(volumemesh_, sizing);
 }
 
 /**
@@ -2258,6 +2396,257 @@ int cvTetGenMeshObject::AppendBoundaryLayerMesh()
   return SV_OK;
 }
 
+/**
+ * @brief Helper function to compute the key of the boundary layer cache
+ * @note Covers everything GenerateBoundaryLayerMesh and GenerateAndMeshCaps
+ * read: the current surface, the original surface used to reset cap ids,
+ * and the options for layer thickness and cap remeshing. It is computed
+ * after GenerateSurfaceRemesh, so the global edge size, sphere refinement
+ * and function based sizing, which all change the remeshed surface the
+ * layer is built on, give a new key and rebuild the layer. Only changes
+ * to the TetGen fill options (quality, optimization level, epsilon and
+ * the like) or a new mesh object meshing the same model with the same
+ * options reuse a cached layer.
+ * @return the hash of the inputs
+ */
+vtkTypeUInt64 cvTetGenMeshObject::GetBoundaryLayerCacheKey()
+{
+  vtkTypeUInt64 key = VtkUtils_HashDataSet(polydatasolid_);
+  key = VtkUtils_HashDataSet(originalpolydata_, key);
+
+  double dvals[3];
+  dvals[0] = meshoptions_.maxedgesize;
+  dvals[1] = meshoptions_.blthicknessfactor;
+  dvals[2] = meshoptions_.sublayerratio;
+  key = VtkUtils_HashBytes(dvals, sizeof(dvals), key);
+
+  int ivals[6];
+  ivals[0] = meshoptions_.numsublayers;
+  ivals[1] = meshoptions_.useconstantblthickness;
+  ivals[2] = meshoptions_.boundarylayerdirection;
+  ivals[3] = meshoptions_.meshwallfirst;
+  ivals[4] = meshoptions_.functionbasedmeshing;
+  ivals[5] = meshoptions_.refinement;
+  key = VtkUtils_HashBytes(ivals, sizeof(ivals), key);
+
+  return key;
+}
+
+/**
+ * @brief Helper function to reuse a cached boundary layer mesh
+ * @param key the value from GetBoundaryLayerCacheKey
+ * @return SV_OK if the boundary layer mesh, inner mesh and capped surface
+ * were restored, SV_ERROR if they have to be generated
+ */
+int cvTetGenMeshObject::RestoreBoundaryLayerFromCache(vtkTypeUInt64 key)
+{
+  std::lock_guard<std::mutex> lock(boundaryLayerCacheMutex);
+
+  std::list<BoundaryLayerCacheEntry>::iterator it;
+  for (it = boundaryLayerCache.begin(); it != boundaryLayerCache.end(); ++it)
+  {
+    if (it->key == key)
+      break;
+  }
+  if (it == boundaryLayerCache.end())
+    return SV_ERROR;
+
+  fprintf(stdout,"Reusing boundary layer mesh from a previous run\n");
+  if (boundarylayermesh_ != NULL)
+    boundarylayermesh_->Delete();
+  if (innerblmesh_ != NULL)
+    innerblmesh_->Delete();
+
+  boundarylayermesh_ = vtkUnstructuredGrid::New();
+  boundarylayermesh_->DeepCopy(it->boundarylayermesh);
+  innerblmesh_ = vtkUnstructuredGrid::New();
+  innerblmesh_->DeepCopy(it->innerblmesh);
+  polydatasolid_->DeepCopy(it->cappedsurface);
+
+  boundaryLayerCache.splice(boundaryLayerCache.begin(), boundaryLayerCache, it);
+
+  return SV_OK;
+}
+
+/**
+ * @brief Helper function to save the boundary layer mesh for later runs
+ * @param key the value from GetBoundaryLayerCacheKey computed before the
+ * boundary layer was generated
+ * @return SV_OK if executed correctly
+ */
+int cvTetGenMeshObject::StoreBoundaryLayerInCache(vtkTypeUInt64 key)
+{
+  if (boundarylayermesh_ == NULL || innerblmesh_ == NULL)
+    return SV_ERROR;
+
+  BoundaryLayerCacheEntry entry;
+  entry.key = key;
+  entry.boundarylayermesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  entry.boundarylayermesh->DeepCopy(boundarylayermesh_);
+  entry.innerblmesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  entry.innerblmesh->DeepCopy(innerblmesh_);
+  entry.cappedsurface = vtkSmartPointer<vtkPolyData>::New();
+  entry.cappedsurface->DeepCopy(polydatasolid_);
+
+  std::lock_guard<std::mutex> lock(boundaryLayerCacheMutex);
+  boundaryLayerCache.push_front(entry);
+  while (boundaryLayerCache.size() > boundaryLayerCacheSize)
+    boundaryLayerCache.pop_back();
+
+  return SV_OK;
+}
+
+/**
+ * @brief Release all cached boundary layer meshes
+ * @note The cache is also released when the last mesh object is deleted
+ */
+void cvTetGenMeshObject::ClearBoundaryLayerCache()
+{
+  std::lock_guard<std::mutex> lock(boundaryLayerCacheMutex);
+  boundaryLayerCache.clear();
+}
+
+/**
+ * @brief Helper function to mesh the model as separate sub-domains
+ * @param *tgb the TetGen options set up by GenerateMesh
+ * @note This is a helper function. It is called from GenerateMesh when
+ * sub-domain planes are set. The surface is cut along the planes, each
+ * piece is meshed by its own TetGen call on a separate thread with its
+ * surface preserved (-Y) so the shared interfaces conform, and the pieces
+ * are merged into surfacemesh_ and volumemesh_. TetGen sets up its
+ * predicates and look-up tables once and keeps the per-call predicate
+ * options per thread, so the calls can run concurrently.
+ * @return SV_OK if executed correctly
+ */
+int cvTetGenMeshObject::GenerateSubDomainMesh(tetgenbehavior *tgb)
+{
+  std::string markerListName = "ModelFaceID";
+  const int interfaceMarker = -1;
+  int useSizingFunction = meshoptions_.functionbasedmeshing ||
+                          meshoptions_.refinement;
+
+  std::vector<vtkSmartPointer<vtkPolyData> > domains;
+  if (TGenUtils_DecomposeSurface(polydatasolid_, subdomainplanes_,
+        meshoptions_.maxedgesize, markerListName, interfaceMarker,
+        domains) != SV_OK)
+  {
+    fprintf(stderr,"Could not split surface into sub-domains\n");
+    return SV_ERROR;
+  }
+
+  int numDomains = domains.size();
+  std::vector<vtkSmartPointer<vtkUnstructuredGrid> > volumes(numDomains);
+  std::vector<vtkSmartPointer<vtkPolyData> > surfaces(numDomains);
+  std::vector<int> status(numDomains, SV_ERROR);
+  for (int i=0; i<numDomains; i++)
+  {
+    volumes[i] = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    surfaces[i] = vtkSmartPointer<vtkPolyData>::New();
+  }
+
+  fprintf(stdout,"TetGen Meshing %d Sub-Domains Started...\n",numDomains);
+  ParallelUtils_For(numDomains, [&](int i)
+  {
+    tetgenbehavior domaintgb = *tgb;
+    domaintgb.nobisect = 1;
+
+    tetgenio domainin, domainout;
+    domainin.firstnumber = 0;
+    domainout.firstnumber = 0;
+
+    if (TGenUtils_ConvertSurfaceToTetGen(&domainin,domains[i]) != SV_OK)
+      return;
+    if (useSizingFunction)
+    {
+      if (TGenUtils_AddPointSizingFunction(&domainin,domains[i],
+            "MeshSizingFunction", meshoptions_.maxedgesize) != SV_OK)
+        return;
+    }
+    if (TGenUtils_AddFacetMarkers(&domainin,domains[i],markerListName) != SV_OK)
+      return;
+
+    try
+    {
+      tetrahedralize(&domaintgb, &domainin, &domainout);
+    }
+    catch (int r)
+    {
+      fprintf(stderr,"ERROR: TetGen quit on sub-domain %d and returned error code %d\n",i,r);
+      return;
+    }
+
+    int domainRegions;
+    if (TGenUtils_ConvertToVTK(&domainout,volumes[i],surfaces[i],
+          &domainRegions,1) != SV_OK)
+      return;
+
+    status[i] = SV_OK;
+  });
+
+  for (int i=0; i<numDomains; i++)
+  {
+    if (status[i] != SV_OK)
+    {
+      fprintf(stderr,"Meshing of sub-domain %d failed\n",i);
+      return SV_ERROR;
+    }
+  }
+  fprintf(stdout,"TetGen Meshing Finished...\n");
+
+  surfacemesh_ = vtkPolyData::New();
+  volumemesh_ = vtkUnstructuredGrid::New();
+  if (TGenUtils_MergeSubDomainMeshes(volumes,surfaces,interfaceMarker,
+        volumemesh_,surfacemesh_,&numBoundaryRegions_) != SV_OK)
+  {
+    fprintf(stderr,"Could not merge sub-domain meshes\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+/**
+ * @brief Add a plane along which the model is split for sub-domain meshing
+ * @param *origin point on the plane
+ * @param *normal normal of the plane
+ * @return SV_OK if executed correctly
+ */
+int cvTetGenMeshObject::AddSubDomainPlane(double *origin, double *normal)
+{
+  if (vtkMath::Norm(normal) == 0.0)
+  {
+    fprintf(stderr,"Sub-domain plane normal cannot be zero\n");
+    return SV_ERROR;
+  }
+  if (subdomainplanes_ == NULL)
+    subdomainplanes_ = vtkPlaneCollection::New();
+
+  vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+  plane->SetOrigin(origin);
+  plane->SetNormal(normal);
+  subdomainplanes_->AddItem(plane);
+
+  return SV_OK;
+}
+
+/**
+ * @brief Replace the sub-domain planes with planes normal to the
+ * centerlines at equal arc length
+ * @param *centerlines centerlines of the model
+ * @param numSubDomains number of pieces to split the centerlines into
+ * @return SV_OK if executed correctly
+ */
+int cvTetGenMeshObject::SetSubDomainPlanesFromCenterlines(vtkPolyData *centerlines,
+    int numSubDomains)
+{
+  if (subdomainplanes_ == NULL)
+    subdomainplanes_ = vtkPlaneCollection::New();
+  subdomainplanes_->RemoveAllItems();
+
+  return TGenUtils_GetSubDomainPlanesFromCenterlines(centerlines,
+    numSubDomains, subdomainplanes_);
+}
+
 /**
  * @brief Helper function to reset the original region ids
  * @note This is a helper function. It is called from GenerateMesh
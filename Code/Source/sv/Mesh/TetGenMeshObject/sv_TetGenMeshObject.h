@@ -56,6 +56,8 @@
 
 #include "simvascular_tetgen.h"
 
+class vtkPlaneCollection;
+
 class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
 
   typedef struct TGoptions {
@@ -147,10 +149,15 @@ class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
 
   void SetAllowMultipleRegions(bool value);
 
+  //Mesh pieces between cut planes concurrently and stitch them together
+  int AddSubDomainPlane(double *origin, double *normal);
+  int SetSubDomainPlanesFromCenterlines(vtkPolyData *centerlines, int numSubDomains);
+
   //Meshing operation and post-meshing cleanup/stats functions
   int GenerateMesh();
   int WriteMesh(char *filename, int smsver);
   int WriteStats(char *filename);
+  int ComputeQuality(cvMeshQuality *quality);
 
   // output visualization files
   int WriteMetisAdjacency (char *filename);
@@ -179,8 +186,17 @@ class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
   int GenerateAndMeshCaps();
   int GenerateMeshSizingFunction();
   int AppendBoundaryLayerMesh();
+  int GenerateSubDomainMesh(tetgenbehavior *tgb);
   int ResetOriginalRegions(std::string regionName);
 
+  //The boundary layer and capped inner surface are kept between
+  //GenerateMesh calls, keyed on the remeshed surface and the options they
+  //use, until the last mesh object is deleted
+  vtkTypeUInt64 GetBoundaryLayerCacheKey();
+  int RestoreBoundaryLayerFromCache(vtkTypeUInt64 key);
+  int StoreBoundaryLayerInCache(vtkTypeUInt64 key);
+  static void ClearBoundaryLayerCache();
+
   private:
   char meshFileName_[MAXPATHLEN];
   char solidFileName_[MAXPATHLEN];
@@ -206,6 +222,7 @@ class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
   vtkUnstructuredGrid *volumemesh_;
   vtkUnstructuredGrid *boundarylayermesh_;
   vtkUnstructuredGrid *innerblmesh_;
+  vtkPlaneCollection *subdomainplanes_;
 
   TGoptions meshoptions_;
 
@@ -58,6 +58,15 @@
 #include "vtkGenericCell.h"
 #include "vtkConnectivityFilter.h"
 #include "vtkDataSetSurfaceFilter.h"
+#include "vtkAppendPolyData.h"
+#include "vtkCleanPolyData.h"
+#include "vtkClipPolyData.h"
+#include "vtkContourTriangulator.h"
+#include "vtkDelaunay2D.h"
+#include "vtkFeatureEdges.h"
+#include "vtkMath.h"
+#include "vtkMergePoints.h"
+#include "vtkStripper.h"
 
 #include "simvascular_tetgen.h"
 
@@ -83,6 +92,9 @@
 
 #include "sv_tetgenmesh_utils.h"
 
+#include <algorithm>
+#include <set>
+
 // -----------------------------
 // cvTetGenMeshObjectUtils_Init()
 // -----------------------------
@@ -1633,3 +1645,681 @@ int TGenUtils_SetLocalMeshSize(vtkPolyData *pd,int regionId,double size)
 
   return SV_OK;
 }
+
+// -----------------------------
+// TGenUtils_GetSubDomainPlanesFromCenterlines
+// -----------------------------
+/**
+ * @brief Places cut planes at equal arc length along the centerlines
+ * @param *centerlines lines through the vessels, e.g. from vtkSVCenterlines
+ * @param numSubDomains the number of pieces wanted; up to numSubDomains-1
+ * planes are placed, each normal to the centerline where it cuts
+ * @param *planes collection the planes are added to
+ * @return SV_OK if function completes properly
+ * @note Per-outlet centerlines overlap along the shared trunk. If the
+ * centerlines carry GroupIds (grouped or separated centerlines) only the
+ * first cell of each group is used, and coincident points are merged so
+ * repeated edges are counted once. Cuts that land within half a spacing
+ * of an earlier plane on another branch are dropped.
+ */
+int TGenUtils_GetSubDomainPlanesFromCenterlines(vtkPolyData *centerlines,
+    int numSubDomains, vtkPlaneCollection *planes)
+{
+  if (centerlines == NULL || centerlines->GetNumberOfLines() == 0)
+  {
+    fprintf(stderr,"Centerlines must contain lines to place sub-domain planes\n");
+    return SV_ERROR;
+  }
+  if (numSubDomains < 2)
+    return SV_OK;
+
+  vtkSmartPointer<vtkCleanPolyData> cleaner =
+    vtkSmartPointer<vtkCleanPolyData>::New();
+  cleaner->SetInputData(centerlines);
+  cleaner->PointMergingOn();
+  cleaner->ToleranceIsAbsoluteOn();
+  cleaner->SetAbsoluteTolerance(0.0);
+  cleaner->ConvertLinesToPointsOff();
+  cleaner->Update();
+  vtkPolyData *cleaned = cleaner->GetOutput();
+
+  vtkDataArray *groupIds = cleaned->GetCellData()->GetArray("GroupIds");
+
+  // Each centerline edge once, in traversal order
+  vtkIdType npts, *pts;
+  std::vector<std::pair<vtkIdType, vtkIdType> > segments;
+  std::set<std::pair<vtkIdType, vtkIdType> > usedEdges;
+  std::set<int> usedGroups;
+  vtkIdType cellId = cleaned->GetNumberOfVerts();
+  vtkCellArray *lines = cleaned->GetLines();
+  for (lines->InitTraversal(); lines->GetNextCell(npts, pts); cellId++)
+  {
+    if (groupIds != NULL &&
+        !usedGroups.insert((int) groupIds->GetTuple1(cellId)).second)
+      continue;
+
+    for (vtkIdType i=1; i<npts; i++)
+    {
+      std::pair<vtkIdType, vtkIdType> edge(std::min(pts[i-1], pts[i]),
+                                           std::max(pts[i-1], pts[i]));
+      if (edge.first == edge.second || !usedEdges.insert(edge).second)
+        continue;
+      segments.push_back(std::make_pair(pts[i-1], pts[i]));
+    }
+  }
+
+  double pt0[3], pt1[3];
+  double totalLength = 0.0;
+  for (size_t i=0; i<segments.size(); i++)
+  {
+    cleaned->GetPoint(segments[i].first, pt0);
+    cleaned->GetPoint(segments[i].second, pt1);
+    totalLength += sqrt(vtkMath::Distance2BetweenPoints(pt0, pt1));
+  }
+
+  double spacing = totalLength/numSubDomains;
+  double minDistance2 = 0.25*spacing*spacing;
+  std::vector<std::vector<double> > origins;
+  double nextCut = spacing;
+  double length = 0.0;
+  int numCuts = 0;
+  for (size_t i=0; i<segments.size(); i++)
+  {
+    cleaned->GetPoint(segments[i].first, pt0);
+    cleaned->GetPoint(segments[i].second, pt1);
+    double segLength = sqrt(vtkMath::Distance2BetweenPoints(pt0, pt1));
+    while (segLength > 0.0 && nextCut <= length + segLength &&
+           numCuts < numSubDomains-1)
+    {
+      double t = (nextCut - length)/segLength;
+      double origin[3], normal[3];
+      for (int j=0; j<3; j++)
+      {
+        origin[j] = pt0[j] + t*(pt1[j]-pt0[j]);
+        normal[j] = pt1[j] - pt0[j];
+      }
+      vtkMath::Normalize(normal);
+      nextCut += spacing;
+      numCuts++;
+
+      bool nearPlane = false;
+      for (size_t j=0; j<origins.size() && !nearPlane; j++)
+        nearPlane = vtkMath::Distance2BetweenPoints(origin, &origins[j][0]) < minDistance2;
+      if (nearPlane)
+        continue;
+      origins.push_back(std::vector<double>(origin, origin+3));
+
+      vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+      plane->SetOrigin(origin);
+      plane->SetNormal(normal);
+      planes->AddItem(plane);
+    }
+    length += segLength;
+  }
+
+  return SV_OK;
+}
+
+// -----------------------------
+// TGenUtils_TriangulatePlanarLoops
+// -----------------------------
+/**
+ * @brief Triangulates the region bounded by closed planar loops
+ * @param *loops polydata with closed polylines lying in one plane; nested
+ * loops bound holes
+ * @param normal the normal of the plane
+ * @param edgeSize target edge size; interior points are placed on a
+ * lattice of this spacing
+ * @param *cap output triangles. The first points are the loop points in
+ * the same order, so the cap can be stitched to either side of the cut.
+ * @return SV_OK if function completes properly
+ * @note Falls back to a triangulation without interior points if the
+ * Delaunay triangulation does not recover every loop edge.
+ */
+int TGenUtils_TriangulatePlanarLoops(vtkPolyData *loops,
+    double normal[3], double edgeSize, vtkPolyData *cap)
+{
+  vtkIdType npts, *pts;
+  vtkIdType numLoopPts = loops->GetNumberOfPoints();
+  if (numLoopPts < 3 || loops->GetNumberOfLines() == 0)
+  {
+    fprintf(stderr,"Not enough loop points to triangulate\n");
+    return SV_ERROR;
+  }
+
+  // Closed loop edges
+  std::vector<std::pair<vtkIdType, vtkIdType> > edges;
+  vtkCellArray *lines = loops->GetLines();
+  for (lines->InitTraversal(); lines->GetNextCell(npts, pts);)
+  {
+    for (vtkIdType i=1; i<npts; i++)
+      edges.push_back(std::make_pair(pts[i-1], pts[i]));
+    if (npts > 2 && pts[0] != pts[npts-1])
+      edges.push_back(std::make_pair(pts[npts-1], pts[0]));
+  }
+
+  // In-plane coordinates about the loop centroid
+  double n[3] = {normal[0], normal[1], normal[2]};
+  vtkMath::Normalize(n);
+  double u[3], v[3];
+  vtkMath::Perpendiculars(n, u, v, 0.0);
+
+  double center[3] = {0.0, 0.0, 0.0};
+  double pt[3];
+  for (vtkIdType i=0; i<numLoopPts; i++)
+  {
+    loops->GetPoint(i, pt);
+    for (int j=0; j<3; j++)
+      center[j] += pt[j]/numLoopPts;
+  }
+
+  std::vector<double> uv(2*numLoopPts);
+  double uvBounds[4] = {VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX};
+  for (vtkIdType i=0; i<numLoopPts; i++)
+  {
+    loops->GetPoint(i, pt);
+    double d[3] = {pt[0]-center[0], pt[1]-center[1], pt[2]-center[2]};
+    uv[2*i]   = vtkMath::Dot(d, u);
+    uv[2*i+1] = vtkMath::Dot(d, v);
+    uvBounds[0] = std::min(uvBounds[0], uv[2*i]);
+    uvBounds[1] = std::max(uvBounds[1], uv[2*i]);
+    uvBounds[2] = std::min(uvBounds[2], uv[2*i+1]);
+    uvBounds[3] = std::max(uvBounds[3], uv[2*i+1]);
+  }
+
+  // Even-odd test against all loops, so holes are handled too
+  auto inside = [&](double x, double y)
+  {
+    bool in = false;
+    for (size_t e=0; e<edges.size(); e++)
+    {
+      double x0 = uv[2*edges[e].first], y0 = uv[2*edges[e].first+1];
+      double x1 = uv[2*edges[e].second], y1 = uv[2*edges[e].second+1];
+      if ((y0 > y) != (y1 > y) && x < x0 + (y-y0)*(x1-x0)/(y1-y0))
+        in = !in;
+    }
+    return in;
+  };
+  auto edgeDistance2 = [&](double x, double y)
+  {
+    double minDist2 = VTK_DOUBLE_MAX;
+    for (size_t e=0; e<edges.size(); e++)
+    {
+      double x0 = uv[2*edges[e].first], y0 = uv[2*edges[e].first+1];
+      double dx = uv[2*edges[e].second]-x0, dy = uv[2*edges[e].second+1]-y0;
+      double len2 = dx*dx + dy*dy;
+      double t = len2 > 0.0 ? ((x-x0)*dx + (y-y0)*dy)/len2 : 0.0;
+      t = std::max(0.0, std::min(1.0, t));
+      double ex = x0 + t*dx - x, ey = y0 + t*dy - y;
+      minDist2 = std::min(minDist2, ex*ex + ey*ey);
+    }
+    return minDist2;
+  };
+
+  // Interior points on an equilateral lattice, kept away from the loops
+  if (edgeSize > 0.0)
+  {
+    double rowSpacing = edgeSize*sqrt(3.0)/2.0;
+    double minDist2 = 0.36*edgeSize*edgeSize;
+    int row = 0;
+    for (double y = uvBounds[2] + rowSpacing/2.0; y < uvBounds[3]; y += rowSpacing, row++)
+    {
+      double start = uvBounds[0] + (row%2 ? edgeSize/2.0 : 0.0);
+      for (double x = start; x < uvBounds[1]; x += edgeSize)
+      {
+        if (inside(x, y) && edgeDistance2(x, y) > minDist2)
+        {
+          uv.push_back(x);
+          uv.push_back(y);
+        }
+      }
+    }
+  }
+  vtkIdType numPts = uv.size()/2;
+
+  vtkSmartPointer<vtkPoints> planePts = vtkSmartPointer<vtkPoints>::New();
+  planePts->SetNumberOfPoints(numPts);
+  for (vtkIdType i=0; i<numPts; i++)
+    planePts->SetPoint(i, uv[2*i], uv[2*i+1], 0.0);
+
+  vtkSmartPointer<vtkCellArray> constraintLines = vtkSmartPointer<vtkCellArray>::New();
+  for (size_t e=0; e<edges.size(); e++)
+  {
+    vtkIdType edge[2] = {edges[e].first, edges[e].second};
+    constraintLines->InsertNextCell(2, edge);
+  }
+
+  vtkSmartPointer<vtkPolyData> planeInput = vtkSmartPointer<vtkPolyData>::New();
+  planeInput->SetPoints(planePts);
+  vtkSmartPointer<vtkPolyData> planeSource = vtkSmartPointer<vtkPolyData>::New();
+  planeSource->SetPoints(planePts);
+  planeSource->SetLines(constraintLines);
+
+  vtkSmartPointer<vtkDelaunay2D> delaunay = vtkSmartPointer<vtkDelaunay2D>::New();
+  delaunay->SetInputData(planeInput);
+  delaunay->SetSourceData(planeSource);
+  delaunay->Update();
+
+  // Keep triangles inside the loops and check every loop edge survived
+  vtkSmartPointer<vtkCellArray> tris = vtkSmartPointer<vtkCellArray>::New();
+  std::set<std::pair<vtkIdType, vtkIdType> > triEdges;
+  vtkPolyData *triangulation = delaunay->GetOutput();
+  vtkCellArray *delaunayTris = triangulation->GetPolys();
+  for (delaunayTris->InitTraversal(); delaunayTris->GetNextCell(npts, pts);)
+  {
+    if (npts != 3)
+      continue;
+    double cx = (uv[2*pts[0]] + uv[2*pts[1]] + uv[2*pts[2]])/3.0;
+    double cy = (uv[2*pts[0]+1] + uv[2*pts[1]+1] + uv[2*pts[2]+1])/3.0;
+    if (!inside(cx, cy))
+      continue;
+    tris->InsertNextCell(npts, pts);
+    for (int j=0; j<3; j++)
+    {
+      vtkIdType a = pts[j], b = pts[(j+1)%3];
+      triEdges.insert(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+  }
+
+  bool recovered = tris->GetNumberOfCells() > 0;
+  for (size_t e=0; e<edges.size() && recovered; e++)
+  {
+    std::pair<vtkIdType, vtkIdType> key(std::min(edges[e].first, edges[e].second),
+                                        std::max(edges[e].first, edges[e].second));
+    recovered = triEdges.count(key) > 0;
+  }
+
+  if (!recovered)
+  {
+    numPts = numLoopPts;
+    tris = vtkSmartPointer<vtkCellArray>::New();
+    if (!vtkContourTriangulator::TriangulateContours(loops, 0,
+          loops->GetNumberOfLines(), tris, n))
+    {
+      fprintf(stderr,"Could not triangulate the interface loops\n");
+      return SV_ERROR;
+    }
+  }
+
+  // Loop points keep their exact coordinates, interior points go back to 3D
+  vtkSmartPointer<vtkPoints> capPts = vtkSmartPointer<vtkPoints>::New();
+  capPts->SetNumberOfPoints(numPts);
+  for (vtkIdType i=0; i<numPts; i++)
+  {
+    if (i < numLoopPts)
+      loops->GetPoint(i, pt);
+    else
+    {
+      for (int j=0; j<3; j++)
+        pt[j] = center[j] + uv[2*i]*u[j] + uv[2*i+1]*v[j];
+    }
+    capPts->SetPoint(i, pt);
+  }
+
+  // Point data of interior points is the loop average
+  vtkSmartPointer<vtkPolyData> result = vtkSmartPointer<vtkPolyData>::New();
+  result->SetPoints(capPts);
+  result->SetPolys(tris);
+  vtkPointData *loopPD = loops->GetPointData();
+  for (int a=0; a<loopPD->GetNumberOfArrays(); a++)
+  {
+    vtkDataArray *loopArray = loopPD->GetArray(a);
+    if (loopArray == NULL)
+      continue;
+    int numComps = loopArray->GetNumberOfComponents();
+    vtkDataArray *capArray = loopArray->NewInstance();
+    capArray->SetName(loopArray->GetName());
+    capArray->SetNumberOfComponents(numComps);
+    capArray->SetNumberOfTuples(numPts);
+    for (int c=0; c<numComps; c++)
+    {
+      double mean = 0.0;
+      for (vtkIdType i=0; i<numLoopPts; i++)
+      {
+        double val = loopArray->GetComponent(i, c);
+        capArray->SetComponent(i, c, val);
+        mean += val/numLoopPts;
+      }
+      for (vtkIdType i=numLoopPts; i<numPts; i++)
+        capArray->SetComponent(i, c, mean);
+    }
+    result->GetPointData()->AddArray(capArray);
+    capArray->Delete();
+  }
+
+  cap->DeepCopy(result);
+
+  return SV_OK;
+}
+
+// -----------------------------
+// TGenUtils_SplitSurfaceWithPlane
+// -----------------------------
+/**
+ * @brief Cuts a closed surface with a plane and closes both sides with the
+ * same interface triangulation
+ * @param *surface closed triangulated surface
+ * @param *plane the cut plane
+ * @param edgeSize target edge size of the interface triangulation
+ * @param markerListName cell array of face ids, the only cell array kept
+ * @param interfaceMarker face id given to the interface triangles
+ * @param *below closed surface on the negative side of the plane
+ * @param *above closed surface on the positive side of the plane
+ * @return SV_OK if the plane cuts the surface, SV_ERROR if the surface is
+ * entirely on one side or the cut could not be closed
+ */
+int TGenUtils_SplitSurfaceWithPlane(vtkPolyData *surface,
+    vtkPlane *plane, double edgeSize, std::string markerListName,
+    int interfaceMarker, vtkPolyData *below, vtkPolyData *above)
+{
+  vtkIdType numPts = surface->GetNumberOfPoints();
+  int numAbove = 0, numBelow = 0;
+  double pt[3];
+  for (vtkIdType i=0; i<numPts; i++)
+  {
+    surface->GetPoint(i, pt);
+    if (plane->EvaluateFunction(pt) > 0.0)
+      numAbove++;
+    else
+      numBelow++;
+  }
+  if (numAbove == 0 || numBelow == 0)
+    return SV_ERROR;
+
+  if (surface->GetCellData()->GetArray(markerListName.c_str()) == NULL)
+  {
+    fprintf(stderr,"Array %s must exist on surface to split it\n",
+      markerListName.c_str());
+    return SV_ERROR;
+  }
+
+  // Only the markers and the sizing function are carried to the pieces
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->ShallowCopy(surface);
+  input->GetCellData()->Initialize();
+  input->GetCellData()->AddArray(surface->GetCellData()->GetArray(markerListName.c_str()));
+  input->GetPointData()->Initialize();
+  if (surface->GetPointData()->GetArray("MeshSizingFunction") != NULL)
+    input->GetPointData()->AddArray(surface->GetPointData()->GetArray("MeshSizingFunction"));
+
+  vtkSmartPointer<vtkClipPolyData> clipper = vtkSmartPointer<vtkClipPolyData>::New();
+  clipper->SetInputData(input);
+  clipper->SetClipFunction(plane);
+  clipper->GenerateClippedOutputOn();
+  clipper->Update();
+
+  vtkPolyData *sides[2] = {clipper->GetClippedOutput(), clipper->GetOutput()};
+  vtkPolyData *outputs[2] = {below, above};
+
+  // The interface is triangulated once from the cut loops of one side
+  vtkSmartPointer<vtkCleanPolyData> sideCleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+  sideCleaner->SetInputData(sides[1]);
+  sideCleaner->Update();
+
+  vtkSmartPointer<vtkFeatureEdges> boundaries = vtkSmartPointer<vtkFeatureEdges>::New();
+  boundaries->SetInputData(sideCleaner->GetOutput());
+  boundaries->BoundaryEdgesOn();
+  boundaries->FeatureEdgesOff();
+  boundaries->NonManifoldEdgesOff();
+  boundaries->ManifoldEdgesOff();
+  boundaries->ColoringOff();
+  boundaries->Update();
+
+  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInputData(boundaries->GetOutput());
+  stripper->JoinContiguousSegmentsOn();
+  stripper->Update();
+
+  vtkSmartPointer<vtkCleanPolyData> loopCleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+  loopCleaner->SetInputData(stripper->GetOutput());
+  loopCleaner->Update();
+
+  vtkSmartPointer<vtkPolyData> cap = vtkSmartPointer<vtkPolyData>::New();
+  if (TGenUtils_TriangulatePlanarLoops(loopCleaner->GetOutput(),
+        plane->GetNormal(), edgeSize, cap) != SV_OK)
+    return SV_ERROR;
+
+  vtkSmartPointer<vtkIntArray> capMarkers = vtkSmartPointer<vtkIntArray>::New();
+  capMarkers->SetName(markerListName.c_str());
+  capMarkers->SetNumberOfTuples(cap->GetNumberOfCells());
+  capMarkers->FillComponent(0, interfaceMarker);
+  cap->GetCellData()->AddArray(capMarkers);
+  vtkDataArray *sizing = input->GetPointData()->GetArray("MeshSizingFunction");
+  if (sizing != NULL && cap->GetPointData()->GetArray("MeshSizingFunction") == NULL)
+  {
+    vtkSmartPointer<vtkDoubleArray> capSizing = vtkSmartPointer<vtkDoubleArray>::New();
+    capSizing->SetName("MeshSizingFunction");
+    capSizing->SetNumberOfTuples(cap->GetNumberOfPoints());
+    capSizing->FillComponent(0, 0.0);
+    cap->GetPointData()->AddArray(capSizing);
+  }
+
+  // Appending the cap first means its points win when the rim is merged,
+  // so both sides end up with identical interface coordinates
+  double bounds[6];
+  surface->GetBounds(bounds);
+  double diag = sqrt(pow(bounds[1]-bounds[0],2) + pow(bounds[3]-bounds[2],2) +
+                     pow(bounds[5]-bounds[4],2));
+  for (int i=0; i<2; i++)
+  {
+    vtkSmartPointer<vtkAppendPolyData> appender = vtkSmartPointer<vtkAppendPolyData>::New();
+    appender->AddInputData(cap);
+    appender->AddInputData(sides[i]);
+    appender->Update();
+
+    vtkSmartPointer<vtkCleanPolyData> cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+    cleaner->SetInputData(appender->GetOutput());
+    cleaner->ToleranceIsAbsoluteOn();
+    cleaner->SetAbsoluteTolerance(1.0e-8*diag);
+    cleaner->ConvertPolysToLinesOff();
+    cleaner->ConvertLinesToPointsOff();
+    cleaner->Update();
+
+    outputs[i]->DeepCopy(cleaner->GetOutput());
+  }
+
+  return SV_OK;
+}
+
+// -----------------------------
+// TGenUtils_DecomposeSurface
+// -----------------------------
+/**
+ * @brief Cuts a closed surface into closed sub-domains with every plane in
+ * turn
+ * @param *domains the resulting pieces; planes that miss a piece leave it
+ * whole
+ * @return SV_OK if function completes properly
+ */
+int TGenUtils_DecomposeSurface(vtkPolyData *surface,
+    vtkPlaneCollection *planes, double edgeSize, std::string markerListName,
+    int interfaceMarker, std::vector<vtkSmartPointer<vtkPolyData> > &domains)
+{
+  domains.clear();
+  vtkSmartPointer<vtkPolyData> whole = vtkSmartPointer<vtkPolyData>::New();
+  whole->DeepCopy(surface);
+  domains.push_back(whole);
+
+  vtkPlane *plane;
+  vtkCollectionSimpleIterator sit;
+  for (planes->InitTraversal(sit); (plane = planes->GetNextPlane(sit));)
+  {
+    std::vector<vtkSmartPointer<vtkPolyData> > newDomains;
+    for (size_t i=0; i<domains.size(); i++)
+    {
+      vtkSmartPointer<vtkPolyData> below = vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> above = vtkSmartPointer<vtkPolyData>::New();
+      if (TGenUtils_SplitSurfaceWithPlane(domains[i], plane, edgeSize,
+            markerListName, interfaceMarker, below, above) == SV_OK)
+      {
+        newDomains.push_back(below);
+        newDomains.push_back(above);
+      }
+      else
+        newDomains.push_back(domains[i]);
+    }
+    domains = newDomains;
+  }
+
+  return SV_OK;
+}
+
+// -----------------------------
+// TGenUtils_MergeSubDomainMeshes
+// -----------------------------
+/**
+ * @brief Stitches sub-domain meshes from TGenUtils_ConvertToVTK into one
+ * mesh
+ * @note Interface nodes are shared by exact coordinate match, interface
+ * faces are dropped from the surface, and GlobalNodeID/GlobalElementID are
+ * renumbered contiguously over the merged mesh.
+ * @return SV_OK if function completes properly
+ */
+int TGenUtils_MergeSubDomainMeshes(
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid> > &volumes,
+    std::vector<vtkSmartPointer<vtkPolyData> > &surfaces,
+    int interfaceMarker, vtkUnstructuredGrid *volumemesh,
+    vtkPolyData *surfacemesh, int *totRegions)
+{
+  if (volumes.size() != surfaces.size() || volumes.empty())
+  {
+    fprintf(stderr,"Need one volume and one surface per sub-domain\n");
+    return SV_ERROR;
+  }
+
+  double bounds[6] = {VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX,
+                      -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX};
+  for (size_t d=0; d<volumes.size(); d++)
+  {
+    double domainBounds[6];
+    volumes[d]->GetBounds(domainBounds);
+    for (int j=0; j<3; j++)
+    {
+      bounds[2*j]   = std::min(bounds[2*j], domainBounds[2*j]);
+      bounds[2*j+1] = std::max(bounds[2*j+1], domainBounds[2*j+1]);
+    }
+  }
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkMergePoints> merger = vtkSmartPointer<vtkMergePoints>::New();
+  merger->InitPointInsertion(points, bounds);
+
+  vtkSmartPointer<vtkCellArray> tets = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkIntArray> modelRegionIds = vtkSmartPointer<vtkIntArray>::New();
+  vtkSmartPointer<vtkIntArray> globalElementIds = vtkSmartPointer<vtkIntArray>::New();
+
+  vtkSmartPointer<vtkCellArray> faces = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkIntArray> faceIds = vtkSmartPointer<vtkIntArray>::New();
+  vtkSmartPointer<vtkIntArray> faceElementIds = vtkSmartPointer<vtkIntArray>::New();
+  std::vector<vtkIdType> surfacePointIds;
+
+  vtkIdType npts, *pts;
+  vtkIdType elementOffset = 0;
+  int maxFaceId = 0;
+  for (size_t d=0; d<volumes.size(); d++)
+  {
+    vtkUnstructuredGrid *volume = volumes[d];
+    vtkPolyData *surface = surfaces[d];
+
+    std::vector<vtkIdType> pointMap(volume->GetNumberOfPoints());
+    double pt[3];
+    for (vtkIdType i=0; i<volume->GetNumberOfPoints(); i++)
+    {
+      volume->GetPoint(i, pt);
+      merger->InsertUniquePoint(pt, pointMap[i]);
+    }
+
+    vtkDataArray *regions = volume->GetCellData()->GetArray("ModelRegionID");
+    vtkIdType tet[4];
+    for (vtkIdType i=0; i<volume->GetNumberOfCells(); i++)
+    {
+      volume->GetCellPoints(i, npts, pts);
+      for (int j=0; j<npts && j<4; j++)
+        tet[j] = pointMap[pts[j]];
+      tets->InsertNextCell(npts, tet);
+      modelRegionIds->InsertNextValue(regions ? (int) regions->GetTuple1(i) : 1);
+      globalElementIds->InsertNextValue(elementOffset + i + 1);
+    }
+
+    // Surface points index volume points through their GlobalNodeID
+    vtkDataArray *nodeIds = surface->GetPointData()->GetArray("GlobalNodeID");
+    vtkDataArray *markers = surface->GetCellData()->GetArray("ModelFaceID");
+    vtkDataArray *elementIds = surface->GetCellData()->GetArray("GlobalElementID");
+    if (nodeIds == NULL || markers == NULL || elementIds == NULL)
+    {
+      fprintf(stderr,"Sub-domain surface is missing its id arrays\n");
+      return SV_ERROR;
+    }
+    vtkIdType tri[3];
+    for (vtkIdType i=0; i<surface->GetNumberOfCells(); i++)
+    {
+      int marker = (int) markers->GetTuple1(i);
+      if (marker == interfaceMarker)
+        continue;
+      surface->GetCellPoints(i, npts, pts);
+      for (int j=0; j<npts && j<3; j++)
+        tri[j] = pointMap[(vtkIdType) nodeIds->GetTuple1(pts[j]) - 1];
+      faces->InsertNextCell(npts, tri);
+      faceIds->InsertNextValue(marker);
+      faceElementIds->InsertNextValue(elementOffset + (vtkIdType) elementIds->GetTuple1(i));
+      maxFaceId = std::max(maxFaceId, marker);
+    }
+
+    elementOffset += volume->GetNumberOfCells();
+  }
+
+  vtkIdType numPts = points->GetNumberOfPoints();
+  vtkSmartPointer<vtkIntArray> globalNodeIds = vtkSmartPointer<vtkIntArray>::New();
+  globalNodeIds->SetNumberOfTuples(numPts);
+  for (vtkIdType i=0; i<numPts; i++)
+    globalNodeIds->SetValue(i, i+1);
+
+  vtkSmartPointer<vtkUnstructuredGrid> fullUGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  fullUGrid->SetPoints(points);
+  fullUGrid->SetCells(VTK_TETRA, tets);
+  modelRegionIds->SetName("ModelRegionID");
+  fullUGrid->GetCellData()->AddArray(modelRegionIds);
+  fullUGrid->GetCellData()->SetActiveScalars("ModelRegionID");
+  globalNodeIds->SetName("GlobalNodeID");
+  fullUGrid->GetPointData()->AddArray(globalNodeIds);
+  globalElementIds->SetName("GlobalElementID");
+  fullUGrid->GetCellData()->AddArray(globalElementIds);
+
+  // Compact the surface points
+  std::vector<vtkIdType> surfaceMap(numPts, -1);
+  vtkSmartPointer<vtkPoints> vtpPoints = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkIntArray> vtpNodeIds = vtkSmartPointer<vtkIntArray>::New();
+  vtkSmartPointer<vtkCellArray> vtpFaces = vtkSmartPointer<vtkCellArray>::New();
+  for (faces->InitTraversal(); faces->GetNextCell(npts, pts);)
+  {
+    vtkIdType tri[3];
+    for (int j=0; j<npts && j<3; j++)
+    {
+      if (surfaceMap[pts[j]] < 0)
+      {
+        surfaceMap[pts[j]] = vtpPoints->InsertNextPoint(points->GetPoint(pts[j]));
+        vtpNodeIds->InsertNextValue(pts[j]+1);
+      }
+      tri[j] = surfaceMap[pts[j]];
+    }
+    vtpFaces->InsertNextCell(npts, tri);
+  }
+
+  vtkSmartPointer<vtkPolyData> fullPolyData = vtkSmartPointer<vtkPolyData>::New();
+  fullPolyData->SetPoints(vtpPoints);
+  fullPolyData->SetPolys(vtpFaces);
+  vtpNodeIds->SetName("GlobalNodeID");
+  fullPolyData->GetPointData()->AddArray(vtpNodeIds);
+  fullPolyData->GetPointData()->SetActiveScalars("GlobalNodeID");
+  faceElementIds->SetName("GlobalElementID");
+  fullPolyData->GetCellData()->AddArray(faceElementIds);
+  faceIds->SetName("ModelFaceID");
+  fullPolyData->GetCellData()->AddArray(faceIds);
+  fullPolyData->GetCellData()->SetActiveScalars("ModelFaceID");
+
+  volumemesh->DeepCopy(fullUGrid);
+  surfacemesh->DeepCopy(fullPolyData);
+  *totRegions = maxFaceId;
+
+  return SV_OK;
+}
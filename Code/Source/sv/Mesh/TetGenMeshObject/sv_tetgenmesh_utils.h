@@ -51,9 +51,14 @@
 
 #include "vtkPolyData.h"
 #include "vtkUnstructuredGrid.h"
+#include "vtkPlane.h"
+#include "vtkPlaneCollection.h"
+#include "vtkSmartPointer.h"
 
 #include "simvascular_tetgen.h"
 
+#include <vector>
+
 SV_EXPORT_TETGEN_MESH int TGenUtils_Init();
 //int cvTetGenMeshObjectUtils_Logon(char *filename);
 //int cvTetGenMeshObjectUtils_Logoff();
@@ -117,4 +122,27 @@ SV_EXPORT_TETGEN_MESH int TGenUtils_CheckSurfaceMesh(vtkPolyData *pd, int meshIn
 
 SV_EXPORT_TETGEN_MESH int TGenUtils_SetLocalMeshSize(vtkPolyData *pd,int regionId,double size);
 
+//Sub-domain meshing: the surface is cut into closed pieces that share a
+//planar interface triangulation, each piece is meshed on its own, and the
+//pieces are merged back together
+SV_EXPORT_TETGEN_MESH int TGenUtils_GetSubDomainPlanesFromCenterlines(vtkPolyData *centerlines,
+    int numSubDomains, vtkPlaneCollection *planes);
+
+SV_EXPORT_TETGEN_MESH int TGenUtils_TriangulatePlanarLoops(vtkPolyData *loops,
+    double normal[3], double edgeSize, vtkPolyData *cap);
+
+SV_EXPORT_TETGEN_MESH int TGenUtils_SplitSurfaceWithPlane(vtkPolyData *surface,
+    vtkPlane *plane, double edgeSize, std::string markerListName,
+    int interfaceMarker, vtkPolyData *below, vtkPolyData *above);
+
+SV_EXPORT_TETGEN_MESH int TGenUtils_DecomposeSurface(vtkPolyData *surface,
+    vtkPlaneCollection *planes, double edgeSize, std::string markerListName,
+    int interfaceMarker, std::vector<vtkSmartPointer<vtkPolyData> > &domains);
+
+SV_EXPORT_TETGEN_MESH int TGenUtils_MergeSubDomainMeshes(
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid> > &volumes,
+    std::vector<vtkSmartPointer<vtkPolyData> > &surfaces,
+    int interfaceMarker, vtkUnstructuredGrid *volumemesh,
+    vtkPolyData *surfacemesh, int *totRegions);
+
 #endif //__CV_TETGENMESH_UTILS_H
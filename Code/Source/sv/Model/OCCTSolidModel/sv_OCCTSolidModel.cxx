@@ -55,8 +55,12 @@
 #include "sv_occtsolid_utils.h"
 #include "sv_misc_utils.h"
 #include "sv_sys_geom.h"
+#include "sv_parallel_utils.h"
 #include <string.h>
 #include <assert.h>
+#include <array>
+#include <map>
+#include <mutex>
 
 #include "gp_Pnt.hxx"
 #include "gp_Ax2.hxx"
@@ -100,6 +104,11 @@
 #include "BRepTools.hxx"
 #include "BRepTools_ReShape.hxx"
 #include "BRep_Tool.hxx"
+#include "BRepMesh_IncrementalMesh.hxx"
+#include "Poly_Triangulation.hxx"
+#include "Prs3d.hxx"
+#include "Prs3d_Drawer.hxx"
+#include "TopLoc_Location.hxx"
 #include "ShapeFix_Shell.hxx"
 #include "ShapeFix_FreeBounds.hxx"
 
@@ -150,6 +159,10 @@
 #include "IGESCAFControl_Reader.hxx"
 #include "StlAPI_Writer.hxx"
 
+// All models register their shapes and faces in the one global XCAF
+// document, which is not thread safe
+static std::recursive_mutex cvOCCTDocumentMutex;
+
 
 // ----------
 // OCCTSolidModel
@@ -167,6 +180,7 @@ cvOCCTSolidModel::cvOCCTSolidModel()
  */
   numBoundaryRegions = 0;
   geom_ = NULL;
+  tessMaxDist_ = 0.0;
 
   //Get the document created inside of the manager
   Handle(TDocStd_Document) doc;
@@ -207,6 +221,7 @@ cvOCCTSolidModel::cvOCCTSolidModel( const cvOCCTSolidModel& sm)
 	: cvSolidModel( SM_KT_OCCT)
 {
   geom_ = NULL;
+  tessMaxDist_ = 0.0;
   Copy( sm );
 }
 
@@ -903,6 +918,23 @@ cvPolyData *cvOCCTSolidModel::GetPolyData(int useMaxDist, double max_dist) const
   if (useMaxDist == 0)
     max_dist = 20.0;
 
+  TopExp_Explorer faceExp(*geom_,TopAbs_FACE);
+  if (faceExp.More())
+  {
+    if (this->BuildTessellationCache(max_dist) != SV_OK)
+    {
+      fprintf(stderr,"Could not tessellate solid\n");
+      return SV_ERROR;
+    }
+
+    pd = vtkPolyData::New();
+    pd->DeepCopy(tessWhole_);
+    result = new cvPolyData(pd);
+    pd->Delete();
+    return result;
+  }
+
+  //No faces, use the IVtk mesher to get the edges
   IVtkOCC_Shape::Handle aShapeImpl = new IVtkOCC_Shape(*geom_);
   //IVtk_IShapeData::Handle aDataImpl = new IVtkVTK_ShapeData();
   IVtkVTK_ShapeData::Handle aDataImpl = new IVtkVTK_ShapeData();
@@ -1066,25 +1098,20 @@ cvPolyData *cvOCCTSolidModel::GetFacePolyData(int faceid, int useMaxDist, double
     return SV_ERROR;
   }
 
-  //const TopoDS_Face& useFace = TopoDS::Face (anExp.Current());
-
-  IVtkOCC_Shape::Handle aShapeImpl = new IVtkOCC_Shape(anExp.Current());
-  IVtkVTK_ShapeData::Handle aDataImpl = new IVtkVTK_ShapeData();
-  //IVtk_IShapeMesher::Handle aMesher = new IVtkOCC_ShapeMesher();
-  //Deviation Coefficient is 0.0001,Deviation Angle = 5rad,default is 12rad,
-  //Do not generate u isoline and do not generate v isoline
-  double devcoeff = 0.0001;
-  double angcoeff = max_dist * M_PI/180.0;
-  int uIsoLine= 0;
-  int vIsoLine= 0;
-  IVtk_IShapeMesher::Handle aMesher = new IVtkOCC_ShapeMesher(
-      devcoeff,angcoeff,uIsoLine,vIsoLine);
-  aMesher->Build(aShapeImpl,aDataImpl);
+  if (this->BuildTessellationCache(max_dist) != SV_OK)
+  {
+    fprintf(stderr,"Could not tessellate solid\n");
+    return SV_ERROR;
+  }
+  int faceIndex = tessFaceMap_.FindIndex(anExp.Current());
+  if (faceIndex < 1)
+  {
+    fprintf(stderr,"ERROR: face not in tessellation!\n");
+    return SV_ERROR;
+  }
 
   pd = vtkPolyData::New();
-  pd->DeepCopy(aDataImpl->getVtkPolyData());
-  //if (max_dist != -1)
-    this->GetOnlyPD(pd,max_dist);
+  pd->DeepCopy(tessFaces_[faceIndex-1]);
 
   result = new cvPolyData(pd);
   pd->Delete();
@@ -1456,6 +1483,7 @@ int cvOCCTSolidModel::AddFaceLabel(TopoDS_Shape &shape, int &id)
     fprintf(stderr,"Face is NULL, cannot add\n");
     return SV_ERROR;
   }
+  std::lock_guard<std::recursive_mutex> lock(cvOCCTDocumentMutex);
   int checkid=-1;
   OCCTUtils_GetFaceLabel(shape,shapetool_,*shapelabel_,checkid);
   if (checkid != -1)
@@ -1535,6 +1563,7 @@ int cvOCCTSolidModel::AddShape()
   if (geom_ == NULL)
     return SV_ERROR;
 
+  std::lock_guard<std::recursive_mutex> lock(cvOCCTDocumentMutex);
   *shapelabel_ = shapetool_->NewShape();
   shapetool_->SetShape(*shapelabel_,*geom_);
   this->RegisterShapeFaces();
@@ -1558,6 +1587,7 @@ int cvOCCTSolidModel::RemoveShape()
     //Full shape info for new shape cannot be retrieved if removed currently
     //Will try some other stuff
     //shapetool_->RemoveShape(*shapelabel_,Standard_False);
+    this->ClearTessellationCache();
     if (shapelabel_ != NULL)
     {
       delete shapelabel_;
@@ -1579,20 +1609,30 @@ int cvOCCTSolidModel::RemoveShape()
 }
 
 // -------------------
-// CreateBSplineSurface
+// OCCTSolidModel_MakeBSplineShape
 // -------------------
-int cvOCCTSolidModel::CreateBSplineSurface(double **CX,double **CY,double **CZ,
-    int &len1,int &len2,double *uKnots,int &uKlen,double *vKnots,int &vKlen,
-    double *uMults,int &uMlen,double *vMults,int &vMlen,int &p,int &q)
+/**
+ * @brief Builds the shape of a B-spline surface with its two open ends
+ * closed by wires. Only OpenCASCADE geometry is touched, so surfaces can
+ * be built on several threads at once.
+ */
+static int OCCTSolidModel_MakeBSplineShape(
+    const cvOCCTSolidModel::BSplineSurfaceData &data,TopoDS_Shape &shape)
 {
-  //Create a BSpline surface from the input control points,knots, and mults
+  int len1 = data.len1;
+  int len2 = data.len2;
+  int uKlen = data.uKnots.size();
+  int vKlen = data.vKnots.size();
+  int uMlen = data.uMults.size();
+  int vMlen = data.vMults.size();
 
   TColgp_Array2OfPnt cPoints(1,len2,1,len1);
   for (int i=0;i<len1;i++)
   {
     for (int j=0;j<len2;j++)
     {
-      gp_Pnt newPnt(CX[i][j],CY[i][j],CZ[i][j]);
+      int index = i*len2+j;
+      gp_Pnt newPnt(data.X[index],data.Y[index],data.Z[index]);
       cPoints.SetValue(j+1,i+1,newPnt);
     }
   }
@@ -1600,46 +1640,26 @@ int cvOCCTSolidModel::CreateBSplineSurface(double **CX,double **CY,double **CZ,
   //Knot spans
   TColStd_Array1OfReal uKCol(1,uKlen);
   for (int i=0;i<uKlen;i++)
-    uKCol.SetValue(i+1, uKnots[i]);
+    uKCol.SetValue(i+1, data.uKnots[i]);
   TColStd_Array1OfReal vKCol(1,vKlen);
   for (int i=0;i<vKlen;i++)
-    vKCol.SetValue(i+1, vKnots[i]);
+    vKCol.SetValue(i+1, data.vKnots[i]);
 
   //Mult spans
   TColStd_Array1OfInteger uMCol(1,uMlen);
   for (int i=0;i<uMlen;i++)
-    uMCol.SetValue(i+1,(int) uMults[i]);
+    uMCol.SetValue(i+1,(int) data.uMults[i]);
   TColStd_Array1OfInteger vMCol(1,vMlen);
   for (int i=0;i<vMlen;i++)
-    vMCol.SetValue(i+1,(int) vMults[i]);
+    vMCol.SetValue(i+1,(int) data.vMults[i]);
 
-  Standard_Real tol = 1.e-6;
   Handle(Geom_BSplineSurface) surface;
   Handle(Geom_Surface) aSurf;
   try {
     Standard_Boolean uPer=Standard_False,vPer=Standard_False;
-    surface = new Geom_BSplineSurface(cPoints,uKCol,vKCol,uMCol,vMCol,p,q,uPer,vPer);
-    //surface->SetUPeriodic();
+    surface = new Geom_BSplineSurface(cPoints,uKCol,vKCol,uMCol,vMCol,
+      data.p,data.q,uPer,vPer);
     aSurf = surface;
-    //fprintf(stdout,"-----------------BSPLINE PARAMETERS----------------------\n");
-    //fprintf(stdout,"U Degree:             %d\n",surface->UDegree());
-    //fprintf(stdout,"Is U Closed?:         %d\n",surface->IsUClosed());
-    //fprintf(stdout,"Is U Periodic?:       %d\n",surface->IsUPeriodic());
-    //fprintf(stdout,"Is U Rational?:       %d\n",surface->IsURational());
-    //fprintf(stdout,"Nb U Poles:           %d\n",surface->NbUPoles());
-    //fprintf(stdout,"Nb U Knots:           %d\n",surface->NbUKnots());
-    //fprintf(stdout,"First U Knot Index:   %d\n",surface->FirstUKnotIndex());
-    //fprintf(stdout,"Last U Knot Index:    %d\n",surface->LastUKnotIndex());
-    //fprintf(stdout,"_________________________________________________________\n");
-    //fprintf(stdout,"V Degree:             %d\n",surface->VDegree());
-    //fprintf(stdout,"Is V Closed?:         %d\n",surface->IsVClosed());
-    //fprintf(stdout,"Is V Periodic?:       %d\n",surface->IsVPeriodic());
-    //fprintf(stdout,"Is U Rational?:       %d\n",surface->IsVRational());
-    //fprintf(stdout,"Nb V Poles:           %d\n",surface->NbVPoles());
-    //fprintf(stdout,"Nb V Knots:           %d\n",surface->NbVKnots());
-    //fprintf(stdout,"First V Knot Index:   %d\n",surface->FirstVKnotIndex());
-    //fprintf(stdout,"Last V Knot Index:    %d\n",surface->LastVKnotIndex());
-    //fprintf(stdout,"_________________________________________________________\n");
   }
   catch (Standard_ConstructionError)
   {
@@ -1648,19 +1668,18 @@ int cvOCCTSolidModel::CreateBSplineSurface(double **CX,double **CY,double **CZ,
   }
 
   BRepBuilderAPI_MakeShell shellBuilder(aSurf);
-  this->NewShape();
-  *geom_ = shellBuilder.Shape();
+  shape = shellBuilder.Shape();
 
   //Attacher!
   TopoDS_Wire wires[2];
   Standard_Real sewtoler =  1.e-6;
   Standard_Real closetoler =  1.e-2;
-  ShapeFix_FreeBounds findFree(*geom_,sewtoler,closetoler,
+  ShapeFix_FreeBounds findFree(shape,sewtoler,closetoler,
         	  Standard_False,Standard_False);
   TopoDS_Compound freeWires = findFree.GetClosedWires();
   TopExp_Explorer NewEdgeExp;
   NewEdgeExp.Init(freeWires,TopAbs_EDGE);
-  for (int i=0;NewEdgeExp.More();NewEdgeExp.Next(),i++)
+  for (int i=0;NewEdgeExp.More() && i<2;NewEdgeExp.Next(),i++)
   {
     TopoDS_Edge tmpEdge = TopoDS::Edge(NewEdgeExp.Current());
 
@@ -1671,14 +1690,74 @@ int cvOCCTSolidModel::CreateBSplineSurface(double **CX,double **CY,double **CZ,
   }
 
   Standard_Real pres3d = 1.0e-6;
-  if (OCCTUtils_ShapeFromBSplineSurface(surface,*geom_,wires[0],wires[1],pres3d) != SV_OK)
+  if (OCCTUtils_ShapeFromBSplineSurface(surface,shape,wires[0],wires[1],pres3d) != SV_OK)
   {
     fprintf(stderr,"Error in conversion from bspline surface to shape\n");
     return SV_ERROR;
   }
-  //TopoDS_Face firstFace,lastFace;
-  //*geom_ = OCCTUtils_MakeSolid(shellBuilder.Shell(),wires[0],wires[1],firstFace,lastFace,pres3d);
 
+  return SV_OK;
+}
+
+// -------------------
+// OCCTSolidModel_CapShape
+// -------------------
+/**
+ * @brief Caps the open ends of a surface and checks that the result is a
+ * solid. The filled faces are the last numFilled faces of solid.
+ */
+static int OCCTSolidModel_CapShape(const TopoDS_Shape &surf,
+    TopoDS_Shape &solid,int &numFilled)
+{
+  TopoDS_Shape shape = surf;
+  BRepBuilderAPI_Sewing attacher;
+  numFilled = 0;
+  if (OCCTUtils_CapShapeToSolid(shape,solid,attacher,numFilled) != SV_OK)
+  {
+    fprintf(stderr,"Error capping shape\n");
+    return SV_ERROR;
+  }
+
+  int issue=0;
+  if (OCCTUtils_CheckIsSolid(solid,issue) != SV_OK || issue != 0)
+  {
+    fprintf(stderr,"Shape is not solid after cap\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+// -------------------
+// CreateBSplineSurface
+// -------------------
+int cvOCCTSolidModel::CreateBSplineSurface(double **CX,double **CY,double **CZ,
+    int &len1,int &len2,double *uKnots,int &uKlen,double *vKnots,int &vKlen,
+    double *uMults,int &uMlen,double *vMults,int &vMlen,int &p,int &q)
+{
+  //Create a BSpline surface from the input control points,knots, and mults
+  BSplineSurfaceData data;
+  data.len1 = len1;
+  data.len2 = len2;
+  for (int i=0;i<len1;i++)
+  {
+    data.X.insert(data.X.end(),CX[i],CX[i]+len2);
+    data.Y.insert(data.Y.end(),CY[i],CY[i]+len2);
+    data.Z.insert(data.Z.end(),CZ[i],CZ[i]+len2);
+  }
+  data.uKnots.assign(uKnots,uKnots+uKlen);
+  data.vKnots.assign(vKnots,vKnots+vKlen);
+  data.uMults.assign(uMults,uMults+uMlen);
+  data.vMults.assign(vMults,vMults+vMlen);
+  data.p = p;
+  data.q = q;
+
+  TopoDS_Shape shape;
+  if (OCCTSolidModel_MakeBSplineShape(data,shape) != SV_OK)
+    return SV_ERROR;
+
+  this->NewShape();
+  *geom_ = shape;
   this->AddShape();
 
   //Name faces
@@ -1692,6 +1771,78 @@ int cvOCCTSolidModel::CreateBSplineSurface(double **CX,double **CY,double **CZ,
   return SV_OK;
 }
 
+// -------------------
+// CreateBSplineSurfaces
+// -------------------
+/**
+ * @brief Creates the B-spline surfaces, capped if addCaps is set, of
+ * several vessels. Faces are named as by CreateBSplineSurface followed by
+ * CapSurfToSolid: "wall" for the surface and "cap" for the filled ends.
+ * @return SV_ERROR if any of the surfaces could not be created.
+ */
+int cvOCCTSolidModel::CreateBSplineSurfaces(int numSurfaces,
+    const BSplineSurfaceData *surfaces,int addCaps,
+    cvOCCTSolidModel **models)
+{
+  std::vector<TopoDS_Shape> shapes(numSurfaces);
+  std::vector<int> numFilled(numSurfaces,0);
+  std::vector<int> status(numSurfaces,SV_ERROR);
+
+  ParallelUtils_For(numSurfaces, [&](int i)
+  {
+    try
+    {
+      TopoDS_Shape surf;
+      if (OCCTSolidModel_MakeBSplineShape(surfaces[i],surf) != SV_OK)
+        return;
+      if (addCaps)
+      {
+        if (OCCTSolidModel_CapShape(surf,shapes[i],numFilled[i]) != SV_OK)
+          return;
+      }
+      else
+        shapes[i] = surf;
+      status[i] = SV_OK;
+    }
+    catch (Standard_Failure)
+    {
+      fprintf(stderr,"OpenCASCADE failure building surface %d\n",i);
+    }
+  });
+
+  for (int i=0;i<numSurfaces;i++)
+  {
+    if (status[i] != SV_OK)
+    {
+      fprintf(stderr,"Could not create bspline surface %d\n",i);
+      return SV_ERROR;
+    }
+  }
+
+  //The document is shared by all models, register them one at a time
+  std::lock_guard<std::recursive_mutex> lock(cvOCCTDocumentMutex);
+  for (int i=0;i<numSurfaces;i++)
+  {
+    cvOCCTSolidModel *model = models[i];
+    model->NewShape();
+    *(model->geom_) = shapes[i];
+    model->AddShape();
+
+    int numFaces = 0;
+    OCCTUtils_GetNumberOfFaces(*(model->geom_),numFaces);
+    TopExp_Explorer anExp(*(model->geom_),TopAbs_FACE);
+    for (int j=0;anExp.More();anExp.Next(),j++)
+    {
+      TopoDS_Face tmpFace = TopoDS::Face(anExp.Current());
+      const char *name = (j >= (numFaces-numFilled[i])) ? "cap" : "wall";
+      OCCTUtils_SetFaceAttribute(tmpFace,model->shapetool_,
+        *(model->shapelabel_),"gdscName",const_cast<char*>(name));
+    }
+  }
+
+  return SV_OK;
+}
+
 // ---------------
 // GetOnlyPD
 // ---------------
@@ -1739,3 +1890,215 @@ int cvOCCTSolidModel::GetOnlyPD(vtkPolyData *pd,double &max_dist) const
   return SV_OK;
 }
 
+// ---------------
+// ClearTessellationCache
+// ---------------
+void cvOCCTSolidModel::ClearTessellationCache() const
+{
+  tessShape_.Nullify();
+  tessMaxDist_ = 0.0;
+  tessFaceMap_.Clear();
+  tessFaces_.clear();
+  tessWhole_ = NULL;
+}
+
+// ---------------
+// OCCTSolidModel_GetFaceTriangles
+// ---------------
+/**
+ * @brief Copies the triangulation of a meshed face. Coincident nodes
+ * (e.g. along the seam of a periodic face) are merged and triangles that
+ * collapse are dropped, as vtkCleanPolyData did on the IVtk output.
+ * @param pts output point coordinates, three per point.
+ * @param tris output point ids, three per triangle.
+ */
+static void OCCTSolidModel_GetFaceTriangles(const TopoDS_Face &face,
+                                            std::vector<double> &pts,
+                                            std::vector<vtkIdType> &tris)
+{
+  TopLoc_Location loc;
+  Handle(Poly_Triangulation) triangulation =
+    BRep_Tool::Triangulation(face,loc);
+  if (triangulation.IsNull())
+    return;
+
+  const gp_Trsf &trsf = loc.Transformation();
+  const TColgp_Array1OfPnt &nodes = triangulation->Nodes();
+  int numNodes = triangulation->NbNodes();
+
+  std::map<std::array<double,3>,vtkIdType> merged;
+  std::vector<vtkIdType> nodeIds(numNodes);
+  for (int i=1; i<=numNodes; i++)
+  {
+    gp_Pnt pnt = nodes(i);
+    if (!loc.IsIdentity())
+      pnt.Transform(trsf);
+    std::array<double,3> key = {{pnt.X(),pnt.Y(),pnt.Z()}};
+    std::map<std::array<double,3>,vtkIdType>::iterator it = merged.find(key);
+    if (it == merged.end())
+    {
+      vtkIdType newId = pts.size()/3;
+      merged[key] = newId;
+      pts.insert(pts.end(),key.begin(),key.end());
+      nodeIds[i-1] = newId;
+    }
+    else
+      nodeIds[i-1] = it->second;
+  }
+
+  const Poly_Array1OfTriangle &triangles = triangulation->Triangles();
+  int numTriangles = triangulation->NbTriangles();
+  tris.reserve(3*numTriangles);
+  for (int i=1; i<=numTriangles; i++)
+  {
+    int n1, n2, n3;
+    triangles(i).Get(n1,n2,n3);
+    vtkIdType id1 = nodeIds[n1-1];
+    vtkIdType id2 = nodeIds[n2-1];
+    vtkIdType id3 = nodeIds[n3-1];
+    if (id1 == id2 || id2 == id3 || id1 == id3)
+      continue;
+    tris.push_back(id1);
+    tris.push_back(id2);
+    tris.push_back(id3);
+  }
+}
+
+// ---------------
+// BuildTessellationCache
+// ---------------
+/**
+ * @brief Meshes geom_ and stores the polydata of every face and of the
+ * whole solid. Nothing is done if the cache already holds the current
+ * shape at this max_dist. OpenCASCADE operations on the model always
+ * produce a new shape, so any modification invalidates the cache.
+ * @param max_dist angular deflection in degrees.
+ * @return SV_OK if the cache is valid on return.
+ */
+int cvOCCTSolidModel::BuildTessellationCache(double max_dist) const
+{
+  if (geom_ == NULL || geom_->IsNull())
+    return SV_ERROR;
+
+  if (!tessShape_.IsNull() && tessShape_.IsEqual(*geom_) &&
+      tessMaxDist_ == max_dist)
+    return SV_OK;
+
+  this->ClearTessellationCache();
+
+  //Same deflection as the IVtk mesher: relative to the bounding box with
+  //deviation coefficient 0.0001, max_dist is the angular deflection.
+  //The whole shape is meshed at once so faces share their edge nodes,
+  //and OpenCASCADE meshes the faces in parallel
+  Handle(Prs3d_Drawer) drawer = new Prs3d_Drawer();
+  drawer->SetTypeOfDeflection(Aspect_TOD_RELATIVE);
+  drawer->SetDeviationCoefficient(0.0001);
+  double deflection = Prs3d::GetDeflection(*geom_,drawer);
+  double angcoeff = max_dist * M_PI/180.0;
+
+  BRepTools::Clean(*geom_);
+  BRepMesh_IncrementalMesh mesher(*geom_,deflection,Standard_False,
+    angcoeff,Standard_True);
+
+  TopExp::MapShapes(*geom_,TopAbs_FACE,tessFaceMap_);
+  int numFaces = tessFaceMap_.Extent();
+
+  //Sub-shape ids of the whole shape, as IVtk would have written them
+  IVtkOCC_Shape::Handle aShapeImpl = new IVtkOCC_Shape(*geom_);
+  std::vector<vtkIdType> subShapeIds(numFaces);
+  for (int i=0; i<numFaces; i++)
+    subShapeIds[i] = aShapeImpl->GetSubShapeId(tessFaceMap_(i+1));
+
+  std::vector<std::vector<double> > facePts(numFaces);
+  std::vector<std::vector<vtkIdType> > faceTris(numFaces);
+  ParallelUtils_For(numFaces, [&](int i)
+  {
+    OCCTSolidModel_GetFaceTriangles(TopoDS::Face(tessFaceMap_(i+1)),
+      facePts[i],faceTris[i]);
+  });
+
+  //Faces are exact copies of the mesh, the whole solid merges points
+  //along shared edges by coordinates
+  std::map<std::array<double,3>,vtkIdType> merged;
+  vtkSmartPointer<vtkPoints> wholePts =
+    vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkCellArray> wholePolys =
+    vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkIdTypeArray> wholeMeshTypes =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  wholeMeshTypes->SetName("MESH_TYPES");
+  vtkSmartPointer<vtkIdTypeArray> wholeSubShapeIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  wholeSubShapeIds->SetName("SUBSHAPE_IDS");
+
+  tessFaces_.resize(numFaces);
+  for (int i=0; i<numFaces; i++)
+  {
+    const std::vector<double> &pts = facePts[i];
+    const std::vector<vtkIdType> &tris = faceTris[i];
+    vtkIdType numPts = pts.size()/3;
+    vtkIdType numTris = tris.size()/3;
+
+    vtkSmartPointer<vtkPoints> points =
+    vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToDouble();
+    points->SetNumberOfPoints(numPts);
+    std::vector<vtkIdType> wholeIds(numPts);
+    for (vtkIdType j=0; j<numPts; j++)
+    {
+      points->SetPoint(j,&pts[3*j]);
+
+      std::array<double,3> key = {{pts[3*j],pts[3*j+1],pts[3*j+2]}};
+      std::map<std::array<double,3>,vtkIdType>::iterator it = merged.find(key);
+      if (it == merged.end())
+      {
+        wholeIds[j] = wholePts->InsertNextPoint(&pts[3*j]);
+        merged[key] = wholeIds[j];
+      }
+      else
+        wholeIds[j] = it->second;
+    }
+
+    vtkSmartPointer<vtkCellArray> polys =
+    vtkSmartPointer<vtkCellArray>::New();
+    polys->Allocate(polys->EstimateSize(numTris,3));
+    vtkSmartPointer<vtkIdTypeArray> meshTypes =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+    meshTypes->SetName("MESH_TYPES");
+    meshTypes->SetNumberOfTuples(numTris);
+    vtkSmartPointer<vtkIdTypeArray> subShapes =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+    subShapes->SetName("SUBSHAPE_IDS");
+    subShapes->SetNumberOfTuples(numTris);
+    for (vtkIdType j=0; j<numTris; j++)
+    {
+      polys->InsertNextCell(3,&tris[3*j]);
+      meshTypes->SetValue(j,7);
+      subShapes->SetValue(j,subShapeIds[i]);
+
+      vtkIdType wholeTri[3] = {wholeIds[tris[3*j]],wholeIds[tris[3*j+1]],
+                               wholeIds[tris[3*j+2]]};
+      wholePolys->InsertNextCell(3,wholeTri);
+      wholeMeshTypes->InsertNextValue(7);
+      wholeSubShapeIds->InsertNextValue(subShapeIds[i]);
+    }
+
+    tessFaces_[i] = vtkSmartPointer<vtkPolyData>::New();
+    tessFaces_[i]->SetPoints(points);
+    tessFaces_[i]->SetPolys(polys);
+    tessFaces_[i]->GetCellData()->AddArray(subShapes);
+    tessFaces_[i]->GetCellData()->AddArray(meshTypes);
+  }
+
+  tessWhole_ = vtkSmartPointer<vtkPolyData>::New();
+  tessWhole_->SetPoints(wholePts);
+  tessWhole_->SetPolys(wholePolys);
+  tessWhole_->GetCellData()->AddArray(wholeSubShapeIds);
+  tessWhole_->GetCellData()->AddArray(wholeMeshTypes);
+
+  tessShape_ = *geom_;
+  tessMaxDist_ = max_dist;
+
+  return SV_OK;
+}
+
@@ -56,9 +56,14 @@
 #include "sv_misc_utils.h"
 #include "TopoDS_Shape.hxx"
 #include "TopoDS_Face.hxx"
+#include "TopTools_IndexedMapOfShape.hxx"
 #include "TDF_Label.hxx"
 #include "XCAFDoc_ShapeTool.hxx"
 
+#include "vtkSmartPointer.h"
+
+#include <vector>
+
 
 // Some elementary notes on abstract base classes (ABC's)
 // ------------------------------------------------------
@@ -188,8 +193,33 @@ public:
     int &len1,int &len2, double *uKnots,int &uKlen,double *vKnots,int &vKlen,
     double *uMults,int &uMlen,double *vMults,int &vMlen,int &p,int &q);
 
+  //Control points, knots, multiplicities and degrees of one B-spline
+  //surface, as given to CreateBSplineSurface. Control point (i,j) is
+  //stored at i*len2+j
+  struct BSplineSurfaceData
+  {
+    int len1, len2;
+    std::vector<double> X, Y, Z;
+    std::vector<double> uKnots, vKnots;
+    std::vector<double> uMults, vMults;
+    int p, q;
+  };
+
+  //Create the B-spline surfaces of several vessels, capped to solids if
+  //addCaps is set. The OpenCASCADE shapes are built concurrently, then
+  //registered in the document one model at a time. Each of models must
+  //be a new solid
+  static int CreateBSplineSurfaces(int numSurfaces,
+    const BSplineSurfaceData *surfaces, int addCaps,
+    cvOCCTSolidModel **models);
+
   int GetOnlyPD(vtkPolyData *pd,double &max_dist) const;
+
+  //Drop the cached tessellation, it is rebuilt on the next call to
+  //GetPolyData or GetFacePolyData
+  void ClearTessellationCache() const;
 protected:
+  int BuildTessellationCache(double max_dist) const;
 
   TopoDS_Shape *geom_;
   TDF_Label *shapelabel_;
@@ -198,6 +228,15 @@ protected:
   int numFaces_;
   int numBoundaryRegions;
 
+  //Tessellation cache. It is valid while tessShape_ is the same shape
+  //as *geom_ and was meshed with the same max_dist. Face polydata are
+  //indexed by tessFaceMap_ index - 1
+  mutable TopoDS_Shape tessShape_;
+  mutable double tessMaxDist_;
+  mutable TopTools_IndexedMapOfShape tessFaceMap_;
+  mutable std::vector<vtkSmartPointer<vtkPolyData> > tessFaces_;
+  mutable vtkSmartPointer<vtkPolyData> tessWhole_;
+
 };
 
 #endif
@@ -48,6 +48,7 @@
 #include "sv_polydatasolid_utils.h"
 #include "sv_misc_utils.h"
 #include "sv_vtk_utils.h"
+#include "sv_geometry_cache.h"
 #include "sv_sys_geom.h"
 
 #include "sv2_globals.h"
@@ -70,6 +71,8 @@
 #include "vtkThreshold.h"
 #include "vtkDataSetSurfaceFilter.h"
 #include "vtkAppendFilter.h"
+#include "vtkFieldData.h"
+#include "vtkIntArray.h"
 
 // -------------
 // PlyDtaUtils_Init
@@ -172,10 +175,40 @@ int PlyDtaUtils_GetFaceIds( vtkPolyData *geom, int *v_num_faces, int **v_faces)
  * with a difference between face normals larger than this angle will be
  * considered a separate face
  * @return SV_OK if function completes properly
+ * @note Results are kept in the geometry cache when it is enabled
  */
 
 int PlyDtaUtils_GetBoundaryFaces( vtkPolyData *geom,double angle,int *numRegions)
 {
+  //Faces of the same surface at the same angle come from the geometry cache
+  vtkTypeUInt64 cacheKey = 0;
+  vtkSmartPointer<vtkPolyData> facesPd = vtkSmartPointer<vtkPolyData>::New();
+  if (GeometryCache_IsEnabled())
+  {
+    cacheKey = GeometryCache_GetSeed("boundaryfaces");
+    cacheKey = VtkUtils_HashBytes(&angle, sizeof(angle), cacheKey);
+    cacheKey = VtkUtils_HashDataSet(geom, cacheKey);
+
+    vtkIntArray *numRegionsArray = NULL;
+    if (GeometryCache_Get("boundaryfaces", cacheKey, facesPd) == SV_OK)
+      numRegionsArray = vtkIntArray::SafeDownCast(
+        facesPd->GetFieldData()->GetArray("NumberOfRegions"));
+    if (numRegionsArray != NULL && numRegionsArray->GetNumberOfTuples() == 1)
+    {
+      *numRegions = numRegionsArray->GetValue(0);
+      facesPd->GetFieldData()->RemoveArray("NumberOfRegions");
+
+      geom->SetPoints(facesPd->GetPoints());
+      geom->SetPolys(facesPd->GetPolys());
+      geom->SetLines(facesPd->GetLines());
+      geom->GetPointData()->PassData(facesPd->GetPointData());
+      geom->GetCellData()->PassData(facesPd->GetCellData());
+      geom->BuildLinks();
+
+      return SV_OK;
+    }
+  }
+
   //Create BoundarySurface Filter to get the boundaries
   vtkSmartPointer<vtkGetBoundaryFaces> boundFacs;
 
@@ -196,6 +229,18 @@ int PlyDtaUtils_GetBoundaryFaces( vtkPolyData *geom,double angle,int *numRegions
 
   *numRegions = boundFacs->GetNumberOfRegions();
 
+  if (GeometryCache_IsEnabled())
+  {
+    vtkSmartPointer<vtkIntArray> numRegionsArray =
+      vtkSmartPointer<vtkIntArray>::New();
+    numRegionsArray->SetName("NumberOfRegions");
+    numRegionsArray->InsertNextValue(*numRegions);
+
+    facesPd->ShallowCopy(boundFacs->GetOutput());
+    facesPd->GetFieldData()->AddArray(numRegionsArray);
+    GeometryCache_Put("boundaryfaces", cacheKey, facesPd);
+  }
+
   return SV_OK;
 
 }
@@ -65,13 +65,13 @@ cvDataObject::~cvDataObject()
 // GetMemoryUsage
 // --------------
 
-int cvDataObject::GetMemoryUsage()
+long long cvDataObject::GetMemoryUsage()
 {
-  int sz = 0;
+  long long sz = 0;
 
   sz += sizeof( this );
   if ( data_ != NULL ) {
-    sz += data_->GetActualMemorySize() * 1024;  // vtk returns kB
+    sz += (long long) data_->GetActualMemorySize() * 1024;  // vtk returns kB
   }
   return sz;
 }
@@ -45,7 +45,7 @@ public:
   virtual ~cvDataObject();
 
   vtkDataObject *GetVtkPtr() { return data_; };
-  virtual int GetMemoryUsage();
+  virtual long long GetMemoryUsage();
 
 protected:
   vtkDataObject *data_;
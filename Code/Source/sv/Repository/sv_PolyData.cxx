@@ -49,6 +49,7 @@ cvPolyData::cvPolyData()
   locator_ = NULL;
   genericCell_ = NULL;
   distMethod_ = PD_DIST_VTK;
+  locatorsMTime_ = 0;
 
 }
 
@@ -66,6 +67,7 @@ cvPolyData::cvPolyData( vtkPolyData *pd )
   locator_ = NULL;
   genericCell_ = NULL;
   distMethod_ = PD_DIST_VTK;
+  locatorsMTime_ = 0;
 
 }
 
@@ -83,6 +85,7 @@ cvPolyData::cvPolyData( cvPolyData *src )
   locator_ = NULL;
   genericCell_ = NULL;
   distMethod_ = PD_DIST_VTK;
+  locatorsMTime_ = 0;
 
 }
 
@@ -259,18 +262,9 @@ void cvPolyData::SetDistMethod( PolyData_DistanceT dt )
 
 int cvPolyData::BuildVtkCellLocator()
 {
+  locator_ = GetCellLocator( 0 );
   if ( locator_ == NULL ) {
-    locator_ = vtkCellLocator::New();
-    if ( locator_ == NULL ) {
-      return SV_ERROR;
-    }
-    locator_->DebugOff();
-    locator_->GlobalWarningDisplayOff();
-    locator_->SetDataSet( (vtkPolyData *) data_ );
-    locator_->AutomaticOn();
-    //  locator_->SetNumberOfCellsPerBucket( 5 );
-    locator_->Initialize();
-    locator_->BuildLocator();
+    return SV_ERROR;
   }
   if ( genericCell_ == NULL ) {
     genericCell_ = vtkGenericCell::New();
@@ -288,13 +282,101 @@ int cvPolyData::BuildVtkCellLocator()
 
 void cvPolyData::ClearVtkCellLocator()
 {
-  if ( locator_ != NULL ) {
-    locator_->Delete();
-    locator_ = NULL;
-  }
+  ClearLocators();
   if ( genericCell_ != NULL ) {
     genericCell_->Delete();
     genericCell_ = NULL;
   }
   return;
 }
+
+
+// --------------
+// GetCellLocator
+// --------------
+
+vtkCellLocator *cvPolyData::GetCellLocator( int slot )
+{
+  if ( slot < 0 ) {
+    return NULL;
+  }
+
+  // Any change to the poly data invalidates all of the locators
+  if ( data_->GetMTime() > locatorsMTime_ ) {
+    ClearLocators();
+  }
+  if ( slot >= (int)cellLocators_.size() ) {
+    cellLocators_.resize( slot + 1, NULL );
+  }
+
+  if ( cellLocators_[slot] == NULL ) {
+    vtkCellLocator *locator = vtkCellLocator::New();
+    locator->DebugOff();
+    locator->GlobalWarningDisplayOff();
+    locator->SetDataSet( (vtkPolyData *) data_ );
+    locator->AutomaticOn();
+    //  locator->SetNumberOfCellsPerBucket( 5 );
+    locator->Initialize();
+    locator->BuildLocator();
+    cellLocators_[slot] = locator;
+    locatorsMTime_ = data_->GetMTime();
+  }
+  return cellLocators_[slot];
+}
+
+
+// ----------
+// GetOBBTree
+// ----------
+
+vtkOBBTree *cvPolyData::GetOBBTree( int slot )
+{
+  if ( slot < 0 ) {
+    return NULL;
+  }
+
+  if ( data_->GetMTime() > locatorsMTime_ ) {
+    ClearLocators();
+  }
+  if ( slot >= (int)obbTrees_.size() ) {
+    obbTrees_.resize( slot + 1, NULL );
+  }
+
+  if ( obbTrees_[slot] == NULL ) {
+    // Line queries fetch cells through the data set itself, so each tree
+    // gets its own shallow copy to keep concurrent queries apart
+    vtkPolyData *pd = vtkPolyData::New();
+    pd->ShallowCopy( (vtkPolyData *) data_ );
+    vtkOBBTree *tree = vtkOBBTree::New();
+    tree->SetDataSet( pd );
+    tree->BuildLocator();
+    pd->Delete();
+    obbTrees_[slot] = tree;
+    locatorsMTime_ = data_->GetMTime();
+  }
+  return obbTrees_[slot];
+}
+
+
+// -------------
+// ClearLocators
+// -------------
+
+void cvPolyData::ClearLocators()
+{
+  for ( int i = 0; i < cellLocators_.size(); i++ ) {
+    if ( cellLocators_[i] != NULL ) {
+      cellLocators_[i]->Delete();
+    }
+  }
+  cellLocators_.clear();
+  for ( int i = 0; i < obbTrees_.size(); i++ ) {
+    if ( obbTrees_[i] != NULL ) {
+      obbTrees_[i]->Delete();
+    }
+  }
+  obbTrees_.clear();
+  locator_ = NULL;
+  locatorsMTime_ = 0;
+  return;
+}
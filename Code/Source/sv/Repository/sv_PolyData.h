@@ -36,6 +36,9 @@
 #include "svRepositoryExports.h" // For exports
 #include "sv_misc_utils.h"
 #include "sv_VTK.h"
+#include "vtkOBBTree.h"
+
+#include <vector>
 
 
 typedef enum {
@@ -64,6 +67,13 @@ public:
   void SetDistMethod( PolyData_DistanceT dt );
   PolyData_DistanceT GetDistMethod() { return distMethod_; }
 
+  // Cached spatial locators, built on first use and rebuilt once the poly
+  // data has been modified. Locator queries are not thread safe, so
+  // concurrent queries each use their own slot.
+  vtkCellLocator *GetCellLocator( int slot = 0 );
+  vtkOBBTree *GetOBBTree( int slot = 0 );
+  void ClearLocators();
+
 private:
   inline int InitDistance();
   PolyData_DistanceT distMethod_;
@@ -74,6 +84,10 @@ private:
   vtkCellLocator *locator_;
   vtkGenericCell *genericCell_;
 
+  std::vector<vtkCellLocator*> cellLocators_;
+  std::vector<vtkOBBTree*> obbTrees_;
+  vtkMTimeType locatorsMTime_;
+
 };
 
 
@@ -87,11 +101,7 @@ int cvPolyData::InitDistance()
   switch (distMethod_) {
 
   case PD_DIST_VTK:
-    if ( ( locator_ == NULL ) || ( genericCell_ == NULL ) ) {
-      return BuildVtkCellLocator();
-    } else {
-      return SV_OK;
-    }
+    return BuildVtkCellLocator();
     break;
 
   default:
@@ -33,23 +33,549 @@
 
 #include "sv_IOstream.h"
 
+// Before sv_Repository.h, which undefines the GetObject macro of windows.h
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "sv2_globals.h"
 #include "sv_Repository.h"
+#include "sv_PolyData.h"
+#include "sv_StrPts.h"
+#include "sv_UnstructuredGrid.h"
+
+#include "vtkBitArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkFieldData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkPointData.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+
+// --------
+// Snapshot
+// --------
+
+// Layout of a repository snapshot, all values in native byte order:
+//
+//   header:  magic "SVREPOS", int32 version, int32 byte order mark,
+//            int32 sizeof(vtkIdType), int64 number of objects
+//   object:  int32 RepositoryDataT, string name, int32 number of labels,
+//            string key/value pairs, then by type
+//              POLY_DATA_T:          points, verts, lines, polys, strips
+//              UNSTRUCTURED_GRID_T:  points, cell types, cell locations,
+//                                    cells, face locations, faces
+//              STRUCTURED_PTS_T:     int32 extent[6], double origin[3],
+//                                    double spacing[3]
+//            followed by the point data and the cell data
+//   string:  int32 length, characters
+//   array:   int32 present, string name, int32 vtk data type, int32 type
+//            size, int32 components, int64 tuples, padding to
+//            REPOS_SNAPSHOT_ALIGN, raw values
+//   cells:   int64 number of cells, array with the connectivity
+//   data:    int32 number of arrays, per array int32 attribute type (-1
+//            if none) and the array
+//
+// Array payloads are aligned in the file so they can be used in place
+// from a mapping of the file.  Objects spilled to disk by the memory
+// budget are written as an int32 RepositoryDataT and the data set
+// record of the object.
+
+#define REPOS_SNAPSHOT_MAGIC "SVREPOS"
+#define REPOS_SNAPSHOT_VERSION 1
+#define REPOS_SNAPSHOT_BOM 0x01020304
+#define REPOS_SNAPSHOT_ALIGN 64
+
+static void Repos_WriteBytes( std::ofstream &out, const void *data, size_t size )
+{
+  out.write( (const char *) data, size );
+}
+
+static void Repos_WriteInt( std::ofstream &out, int val )
+{
+  Repos_WriteBytes( out, &val, sizeof(int) );
+}
+
+static void Repos_WriteInt64( std::ofstream &out, long long val )
+{
+  Repos_WriteBytes( out, &val, sizeof(long long) );
+}
+
+static void Repos_WriteString( std::ofstream &out, const char *str )
+{
+  int len = ( str == NULL ) ? 0 : strlen( str );
+  Repos_WriteInt( out, len );
+  Repos_WriteBytes( out, str, len );
+}
+
+static void Repos_WritePadding( std::ofstream &out )
+{
+  static const char zeros[REPOS_SNAPSHOT_ALIGN] = {0};
+  long long pos = (long long) out.tellp();
+  int pad = ( REPOS_SNAPSHOT_ALIGN - pos % REPOS_SNAPSHOT_ALIGN ) % REPOS_SNAPSHOT_ALIGN;
+  Repos_WriteBytes( out, zeros, pad );
+}
+
+// Bit arrays are not byte addressable and are written as absent.
+static void Repos_WriteArray( std::ofstream &out, vtkDataArray *array )
+{
+  if ( array == NULL || vtkBitArray::SafeDownCast( array ) != NULL ) {
+    Repos_WriteInt( out, 0 );
+    return;
+  }
+
+  int typeSize = array->GetDataTypeSize();
+  long long numTuples = array->GetNumberOfTuples();
+  int numComps = array->GetNumberOfComponents();
+
+  Repos_WriteInt( out, 1 );
+  Repos_WriteString( out, array->GetName() );
+  Repos_WriteInt( out, array->GetDataType() );
+  Repos_WriteInt( out, typeSize );
+  Repos_WriteInt( out, numComps );
+  Repos_WriteInt64( out, numTuples );
+  Repos_WritePadding( out );
+  if ( numTuples > 0 ) {
+    Repos_WriteBytes( out, array->GetVoidPointer( 0 ),
+		      numTuples * numComps * typeSize );
+  }
+}
+
+static void Repos_WriteCells( std::ofstream &out, vtkCellArray *cells )
+{
+  if ( cells == NULL ) {
+    Repos_WriteInt64( out, 0 );
+    Repos_WriteArray( out, NULL );
+    return;
+  }
+  Repos_WriteInt64( out, cells->GetNumberOfCells() );
+  Repos_WriteArray( out, cells->GetData() );
+}
+
+static void Repos_WriteAttributes( std::ofstream &out, vtkDataSetAttributes *attributes )
+{
+  std::vector<int> arrays;
+  for ( int i = 0; i < attributes->GetNumberOfArrays(); i++ ) {
+    vtkDataArray *array = attributes->GetArray( i );
+    if ( array != NULL && vtkBitArray::SafeDownCast( array ) == NULL ) {
+      arrays.push_back( i );
+    }
+  }
+
+  Repos_WriteInt( out, arrays.size() );
+  for ( int i = 0; i < arrays.size(); i++ ) {
+    Repos_WriteInt( out, attributes->IsArrayAnAttribute( arrays[i] ) );
+    Repos_WriteArray( out, attributes->GetArray( arrays[i] ) );
+  }
+}
+
+static int Repos_IsDataSetType( RepositoryDataT type )
+{
+  return ( type == POLY_DATA_T || type == STRUCTURED_PTS_T ||
+	   type == UNSTRUCTURED_GRID_T );
+}
+
+// The spill record only holds numeric point and cell data arrays, so
+// data sets with anything else stay in memory.
+static int Repos_CanSpillAttributes( vtkDataSetAttributes *attributes )
+{
+  for ( int i = 0; i < attributes->GetNumberOfArrays(); i++ ) {
+    vtkDataArray *array = attributes->GetArray( i );
+    if ( array == NULL || vtkBitArray::SafeDownCast( array ) != NULL ) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static int Repos_CanSpill( vtkDataSet *ds )
+{
+  if ( ds == NULL ) {
+    return 0;
+  }
+  if ( ds->GetFieldData() != NULL &&
+       ds->GetFieldData()->GetNumberOfArrays() > 0 ) {
+    return 0;
+  }
+  return Repos_CanSpillAttributes( ds->GetPointData() ) &&
+    Repos_CanSpillAttributes( ds->GetCellData() );
+}
+
+static void Repos_WriteDataSet( std::ofstream &out, RepositoryDataT type, vtkDataSet *ds )
+{
+  switch ( type ) {
+  case POLY_DATA_T: {
+    vtkPolyData *pd = (vtkPolyData *) ds;
+    Repos_WriteArray( out, pd->GetPoints() ? pd->GetPoints()->GetData() : NULL );
+    Repos_WriteCells( out, pd->GetVerts() );
+    Repos_WriteCells( out, pd->GetLines() );
+    Repos_WriteCells( out, pd->GetPolys() );
+    Repos_WriteCells( out, pd->GetStrips() );
+    break;
+  }
+  case UNSTRUCTURED_GRID_T: {
+    vtkUnstructuredGrid *ug = (vtkUnstructuredGrid *) ds;
+    Repos_WriteArray( out, ug->GetPoints() ? ug->GetPoints()->GetData() : NULL );
+    Repos_WriteArray( out, ug->GetCellTypesArray() );
+    Repos_WriteArray( out, ug->GetCellLocationsArray() );
+    Repos_WriteCells( out, ug->GetCells() );
+    Repos_WriteArray( out, ug->GetFaceLocations() );
+    Repos_WriteArray( out, ug->GetFaces() );
+    break;
+  }
+  case STRUCTURED_PTS_T: {
+    vtkStructuredPoints *sp = (vtkStructuredPoints *) ds;
+    Repos_WriteBytes( out, sp->GetExtent(), 6 * sizeof(int) );
+    Repos_WriteBytes( out, sp->GetOrigin(), 3 * sizeof(double) );
+    Repos_WriteBytes( out, sp->GetSpacing(), 3 * sizeof(double) );
+    break;
+  }
+  default:
+    break;
+  }
+
+  Repos_WriteAttributes( out, ds->GetPointData() );
+  Repos_WriteAttributes( out, ds->GetCellData() );
+}
+
+// Reads from a snapshot in memory.  Any read past the end clears ok_.
+class cvReposSnapshotReader {
+
+public:
+  cvReposSnapshotReader( char *data, size_t size )
+    : data_( data ), size_( size ), pos_( 0 ), ok_( 1 ) {}
+
+  int IsOk() { return ok_; }
+
+  char *ReadBytes( size_t size ) {
+    if ( !ok_ || size > size_ - pos_ ) {
+      ok_ = 0;
+      return NULL;
+    }
+    char *ptr = data_ + pos_;
+    pos_ += size;
+    return ptr;
+  }
+
+  int ReadInt() {
+    int val = 0;
+    char *ptr = ReadBytes( sizeof(int) );
+    if ( ptr != NULL ) {
+      memcpy( &val, ptr, sizeof(int) );
+    }
+    return val;
+  }
+
+  long long ReadInt64() {
+    long long val = 0;
+    char *ptr = ReadBytes( sizeof(long long) );
+    if ( ptr != NULL ) {
+      memcpy( &val, ptr, sizeof(long long) );
+    }
+    return val;
+  }
+
+  std::string ReadString() {
+    int len = ReadInt();
+    if ( len < 0 ) {
+      ok_ = 0;
+      return "";
+    }
+    char *ptr = ReadBytes( len );
+    return ( ptr == NULL ) ? "" : std::string( ptr, len );
+  }
+
+  void SkipPadding() {
+    size_t pad = ( REPOS_SNAPSHOT_ALIGN - pos_ % REPOS_SNAPSHOT_ALIGN ) % REPOS_SNAPSHOT_ALIGN;
+    ReadBytes( pad );
+  }
+
+  // Returns a new array whose values point into the snapshot, or NULL
+  // if the array is absent or invalid.
+  vtkDataArray *ReadArray() {
+    if ( ReadInt() == 0 ) {
+      return NULL;
+    }
+    std::string name = ReadString();
+    int dataType = ReadInt();
+    int typeSize = ReadInt();
+    int numComps = ReadInt();
+    long long numTuples = ReadInt64();
+    SkipPadding();
+    if ( !ok_ || numComps < 1 || numTuples < 0 ) {
+      ok_ = 0;
+      return NULL;
+    }
+
+    vtkDataArray *array = vtkDataArray::CreateDataArray( dataType );
+    if ( array == NULL || array->GetDataTypeSize() != typeSize ||
+	 vtkBitArray::SafeDownCast( array ) != NULL ) {
+      fprintf( stderr, "snapshot array %s has unsupported type %d\n",
+	       name.c_str(), dataType );
+      if ( array != NULL ) {
+	array->Delete();
+      }
+      ok_ = 0;
+      return NULL;
+    }
+
+    char *values = ReadBytes( (size_t) numTuples * numComps * typeSize );
+    if ( !ok_ ) {
+      array->Delete();
+      return NULL;
+    }
+    array->SetNumberOfComponents( numComps );
+    if ( name.length() > 0 ) {
+      array->SetName( name.c_str() );
+    }
+    if ( numTuples > 0 ) {
+      // save=1, the mapping owns the memory
+      array->SetVoidArray( values, numTuples * numComps, 1 );
+    }
+    return array;
+  }
+
+  vtkCellArray *ReadCells() {
+    long long numCells = ReadInt64();
+    vtkDataArray *data = ReadArray();
+    if ( data == NULL ) {
+      return NULL;
+    }
+    vtkIdTypeArray *ids = vtkIdTypeArray::SafeDownCast( data );
+    if ( ids == NULL ) {
+      data->Delete();
+      ok_ = 0;
+      return NULL;
+    }
+    vtkCellArray *cells = vtkCellArray::New();
+    cells->SetCells( numCells, ids );
+    ids->Delete();
+    return cells;
+  }
+
+  void ReadAttributes( vtkDataSetAttributes *attributes ) {
+    int numArrays = ReadInt();
+    for ( int i = 0; ok_ && i < numArrays; i++ ) {
+      int attributeType = ReadInt();
+      vtkDataArray *array = ReadArray();
+      if ( array == NULL ) {
+	continue;
+      }
+      attributes->AddArray( array );
+      if ( attributeType >= 0 && array->GetName() != NULL ) {
+	attributes->SetActiveAttribute( array->GetName(), attributeType );
+      }
+      array->Delete();
+    }
+  }
+
+  // Returns a new data set of the given type, or NULL on error.  Its
+  // arrays point into the snapshot.
+  vtkDataSet *ReadDataSet( RepositoryDataT type ) {
+    vtkDataSet *ds = NULL;
+    switch ( type ) {
+    case POLY_DATA_T: {
+      vtkPolyData *pd = vtkPolyData::New();
+      vtkDataArray *pts = ReadArray();
+      if ( pts != NULL ) {
+	vtkPoints *points = vtkPoints::New();
+	points->SetData( pts );
+	pd->SetPoints( points );
+	points->Delete();
+	pts->Delete();
+      }
+      vtkCellArray *cells[4];
+      for ( int j = 0; j < 4; j++ ) {
+	cells[j] = ReadCells();
+      }
+      if ( cells[0] != NULL ) pd->SetVerts( cells[0] );
+      if ( cells[1] != NULL ) pd->SetLines( cells[1] );
+      if ( cells[2] != NULL ) pd->SetPolys( cells[2] );
+      if ( cells[3] != NULL ) pd->SetStrips( cells[3] );
+      for ( int j = 0; j < 4; j++ ) {
+	if ( cells[j] != NULL ) cells[j]->Delete();
+      }
+      ds = pd;
+      break;
+    }
+    case UNSTRUCTURED_GRID_T: {
+      vtkUnstructuredGrid *ug = vtkUnstructuredGrid::New();
+      vtkDataArray *pts = ReadArray();
+      if ( pts != NULL ) {
+	vtkPoints *points = vtkPoints::New();
+	points->SetData( pts );
+	ug->SetPoints( points );
+	points->Delete();
+	pts->Delete();
+      }
+      vtkDataArray *types = ReadArray();
+      vtkDataArray *locations = ReadArray();
+      vtkCellArray *cells = ReadCells();
+      vtkDataArray *faceLocations = ReadArray();
+      vtkDataArray *faces = ReadArray();
+      if ( vtkUnsignedCharArray::SafeDownCast( types ) != NULL &&
+	   vtkIdTypeArray::SafeDownCast( locations ) != NULL && cells != NULL ) {
+	ug->SetCells( vtkUnsignedCharArray::SafeDownCast( types ),
+		      vtkIdTypeArray::SafeDownCast( locations ), cells,
+		      vtkIdTypeArray::SafeDownCast( faceLocations ),
+		      vtkIdTypeArray::SafeDownCast( faces ) );
+      }
+      if ( types != NULL ) types->Delete();
+      if ( locations != NULL ) locations->Delete();
+      if ( cells != NULL ) cells->Delete();
+      if ( faceLocations != NULL ) faceLocations->Delete();
+      if ( faces != NULL ) faces->Delete();
+      ds = ug;
+      break;
+    }
+    case STRUCTURED_PTS_T: {
+      vtkStructuredPoints *sp = vtkStructuredPoints::New();
+      int extent[6];
+      double origin[3], spacing[3];
+      char *ptr = ReadBytes( 6 * sizeof(int) + 6 * sizeof(double) );
+      if ( ptr != NULL ) {
+	memcpy( extent, ptr, 6 * sizeof(int) );
+	memcpy( origin, ptr + 6 * sizeof(int), 3 * sizeof(double) );
+	memcpy( spacing, ptr + 6 * sizeof(int) + 3 * sizeof(double), 3 * sizeof(double) );
+	sp->SetExtent( extent );
+	sp->SetOrigin( origin );
+	sp->SetSpacing( spacing );
+      }
+      ds = sp;
+      break;
+    }
+    default:
+      fprintf( stderr, "repository load: unknown object type %d\n", type );
+      ok_ = 0;
+      return NULL;
+    }
+
+    ReadAttributes( ds->GetPointData() );
+    ReadAttributes( ds->GetCellData() );
+    if ( !ok_ ) {
+      ds->Delete();
+      return NULL;
+    }
+    return ds;
+  }
+
+private:
+  char *data_;
+  size_t size_;
+  size_t pos_;
+  int ok_;
+
+};
+
+// A snapshot file mapped copy-on-write, so restored arrays can be
+// modified without touching the file.
+
+struct cvReposMappedFile {
+  char *data;
+  size_t size;
+#ifdef WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+};
+
+static cvReposMappedFile *Repos_MapFile( char *filename )
+{
+  cvReposMappedFile *mapped = new cvReposMappedFile;
+  mapped->data = NULL;
+  mapped->size = 0;
+
+#ifdef WIN32
+  mapped->file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+			     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+  if ( mapped->file == INVALID_HANDLE_VALUE ) {
+    delete mapped;
+    return NULL;
+  }
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx( mapped->file, &fileSize );
+  mapped->size = (size_t) fileSize.QuadPart;
+  mapped->mapping = CreateFileMappingA( mapped->file, NULL, PAGE_WRITECOPY,
+				       0, 0, NULL );
+  if ( mapped->mapping != NULL ) {
+    mapped->data = (char *) MapViewOfFile( mapped->mapping, FILE_MAP_COPY,
+					   0, 0, 0 );
+  }
+  if ( mapped->data == NULL ) {
+    if ( mapped->mapping != NULL ) {
+      CloseHandle( mapped->mapping );
+    }
+    CloseHandle( mapped->file );
+    delete mapped;
+    return NULL;
+  }
+#else
+  int fd = open( filename, O_RDONLY );
+  if ( fd < 0 ) {
+    delete mapped;
+    return NULL;
+  }
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+    close( fd );
+    delete mapped;
+    return NULL;
+  }
+  mapped->size = st.st_size;
+  void *data = mmap( NULL, mapped->size, PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if ( data == MAP_FAILED ) {
+    delete mapped;
+    return NULL;
+  }
+  mapped->data = (char *) data;
+#endif
+
+  return mapped;
+}
+
+static void Repos_UnmapFile( cvReposMappedFile *mapped )
+{
+#ifdef WIN32
+  UnmapViewOfFile( mapped->data );
+  CloseHandle( mapped->mapping );
+  CloseHandle( mapped->file );
+#else
+  munmap( mapped->data, mapped->size );
+#endif
+  delete mapped;
+}
+
 
 // ----------
 // cvRepository
 // ----------
 
-// The cvRepository constructor should simply initialize the hash table
-// to be used to store name/ptr associations.  The generic Tcl hash
-// table package is used for this purpose.  The string keys to be used
+// The cvRepository constructor should simply initialize the table to
+// be used to store name/ptr associations.  The string keys to be used
 // to look up entries in this table are the object names which will be
 // indicated by clients when they add or query objects.
 
 cvRepository::cvRepository()
 {
-  Tcl_InitHashTable( &table_, TCL_STRING_KEYS );
   iterValid_ = 0;
+  iterPos_ = 0;
+  useCount_ = 0;
+  memoryBudget_ = 0;
+  spillMinSize_ = 0;
+  spillCount_ = 0;
 }
 
 
@@ -59,7 +585,15 @@ cvRepository::cvRepository()
 
 cvRepository::~cvRepository()
 {
-  Tcl_DeleteHashTable( &table_ );
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    if ( !it->second.spillFile.empty() ) {
+      remove( it->second.spillFile.c_str() );
+    }
+  }
+  for ( int i = 0; i < mappedFiles_.size(); i++ ) {
+    Repos_UnmapFile( mappedFiles_[i] );
+  }
 }
 
 
@@ -77,7 +611,7 @@ cvRepository::~cvRepository()
 // type), while at the same time allowing the repository to store
 // objects of multiple different derived types.
 
-// The Register method allocates a new hash table entry for the given
+// The Register method allocates a new table entry for the given
 // object.  Once an object is registered with the repository, the
 // repository assumes memory management responsibility.  Clients
 // should Delete vtk objects created as part of the process of
@@ -88,7 +622,7 @@ cvRepository::~cvRepository()
 //                repository->Register( pgn, "/this/is/a/test" );
 //                pgn->Delete();
 
-// Invalidate iterator if hash table changes.
+// Invalidate iterator if the table changes.
 
 // KCW [3/19/99]
 // ---
@@ -102,18 +636,17 @@ cvRepository::~cvRepository()
 
 int cvRepository::Register( char *name, cvRepositoryData *obj )
 {
-  Tcl_HashEntry *entryPtr;
-  int newEntry;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  entryPtr = Tcl_CreateHashEntry( &table_, name, &newEntry );
-  if ( !newEntry ) {
+  cvReposEntry entry;
+  entry.obj = obj;
+  entry.lastUse = ++useCount_;
+  if ( !table_.insert( std::make_pair( std::string( name ), entry ) ).second ) {
     return SV_ERROR;
-  } else {
-    Tcl_SetHashValue( entryPtr, obj );
-    obj->SetName( name );
-    iterValid_ = 0;
-    return SV_OK;
   }
+  obj->SetName( name );
+  iterValid_ = 0;
+  return SV_OK;
 }
 
 
@@ -121,26 +654,27 @@ int cvRepository::Register( char *name, cvRepositoryData *obj )
 // UnRegister
 // ----------
 
-// Invalidate iterator if hash table changes.
+// Invalidate iterator if the table changes.
 
 int cvRepository::UnRegister( char *name )
 {
-  Tcl_HashEntry *entryPtr;
-  cvRepositoryData *obj;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  entryPtr = Tcl_FindHashEntry( &table_, name );
-  if ( entryPtr == NULL ) {
+  std::unordered_map<std::string,cvReposEntry>::iterator it = table_.find( name );
+  if ( it == table_.end() ) {
     return SV_ERROR;
-  } else {
-    obj = (cvRepositoryData *) Tcl_GetHashValue( entryPtr );
-    if ( obj->NumLocks() > 0 ) {
-      return SV_ERROR;
-    }
-    Tcl_DeleteHashEntry( entryPtr );
-    delete obj;
-    iterValid_ = 0;
-    return SV_OK;
   }
+  cvRepositoryData *obj = it->second.obj;
+  if ( obj->NumLocks() > 0 ) {
+    return SV_ERROR;
+  }
+  if ( !it->second.spillFile.empty() ) {
+    remove( it->second.spillFile.c_str() );
+  }
+  table_.erase( it );
+  delete obj;
+  iterValid_ = 0;
+  return SV_OK;
 }
 
 
@@ -150,10 +684,9 @@ int cvRepository::UnRegister( char *name )
 
 int cvRepository::Exists( char *name )
 {
-  Tcl_HashEntry *entryPtr;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  entryPtr = Tcl_FindHashEntry( &table_, name );
-  if ( entryPtr == NULL ) {
+  if ( table_.find( name ) == table_.end() ) {
     return SV_ERROR;
   } else {
     return SV_OK;
@@ -165,15 +698,17 @@ int cvRepository::Exists( char *name )
 // GetType
 // -------
 
+// Does not restore spilled objects.
+
 RepositoryDataT cvRepository::GetType( CONST84 char *name )
 {
-  cvRepositoryData *obj;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  obj = this->GetObject( name );
-  if ( obj == NULL ) {
+  std::unordered_map<std::string,cvReposEntry>::iterator it = table_.find( name );
+  if ( it == table_.end() ) {
     return OBJ_NOT_FOUND_T;
   } else {
-    return obj->GetType();
+    return it->second.obj->GetType();
   }
 }
 
@@ -182,18 +717,23 @@ RepositoryDataT cvRepository::GetType( CONST84 char *name )
 // GetObject
 // ---------
 
+// Restores the object first if it was spilled to disk.
+
 cvRepositoryData *cvRepository::GetObject( CONST84 char *name )
 {
-  Tcl_HashEntry *entryPtr;
-  cvRepositoryData *obj;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  entryPtr = Tcl_FindHashEntry( &table_, name );
-  if ( entryPtr == NULL ) {
+  std::unordered_map<std::string,cvReposEntry>::iterator it = table_.find( name );
+  if ( it == table_.end() ) {
     return NULL;
-  } else {
-    obj = (cvRepositoryData *) Tcl_GetHashValue( entryPtr );
-    return obj;
   }
+  if ( !it->second.spillFile.empty() ) {
+    if ( this->RestoreObject( it->second ) != SV_OK ) {
+      return NULL;
+    }
+  }
+  it->second.lastUse = ++useCount_;
+  return it->second.obj;
 }
 
 
@@ -201,10 +741,90 @@ cvRepositoryData *cvRepository::GetObject( CONST84 char *name )
 // Save
 // ----
 
+// Objects that are not VTK data sets (solid models, meshes, paths,
+// ...) have no generic representation and are skipped with a warning.
+// Spilled objects are copied from their scratch files.
+
 int cvRepository::Save( char *filename )
 {
-  cout << "cvRepository::Save not yet implemented." << endl;
-  return SV_ERROR;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  std::vector<cvReposEntry*> entries;
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    cvRepositoryData *obj = it->second.obj;
+    if ( Repos_IsDataSetType( obj->GetType() ) ) {
+      entries.push_back( &it->second );
+    } else {
+      char *typeStr = RepositoryDataT_EnumToStr( obj->GetType() );
+      fprintf( stderr, "repository save: skipping %s object %s\n",
+	       typeStr, obj->GetName() );
+      delete [] typeStr;
+    }
+  }
+
+  std::ofstream out( filename, std::ios::out | std::ios::binary );
+  if ( !out.is_open() ) {
+    fprintf( stderr, "repository save: could not open %s\n", filename );
+    return SV_ERROR;
+  }
+
+  Repos_WriteBytes( out, REPOS_SNAPSHOT_MAGIC, sizeof(REPOS_SNAPSHOT_MAGIC) );
+  Repos_WriteInt( out, REPOS_SNAPSHOT_VERSION );
+  Repos_WriteInt( out, REPOS_SNAPSHOT_BOM );
+  Repos_WriteInt( out, sizeof(vtkIdType) );
+  Repos_WriteInt64( out, entries.size() );
+
+  for ( int i = 0; i < entries.size(); i++ ) {
+    cvRepositoryData *obj = entries[i]->obj;
+    Repos_WriteInt( out, obj->GetType() );
+    Repos_WriteString( out, obj->GetName() );
+
+    int numKeys;
+    char **keys;
+    obj->GetLabelKeys( &numKeys, &keys );
+    Repos_WriteInt( out, numKeys );
+    for ( int j = 0; j < numKeys; j++ ) {
+      char *value;
+      obj->GetLabel( keys[j], &value );
+      Repos_WriteString( out, keys[j] );
+      Repos_WriteString( out, value );
+    }
+    delete [] keys;
+
+    if ( entries[i]->spillFile.empty() ) {
+      vtkDataSet *ds = vtkDataSet::SafeDownCast( ((cvDataObject *) obj)->GetVtkPtr() );
+      Repos_WriteDataSet( out, obj->GetType(), ds );
+    } else {
+      vtkDataSet *ds = NULL;
+      cvReposMappedFile *mapped = Repos_MapFile( (char *) entries[i]->spillFile.c_str() );
+      if ( mapped != NULL ) {
+	cvReposSnapshotReader reader( mapped->data, mapped->size );
+	if ( reader.ReadInt() == obj->GetType() ) {
+	  ds = reader.ReadDataSet( obj->GetType() );
+	}
+      }
+      if ( ds == NULL ) {
+	fprintf( stderr, "repository save: could not read spilled object %s\n",
+		 obj->GetName() );
+	if ( mapped != NULL ) {
+	  Repos_UnmapFile( mapped );
+	}
+	return SV_ERROR;
+      }
+      Repos_WriteDataSet( out, obj->GetType(), ds );
+      ds->Delete();
+      Repos_UnmapFile( mapped );
+    }
+  }
+
+  out.close();
+  if ( out.fail() ) {
+    fprintf( stderr, "repository save: error writing %s\n", filename );
+    return SV_ERROR;
+  }
+
+  return SV_OK;
 }
 
 
@@ -218,14 +838,96 @@ int cvRepository::Save( char *filename )
 // Load for any cvRepository except an empty one (i.e. one for which
 // GetNumObjects returns 0).
 
+// Objects are only registered once the whole snapshot has been read,
+// so a truncated or corrupt file leaves the repository empty.
+
 int cvRepository::Load( char *filename )
 {
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
   if ( ( this->GetNumObjects() ) != 0 ) {
+    fprintf( stderr, "repository load: repository is not empty\n" );
+    return SV_ERROR;
+  }
+
+  cvReposMappedFile *mapped = Repos_MapFile( filename );
+  if ( mapped == NULL ) {
+    fprintf( stderr, "repository load: could not map %s\n", filename );
     return SV_ERROR;
   }
 
-  cout << "cvRepository::Load not yet implemented." << endl;
-  return SV_ERROR;
+  cvReposSnapshotReader reader( mapped->data, mapped->size );
+  char *magic = reader.ReadBytes( sizeof(REPOS_SNAPSHOT_MAGIC) );
+  int version = reader.ReadInt();
+  int bom = reader.ReadInt();
+  int idSize = reader.ReadInt();
+  long long numObjs = reader.ReadInt64();
+  if ( !reader.IsOk() ||
+       memcmp( magic, REPOS_SNAPSHOT_MAGIC, sizeof(REPOS_SNAPSHOT_MAGIC) ) != 0 ) {
+    fprintf( stderr, "repository load: %s is not a repository snapshot\n", filename );
+    Repos_UnmapFile( mapped );
+    return SV_ERROR;
+  }
+  if ( version != REPOS_SNAPSHOT_VERSION || bom != REPOS_SNAPSHOT_BOM ||
+       idSize != sizeof(vtkIdType) ) {
+    fprintf( stderr, "repository load: snapshot version %d is not supported\n", version );
+    Repos_UnmapFile( mapped );
+    return SV_ERROR;
+  }
+
+  std::vector<cvRepositoryData*> objs;
+  std::vector<std::string> names;
+  for ( long long i = 0; reader.IsOk() && i < numObjs; i++ ) {
+    RepositoryDataT type = (RepositoryDataT) reader.ReadInt();
+    std::string name = reader.ReadString();
+
+    int numLabels = reader.ReadInt();
+    std::vector<std::string> labels;
+    for ( int j = 0; reader.IsOk() && j < numLabels; j++ ) {
+      labels.push_back( reader.ReadString() );
+      labels.push_back( reader.ReadString() );
+    }
+
+    vtkDataSet *ds = reader.ReadDataSet( type );
+    if ( ds == NULL ) {
+      break;
+    }
+
+    cvRepositoryData *obj = NULL;
+    if ( type == POLY_DATA_T ) {
+      obj = new cvPolyData( (vtkPolyData *) ds );
+    } else if ( type == UNSTRUCTURED_GRID_T ) {
+      obj = new cvUnstructuredGrid( (vtkUnstructuredGrid *) ds );
+    } else {
+      obj = new cvStrPts( (vtkStructuredPoints *) ds );
+    }
+    ds->Delete();
+
+    for ( int j = 0; j + 1 < labels.size(); j += 2 ) {
+      obj->SetLabel( (char *) labels[j].c_str(), (char *) labels[j+1].c_str() );
+    }
+    objs.push_back( obj );
+    names.push_back( name );
+  }
+
+  if ( !reader.IsOk() || objs.size() != numObjs ) {
+    fprintf( stderr, "repository load: %s is truncated or corrupt\n", filename );
+    for ( int i = 0; i < objs.size(); i++ ) {
+      delete objs[i];
+    }
+    Repos_UnmapFile( mapped );
+    return SV_ERROR;
+  }
+
+  for ( int i = 0; i < objs.size(); i++ ) {
+    if ( this->Register( (char *) names[i].c_str(), objs[i] ) != SV_OK ) {
+      fprintf( stderr, "repository load: duplicate object %s\n", names[i].c_str() );
+      delete objs[i];
+    }
+  }
+  mappedFiles_.push_back( mapped );
+
+  return SV_OK;
 }
 
 
@@ -233,19 +935,11 @@ int cvRepository::Load( char *filename )
 // GetNumObjects
 // -------------
 
-// Need to figure out the format of the string returned by
-// Tcl_HashStats so we can parse it for total number of hash table
-// entries.
-
 int cvRepository::GetNumObjects()
 {
-  CONST84 char *stats;
-
-  stats = Tcl_HashStats( &table_ );
-  cout << stats << endl;
-  delete stats;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  return -1;
+  return table_.size();
 }
 
 
@@ -253,14 +947,21 @@ int cvRepository::GetNumObjects()
 // InitIterator
 // ------------
 
-// Calls Tcl_FirstHashEntry to start a search.  Due to the semantics
-// of the Tcl hash table search functions, the iterator position
-// (i.e. currEntryPtr_) always points to the entry which contains the
-// next name to be returned (as opposed to the last one returned).
+// Takes a copy of the object names.  The iterator position
+// (i.e. iterPos_) always points to the name to be returned next (as
+// opposed to the last one returned).
 
 void cvRepository::InitIterator()
 {
-  currEntryPtr_ = Tcl_FirstHashEntry( &table_, &search_ );
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  iterNames_.clear();
+  iterNames_.reserve( table_.size() );
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    iterNames_.push_back( it->first );
+  }
+  iterPos_ = 0;
   iterValid_ = 1;
 }
 
@@ -271,13 +972,228 @@ void cvRepository::InitIterator()
 
 char *cvRepository::GetNextName()
 {
-  char *key;
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
 
-  if ( currEntryPtr_ == NULL ) {
+  if ( !iterValid_ || iterPos_ >= iterNames_.size() ) {
     return NULL;
   } else {
-    key = (char*)(Tcl_GetHashKey( &table_, currEntryPtr_ ));
-    currEntryPtr_ = Tcl_NextHashEntry( &search_ );
-    return key;
+    return (char *) iterNames_[iterPos_++].c_str();
+  }
+}
+
+
+// --------------
+// GetMemoryUsage
+// --------------
+
+// Sum of cvRepositoryData::GetMemoryUsage over the registered objects,
+// in bytes.  Spilled objects only count their empty VTK containers.
+
+long long cvRepository::GetMemoryUsage()
+{
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  long long total = 0;
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    total += it->second.obj->GetMemoryUsage();
+  }
+  return total;
+}
+
+long long cvRepository::GetMemoryUsage( RepositoryDataT type )
+{
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  long long total = 0;
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    if ( it->second.obj->GetType() == type ) {
+      total += it->second.obj->GetMemoryUsage();
+    }
+  }
+  return total;
+}
+
+
+// ---------------
+// SetMemoryBudget
+// ---------------
+
+int cvRepository::SetMemoryBudget( long long budget, long long minSize, char *scratchDir )
+{
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  if ( budget < 0 || minSize < 0 ) {
+    return SV_ERROR;
+  }
+  if ( budget > 0 && ( scratchDir == NULL || strlen( scratchDir ) == 0 ) ) {
+    fprintf( stderr, "repository: a scratch directory is needed to spill objects\n" );
+    return SV_ERROR;
+  }
+
+  memoryBudget_ = budget;
+  spillMinSize_ = minSize;
+  scratchDir_ = ( scratchDir == NULL ) ? "" : scratchDir;
+  if ( memoryBudget_ > 0 ) {
+    this->EnforceMemoryBudget();
+  }
+  return SV_OK;
+}
+
+
+// ----------
+// TrimMemory
+// ----------
+
+int cvRepository::TrimMemory()
+{
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  if ( memoryBudget_ > 0 ) {
+    this->EnforceMemoryBudget();
   }
+  return SV_OK;
+}
+
+
+// --------------
+// GetNumSpilled
+// --------------
+
+int cvRepository::GetNumSpilled()
+{
+  std::lock_guard<std::recursive_mutex> lock( mutex_ );
+
+  int numSpilled = 0;
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    if ( !it->second.spillFile.empty() ) {
+      numSpilled++;
+    }
+  }
+  return numSpilled;
+}
+
+
+// -------------------
+// EnforceMemoryBudget
+// -------------------
+
+// Spills the least recently used data sets until the resident objects
+// fit in the budget.  Locked objects, objects smaller than
+// spillMinSize_ and objects that cannot be spilled losslessly are
+// never spilled.
+
+void cvRepository::EnforceMemoryBudget()
+{
+  long long total = 0;
+  std::vector<std::pair<unsigned long long,cvReposEntry*> > candidates;
+  std::unordered_map<std::string,cvReposEntry>::iterator it;
+  for ( it = table_.begin(); it != table_.end(); ++it ) {
+    cvReposEntry &entry = it->second;
+    long long usage = entry.obj->GetMemoryUsage();
+    total += usage;
+    if ( entry.spillFile.empty() &&
+	 entry.obj->NumLocks() == 0 && usage >= spillMinSize_ &&
+	 Repos_IsDataSetType( entry.obj->GetType() ) &&
+	 Repos_CanSpill( vtkDataSet::SafeDownCast( ((cvDataObject *) entry.obj)->GetVtkPtr() ) ) ) {
+      candidates.push_back( std::make_pair( entry.lastUse, &entry ) );
+    }
+  }
+  if ( total <= memoryBudget_ ) {
+    return;
+  }
+
+  std::sort( candidates.begin(), candidates.end() );
+  for ( int i = 0; i < candidates.size() && total > memoryBudget_; i++ ) {
+    cvReposEntry &entry = *candidates[i].second;
+    long long usage = entry.obj->GetMemoryUsage();
+    if ( this->SpillObject( entry ) == SV_OK ) {
+      total -= usage - entry.obj->GetMemoryUsage();
+    }
+  }
+}
+
+
+// -----------
+// SpillObject
+// -----------
+
+int cvRepository::SpillObject( cvReposEntry &entry )
+{
+  cvRepositoryData *obj = entry.obj;
+  vtkDataSet *ds = vtkDataSet::SafeDownCast( ((cvDataObject *) obj)->GetVtkPtr() );
+  if ( ds == NULL ) {
+    return SV_ERROR;
+  }
+
+  char filename[2048];
+#ifdef WIN32
+  int pid = GetCurrentProcessId();
+#else
+  int pid = getpid();
+#endif
+  snprintf( filename, sizeof(filename), "%s/sv_repository_%d_%d.bin",
+	    scratchDir_.c_str(), pid, ++spillCount_ );
+
+  std::ofstream out( filename, std::ios::out | std::ios::binary );
+  if ( !out.is_open() ) {
+    fprintf( stderr, "repository: could not open scratch file %s\n", filename );
+    return SV_ERROR;
+  }
+  Repos_WriteInt( out, obj->GetType() );
+  Repos_WriteDataSet( out, obj->GetType(), ds );
+  out.close();
+  if ( out.fail() ) {
+    fprintf( stderr, "repository: error writing scratch file %s\n", filename );
+    remove( filename );
+    return SV_ERROR;
+  }
+
+  ds->Initialize();
+  entry.spillFile = filename;
+  return SV_OK;
+}
+
+
+// -------------
+// RestoreObject
+// -------------
+
+int cvRepository::RestoreObject( cvReposEntry &entry )
+{
+  cvRepositoryData *obj = entry.obj;
+  vtkDataSet *ds = vtkDataSet::SafeDownCast( ((cvDataObject *) obj)->GetVtkPtr() );
+
+  cvReposMappedFile *mapped = Repos_MapFile( (char *) entry.spillFile.c_str() );
+  if ( ds == NULL || mapped == NULL ) {
+    fprintf( stderr, "repository: could not restore %s from %s\n",
+	     obj->GetName(), entry.spillFile.c_str() );
+    if ( mapped != NULL ) {
+      Repos_UnmapFile( mapped );
+    }
+    return SV_ERROR;
+  }
+
+  cvReposSnapshotReader reader( mapped->data, mapped->size );
+  vtkDataSet *spilled = NULL;
+  if ( reader.ReadInt() == obj->GetType() ) {
+    spilled = reader.ReadDataSet( obj->GetType() );
+  }
+  if ( spilled == NULL ) {
+    fprintf( stderr, "repository: scratch file %s is corrupt\n",
+	     entry.spillFile.c_str() );
+    Repos_UnmapFile( mapped );
+    return SV_ERROR;
+  }
+
+  // Deep copy, the mapping is released with the scratch file
+  ds->DeepCopy( spilled );
+  spilled->Delete();
+  Repos_UnmapFile( mapped );
+
+  remove( entry.spillFile.c_str() );
+  entry.spillFile.clear();
+  return SV_OK;
 }
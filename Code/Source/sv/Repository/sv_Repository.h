@@ -63,21 +63,28 @@
 // should NEVER delete those objects.  cvRepository assumes memory
 // management responsibility for any object once it is registered.
 
-// As far as the object name iterator is concerned, we will follow the
-// rules set by the Tcl hash table package, which is what we're using
-// to implement this table.  Those rules state that it is not safe to
-// make changes to a table when a search (i.e. iterator) is active.
-// Therefore, after any Register or UnRegister operation, InitIterator
-// will need to be called anew to traverse the object names in the
-// repository.  If a query is made (i.e. GetNextName) when that
-// condition is not satisfied (i.e. the last call to InitIterator was
-// prior to either a more recent Register or UnRegister), then
-// GetNextName returns NULL.
+// InitIterator takes a copy of the object names.  Any Register or
+// UnRegister operation invalidates it, and InitIterator will need to
+// be called anew to traverse the object names in the repository.  If
+// a query is made (i.e. GetNextName) when that condition is not
+// satisfied (i.e. the last call to InitIterator was prior to either a
+// more recent Register or UnRegister), then GetNextName returns NULL.
+
+// All methods lock the repository, so objects can be registered and
+// looked up from several threads.  The objects themselves are not
+// locked.
 
 #include "sv_RepositoryData.h"
 #include "SimVascular.h"
 #include "svRepositoryExports.h" // For exports
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct cvReposMappedFile;
+
 class SV_EXPORT_REPOSITORY cvRepository {
 
 public:
@@ -91,6 +98,10 @@ public:
   RepositoryDataT GetType( CONST84 char *name );
   cvRepositoryData *GetObject( CONST84 char *name );
 
+  // Binary snapshot of all poly data, structured points and unstructured
+  // grid objects: names, labels, topology and point/cell data arrays.
+  // Load maps the file and the restored arrays use the mapped payloads
+  // directly, copying only the pages that are later written to.
   int Save( char *filename );
   int Load( char *filename );
 
@@ -98,11 +109,55 @@ public:
   void InitIterator();
   char *GetNextName();
 
+  // Memory held by the registered objects in bytes, in total or for
+  // one object type (see cvRepositoryData::GetMemoryUsage).
+  long long GetMemoryUsage();
+  long long GetMemoryUsage( RepositoryDataT type );
+
+  // With a budget > 0, TrimMemory writes the least recently used poly
+  // data, structured points and unstructured grid objects of at least
+  // minSize bytes to scratchDir until the repository fits the budget.
+  // They are read back on the next GetObject.  SetMemoryBudget trims
+  // once.  A budget of 0 disables spilling.
+  //
+  // Spilling empties the VTK data set of an object in place, so
+  // TrimMemory must only be called when no caller holds an object
+  // pointer from GetObject, e.g. between script commands and not while
+  // worker threads use the repository.  Locked objects and objects with
+  // data the spill format cannot hold (bit arrays, non-numeric arrays,
+  // field data) are never spilled.
+  int SetMemoryBudget( long long budget, long long minSize, char *scratchDir );
+  long long GetMemoryBudget() { return memoryBudget_; }
+  int TrimMemory();
+  int GetNumSpilled();
+
 private:
-  Tcl_HashTable table_;
+  struct cvReposEntry {
+    cvRepositoryData *obj;
+    unsigned long long lastUse;
+    std::string spillFile;
+  };
+
+  void EnforceMemoryBudget();
+  int SpillObject( cvReposEntry &entry );
+  int RestoreObject( cvReposEntry &entry );
+
+  std::unordered_map<std::string,cvReposEntry> table_;
+  std::recursive_mutex mutex_;
+  unsigned long long useCount_;
+
   int iterValid_;
-  Tcl_HashEntry *currEntryPtr_;
-  Tcl_HashSearch search_;
+  int iterPos_;
+  std::vector<std::string> iterNames_;
+
+  long long memoryBudget_;
+  long long spillMinSize_;
+  std::string scratchDir_;
+  int spillCount_;
+
+  // Snapshots mapped by Load. Restored arrays point into the mappings,
+  // so they stay mapped for the lifetime of the repository.
+  std::vector<cvReposMappedFile*> mappedFiles_;
 
 };
 
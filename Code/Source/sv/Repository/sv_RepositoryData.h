@@ -98,7 +98,7 @@ public:
   void ClearLabel( char *key );
 
   // Memory usage:
-  virtual int GetMemoryUsage() { return 0; }
+  virtual long long GetMemoryUsage() { return 0; }
 
 private:
   RepositoryDataT type_;
@@ -85,6 +85,15 @@ int Repos_SaveCmd( ClientData clientData, Tcl_Interp *interp,
 int Repos_LoadCmd( ClientData clientData, Tcl_Interp *interp,
 		   int argc, CONST84 char *argv[] );
 
+int Repos_GetMemoryUsageCmd( ClientData clientData, Tcl_Interp *interp,
+			     int argc, CONST84 char *argv[] );
+
+int Repos_SetMemoryBudgetCmd( ClientData clientData, Tcl_Interp *interp,
+			      int argc, CONST84 char *argv[] );
+
+int Repos_TrimMemoryCmd( ClientData clientData, Tcl_Interp *interp,
+			 int argc, CONST84 char *argv[] );
+
 int Repos_WriteVtkPolyDataCmd( ClientData clientData, Tcl_Interp *interp,
 			  int argc, CONST84 char *argv[] );
 
@@ -167,6 +176,12 @@ int Repos_Init( Tcl_Interp *interp )
 		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
   Tcl_CreateCommand( interp, "repos_load", Repos_LoadCmd,
 		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
+  Tcl_CreateCommand( interp, "repos_getMemoryUsage", Repos_GetMemoryUsageCmd,
+		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
+  Tcl_CreateCommand( interp, "repos_setMemoryBudget", Repos_SetMemoryBudgetCmd,
+		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
+  Tcl_CreateCommand( interp, "repos_trimMemory", Repos_TrimMemoryCmd,
+		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
   Tcl_CreateCommand( interp, "repos_writeVtkPolyData",
 		     Repos_WriteVtkPolyDataCmd,
 		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
@@ -871,6 +886,107 @@ int Repos_LoadCmd( ClientData clientData, Tcl_Interp *interp,
 }
 
 
+// -----------------------
+// Repos_GetMemoryUsageCmd
+// -----------------------
+
+// repos_getMemoryUsage ?<type>?
+
+int Repos_GetMemoryUsageCmd( ClientData clientData, Tcl_Interp *interp,
+			     int argc, CONST84 char *argv[] )
+{
+  char rtnstr[255];
+  long long usage;
+
+  if ( argc > 2 ) {
+    Tcl_SetResult( interp, "usage: repos_getMemoryUsage ?<type>?", TCL_STATIC );
+    return TCL_ERROR;
+  }
+
+  if ( argc == 2 ) {
+    // RepositoryDataT_StrToEnum only knows a few of the types
+    RepositoryDataT type = RDT_INVALID;
+    for ( int i = POLY_DATA_T; i <= CONTOUR_T; i++ ) {
+      char *typeStr = RepositoryDataT_EnumToStr( (RepositoryDataT) i );
+      if ( !strcmp( typeStr, argv[1] ) ) {
+	type = (RepositoryDataT) i;
+      }
+      delete [] typeStr;
+    }
+    if ( type == RDT_INVALID ) {
+      Tcl_AppendResult( interp, "unknown type ", argv[1], (char *)NULL );
+      return TCL_ERROR;
+    }
+    usage = gRepository->GetMemoryUsage( type );
+  } else {
+    usage = gRepository->GetMemoryUsage();
+  }
+
+  sprintf( rtnstr, "%lld", usage );
+  Tcl_SetResult( interp, rtnstr, TCL_VOLATILE );
+  return TCL_OK;
+}
+
+
+// ------------------------
+// Repos_SetMemoryBudgetCmd
+// ------------------------
+
+// repos_setMemoryBudget <budget> ?<minSize>? ?<scratchDir>?
+
+int Repos_SetMemoryBudgetCmd( ClientData clientData, Tcl_Interp *interp,
+			      int argc, CONST84 char *argv[] )
+{
+  long long budget;
+  long long minSize = 0;
+  char *scratchDir = NULL;
+
+  if ( argc < 2 || argc > 4 ) {
+    Tcl_SetResult( interp, "usage: repos_setMemoryBudget <budget> ?<minSize>? ?<scratchDir>?", TCL_STATIC );
+    return TCL_ERROR;
+  }
+  if ( sscanf( argv[1], "%lld", &budget ) != 1 ||
+       ( argc > 2 && sscanf( argv[2], "%lld", &minSize ) != 1 ) ) {
+    Tcl_SetResult( interp, "budget and minSize must be integers", TCL_STATIC );
+    return TCL_ERROR;
+  }
+  if ( argc > 3 ) {
+    scratchDir = (char *) argv[3];
+  }
+
+  if ( gRepository->SetMemoryBudget( budget, minSize, scratchDir ) != SV_OK ) {
+    Tcl_SetResult( interp, "error setting repository memory budget", TCL_STATIC );
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+
+// -------------------
+// Repos_TrimMemoryCmd
+// -------------------
+
+// repos_trimMemory
+
+// Spills objects until the repository fits its memory budget.  Runs
+// between commands, so no object pointers are held.
+
+int Repos_TrimMemoryCmd( ClientData clientData, Tcl_Interp *interp,
+			 int argc, CONST84 char *argv[] )
+{
+  if ( argc != 1 ) {
+    Tcl_SetResult( interp, "usage: repos_trimMemory", TCL_STATIC );
+    return TCL_ERROR;
+  }
+
+  if ( gRepository->TrimMemory() != SV_OK ) {
+    Tcl_SetResult( interp, "error trimming repository memory", TCL_STATIC );
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+
 // -------------------------
 // Repos_WriteVtkPolyDataCmd
 // -------------------------
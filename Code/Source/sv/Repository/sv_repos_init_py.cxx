@@ -44,6 +44,13 @@
 #include "vtkTclUtil.h"
 #include "vtkPythonUtil.h"
 #include <vtkXMLPolyDataReader.h>
+#include "vtkCallbackCommand.h"
+#include "vtkCellArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkPointSet.h"
+
+#include <string.h>
+#include <vector>
 
 // The following is needed for Windows
 #ifdef GetObject
@@ -82,6 +89,24 @@ PyObject*  Repos_SaveCmd( PyObject* self, PyObject* args );
 
 PyObject*  Repos_LoadCmd( PyObject* self, PyObject* args );
 
+PyObject*  Repos_GetMemoryUsageCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_SetMemoryBudgetCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_TrimMemoryCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_GetPointsBufferCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_GetCellsBufferCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_GetArrayBufferCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_ImportArrayBufferCmd( PyObject* self, PyObject* args );
+
+PyObject*  Repos_ImportPolyDataBuffersCmd( PyObject* self, PyObject* args );
+
+int Repos_pyInitBufferType( PyObject *module );
+
 PyObject* Repos_WriteVtkPolyDataCmd( PyObject* self, PyObject* args);
 
 PyObject* Repos_ReadVtkPolyDataCmd( PyObject* self, PyObject* args);
@@ -132,6 +157,14 @@ PyMethodDef pyRepository_methods[] =
       METH_VARARGS,NULL},
     {"Save", Repos_SaveCmd, METH_VARARGS,NULL},
     {"Load", Repos_LoadCmd, METH_VARARGS,NULL},
+    {"GetMemoryUsage", Repos_GetMemoryUsageCmd, METH_NOARGS,NULL},
+    {"SetMemoryBudget", Repos_SetMemoryBudgetCmd, METH_VARARGS,NULL},
+    {"TrimMemory", Repos_TrimMemoryCmd, METH_NOARGS,NULL},
+    {"GetPointsBuffer", Repos_GetPointsBufferCmd, METH_VARARGS,NULL},
+    {"GetCellsBuffer", Repos_GetCellsBufferCmd, METH_VARARGS,NULL},
+    {"GetArrayBuffer", Repos_GetArrayBufferCmd, METH_VARARGS,NULL},
+    {"ImportArrayBuffer", Repos_ImportArrayBufferCmd, METH_VARARGS,NULL},
+    {"ImportPolyDataBuffers", Repos_ImportPolyDataBuffersCmd, METH_VARARGS,NULL},
     {"WriteVtkPolyData", Repos_WriteVtkPolyDataCmd, METH_VARARGS,NULL},
     {"ReadVtkPolyData", Repos_ReadVtkPolyDataCmd, METH_VARARGS,NULL},
     {"ReadXMLPolyData",Repos_ReadVtkXMLPolyDataCmd,METH_VARARGS,NULL},
@@ -175,6 +208,7 @@ PyMODINIT_FUNC initpyRepository(void)
   PyRunTimeErr = PyErr_NewException("pyRepository.error",NULL,NULL);
   Py_INCREF(PyRunTimeErr);
   PyModule_AddObject(pyRepo,"error",PyRunTimeErr);
+  Repos_pyInitBufferType(pyRepo);
 
 }
 
@@ -194,6 +228,7 @@ PyMODINIT_FUNC PyInit_pyRepository(void)
   PyRunTimeErr = PyErr_NewException("pyRepository.error",NULL,NULL);
   Py_INCREF(PyRunTimeErr);
   PyModule_AddObject(pyRepo,"error",PyRunTimeErr);
+  Repos_pyInitBufferType(pyRepo);
   return pyRepo;
 }
 #endif
@@ -783,6 +818,96 @@ PyObject* Repos_LoadCmd( PyObject* self, PyObject* args)
 }
 
 
+// -----------------------
+// Repos_GetMemoryUsageCmd
+// -----------------------
+
+// Returns a dict of bytes used per object type, plus the overall
+// "total" and the number of objects spilled to disk.
+
+PyObject* Repos_GetMemoryUsageCmd( PyObject* self, PyObject* args )
+
+{
+
+  PyObject *pydict = PyDict_New();
+  for ( int type = POLY_DATA_T; type <= CONTOUR_T; type++ )
+  {
+    long long usage = gRepository->GetMemoryUsage( (RepositoryDataT) type );
+    if ( usage > 0 )
+    {
+      char *typeStr = RepositoryDataT_EnumToStr( (RepositoryDataT) type );
+      PyObject *pyUsage = PyLong_FromLongLong( usage );
+      PyDict_SetItemString( pydict, typeStr, pyUsage );
+      Py_DECREF( pyUsage );
+      delete [] typeStr;
+    }
+  }
+
+  PyObject *pyTotal = PyLong_FromLongLong( gRepository->GetMemoryUsage() );
+  PyDict_SetItemString( pydict, "total", pyTotal );
+  Py_DECREF( pyTotal );
+  PyObject *pySpilled = PyLong_FromLong( gRepository->GetNumSpilled() );
+  PyDict_SetItemString( pydict, "spilled", pySpilled );
+  Py_DECREF( pySpilled );
+  return pydict;
+
+}
+
+
+// ------------------------
+// Repos_SetMemoryBudgetCmd
+// ------------------------
+
+// SetMemoryBudget( budget, minSize, scratchDir ), sizes in bytes.  A
+// budget of 0 disables spilling objects to scratchDir.
+
+PyObject* Repos_SetMemoryBudgetCmd( PyObject* self, PyObject* args )
+
+{
+
+  long long budget;
+  long long minSize = 0;
+  char *scratchDir = NULL;
+
+  if (!PyArg_ParseTuple(args,"L|Ls", &budget, &minSize, &scratchDir))
+  {
+    PyErr_SetString(PyRunTimeErr,
+      "Could not import 1 long long, 1 optional long long and 1 optional char: budget, minSize, scratchDir");
+    return SV_PYTHON_ERROR;
+  }
+
+  if ( gRepository->SetMemoryBudget( budget, minSize, scratchDir ) != SV_OK )
+  {
+    PyErr_SetString(PyRunTimeErr, "error setting repository memory budget");
+    return SV_PYTHON_ERROR;
+  }
+  return SV_PYTHON_OK;
+
+}
+
+
+// -------------------
+// Repos_TrimMemoryCmd
+// -------------------
+
+// Spills objects until the repository fits its memory budget.  Call it
+// between steps of a script, when no buffer views of repository
+// objects are in use.
+
+PyObject* Repos_TrimMemoryCmd( PyObject* self, PyObject* args )
+
+{
+
+  if ( gRepository->TrimMemory() != SV_OK )
+  {
+    PyErr_SetString(PyRunTimeErr, "error trimming repository memory");
+    return SV_PYTHON_ERROR;
+  }
+  return SV_PYTHON_OK;
+
+}
+
+
 // -------------------------
 // Repos_WriteVtkPolyDataCmd
 // -------------------------
@@ -1245,3 +1370,689 @@ PyObject* Repos_ClearLabelCmd( PyObject* self, PyObject* args)
   return SV_PYTHON_OK;
 
 }
+
+
+// --------------
+// Buffer methods
+// --------------
+
+// Points, cell connectivity and point/cell data arrays of repository
+// data sets are exposed through the Python buffer protocol, so that
+// e.g. numpy.asarray( pyRepository.GetPointsBuffer( "pd" ) ) is a view
+// on the VTK memory.  Each view holds a reference to the VTK array, so
+// it stays valid after the object is deleted from the repository.
+// The views are read-only: writing through them would not bump the
+// MTime of the array, and caches keyed on it (e.g. point locators)
+// would go stale.  Copy the view to modify the data.
+// Importing goes the other way: the VTK arrays point into the buffers
+// of the given Python objects, which are released when the VTK array
+// is deleted.  Read-only buffers are copied instead.
+
+typedef struct {
+  PyObject_HEAD
+  vtkDataArray *array;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+} pyRepositoryBuffer;
+
+static PyBufferProcs pyRepositoryBuffer_as_buffer;
+
+static const char *Repos_BufferFormat( int vtkType )
+{
+  switch ( vtkType ) {
+  case VTK_FLOAT:
+    return "f";
+  case VTK_DOUBLE:
+    return "d";
+  case VTK_CHAR:
+  case VTK_SIGNED_CHAR:
+    return "b";
+  case VTK_UNSIGNED_CHAR:
+    return "B";
+  case VTK_SHORT:
+    return "h";
+  case VTK_UNSIGNED_SHORT:
+    return "H";
+  case VTK_INT:
+    return "i";
+  case VTK_UNSIGNED_INT:
+    return "I";
+  case VTK_LONG:
+    return "l";
+  case VTK_UNSIGNED_LONG:
+    return "L";
+  case VTK_LONG_LONG:
+    return "q";
+  case VTK_UNSIGNED_LONG_LONG:
+    return "Q";
+  case VTK_ID_TYPE:
+    return ( sizeof(vtkIdType) == sizeof(long long) ) ? "q" : "i";
+  default:
+    return NULL;
+  }
+}
+
+// Maps a native struct format character to the VTK type of the same
+// size; integers of the size of vtkIdType map to VTK_ID_TYPE.
+
+static int Repos_BufferVtkType( const char *format, Py_ssize_t itemsize )
+{
+  if ( format == NULL ) {
+    return VTK_UNSIGNED_CHAR;
+  }
+  if ( format[0] == '@' || format[0] == '=' ) {
+    format++;
+  }
+  if ( strlen( format ) != 1 ) {
+    return -1;
+  }
+
+  switch ( format[0] ) {
+  case 'f':
+    return VTK_FLOAT;
+  case 'd':
+    return VTK_DOUBLE;
+  case 'b':
+    return VTK_SIGNED_CHAR;
+  case 'B':
+  case '?':
+    return VTK_UNSIGNED_CHAR;
+  case 'h':
+    return VTK_SHORT;
+  case 'H':
+    return VTK_UNSIGNED_SHORT;
+  case 'i':
+  case 'l':
+  case 'q':
+    if ( itemsize == sizeof(vtkIdType) ) {
+      return VTK_ID_TYPE;
+    }
+    return ( itemsize == sizeof(int) ) ? VTK_INT : VTK_LONG_LONG;
+  case 'I':
+  case 'L':
+  case 'Q':
+    return ( itemsize == sizeof(int) ) ? VTK_UNSIGNED_INT : VTK_UNSIGNED_LONG_LONG;
+  default:
+    return -1;
+  }
+}
+
+static void pyRepositoryBuffer_dealloc( pyRepositoryBuffer *self )
+{
+  if ( self->array != NULL ) {
+    self->array->UnRegister( NULL );
+  }
+  Py_TYPE( self )->tp_free( (PyObject *) self );
+}
+
+static int pyRepositoryBuffer_getbuffer( PyObject *obj, Py_buffer *view, int flags )
+{
+  pyRepositoryBuffer *self = (pyRepositoryBuffer *) obj;
+  vtkDataArray *array = self->array;
+  int numComp = array->GetNumberOfComponents();
+
+  if ( ( flags & PyBUF_WRITABLE ) == PyBUF_WRITABLE ) {
+    PyErr_SetString( PyExc_BufferError, "repository views are read-only" );
+    view->obj = NULL;
+    return -1;
+  }
+
+  view->obj = obj;
+  Py_INCREF( obj );
+  view->buf = array->GetVoidPointer( 0 );
+  view->itemsize = array->GetDataTypeSize();
+  view->len = array->GetNumberOfTuples() * numComp * view->itemsize;
+  view->readonly = 1;
+  view->format = NULL;
+  if ( flags & PyBUF_FORMAT ) {
+    view->format = (char *) Repos_BufferFormat( array->GetDataType() );
+  }
+  view->ndim = ( numComp == 1 ) ? 1 : 2;
+  view->shape = NULL;
+  view->strides = NULL;
+  if ( ( flags & PyBUF_ND ) == PyBUF_ND ) {
+    view->shape = self->shape;
+  }
+  if ( ( flags & PyBUF_STRIDES ) == PyBUF_STRIDES ) {
+    view->strides = self->strides;
+  }
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static PyTypeObject pyRepositoryBufferType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pyRepository.pyRepositoryBuffer", /* tp_name */
+  sizeof(pyRepositoryBuffer),   /* tp_basicsize */
+  0,                         /* tp_itemsize */
+  (destructor)pyRepositoryBuffer_dealloc, /* tp_dealloc */
+  0,                         /* tp_print */
+  0,                         /* tp_getattr */
+  0,                         /* tp_setattr */
+  0,                         /* tp_compare */
+  0,                         /* tp_repr */
+  0,                         /* tp_as_number */
+  0,                         /* tp_as_sequence */
+  0,                         /* tp_as_mapping */
+  0,                         /* tp_hash */
+  0,                         /* tp_call */
+  0,                         /* tp_str */
+  0,                         /* tp_getattro */
+  0,                         /* tp_setattro */
+  &pyRepositoryBuffer_as_buffer, /* tp_as_buffer */
+#if PYTHON_MAJOR_VERSION == 2
+  Py_TPFLAGS_DEFAULT |
+      Py_TPFLAGS_HAVE_NEWBUFFER, /* tp_flags */
+#else
+  Py_TPFLAGS_DEFAULT,        /* tp_flags */
+#endif
+  "view on a repository data array", /* tp_doc */
+};
+
+int Repos_pyInitBufferType( PyObject *module )
+{
+  pyRepositoryBuffer_as_buffer.bf_getbuffer = pyRepositoryBuffer_getbuffer;
+  pyRepositoryBuffer_as_buffer.bf_releasebuffer = NULL;
+  if ( PyType_Ready( &pyRepositoryBufferType ) < 0 ) {
+    return SV_ERROR;
+  }
+  Py_INCREF( &pyRepositoryBufferType );
+  PyModule_AddObject( module, "pyRepositoryBuffer",
+                      (PyObject *) &pyRepositoryBufferType );
+  return SV_OK;
+}
+
+// Returns a memoryview of shape (tuples, components) on array.
+
+static PyObject *Repos_NewArrayView( vtkDataArray *array )
+{
+  if ( Repos_BufferFormat( array->GetDataType() ) == NULL ) {
+    PyErr_SetString( PyRunTimeErr, "array type has no buffer format" );
+    return NULL;
+  }
+
+  pyRepositoryBuffer *view = PyObject_New( pyRepositoryBuffer, &pyRepositoryBufferType );
+  if ( view == NULL ) {
+    return NULL;
+  }
+  view->array = array;
+  array->Register( NULL );
+  int numComp = array->GetNumberOfComponents();
+  view->shape[0] = array->GetNumberOfTuples();
+  view->shape[1] = numComp;
+  view->strides[0] = numComp * array->GetDataTypeSize();
+  view->strides[1] = array->GetDataTypeSize();
+  if ( numComp == 1 ) {
+    view->strides[0] = array->GetDataTypeSize();
+  }
+
+  PyObject *mv = PyMemoryView_FromObject( (PyObject *) view );
+  Py_DECREF( view );
+  return mv;
+}
+
+// Releases the Python buffer an imported array points into.
+
+static void Repos_ReleaseImportedBuffer( vtkObject *caller, unsigned long eid,
+                                         void *clientData, void *callData )
+{
+  Py_buffer *view = (Py_buffer *) clientData;
+  if ( Py_IsInitialized() ) {
+    PyGILState_STATE state = PyGILState_Ensure();
+    PyBuffer_Release( view );
+    PyGILState_Release( state );
+  }
+  delete view;
+}
+
+// Wraps a C-contiguous 1 or 2 dimensional buffer in a VTK array
+// without copying.  Read-only buffers are copied, so that the VTK
+// array never writes into memory its exporter did not hand out as
+// writable.  numTuples < 0 accepts any number of rows.
+
+static vtkDataArray *Repos_ArrayFromBuffer( PyObject *obj, vtkIdType numTuples,
+                                            int numComp = -1 )
+{
+  Py_buffer *view = new Py_buffer;
+  int writable = 1;
+  if ( PyObject_GetBuffer( obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT |
+                           PyBUF_WRITABLE ) < 0 ) {
+    PyErr_Clear();
+    writable = 0;
+    if ( PyObject_GetBuffer( obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT ) < 0 ) {
+      delete view;
+      return NULL;
+    }
+  }
+
+  char r[2048];
+  int vtkType = Repos_BufferVtkType( view->format, view->itemsize );
+  vtkIdType rows = ( view->ndim == 0 ) ? 1 : view->shape[0];
+  int cols = ( view->ndim == 2 ) ? view->shape[1] : 1;
+  if ( vtkType < 0 || view->ndim > 2 ) {
+    sprintf( r, "buffer format %s with %d dimensions not supported",
+             view->format, view->ndim );
+  } else if ( numTuples >= 0 && rows != numTuples ) {
+    sprintf( r, "buffer has %lld rows, expected %lld", (long long) rows,
+             (long long) numTuples );
+  } else if ( numComp > 0 && cols != numComp ) {
+    sprintf( r, "buffer has %d columns, expected %d", cols, numComp );
+  } else {
+    r[0] = '\0';
+  }
+  if ( r[0] != '\0' ) {
+    PyErr_SetString( PyRunTimeErr, r );
+    PyBuffer_Release( view );
+    delete view;
+    return NULL;
+  }
+
+  vtkDataArray *array = vtkDataArray::CreateDataArray( vtkType );
+  array->SetNumberOfComponents( cols );
+  if ( !writable ) {
+    array->SetNumberOfTuples( rows );
+    memcpy( array->GetVoidPointer( 0 ), view->buf,
+            rows * cols * array->GetDataTypeSize() );
+    PyBuffer_Release( view );
+    delete view;
+    return array;
+  }
+  array->SetVoidArray( view->buf, rows * cols, 1 );
+
+  vtkCallbackCommand *release = vtkCallbackCommand::New();
+  release->SetCallback( Repos_ReleaseImportedBuffer );
+  release->SetClientData( view );
+  array->AddObserver( vtkCommand::DeleteEvent, release );
+  release->Delete();
+  return array;
+}
+
+static vtkDataSet *Repos_GetDataSet( char *objName )
+{
+  char r[2048];
+  RepositoryDataT type = gRepository->GetType( objName );
+  if ( type == OBJ_NOT_FOUND_T ) {
+    sprintf( r, "object %s not found", objName );
+    PyErr_SetString( PyRunTimeErr, r );
+    return NULL;
+  }
+  if ( type != POLY_DATA_T && type != UNSTRUCTURED_GRID_T &&
+       type != STRUCTURED_PTS_T ) {
+    sprintf( r, "object %s is not a data set", objName );
+    PyErr_SetString( PyRunTimeErr, r );
+    return NULL;
+  }
+  cvDataObject *obj = (cvDataObject *) gRepository->GetObject( objName );
+  if ( obj == NULL ) {
+    sprintf( r, "couldn't restore object %s", objName );
+    PyErr_SetString( PyRunTimeErr, r );
+    return NULL;
+  }
+  return vtkDataSet::SafeDownCast( obj->GetVtkPtr() );
+}
+
+static vtkDataSetAttributes *Repos_GetAttributes( vtkDataSet *ds, char *location )
+{
+  if ( location == NULL || !strcmp( location, "point" ) ) {
+    return ds->GetPointData();
+  } else if ( !strcmp( location, "cell" ) ) {
+    return ds->GetCellData();
+  }
+  PyErr_SetString( PyRunTimeErr, "location must be point or cell" );
+  return NULL;
+}
+
+
+// -----------------------
+// Repos_GetPointsBufferCmd
+// -----------------------
+
+// GetPointsBuffer( objName ) returns a (points, 3) view.
+
+PyObject* Repos_GetPointsBufferCmd( PyObject* self, PyObject* args )
+
+{
+
+  char *objName;
+
+  if (!PyArg_ParseTuple(args,"s", &objName))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import 1 char: objName");
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkDataSet *ds = Repos_GetDataSet( objName );
+  if ( ds == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkPointSet *ps = vtkPointSet::SafeDownCast( ds );
+  if ( ps == NULL || ps->GetPoints() == NULL )
+  {
+    PyErr_SetString(PyRunTimeErr, "object has no explicit points");
+    return SV_PYTHON_ERROR;
+  }
+
+  PyObject *mv = Repos_NewArrayView( ps->GetPoints()->GetData() );
+  if ( mv == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  return mv;
+
+}
+
+
+// ----------------------
+// Repos_GetCellsBufferCmd
+// ----------------------
+
+// GetCellsBuffer( objName, [ "verts" | "lines" | "polys" | "strips" ] )
+// returns a view on the connectivity in VTK cell array layout
+// (npts, id0, id1, ..., npts, ...).  Poly data defaults to polys, for
+// unstructured grids the cell type is ignored.
+
+PyObject* Repos_GetCellsBufferCmd( PyObject* self, PyObject* args )
+
+{
+
+  char *objName;
+  char *cellType = NULL;
+
+  if (!PyArg_ParseTuple(args,"s|s", &objName, &cellType))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import 1 char and 1 optional char: objName, cellType");
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkDataSet *ds = Repos_GetDataSet( objName );
+  if ( ds == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkCellArray *cells = NULL;
+  if ( vtkPolyData::SafeDownCast( ds ) != NULL )
+  {
+    vtkPolyData *pd = (vtkPolyData *) ds;
+    if ( cellType == NULL || !strcmp( cellType, "polys" ) ) {
+      cells = pd->GetPolys();
+    } else if ( !strcmp( cellType, "verts" ) ) {
+      cells = pd->GetVerts();
+    } else if ( !strcmp( cellType, "lines" ) ) {
+      cells = pd->GetLines();
+    } else if ( !strcmp( cellType, "strips" ) ) {
+      cells = pd->GetStrips();
+    } else {
+      PyErr_SetString(PyRunTimeErr, "cell type must be verts, lines, polys or strips");
+      return SV_PYTHON_ERROR;
+    }
+  }
+  else if ( vtkUnstructuredGrid::SafeDownCast( ds ) != NULL )
+  {
+    cells = ((vtkUnstructuredGrid *) ds)->GetCells();
+  }
+
+  if ( cells == NULL )
+  {
+    PyErr_SetString(PyRunTimeErr, "object has no explicit cells");
+    return SV_PYTHON_ERROR;
+  }
+
+  PyObject *mv = Repos_NewArrayView( cells->GetData() );
+  if ( mv == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  return mv;
+
+}
+
+
+// ----------------------
+// Repos_GetArrayBufferCmd
+// ----------------------
+
+// GetArrayBuffer( objName, arrayName, [ "point" | "cell" ] ) returns a
+// (tuples, components) view on a named data array.
+
+PyObject* Repos_GetArrayBufferCmd( PyObject* self, PyObject* args )
+
+{
+
+  char *objName, *arrayName;
+  char *location = NULL;
+
+  if (!PyArg_ParseTuple(args,"ss|s", &objName, &arrayName, &location))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import 2 chars and 1 optional char: objName, arrayName, location");
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkDataSet *ds = Repos_GetDataSet( objName );
+  if ( ds == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  vtkDataSetAttributes *attributes = Repos_GetAttributes( ds, location );
+  if ( attributes == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkDataArray *array = attributes->GetArray( arrayName );
+  if ( array == NULL )
+  {
+    char r[2048];
+    sprintf( r, "array %s not found", arrayName );
+    PyErr_SetString(PyRunTimeErr, r);
+    return SV_PYTHON_ERROR;
+  }
+
+  PyObject *mv = Repos_NewArrayView( array );
+  if ( mv == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  return mv;
+
+}
+
+
+// -------------------------
+// Repos_ImportArrayBufferCmd
+// -------------------------
+
+// ImportArrayBuffer( objName, arrayName, buffer, [ "point" | "cell" ] )
+// adds buffer as a data array without copying.  Its rows must match
+// the number of points or cells.
+
+PyObject* Repos_ImportArrayBufferCmd( PyObject* self, PyObject* args )
+
+{
+
+  char *objName, *arrayName;
+  PyObject *buffer;
+  char *location = NULL;
+
+  if (!PyArg_ParseTuple(args,"ssO|s", &objName, &arrayName, &buffer, &location))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import 2 chars, 1 buffer and 1 optional char: objName, arrayName, buffer, location");
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkDataSet *ds = Repos_GetDataSet( objName );
+  if ( ds == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  vtkDataSetAttributes *attributes = Repos_GetAttributes( ds, location );
+  if ( attributes == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkIdType numTuples = ( attributes == ds->GetPointData() ) ?
+    ds->GetNumberOfPoints() : ds->GetNumberOfCells();
+  vtkDataArray *array = Repos_ArrayFromBuffer( buffer, numTuples );
+  if ( array == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  array->SetName( arrayName );
+  attributes->AddArray( array );
+  array->Delete();
+
+  return SV_PYTHON_OK;
+
+}
+
+
+// ----------------------------
+// Repos_ImportPolyDataBuffersCmd
+// ----------------------------
+
+// ImportPolyDataBuffers( objName, points, [ polys ] ) creates a poly
+// data object from a (points, 3) float or double buffer and an
+// optional polys buffer.  A one dimensional integer buffer is taken to
+// be in VTK cell array layout (npts, id0, id1, ..., npts, ...) and is
+// used without copying if its integers are vtkIdType sized; a
+// (cells, n) integer buffer is converted.  All point ids must lie in
+// [0, points).
+
+PyObject* Repos_ImportPolyDataBuffersCmd( PyObject* self, PyObject* args )
+
+{
+
+  char *objName;
+  PyObject *pointsBuffer;
+  PyObject *polysBuffer = NULL;
+
+  if (!PyArg_ParseTuple(args,"sO|O", &objName, &pointsBuffer, &polysBuffer))
+  {
+    PyErr_SetString(PyRunTimeErr, "Could not import 1 char and 2 buffers: objName, points, polys");
+    return SV_PYTHON_ERROR;
+  }
+
+  if ( gRepository->Exists( objName ) )
+  {
+    char r[2048];
+    sprintf( r, "obj %s already exists", objName );
+    PyErr_SetString(PyRunTimeErr, r);
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkDataArray *coords = Repos_ArrayFromBuffer( pointsBuffer, -1, 3 );
+  if ( coords == NULL )
+  {
+    return SV_PYTHON_ERROR;
+  }
+  if ( coords->GetDataType() != VTK_FLOAT && coords->GetDataType() != VTK_DOUBLE )
+  {
+    coords->Delete();
+    PyErr_SetString(PyRunTimeErr, "points must be float or double");
+    return SV_PYTHON_ERROR;
+  }
+
+  vtkPolyData *pd = vtkPolyData::New();
+  vtkPoints *points = vtkPoints::New( coords->GetDataType() );
+  points->SetData( coords );
+  coords->Delete();
+  pd->SetPoints( points );
+  points->Delete();
+
+  if ( polysBuffer != NULL && polysBuffer != Py_None )
+  {
+    vtkDataArray *conn = Repos_ArrayFromBuffer( polysBuffer, -1 );
+    if ( conn == NULL )
+    {
+      pd->Delete();
+      return SV_PYTHON_ERROR;
+    }
+
+    if ( conn->GetDataType() == VTK_FLOAT || conn->GetDataType() == VTK_DOUBLE )
+    {
+      conn->Delete();
+      pd->Delete();
+      PyErr_SetString(PyRunTimeErr, "polys must be integers");
+      return SV_PYTHON_ERROR;
+    }
+
+    vtkIdType numPts = pd->GetNumberOfPoints();
+    vtkCellArray *polys = vtkCellArray::New();
+    const char *msg = NULL;
+    if ( conn->GetNumberOfComponents() == 1 )
+    {
+      vtkIdTypeArray *cellIds = vtkIdTypeArray::SafeDownCast( conn );
+      if ( cellIds == NULL ) {
+        cellIds = vtkIdTypeArray::New();
+        cellIds->DeepCopy( conn );
+      } else {
+        cellIds->Register( NULL );
+      }
+      vtkIdType *ids = cellIds->GetPointer( 0 );
+      vtkIdType size = cellIds->GetNumberOfTuples();
+      vtkIdType numCells = 0;
+      for ( vtkIdType i = 0; msg == NULL && i < size; i += ids[i] + 1, numCells++ ) {
+        if ( ids[i] < 0 || i + ids[i] >= size ) {
+          msg = "polys buffer is not in cell array layout";
+          break;
+        }
+        for ( vtkIdType j = 1; j <= ids[i]; j++ ) {
+          if ( ids[i+j] < 0 || ids[i+j] >= numPts ) {
+            msg = "polys buffer has point ids out of range";
+            break;
+          }
+        }
+      }
+      if ( msg == NULL ) {
+        polys->SetCells( numCells, cellIds );
+      }
+      cellIds->Delete();
+    }
+    else
+    {
+      int npts = conn->GetNumberOfComponents();
+      vtkIdType numCells = conn->GetNumberOfTuples();
+      polys->Allocate( numCells * ( npts + 1 ) );
+      std::vector<vtkIdType> ids( npts );
+      for ( vtkIdType i = 0; msg == NULL && i < numCells; i++ ) {
+        for ( int j = 0; j < npts; j++ ) {
+          ids[j] = (vtkIdType) conn->GetComponent( i, j );
+          if ( ids[j] < 0 || ids[j] >= numPts ) {
+            msg = "polys buffer has point ids out of range";
+            break;
+          }
+        }
+        if ( msg == NULL ) {
+          polys->InsertNextCell( npts, &ids[0] );
+        }
+      }
+    }
+    conn->Delete();
+
+    if ( msg != NULL )
+    {
+      polys->Delete();
+      pd->Delete();
+      PyErr_SetString(PyRunTimeErr, msg);
+      return SV_PYTHON_ERROR;
+    }
+    pd->SetPolys( polys );
+    polys->Delete();
+  }
+
+  cvPolyData *obj = new cvPolyData( pd );
+  pd->Delete();
+  if ( !( gRepository->Register( objName, obj ) ) )
+  {
+    PyErr_SetString(PyRunTimeErr, "error registering obj in repository");
+    delete obj;
+    return SV_PYTHON_ERROR;
+  }
+
+  return Py_BuildValue("s",obj->GetName());
+
+}
@@ -0,0 +1,357 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "SimVascular.h"
+
+#include "sv_geometry_cache.h"
+#include "sv_vtk_utils.h"
+
+#include "vtkSmartPointer.h"
+#include "vtkXMLPolyDataReader.h"
+#include "vtkXMLPolyDataWriter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bump when the stored results of an operation change, old entries are
+// then never hit again and age out of the cache.
+#define SV_GEOMETRY_CACHE_VERSION "1"
+
+#define SV_GEOMETRY_CACHE_EXTENSION ".vtp"
+
+namespace {
+
+struct GeometryCacheFile
+{
+  std::string path;
+  long long size;
+  time_t mtime;
+};
+
+std::mutex geometryCacheMutex;
+bool geometryCacheDirectorySet = false;
+std::string geometryCacheDirectory;
+std::atomic<long long> geometryCacheMaxSize(512LL*1024*1024);
+
+// Directory of the innermost cvGeometryCacheScope of this thread
+thread_local bool geometryCacheScoped = false;
+thread_local std::string geometryCacheScopeDirectory;
+
+std::string GeometryCache_FilePath( const std::string &dir, const std::string &op,
+                                    vtkTypeUInt64 key )
+{
+  char hex[17];
+  sprintf(hex, "%016llx", (unsigned long long) key);
+  return dir + "/" + op + "_" + hex + SV_GEOMETRY_CACHE_EXTENSION;
+}
+
+// Cache files in dir, temporary files of unfinished writes are skipped
+void GeometryCache_ListFiles( const std::string &dir, std::vector<GeometryCacheFile> &files )
+{
+  std::vector<std::string> names;
+#ifdef WIN32
+  WIN32_FIND_DATAA findData;
+  HANDLE handle = FindFirstFileA((dir + "/*" + SV_GEOMETRY_CACHE_EXTENSION).c_str(), &findData);
+  if (handle == INVALID_HANDLE_VALUE)
+    return;
+  do
+  {
+    names.push_back(findData.cFileName);
+  } while (FindNextFileA(handle, &findData));
+  FindClose(handle);
+#else
+  DIR *dirp = opendir(dir.c_str());
+  if (dirp == NULL)
+    return;
+  struct dirent *entry;
+  while ((entry = readdir(dirp)) != NULL)
+    names.push_back(entry->d_name);
+  closedir(dirp);
+#endif
+
+  std::string ext = SV_GEOMETRY_CACHE_EXTENSION;
+  for (size_t i=0; i<names.size(); i++)
+  {
+    if (names[i].size() <= ext.size() ||
+        names[i].compare(names[i].size()-ext.size(), ext.size(), ext) != 0)
+      continue;
+
+    GeometryCacheFile file;
+    file.path = dir + "/" + names[i];
+    struct stat info;
+    if (stat(file.path.c_str(), &info) != 0)
+      continue;
+    file.size = (long long) info.st_size;
+    file.mtime = info.st_mtime;
+    files.push_back(file);
+  }
+}
+
+// Removes the least recently used files until the cache fits maxSize
+void GeometryCache_Evict( const std::string &dir, long long maxSize )
+{
+  std::vector<GeometryCacheFile> files;
+  GeometryCache_ListFiles(dir, files);
+
+  long long totalSize = 0;
+  for (size_t i=0; i<files.size(); i++)
+    totalSize += files[i].size;
+  if (totalSize <= maxSize)
+    return;
+
+  std::sort(files.begin(), files.end(),
+            [](const GeometryCacheFile &a, const GeometryCacheFile &b) { return a.mtime < b.mtime; });
+  for (size_t i=0; i<files.size() && totalSize > maxSize; i++)
+  {
+    if (remove(files[i].path.c_str()) == 0)
+      totalSize -= files[i].size;
+  }
+}
+
+std::string GeometryCache_LockedDirectory()
+{
+  if (geometryCacheScoped)
+    return geometryCacheScopeDirectory;
+
+  std::lock_guard<std::mutex> lock(geometryCacheMutex);
+  if (!geometryCacheDirectorySet)
+  {
+    const char *env = getenv("SV_GEOMETRY_CACHE_DIR");
+    if (env != NULL)
+      geometryCacheDirectory = env;
+    geometryCacheDirectorySet = true;
+  }
+  return geometryCacheDirectory;
+}
+
+} // namespace
+
+// -------------------------
+// GeometryCache_SetDirectory
+// -------------------------
+
+void GeometryCache_SetDirectory( const std::string &dir )
+{
+  std::lock_guard<std::mutex> lock(geometryCacheMutex);
+  geometryCacheDirectory = dir;
+  geometryCacheDirectorySet = true;
+}
+
+// -------------------------
+// GeometryCache_GetDirectory
+// -------------------------
+
+std::string GeometryCache_GetDirectory()
+{
+  return GeometryCache_LockedDirectory();
+}
+
+// -----------------------
+// GeometryCache_IsEnabled
+// -----------------------
+
+bool GeometryCache_IsEnabled()
+{
+  return !GeometryCache_LockedDirectory().empty();
+}
+
+// -----------------------
+// GeometryCache_SetMaxSize
+// -----------------------
+
+void GeometryCache_SetMaxSize( long long maxBytes )
+{
+  geometryCacheMaxSize = maxBytes > 0 ? maxBytes : 0;
+}
+
+// -----------------------
+// GeometryCache_GetMaxSize
+// -----------------------
+
+long long GeometryCache_GetMaxSize()
+{
+  return geometryCacheMaxSize;
+}
+
+// ---------------------
+// GeometryCache_GetSeed
+// ---------------------
+
+vtkTypeUInt64 GeometryCache_GetSeed( const std::string &op )
+{
+  vtkTypeUInt64 seed = VtkUtils_HashString(SV_GEOMETRY_CACHE_VERSION);
+  return VtkUtils_HashString(op, seed);
+}
+
+// -----------------
+// GeometryCache_Get
+// -----------------
+
+int GeometryCache_Get( const std::string &op, vtkTypeUInt64 key, vtkPolyData *result )
+{
+  std::string dir = GeometryCache_LockedDirectory();
+  if (dir.empty() || result == NULL)
+    return SV_ERROR;
+
+  std::string path = GeometryCache_FilePath(dir, op, key);
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0)
+    return SV_ERROR;
+
+  vtkSmartPointer<vtkXMLPolyDataReader> reader =
+    vtkSmartPointer<vtkXMLPolyDataReader>::New();
+  reader->SetFileName(path.c_str());
+  reader->Update();
+  if (reader->GetErrorCode() != 0 || reader->GetOutput()->GetNumberOfPoints() == 0)
+  {
+    // Truncated or otherwise unreadable, drop it so it is rewritten
+    fprintf(stderr,"Removing unreadable geometry cache file %s\n", path.c_str());
+    remove(path.c_str());
+    return SV_ERROR;
+  }
+
+  result->DeepCopy(reader->GetOutput());
+
+  // Mark as recently used for the eviction order
+  utime(path.c_str(), NULL);
+
+  return SV_OK;
+}
+
+// -----------------
+// GeometryCache_Put
+// -----------------
+
+int GeometryCache_Put( const std::string &op, vtkTypeUInt64 key, vtkPolyData *result )
+{
+  std::string dir = GeometryCache_LockedDirectory();
+  if (dir.empty() || result == NULL)
+    return SV_ERROR;
+
+  long long maxSize = geometryCacheMaxSize;
+  if (maxSize == 0)
+    return SV_ERROR;
+
+  // Write to a unique temporary file first and rename it into place, so
+  // readers in this or another session never see a partial file
+  std::string path = GeometryCache_FilePath(dir, op, key);
+  char suffix[64];
+  sprintf(suffix, ".%llx.%llx.tmp",
+          (unsigned long long) std::hash<std::thread::id>()(std::this_thread::get_id()),
+          (unsigned long long) std::chrono::steady_clock::now().time_since_epoch().count());
+  std::string tmpPath = path + suffix;
+
+  vtkSmartPointer<vtkXMLPolyDataWriter> writer =
+    vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+  writer->SetFileName(tmpPath.c_str());
+  writer->SetInputData(result);
+  writer->SetDataModeToBinary();
+  if (writer->Write() != 1)
+  {
+    fprintf(stderr,"Could not write geometry cache file %s\n", tmpPath.c_str());
+    remove(tmpPath.c_str());
+    return SV_ERROR;
+  }
+
+  std::lock_guard<std::mutex> lock(geometryCacheMutex);
+#ifdef WIN32
+  remove(path.c_str());
+#endif
+  if (rename(tmpPath.c_str(), path.c_str()) != 0)
+  {
+    remove(tmpPath.c_str());
+    return SV_ERROR;
+  }
+
+  GeometryCache_Evict(dir, maxSize);
+
+  return SV_OK;
+}
+
+// -------------------
+// GeometryCache_Clear
+// -------------------
+
+int GeometryCache_Clear()
+{
+  std::string dir = GeometryCache_LockedDirectory();
+  if (dir.empty())
+    return SV_ERROR;
+
+  std::lock_guard<std::mutex> lock(geometryCacheMutex);
+  GeometryCache_Evict(dir, 0);
+
+  return SV_OK;
+}
+
+// --------------------
+// cvGeometryCacheScope
+// --------------------
+
+cvGeometryCacheScope::cvGeometryCacheScope( const std::string &dir )
+{
+  prevScoped_ = geometryCacheScoped;
+  prevDirectory_ = geometryCacheScopeDirectory;
+  geometryCacheScoped = true;
+  geometryCacheScopeDirectory = dir;
+}
+
+// ---------------------
+// ~cvGeometryCacheScope
+// ---------------------
+
+cvGeometryCacheScope::~cvGeometryCacheScope()
+{
+  geometryCacheScoped = prevScoped_;
+  geometryCacheScopeDirectory = prevDirectory_;
+}
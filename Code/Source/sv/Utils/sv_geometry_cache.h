@@ -0,0 +1,106 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __CVGEOMETRY_CACHE_H
+#define __CVGEOMETRY_CACHE_H
+
+#include "SimVascular.h"
+#include "svUtilsExports.h" // For exports
+
+#include "vtkPolyData.h"
+#include "vtkType.h"
+
+#include <string>
+
+// Persistent cache of expensive geometry results (centerlines, face
+// detection, remeshing). Results are stored as <op>_<key>.vtp files in a
+// cache directory, so a repeated operation on the same input is read back
+// instead of recomputed, also in later sessions. In the GUI the directory
+// is the .svcache folder of the project that owns the data, set with a
+// cvGeometryCacheScope around the operation. Keys are content hashes of
+// the inputs and parameters built with the VtkUtils_Hash functions and
+// GeometryCache_GetSeed. The least recently used files are removed when
+// the cache grows past its maximum size.
+// ---
+
+// Sets the default cache directory, an empty string disables the cache.
+// Until it is set the directory is taken from SV_GEOMETRY_CACHE_DIR, if
+// defined.
+SV_EXPORT_UTILS void GeometryCache_SetDirectory( const std::string &dir );
+
+// The cache directory of the calling thread, the directory of its
+// innermost cvGeometryCacheScope or else the default directory.
+SV_EXPORT_UTILS std::string GeometryCache_GetDirectory();
+
+// True if a cache directory is set. Callers check this before hashing
+// their inputs.
+SV_EXPORT_UTILS bool GeometryCache_IsEnabled();
+
+// Maximum total size of the cache files in bytes, 512 MB by default.
+SV_EXPORT_UTILS void GeometryCache_SetMaxSize( long long maxBytes );
+
+SV_EXPORT_UTILS long long GeometryCache_GetMaxSize();
+
+// Seed for the key of an operation. It includes the cache format version,
+// so bumping the version invalidates all existing entries.
+SV_EXPORT_UTILS vtkTypeUInt64 GeometryCache_GetSeed( const std::string &op );
+
+// Reads the cached result of op for key into result. Returns SV_OK on a
+// hit and SV_ERROR on a miss or if the cache is disabled.
+SV_EXPORT_UTILS int GeometryCache_Get( const std::string &op, vtkTypeUInt64 key, vtkPolyData *result );
+
+// Stores result as the cached result of op for key and evicts old entries
+// if the cache is over its maximum size.
+SV_EXPORT_UTILS int GeometryCache_Put( const std::string &op, vtkTypeUInt64 key, vtkPolyData *result );
+
+// Removes all cache files from the cache directory.
+SV_EXPORT_UTILS int GeometryCache_Clear();
+
+// Sets the cache directory of the calling thread while the scope exists,
+// an empty directory disables the cache on the thread. Other threads keep
+// their own directory, so operations on data of different projects cache
+// into their own projects.
+class SV_EXPORT_UTILS cvGeometryCacheScope
+{
+  public:
+    cvGeometryCacheScope( const std::string &dir );
+    ~cvGeometryCacheScope();
+
+  private:
+    cvGeometryCacheScope( const cvGeometryCacheScope & );
+    cvGeometryCacheScope &operator=( const cvGeometryCacheScope & );
+
+    bool prevScoped_;
+    std::string prevDirectory_;
+};
+
+#endif // __CVGEOMETRY_CACHE_H
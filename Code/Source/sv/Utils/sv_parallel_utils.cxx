@@ -0,0 +1,97 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "SimVascular.h"
+
+#include "sv_parallel_utils.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// -------------------------------
+// ParallelUtils_GetNumberOfThreads
+// -------------------------------
+
+int ParallelUtils_GetNumberOfThreads()
+{
+  const char *env = getenv("SV_NUM_THREADS");
+  if (env != NULL)
+  {
+    int numThreads = atoi(env);
+    if (numThreads > 0)
+      return numThreads;
+  }
+
+  int numThreads = (int) std::thread::hardware_concurrency();
+  return numThreads > 0 ? numThreads : 1;
+}
+
+// ----------------
+// ParallelUtils_For
+// ----------------
+
+void ParallelUtils_For( int numTasks, const std::function<void(int)> &task,
+                        int maxThreads )
+{
+  if (numTasks <= 0)
+    return;
+
+  int numThreads = maxThreads > 0 ? maxThreads : ParallelUtils_GetNumberOfThreads();
+  if (numThreads > numTasks)
+    numThreads = numTasks;
+
+  if (numThreads <= 1)
+  {
+    for (int i=0; i<numTasks; i++)
+      task(i);
+    return;
+  }
+
+  std::atomic<int> next(0);
+  auto worker = [&]()
+  {
+    for (int i = next++; i < numTasks; i = next++)
+      task(i);
+  };
+
+  // The calling thread is one of the workers
+  std::vector<std::thread> threads;
+  for (int i=1; i<numThreads; i++)
+    threads.push_back(std::thread(worker));
+  worker();
+
+  for (size_t i=0; i<threads.size(); i++)
+    threads[i].join();
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __CVPARALLEL_UTILS_H
+#define __CVPARALLEL_UTILS_H
+
+#include "SimVascular.h"
+#include "svUtilsExports.h" // For exports
+
+#include <functional>
+
+// Coarse grained task parallelism for work items that are too large and
+// too few for vtkSMPTools (e.g. one TetGen or MMG run per sub-domain).
+// ---
+
+// Number of worker threads to use, from SV_NUM_THREADS if set and the
+// hardware concurrency otherwise. Always at least one.
+SV_EXPORT_UTILS int ParallelUtils_GetNumberOfThreads();
+
+// Calls task(i) for every i in [0,numTasks) on up to maxThreads threads
+// (ParallelUtils_GetNumberOfThreads() if maxThreads < 1). Tasks are handed
+// out one at a time so uneven task sizes balance. The task must not throw.
+SV_EXPORT_UTILS void ParallelUtils_For( int numTasks, const std::function<void(int)> &task,
+                                        int maxThreads = 0 );
+
+#endif // __CVPARALLEL_UTILS_H
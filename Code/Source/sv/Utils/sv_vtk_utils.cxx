@@ -56,6 +56,7 @@ typedef struct {
 } PostPt_T;
 
 #include "sv_vtk_utils.h"
+#include "vtkSmartPointer.h"
 
 // Static helpers
 // --------------
@@ -1730,3 +1731,120 @@ int VtkUtils_UGCheckArrayName(vtkUnstructuredGrid *object,int datatype,std::stri
     return SV_ERROR;
   }
 }
+
+// -------------------
+// VtkUtils_HashBytes
+// -------------------
+/**
+ * @brief Hash a block of memory with 64 bit FNV-1a
+ * @param data pointer to the bytes
+ * @param size number of bytes
+ * @param seed previous hash to continue from
+ */
+
+vtkTypeUInt64 VtkUtils_HashBytes( const void *data, size_t size, vtkTypeUInt64 seed )
+{
+  const unsigned char *bytes = static_cast<const unsigned char*>(data);
+  vtkTypeUInt64 hash = seed;
+  for (size_t i=0; i<size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+vtkTypeUInt64 VtkUtils_HashString( const std::string &str, vtkTypeUInt64 seed )
+{
+  vtkTypeUInt64 size = str.size();
+  seed = VtkUtils_HashBytes(&size, sizeof(size), seed);
+  return VtkUtils_HashBytes(str.data(), str.size(), seed);
+}
+
+// -------------------
+// VtkUtils_HashDataArray
+// -------------------
+/**
+ * @brief Hash the name, type, shape and values of a data array
+ */
+
+vtkTypeUInt64 VtkUtils_HashDataArray( vtkDataArray *array, vtkTypeUInt64 seed )
+{
+  if (array == NULL)
+    return VtkUtils_HashString("", seed);
+
+  vtkTypeUInt64 hash = VtkUtils_HashString(array->GetName() ? array->GetName() : "", seed);
+
+  vtkTypeUInt64 shape[3];
+  shape[0] = array->GetDataType();
+  shape[1] = array->GetNumberOfComponents();
+  shape[2] = array->GetNumberOfTuples();
+  hash = VtkUtils_HashBytes(shape, sizeof(shape), hash);
+
+  if (array->GetNumberOfValues() > 0)
+  {
+    hash = VtkUtils_HashBytes(array->GetVoidPointer(0),
+      array->GetNumberOfValues()*array->GetDataTypeSize(), hash);
+  }
+  return hash;
+}
+
+// -------------------
+// VtkUtils_HashDataSet
+// -------------------
+/**
+ * @brief Hash the geometry, topology and attribute arrays of a data set
+ * @note Poly data and unstructured grids hash their raw cell arrays; any
+ * other point set falls back to walking the cells.
+ */
+
+vtkTypeUInt64 VtkUtils_HashDataSet( vtkDataSet *ds, vtkTypeUInt64 seed )
+{
+  if (ds == NULL)
+    return VtkUtils_HashString("", seed);
+
+  vtkTypeUInt64 hash = VtkUtils_HashString(ds->GetClassName(), seed);
+
+  vtkPointSet *ps = vtkPointSet::SafeDownCast(ds);
+  if (ps != NULL && ps->GetPoints() != NULL)
+    hash = VtkUtils_HashDataArray(ps->GetPoints()->GetData(), hash);
+
+  vtkPolyData *pd = vtkPolyData::SafeDownCast(ds);
+  vtkUnstructuredGrid *ug = vtkUnstructuredGrid::SafeDownCast(ds);
+  if (pd != NULL)
+  {
+    vtkCellArray *cells[4] = {pd->GetVerts(), pd->GetLines(), pd->GetPolys(),
+                              pd->GetStrips()};
+    for (int i=0; i<4; i++)
+      hash = VtkUtils_HashDataArray(cells[i] ? cells[i]->GetData() : NULL, hash);
+  }
+  else if (ug != NULL)
+  {
+    hash = VtkUtils_HashDataArray(ug->GetCells() ? ug->GetCells()->GetData() : NULL, hash);
+    hash = VtkUtils_HashDataArray(ug->GetCellTypesArray(), hash);
+  }
+  else
+  {
+    vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
+    for (vtkIdType i=0; i<ds->GetNumberOfCells(); i++)
+    {
+      int cellType = ds->GetCellType(i);
+      hash = VtkUtils_HashBytes(&cellType, sizeof(cellType), hash);
+      ds->GetCellPoints(i, ptIds);
+      if (ptIds->GetNumberOfIds() > 0)
+        hash = VtkUtils_HashBytes(ptIds->GetPointer(0),
+          ptIds->GetNumberOfIds()*sizeof(vtkIdType), hash);
+    }
+  }
+
+  vtkDataSetAttributes *attributes[2] = {ds->GetPointData(), ds->GetCellData()};
+  for (int i=0; i<2; i++)
+  {
+    int numArrays = attributes[i]->GetNumberOfArrays();
+    hash = VtkUtils_HashBytes(&numArrays, sizeof(numArrays), hash);
+    for (int j=0; j<numArrays; j++)
+      hash = VtkUtils_HashDataArray(attributes[i]->GetArray(j), hash);
+  }
+
+  return hash;
+}
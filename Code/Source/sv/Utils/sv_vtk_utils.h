@@ -105,4 +105,17 @@ int SV_EXPORT_UTILS VtkUtils_ReversePtList( int num, double ptsIn[], double *pts
 int SV_EXPORT_UTILS VtkUtils_PDCheckArrayName( vtkPolyData *object, int datatype,std::string arrayname);
 
 int SV_EXPORT_UTILS VtkUtils_UGCheckArrayName( vtkUnstructuredGrid *object, int datatype,std::string arrayname);
+
+// Content hashes (64 bit FNV-1a) used as cache keys. A hash can be
+// chained by passing the result of one call as the seed of the next.
+#define SV_HASH_SEED 14695981039346656037ULL
+
+SV_EXPORT_UTILS vtkTypeUInt64 VtkUtils_HashBytes( const void *data, size_t size, vtkTypeUInt64 seed = SV_HASH_SEED );
+
+SV_EXPORT_UTILS vtkTypeUInt64 VtkUtils_HashString( const std::string &str, vtkTypeUInt64 seed = SV_HASH_SEED );
+
+SV_EXPORT_UTILS vtkTypeUInt64 VtkUtils_HashDataArray( vtkDataArray *array, vtkTypeUInt64 seed = SV_HASH_SEED );
+
+// Hashes points, connectivity and every named point and cell data array.
+SV_EXPORT_UTILS vtkTypeUInt64 VtkUtils_HashDataSet( vtkDataSet *ds, vtkTypeUInt64 seed = SV_HASH_SEED );
 #endif // __CVVTKUTILS_H
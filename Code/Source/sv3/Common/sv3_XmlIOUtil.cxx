@@ -31,6 +31,10 @@
 
 #include "sv3_XmlIOUtil.h"
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 using sv3::XmlIOUtil;
@@ -132,3 +136,171 @@ XmlIOUtil::GetDoubleAttributeListFromXMLNode(TiXmlElement* e, const char *attrib
 
     return list;
 }
+
+static const char XmlIOUtil_Base64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static bool XmlIOUtil_DefaultArrayEncoding()
+{
+    std::string encoding;
+#ifdef WIN32
+    size_t requiredSize = 0;
+    getenv_s(&requiredSize, NULL, 0, "SV_XML_ARRAY_ENCODING");
+    if (requiredSize > 0) {
+        std::vector<char> value(requiredSize);
+        getenv_s(&requiredSize, value.data(), requiredSize, "SV_XML_ARRAY_ENCODING");
+        encoding = value.data();
+    }
+#else
+    const char* value = getenv("SV_XML_ARRAY_ENCODING");
+    if (value != NULL) {
+        encoding = value;
+    }
+#endif
+    return encoding == "base64";
+}
+
+static std::atomic<bool>& XmlIOUtil_ArrayEncoding()
+{
+    static std::atomic<bool> base64(XmlIOUtil_DefaultArrayEncoding());
+    return base64;
+}
+
+void XmlIOUtil::SetArrayEncoding(bool base64)
+{
+    XmlIOUtil_ArrayEncoding() = base64;
+}
+
+bool XmlIOUtil::GetArrayEncoding()
+{
+    return XmlIOUtil_ArrayEncoding();
+}
+
+std::string XmlIOUtil::EncodeBase64(const double* values, size_t numberOfValues)
+{
+    // Serialize as little-endian regardless of the host byte order.
+    std::vector<unsigned char> bytes(numberOfValues*8);
+    for (size_t i = 0; i < numberOfValues; i++) {
+        uint64_t bits;
+        memcpy(&bits, &values[i], 8);
+        for (int b = 0; b < 8; b++) {
+            bytes[i*8+b] = (unsigned char) ((bits >> (8*b)) & 0xff);
+        }
+    }
+
+    std::string text;
+    text.reserve(((bytes.size()+2)/3)*4);
+    size_t i = 0;
+    for (; i+2 < bytes.size(); i += 3) {
+        uint32_t n = (bytes[i] << 16) | (bytes[i+1] << 8) | bytes[i+2];
+        text.push_back(XmlIOUtil_Base64Chars[(n >> 18) & 63]);
+        text.push_back(XmlIOUtil_Base64Chars[(n >> 12) & 63]);
+        text.push_back(XmlIOUtil_Base64Chars[(n >> 6) & 63]);
+        text.push_back(XmlIOUtil_Base64Chars[n & 63]);
+    }
+    if (i < bytes.size()) {
+        uint32_t n = bytes[i] << 16;
+        if (i+1 < bytes.size()) {
+            n |= bytes[i+1] << 8;
+        }
+        text.push_back(XmlIOUtil_Base64Chars[(n >> 18) & 63]);
+        text.push_back(XmlIOUtil_Base64Chars[(n >> 12) & 63]);
+        text.push_back(i+1 < bytes.size() ? XmlIOUtil_Base64Chars[(n >> 6) & 63] : '=');
+        text.push_back('=');
+    }
+
+    return text;
+}
+
+bool XmlIOUtil::DecodeBase64(const char* text, std::vector<double>& values)
+{
+    values.clear();
+    if (text == NULL) {
+        return true;
+    }
+
+    signed char lookup[256];
+    memset(lookup, -1, sizeof(lookup));
+    for (int i = 0; i < 64; i++) {
+        lookup[(unsigned char) XmlIOUtil_Base64Chars[i]] = (signed char) i;
+    }
+
+    std::vector<unsigned char> bytes;
+    bytes.reserve(strlen(text)/4*3);
+    uint32_t n = 0;
+    int bits = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '=') {
+            break;
+        }
+        if (*c == ' ' || *c == '\n' || *c == '\r' || *c == '\t') {
+            continue;
+        }
+        int v = lookup[(unsigned char) *c];
+        if (v < 0) {
+            return false;
+        }
+        n = (n << 6) | v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            bytes.push_back((unsigned char) ((n >> bits) & 0xff));
+        }
+    }
+
+    if (bytes.size() % 8 != 0) {
+        return false;
+    }
+
+    values.resize(bytes.size()/8);
+    for (size_t i = 0; i < values.size(); i++) {
+        uint64_t word = 0;
+        for (int b = 0; b < 8; b++) {
+            word |= ((uint64_t) bytes[i*8+b]) << (8*b);
+        }
+        memcpy(&values[i], &word, 8);
+    }
+
+    return true;
+}
+
+TiXmlElement* XmlIOUtil::CreateXMLArrayElement(const char* name, const std::vector<double>& values, int numberOfComponents)
+{
+    auto  arrayElement = new TiXmlElement(name);
+    arrayElement->SetAttribute("encoding", "base64");
+    arrayElement->SetAttribute("count", (int) (values.size()/numberOfComponents));
+    arrayElement->SetAttribute("components", numberOfComponents);
+    arrayElement->LinkEndChild(new TiXmlText(EncodeBase64(values.data(), values.size())));
+    return arrayElement;
+}
+
+bool XmlIOUtil::IsXMLArrayElement(TiXmlElement* element)
+{
+    if (element == nullptr) {
+        return false;
+    }
+    const char* encoding = element->Attribute("encoding");
+    return encoding != nullptr && strcmp(encoding, "base64") == 0;
+}
+
+bool XmlIOUtil::GetArray(TiXmlElement* element, int numberOfComponents, std::vector<double>& values)
+{
+    values.clear();
+    if (!IsXMLArrayElement(element)) {
+        return false;
+    }
+
+    int count = 0;
+    int components = numberOfComponents;
+    element->QueryIntAttribute("count", &count);
+    element->QueryIntAttribute("components", &components);
+    if (components != numberOfComponents) {
+        return false;
+    }
+
+    if (!DecodeBase64(element->GetText(), values)) {
+        return false;
+    }
+
+    return values.size() == (size_t) count * numberOfComponents;
+}
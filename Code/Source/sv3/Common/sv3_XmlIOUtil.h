@@ -40,6 +40,8 @@
 
 #include <list>
 #include <array>
+#include <string>
+#include <vector>
 namespace sv3 {
     
 class SV_EXPORT_COMMON XmlIOUtil
@@ -58,6 +60,31 @@ public:
     static std::array<double,3> GetVector(TiXmlElement* element);
 
     static std::list< double > GetDoubleAttributeListFromXMLNode(TiXmlElement* e, const char *attributeNameBase, unsigned int count);
+
+    // Compact array payloads. Instead of one element per point, the values of
+    // an array are written as little-endian doubles, base64 encoded into the
+    // text of a single element:
+    //
+    //   <name encoding="base64" count="N" components="C">...</name>
+    //
+    // Readers check IsXMLArrayElement and fall back to the per-point elements,
+    // so files written either way can be read back.
+
+    // Enables the compact encoding for writers. The default is taken from the
+    // SV_XML_ARRAY_ENCODING environment variable ("base64" to enable).
+    static void SetArrayEncoding(bool base64);
+    static bool GetArrayEncoding();
+
+    static TiXmlElement* CreateXMLArrayElement(const char* name, const std::vector<double>& values, int numberOfComponents);
+
+    static bool IsXMLArrayElement(TiXmlElement* element);
+
+    // Decodes an array element written by CreateXMLArrayElement. Returns false if
+    // the payload is malformed or does not hold numberOfComponents per tuple.
+    static bool GetArray(TiXmlElement* element, int numberOfComponents, std::vector<double>& values);
+
+    static std::string EncodeBase64(const double* values, size_t numberOfValues);
+    static bool DecodeBase64(const char* text, std::vector<double>& values);
 };
 }
 
@@ -419,7 +419,7 @@ void PathElement::CreatePathPoints()
         return;
     }
 
-    Spline* spline=new Spline();
+    Spline* spline=&m_Spline;
     spline->SetClosed(false);
 
     switch(m_Method)
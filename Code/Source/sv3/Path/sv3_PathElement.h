@@ -140,6 +140,10 @@ protected:
     CalculationMethod m_Method;
 
     int m_CalculationNumber;
+
+    // Kept between updates so control point edits only re-sample the changed
+    // segments. Not copied with the element.
+    Spline m_Spline;
 };
 }
 #endif // __SV3_PATHELEMENT_H__
@@ -118,36 +118,72 @@ int PathIO::ReadPath(PathElement* path, TiXmlElement* pathXml)
     //control points without updating contour points
     TiXmlElement* controlpointsElement = pathXml->FirstChildElement("control_points");
     std::vector<std::array<double, 3> > controlPoints;
-    for( TiXmlElement* pointElement = controlpointsElement->FirstChildElement("point");
-            pointElement != nullptr;
-            pointElement = pointElement->NextSiblingElement("point") )
+    if(XmlIOUtil::IsXMLArrayElement(controlpointsElement))
     {
-        if (pointElement == nullptr)
-            continue;
+        std::vector<double> values;
+        if(!XmlIOUtil::GetArray(controlpointsElement, 3, values))
+        {
+            std::cout << "Invalid control point data"<<std::endl;
+            return SV_ERROR;
+        }
+        controlPoints.resize(values.size()/3);
+        for(size_t i=0;i<controlPoints.size();i++)
+            controlPoints[i]={values[3*i],values[3*i+1],values[3*i+2]};
+    }
+    else
+    {
+        for( TiXmlElement* pointElement = controlpointsElement->FirstChildElement("point");
+                pointElement != nullptr;
+                pointElement = pointElement->NextSiblingElement("point") )
+        {
+            if (pointElement == nullptr)
+                continue;
 
-        controlPoints.push_back(XmlIOUtil::GetPoint(pointElement));
+            controlPoints.push_back(XmlIOUtil::GetPoint(pointElement));
+        }
     }
     path->SetControlPoints(controlPoints,false);
 
-    //path points
+    //path points, stored as id, pos, tangent, rotation when encoded
     TiXmlElement* pathpointsElement = pathXml->FirstChildElement("path_points");
     std::vector<PathElement::PathPoint> pathPoints;
-    for( TiXmlElement* pointElement = pathpointsElement->FirstChildElement("path_point");
-            pointElement != nullptr;
-            pointElement = pointElement->NextSiblingElement("path_point") )
+    if(XmlIOUtil::IsXMLArrayElement(pathpointsElement))
     {
-        if (pointElement == nullptr)
-            continue;
+        std::vector<double> values;
+        if(!XmlIOUtil::GetArray(pathpointsElement, 10, values))
+        {
+            std::cout << "Invalid path point data"<<std::endl;
+            return SV_ERROR;
+        }
+        pathPoints.resize(values.size()/10);
+        for(size_t i=0;i<pathPoints.size();i++)
+        {
+            const double* v=&values[10*i];
+            pathPoints[i].id=(int)v[0];
+            pathPoints[i].pos={v[1],v[2],v[3]};
+            pathPoints[i].tangent={v[4],v[5],v[6]};
+            pathPoints[i].rotation={v[7],v[8],v[9]};
+        }
+    }
+    else
+    {
+        for( TiXmlElement* pointElement = pathpointsElement->FirstChildElement("path_point");
+                pointElement != nullptr;
+                pointElement = pointElement->NextSiblingElement("path_point") )
+        {
+            if (pointElement == nullptr)
+                continue;
 
-        PathElement::PathPoint pathPoint;
-        int id=0;
-        pointElement->QueryIntAttribute("id", &id);
-        pathPoint.id=id;
-        pathPoint.pos=XmlIOUtil::GetPoint(pointElement->FirstChildElement("pos"));
-        pathPoint.tangent=XmlIOUtil::GetVector(pointElement->FirstChildElement("tangent"));
-        pathPoint.rotation=XmlIOUtil::GetVector(pointElement->FirstChildElement("rotation"));
+            PathElement::PathPoint pathPoint;
+            int id=0;
+            pointElement->QueryIntAttribute("id", &id);
+            pathPoint.id=id;
+            pathPoint.pos=XmlIOUtil::GetPoint(pointElement->FirstChildElement("pos"));
+            pathPoint.tangent=XmlIOUtil::GetVector(pointElement->FirstChildElement("tangent"));
+            pathPoint.rotation=XmlIOUtil::GetVector(pointElement->FirstChildElement("rotation"));
 
-        pathPoints.push_back(pathPoint);
+            pathPoints.push_back(pathPoint);
+        }
     }
     path->SetPathPoints(pathPoints);
     
@@ -212,6 +248,31 @@ void PathIO::WritePath(PathElement* path, TiXmlElement* timeStepElem)
     pathXml->SetAttribute("calculation_number", path->GetCalculationNumber());
     pathXml->SetDoubleAttribute("spacing", path->GetSpacing());
 
+    if(XmlIOUtil::GetArrayEncoding())
+    {
+        std::vector<double> values;
+        values.reserve(3*path->GetControlPointNumber());
+        for(int i=0;i<path->GetControlPointNumber();i++)
+        {
+            std::array<double,3> point=path->GetControlPoint(i);
+            values.insert(values.end(),point.begin(),point.end());
+        }
+        pathXml->LinkEndChild(XmlIOUtil::CreateXMLArrayElement("control_points",values,3));
+
+        values.clear();
+        values.reserve(10*path->GetPathPointNumber());
+        for(int i=0;i<path->GetPathPointNumber();i++)
+        {
+            PathElement::PathPoint pathPoint=path->GetPathPoint(i);
+            values.push_back(pathPoint.id);
+            values.insert(values.end(),pathPoint.pos.begin(),pathPoint.pos.end());
+            values.insert(values.end(),pathPoint.tangent.begin(),pathPoint.tangent.end());
+            values.insert(values.end(),pathPoint.rotation.begin(),pathPoint.rotation.end());
+        }
+        pathXml->LinkEndChild(XmlIOUtil::CreateXMLArrayElement("path_points",values,10));
+        return;
+    }
+
     auto  controlpointsElement = new TiXmlElement("control_points");
     pathXml->LinkEndChild(controlpointsElement);
     for(int i=0;i<path->GetControlPointNumber();i++)
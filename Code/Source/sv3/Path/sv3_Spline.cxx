@@ -44,6 +44,8 @@ using sv3::Spline;
 using sv3::VtkParametricSpline;
 Spline::Spline()
     : m_FurtherSubdivisionNumber(10)
+    , m_SegmentsClosed(false)
+    , m_SegmentsFurtherSubdivisionNumber(0)
 {
 }
 
@@ -51,6 +53,8 @@ Spline::Spline(bool closed, CalculationMethod method, int furtherSubdivisionNumb
     : m_Closed(closed)
     , m_Method(method)
     , m_FurtherSubdivisionNumber(furtherSubdivisionNumber)
+    , m_SegmentsClosed(false)
+    , m_SegmentsFurtherSubdivisionNumber(0)
 {
 }
 
@@ -171,11 +175,65 @@ double Spline::GetLength(VtkParametricSpline* svpp, double t1, double t2)
     return totalLength;
 }
 
+Spline::SegmentSignature Spline::GetSegmentSignature(VtkParametricSpline* svpp, int idx)
+{
+    SegmentSignature signature;
+    for(int k=0;k<4;k++)
+    {
+        std::array<double,3> point=GetPoint(svpp,idx+k/3.0);
+        signature[3*k]=point[0];
+        signature[3*k+1]=point[1];
+        signature[3*k+2]=point[2];
+    }
+    return signature;
+}
+
+std::vector<Spline::SplinePoint> Spline::CreateSegmentPoints(VtkParametricSpline* svpp, int idx, int interNumber)
+{
+    std::vector<SplinePoint> points;
+    points.reserve(interNumber);
+
+    cvMath *cMath = new cvMath();
+    SplinePoint splinePoint;
+    splinePoint.id=-1;
+    for(int j=0;j<interNumber;j++)
+    {
+        double tnew=idx+j*1.0/interNumber;
+        double tx=tnew+1.0/interNumber/m_FurtherSubdivisionNumber;
+
+        std::array<double,3> pt1=(j==0)?m_InputPoints[idx]:GetPoint(svpp,tnew);
+        std::array<double,3> ptx=GetPoint(svpp,tx);
+
+        splinePoint.pos=pt1;
+        for (int i=0;i<3;i++)
+            splinePoint.tangent[i]=ptx[i]-pt1[i];
+        double length = sqrt(pow(splinePoint.tangent[0],2)+pow(splinePoint.tangent[1],2)+pow(splinePoint.tangent[2],2));
+        for (int i = 0;i<3;i++)
+            splinePoint.tangent[i]/=length;
+        splinePoint.rotation= cMath->GetPerpendicularNormalVector(splinePoint.tangent);
+        points.push_back(splinePoint);
+    }
+    delete cMath;
+
+    return points;
+}
+
+void Spline::ClearCache()
+{
+    m_Segments.clear();
+}
+
 void Spline::Update()
 {
-    double length;
     m_SplinePoints.clear();
 
+    int inputPointNumber=m_InputPoints.size();
+    if(inputPointNumber==0)
+    {
+        m_Segments.clear();
+        return;
+    }
+
     VtkParametricSpline* svpp= new VtkParametricSpline();
     svpp->ParameterizeByLengthOff();
 
@@ -184,16 +242,12 @@ void Spline::Update()
     else
         svpp->ClosedOff();
 
-    int inputPointNumber=m_InputPoints.size();
     svpp->SetNumberOfPoints(inputPointNumber);
 
     for(int i=0;i<inputPointNumber;i++)
         svpp->SetPoint(i,m_InputPoints[i][0],m_InputPoints[i][1],m_InputPoints[i][2]);
 
-
-    SplinePoint splinePoint;
-    std::array<double,3>  pt1,ptx;
-    int interNumber;
+    int interNumber=0;
 
     switch(m_Method)
     {
@@ -209,79 +263,74 @@ void Spline::Update()
     default:
         break;
     }
-    int splinePointID=0;
-    for(int i=0;i<inputPointNumber;i++)
+
+    if(m_Closed!=m_SegmentsClosed || m_FurtherSubdivisionNumber!=m_SegmentsFurtherSubdivisionNumber)
     {
+        m_Segments.clear();
+        m_SegmentsClosed=m_Closed;
+        m_SegmentsFurtherSubdivisionNumber=m_FurtherSubdivisionNumber;
+    }
 
-        pt1=m_InputPoints[i];
+    // Sample each segment, reusing the points of segments whose curve did not
+    // change. Only segments still in use are kept for the next update.
+    std::map<SegmentSignature, SplineSegment> segments;
+    int segmentNumber=m_Closed?inputPointNumber:inputPointNumber-1;
+    for(int i=0;i<segmentNumber;i++)
+    {
+        SegmentSignature signature=GetSegmentSignature(svpp,i);
+        auto cached=m_Segments.find(signature);
+
+        double length=-1.0;
+        if(cached!=m_Segments.end())
+            length=cached->second.length;
 
         if(m_Method==CONSTANT_SPACING)
         {
-            if(i<inputPointNumber-1||m_Closed)
-            {
-                interNumber=std::ceil(GetLength(svpp,i,i+1)/m_Spacing);
-                if(interNumber<5) interNumber=5;//make sure not too small
-            }//otherwise interNumber not changes.It means using the previous value
+            if(length<0)
+                length=GetLength(svpp,i,i+1);
+            interNumber=std::ceil(length/m_Spacing);
+            if(interNumber<5) interNumber=5;//make sure not too small
         }
 
-        splinePoint.pos=pt1;
-       
-        if(i==inputPointNumber-1 &&!m_Closed)
+        SplineSegment& segment=segments[signature];
+        if(cached!=m_Segments.end() && cached->second.interNumber==interNumber)
+        {
+            segment=cached->second;
+        }
+        else
         {
-            double tx=i-1.0/interNumber/m_FurtherSubdivisionNumber;
-            ptx=GetPoint(svpp,tx);
-            splinePoint.id=splinePointID;
-            splinePointID++;
-            for (int i=0;i<3;i++)
-                splinePoint.tangent[i]=pt1[i]-ptx[i];
-            length = sqrt(pow(splinePoint.tangent[0],2)+pow(splinePoint.tangent[1],2)+pow(splinePoint.tangent[2],2));
-            for (int i = 0;i<3;i++)
-                splinePoint.tangent[i]/=length;
-            cvMath *cMath = new cvMath();
-            splinePoint.rotation= cMath->GetPerpendicularNormalVector(splinePoint.tangent);
-            delete cMath;
-            m_SplinePoints.push_back(splinePoint);
-            break;
+            segment.interNumber=interNumber;
+            segment.points=CreateSegmentPoints(svpp,i,interNumber);
         }
-        double txx=i+1.0/interNumber/m_FurtherSubdivisionNumber;
-        ptx=GetPoint(svpp,txx);
+        segment.length=length;
 
-        splinePoint.id=splinePointID;
-        splinePointID++;
+        m_SplinePoints.insert(m_SplinePoints.end(),segment.points.begin(),segment.points.end());
+    }
+
+    //the last point of an open spline uses the previous interNumber
+    if(!m_Closed)
+    {
+        int i=inputPointNumber-1;
+        double tx=i-1.0/interNumber/m_FurtherSubdivisionNumber;
+        std::array<double,3> pt1=m_InputPoints[i];
+        std::array<double,3> ptx=GetPoint(svpp,tx);
+
+        SplinePoint splinePoint;
+        splinePoint.pos=pt1;
         for (int i=0;i<3;i++)
-            splinePoint.tangent[i]=ptx[i]-pt1[i];
-        length = sqrt(pow(splinePoint.tangent[0],2)+pow(splinePoint.tangent[1],2)+pow(splinePoint.tangent[2],2));
+            splinePoint.tangent[i]=pt1[i]-ptx[i];
+        double length = sqrt(pow(splinePoint.tangent[0],2)+pow(splinePoint.tangent[1],2)+pow(splinePoint.tangent[2],2));
         for (int i = 0;i<3;i++)
             splinePoint.tangent[i]/=length;
         cvMath *cMath = new cvMath();
         splinePoint.rotation= cMath->GetPerpendicularNormalVector(splinePoint.tangent);
         delete cMath;
         m_SplinePoints.push_back(splinePoint);
-
-        for(int j=1;j<interNumber;j++)
-        {
-            double tnew=i+j*1.0/interNumber;
-            double tx=tnew+1.0/interNumber/m_FurtherSubdivisionNumber;
-
-            pt1=GetPoint(svpp,tnew);
-            ptx=GetPoint(svpp,tx);
-
-            splinePoint.id=splinePointID;
-            splinePointID++;
-            splinePoint.pos=pt1;
-            for (int i=0;i<3;i++)
-                splinePoint.tangent[i]=ptx[i]-pt1[i];
-            length = sqrt(pow(splinePoint.tangent[0],2)+pow(splinePoint.tangent[1],2)+pow(splinePoint.tangent[2],2));
-            for (int i = 0;i<3;i++)
-                splinePoint.tangent[i]/=length;
-            cvMath *cMath = new cvMath();
-            splinePoint.rotation= cMath->GetPerpendicularNormalVector(splinePoint.tangent);
-            delete cMath;
-            m_SplinePoints.push_back(splinePoint);
-        }
-        
-
-
     }
 
+    for(int i=0;i<m_SplinePoints.size();i++)
+        m_SplinePoints[i].id=i;
+
+    m_Segments.swap(segments);
+    svpp->Delete();
 }
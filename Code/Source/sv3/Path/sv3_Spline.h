@@ -37,6 +37,7 @@
 #include "sv3PathExports.h"
 #include "sv3_VtkParametricSpline.h"
 #include <array>
+#include <map>
 #include <vector>
 namespace sv3 {
 
@@ -88,7 +89,12 @@ public:
 
     std::vector<std::array<double,3> > GetSplinePosPoints();
 
+    // Recomputes the spline points. Segments whose curve is unchanged since the
+    // previous Update() are reused from a cache, so editing a single control point
+    // only re-samples the segments around it.
     void Update();
+
+    void ClearCache();
     
     double GetLength(VtkParametricSpline* svpp, double idx1, double idx2);
 
@@ -110,6 +116,27 @@ protected:
 
     std::vector<SplinePoint> m_SplinePoints;
 
+    // The spline curve of a segment is identified by its positions at four
+    // parameters, which determine the cubic.
+    typedef std::array<double,12> SegmentSignature;
+
+    struct SplineSegment
+    {
+        double length; // negative if not computed
+        int interNumber;
+        std::vector<SplinePoint> points;
+    };
+
+    SegmentSignature GetSegmentSignature(VtkParametricSpline* svpp, int idx);
+
+    std::vector<SplinePoint> CreateSegmentPoints(VtkParametricSpline* svpp, int idx, int interNumber);
+
+    std::map<SegmentSignature, SplineSegment> m_Segments;
+
+    bool m_SegmentsClosed;
+
+    int m_SegmentsFurtherSubdivisionNumber;
+
 };
 }
 #endif // SV3_SPLINE_H
@@ -106,9 +106,12 @@ void sv4guiMitkMeshIO::Write()
 {
     ValidateOutputLocation();
 
-    std::string fileName=GetOutputLocation();
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
 
-    const sv4guiMitkMesh* mitkMesh = dynamic_cast<const sv4guiMitkMesh*>(this->GetInput());
+void sv4guiMitkMeshIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiMitkMesh* mitkMesh = dynamic_cast<const sv4guiMitkMesh*>(data);
     if(!mitkMesh) return;
 
     TiXmlDocument document;
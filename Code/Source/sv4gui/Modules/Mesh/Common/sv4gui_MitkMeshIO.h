@@ -53,6 +53,7 @@ public:
     mitk::IFileIO::ConfidenceLevel GetReaderConfidenceLevel() const override;
 
     void Write() override;
+    static void WriteFile(const mitk::BaseData* data, std::string fileName);
     mitk::IFileIO::ConfidenceLevel GetWriterConfidenceLevel() const override;
 
     static sv4guiMitkMesh::Pointer ReadFromFile(std::string fileName, bool readSurfaceMesh, bool readVolumeMesh);
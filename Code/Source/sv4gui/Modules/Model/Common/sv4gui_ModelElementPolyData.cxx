@@ -225,15 +225,15 @@ bool sv4guiModelElementPolyData::RemeshFaces(std::vector<int> faceIDs, double si
     }
 
 #ifdef SV_USE_MMG
+    double hausd = 0.01;
+    double angle = 45.0;
+    double hgrad = 1.1;
+    vtkDoubleArray *meshSizingFunction = NULL;
+    int useSizingFunction = 0;
+    int numAddedRefines = 0;
+
     if (excluded->GetNumberOfIds() == m_Faces.size())
     {
-      double hausd = 0.01;
-      double angle = 45.0;
-      double hgrad = 1.1;
-      vtkDoubleArray *meshSizingFunction = NULL;
-      int useSizingFunction = 0;
-      int numAddedRefines = 0;
-
       if ( MMGUtils_SurfaceRemeshing( m_WholeVtkPolyData, size, size, hausd, angle, hgrad,
         useSizingFunction, meshSizingFunction, numAddedRefines) != SV_OK ) {
           fprintf(stderr,"Issue while remeshing surface\n");
@@ -242,7 +242,17 @@ bool sv4guiModelElementPolyData::RemeshFaces(std::vector<int> faceIDs, double si
       }
     else
     {
-#endif
+      //Selected faces are remeshed concurrently, excluded faces stay as is
+      vtkSmartPointer<vtkPolyData> facespd = vtkSmartPointer<vtkPolyData>::New();
+      facespd->DeepCopy(m_WholeVtkPolyData);
+      if ( MMGUtils_SurfaceRemeshingFaces( facespd, excluded, size, size, hausd,
+        useSizingFunction, meshSizingFunction) != SV_OK ) {
+          fprintf(stderr,"Issue while remeshing surface\n");
+          return false;
+        }
+      m_WholeVtkPolyData=facespd;
+    }
+#else
 
       int meshcaps = 1;
       int preserveedges = 0;
@@ -259,9 +269,6 @@ bool sv4guiModelElementPolyData::RemeshFaces(std::vector<int> faceIDs, double si
           fprintf(stderr,"Issue while remeshing surface\n");
           return false;
       }
-
-#ifdef SV_USE_MMG
-    }
 #endif
 
     //update all faces; some excluded faces may be remeshed
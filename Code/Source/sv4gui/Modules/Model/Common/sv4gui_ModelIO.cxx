@@ -346,9 +346,12 @@ void sv4guiModelIO::Write()
 {
     ValidateOutputLocation();
 
-    std::string fileName=GetOutputLocation();
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
 
-    const sv4guiModel* model = dynamic_cast<const sv4guiModel*>(this->GetInput());
+void sv4guiModelIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiModel* model = dynamic_cast<const sv4guiModel*>(data);
     if(!model) return;
 
     TiXmlDocument document;
@@ -38,8 +38,11 @@
 #include "sv4gui_MitkSeg3D.h"
 
 #include "SimVascular.h"
+#include "sv_geometry_cache.h"
+#include "sv_parallel_utils.h"
 #include "sv_sys_geom.h"
 #include "sv_vmtk_utils.h"
+#include "sv_vtk_utils.h"
 #include "sv_PolyData.h"
 #include "sv_polydatasolid_utils.h"
 
@@ -55,24 +58,41 @@
 
 #include "vtkXMLPolyDataWriter.h"
 
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+
+// Lofted vessels from CreateLoftSurfaces keyed by ComputeLoftHash. Oldest
+// entries are dropped first once the cache holds svLoftCacheSize lofts.
+static const int svLoftCacheSize = 256;
+static std::map<vtkTypeUInt64, vtkSmartPointer<vtkPolyData> > svLoftCache;
+static std::deque<vtkTypeUInt64> svLoftCacheOrder;
+static std::mutex svLoftCacheMutex;
+
 vtkPolyData* sv4guiModelUtils::CreatePolyData(std::vector<sv4guiContourGroup*> groups, std::vector<vtkPolyData*> vtps, int numSamplingPts, svLoftingParam *param, unsigned int t, int noInterOut, double tol)
 {
     int groupNumber=groups.size();
     int vtpNumber=vtps.size();
-    cvPolyData **srcs=new cvPolyData* [groupNumber+vtpNumber];
+    std::vector<vtkPolyData*> lofts=CreateLoftSurfaces(groups,numSamplingPts,1,param,t);
     for(int i=0;i<groupNumber;i++)
     {
-      sv4guiContourGroup* group=groups[i];
-      vtkPolyData *vtkpd = CreateLoftSurface(group,numSamplingPts,1,param,t);
-      if (vtkpd == NULL)
+      if (lofts[i] == NULL)
       {
-        for (int j=0; j< i-1; j++)
-          delete srcs[j];
-        delete [] srcs;
+        for (int j=0; j<groupNumber; j++)
+        {
+          if (lofts[j] != NULL)
+            lofts[j]->Delete();
+        }
         return NULL;
       }
-      srcs[i]=new cvPolyData(vtkpd);
-      vtkpd->Delete();
+    }
+
+    cvPolyData **srcs=new cvPolyData* [groupNumber+vtpNumber];
+    for(int i=0;i<groupNumber;i++)
+    {
+      srcs[i]=new cvPolyData(lofts[i]);
+      lofts[i]->Delete();
     }
 
     for(int i=0;i<vtpNumber;i++)
@@ -338,6 +358,139 @@ vtkPolyData* sv4guiModelUtils::CreateLoftSurface(sv4guiContourGroup* contourGrou
     return CreateLoftSurface(contourSet,numSamplingPts,usedParam,addCaps);
 }
 
+std::vector<vtkPolyData*> sv4guiModelUtils::CreateLoftSurfaces(std::vector<sv4guiContourGroup*> groups, int numSamplingPts, int addCaps, svLoftingParam* param, unsigned int t)
+{
+    int groupNumber=groups.size();
+    std::vector<vtkPolyData*> lofts(groupNumber,NULL);
+
+    // CreateLoftSurface writes the derived sampling sizes into the lofting
+    // parameters, so every vessel gets its own copy. The contour sets are
+    // gathered up front; the lofts themselves only read the contours.
+    std::vector<std::vector<sv4guiContour*> > contourSets(groupNumber);
+    std::vector<svLoftingParam> params(groupNumber);
+    std::vector<bool> hasParam(groupNumber,false);
+    for(int i=0;i<groupNumber;i++)
+    {
+        contourSets[i]=groups[i]->GetValidContourSet(t);
+        svLoftingParam* usedParam= groups[i]->GetLoftingParam();
+        if(param!=NULL) usedParam=param;
+        if(usedParam!=NULL)
+        {
+            params[i]=*usedParam;
+            hasParam[i]=true;
+        }
+    }
+
+    // Reuse the lofts of unchanged groups. The keys are computed before
+    // lofting since CreateLoftSurface modifies the parameters.
+    std::vector<vtkTypeUInt64> keys(groupNumber,0);
+    std::vector<int> toLoft;
+    {
+        std::lock_guard<std::mutex> lock(svLoftCacheMutex);
+        for(int i=0;i<groupNumber;i++)
+        {
+            if(!hasParam[i])
+            {
+                toLoft.push_back(i);
+                continue;
+            }
+            keys[i]=ComputeLoftHash(contourSets[i],numSamplingPts,&params[i],addCaps);
+            std::map<vtkTypeUInt64, vtkSmartPointer<vtkPolyData> >::iterator it=svLoftCache.find(keys[i]);
+            if(it==svLoftCache.end())
+            {
+                toLoft.push_back(i);
+                continue;
+            }
+            lofts[i]=vtkPolyData::New();
+            lofts[i]->DeepCopy(it->second);
+        }
+    }
+
+    std::vector<double> seconds(groupNumber,0.0);
+    ParallelUtils_For(toLoft.size(), [&](int n)
+    {
+        int i=toLoft[n];
+        std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+        lofts[i]=CreateLoftSurface(contourSets[i],numSamplingPts,hasParam[i] ? &params[i] : NULL,addCaps);
+        seconds[i]=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    });
+
+    std::lock_guard<std::mutex> lock(svLoftCacheMutex);
+    for(int n=0;n<toLoft.size();n++)
+    {
+        int i=toLoft[n];
+        MITK_INFO << "Lofted vessel " << i << " (" << contourSets[i].size() << " contours) in "
+                  << seconds[i] << " s" << (lofts[i]==NULL ? ", failed" : "");
+
+        if(lofts[i]==NULL || !hasParam[i] || svLoftCache.count(keys[i]))
+            continue;
+
+        vtkSmartPointer<vtkPolyData> cached=vtkSmartPointer<vtkPolyData>::New();
+        cached->DeepCopy(lofts[i]);
+        svLoftCache[keys[i]]=cached;
+        svLoftCacheOrder.push_back(keys[i]);
+        while((int)svLoftCacheOrder.size()>svLoftCacheSize)
+        {
+            svLoftCache.erase(svLoftCacheOrder.front());
+            svLoftCacheOrder.pop_front();
+        }
+    }
+    MITK_INFO << "Lofted " << toLoft.size() << " of " << groupNumber << " vessels, "
+              << groupNumber-toLoft.size() << " reused from the loft cache";
+
+    return lofts;
+}
+
+vtkTypeUInt64 sv4guiModelUtils::ComputeLoftHash(std::vector<sv4guiContour*> contourSet, int numSamplingPts, svLoftingParam* param, int addCaps)
+{
+    vtkTypeUInt64 hash=SV_HASH_SEED;
+
+    int contourNumber=contourSet.size();
+    hash=VtkUtils_HashBytes(&contourNumber,sizeof(int),hash);
+    for(int i=0;i<contourNumber;i++)
+    {
+        int pointNumber=contourSet[i]->GetContourPointNumber();
+        int closed=contourSet[i]->IsClosed() ? 1 : 0;
+        hash=VtkUtils_HashBytes(&pointNumber,sizeof(int),hash);
+        hash=VtkUtils_HashBytes(&closed,sizeof(int),hash);
+        for(int j=0;j<pointNumber;j++)
+        {
+            std::array<double,3> pt=contourSet[i]->sv3::Contour::GetContourPoint(j);
+            hash=VtkUtils_HashBytes(pt.data(),3*sizeof(double),hash);
+        }
+    }
+
+    hash=VtkUtils_HashBytes(&numSamplingPts,sizeof(int),hash);
+    hash=VtkUtils_HashBytes(&addCaps,sizeof(int),hash);
+
+    // Only the user settings; the sizes CreateLoftSurface derives from them
+    // are overwritten on every loft.
+    if(param!=NULL)
+    {
+        int intParams[]={param->numOutPtsInSegs, param->samplePerSegment,
+                         param->useLinearSampleAlongLength, param->linearMuliplier,
+                         param->useFFT, param->numModes, param->vecFlag,
+                         param->splineType, param->uDegree, param->vDegree};
+        double doubleParams[]={param->bias, param->tension, param->continuity};
+        hash=VtkUtils_HashString(param->method,hash);
+        hash=VtkUtils_HashBytes(intParams,sizeof(intParams),hash);
+        hash=VtkUtils_HashBytes(doubleParams,sizeof(doubleParams),hash);
+        hash=VtkUtils_HashString(param->uKnotSpanType,hash);
+        hash=VtkUtils_HashString(param->vKnotSpanType,hash);
+        hash=VtkUtils_HashString(param->uParametricSpanType,hash);
+        hash=VtkUtils_HashString(param->vParametricSpanType,hash);
+    }
+
+    return hash;
+}
+
+void sv4guiModelUtils::ClearLoftCache()
+{
+    std::lock_guard<std::mutex> lock(svLoftCacheMutex);
+    svLoftCache.clear();
+    svLoftCacheOrder.clear();
+}
+
 vtkPolyData* sv4guiModelUtils::CreateLoftSurface(std::vector<sv4guiContour*> contourSet, int numSamplingPts, svLoftingParam* param, int addCaps)
 {
     int contourNumber=contourSet.size();
@@ -1114,6 +1267,23 @@ vtkPolyData* sv4guiModelUtils::CreateCenterlines(vtkPolyData* inpd,
     if(inpd==NULL)
         return NULL;
 
+    // Centerlines of the same capped surface and end points are read back
+    // from the geometry cache
+    bool useCache=GeometryCache_IsEnabled();
+    vtkTypeUInt64 cacheKey=0;
+    if(useCache)
+    {
+        cacheKey=GeometryCache_GetSeed("centerlines");
+        cacheKey=VtkUtils_HashBytes(sourcePtIds->GetPointer(0), sourcePtIds->GetNumberOfIds()*sizeof(vtkIdType), cacheKey);
+        cacheKey=VtkUtils_HashBytes(targetPtIds->GetPointer(0), targetPtIds->GetNumberOfIds()*sizeof(vtkIdType), cacheKey);
+        cacheKey=VtkUtils_HashDataSet(inpd, cacheKey);
+
+        vtkPolyData* cachedCenterlines=vtkPolyData::New();
+        if(GeometryCache_Get("centerlines", cacheKey, cachedCenterlines)==SV_OK)
+            return cachedCenterlines;
+        cachedCenterlines->Delete();
+    }
+
     cvPolyData *src = new cvPolyData(inpd);
     cvPolyData *tempCenterlines = NULL;
     cvPolyData *voronoi = NULL;
@@ -1148,6 +1318,9 @@ vtkPolyData* sv4guiModelUtils::CreateCenterlines(vtkPolyData* inpd,
     }
     delete tempCenterlines;
 
+    if(useCache)
+        GeometryCache_Put("centerlines", cacheKey, centerlines->GetVtkPolyData());
+
     return centerlines->GetVtkPolyData();
 }
 
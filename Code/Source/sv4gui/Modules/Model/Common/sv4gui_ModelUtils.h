@@ -56,6 +56,16 @@ public:
 
     static vtkPolyData* CreateLoftSurface(std::vector<sv4guiContour*> contourSet, int numSamplingPts, svLoftingParam* param, int addCaps);
 
+    // Lofts each contour group concurrently. Entry i is the loft of groups[i],
+    // or NULL if that loft failed; the caller owns the returned surfaces.
+    // Lofts are cached by a hash of the contour points, lofting parameters
+    // and sampling, so only groups that changed since the last call re-loft.
+    static std::vector<vtkPolyData*> CreateLoftSurfaces(std::vector<sv4guiContourGroup*> groups, int numSamplingPts, int addCaps, svLoftingParam* param = NULL, unsigned int t = 0);
+
+    static vtkTypeUInt64 ComputeLoftHash(std::vector<sv4guiContour*> contourSet, int numSamplingPts, svLoftingParam* param, int addCaps);
+
+    static void ClearLoftCache();
+
     static vtkPolyData* CreateOrientOpenPolySolidVessel(vtkPolyData* inpd);
 
     static vtkPolyData* FillHoles(vtkPolyData* inpd);
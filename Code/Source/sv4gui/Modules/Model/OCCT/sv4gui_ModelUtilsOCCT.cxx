@@ -32,22 +32,50 @@
 #include "sv4gui_ModelUtilsOCCT.h"
 
 #include "SimVascular.h"
+#include "sv_parallel_utils.h"
 #include "sv_sys_geom.h"
 #include "sv_PolyData.h"
 #include "sv_polydatasolid_utils.h"
 
 #include "vtkSVGlobals.h"
 
-cvOCCTSolidModel* sv4guiModelUtilsOCCT::CreateLoftSurfaceOCCT(std::vector<sv4guiContour*> contourSet, std::string groupName, int numSamplingPts, svLoftingParam *param, int vecFlag, int addCaps)
+#include <chrono>
+#include <mutex>
+
+// Every cvOCCTSolidModel registers its shapes in the one global XCAF
+// document, which is not thread safe. Lofts run concurrently, so all calls
+// that create or modify OCCT solids hold this lock; the contour sampling and
+// NURBS fitting in between only use VTK and run unlocked.
+static std::mutex sv4guiOCCTDocumentMutex;
+
+// Set the parent group name on all faces of a lofted vessel
+static int sv4guiModelUtilsOCCT_SetFaceParents(cvOCCTSolidModel* solid, std::string groupName)
+{
+    int numFaces;
+    int *faces;
+    if(solid->GetFaceIds( &numFaces, &faces) != SV_OK )
+    {
+        MITK_ERROR << "GetFaceIds: error on object";
+        return SV_ERROR;
+    }
+
+    for(int i=0;i<numFaces;i++)
+    {
+        char* gn=const_cast<char*>(groupName.c_str());
+
+        solid->SetFaceAttribute("parent",faces[i],gn);
+    }
+
+    return SV_OK;
+}
+
+cvPolyData** sv4guiModelUtilsOCCT::SampleContoursOCCT(std::vector<sv4guiContour*> contourSet, int numSamplingPts, int vecFlag)
 {
     int contourNumber=contourSet.size();
 
     if(contourNumber==0 || numSamplingPts==0)
         return NULL;
 
-    if(param==NULL)
-        return NULL;
-
     int numSuperPts=0;
     for(int i=0;i<contourNumber;i++)
     {
@@ -127,6 +155,157 @@ cvOCCTSolidModel* sv4guiModelUtilsOCCT::CreateLoftSurfaceOCCT(std::vector<sv4gui
         sampledContours[i]=cvpd4;
     }
 
+    return sampledContours;
+}
+
+int sv4guiModelUtilsOCCT::FitBSplineSurfaceOCCT(cvPolyData **sampledContours, int contourNumber, int numSamplingPts, svLoftingParam *param, cvOCCTSolidModel::BSplineSurfaceData &surface)
+{
+    // Set degrees
+    int uDegree = param->uDegree;
+    int vDegree = param->vDegree;
+
+    // Need to return if contourNumber is too low
+    if (contourNumber < 3)
+    {
+      MITK_ERROR << "Not enough segmentations provided in group. Need at least 3";
+      return SV_ERROR;
+    }
+
+    // Override to maximum possible degree if too large a degree for given number of inputs!
+    if (uDegree > contourNumber)
+      uDegree = contourNumber;
+    if (vDegree > numSamplingPts)
+      vDegree = numSamplingPts;
+
+    // OpenCASCADE only handles surfaces of deg >= 3 currently
+    if (uDegree < 3)
+      uDegree = 3;
+    if (vDegree < 3)
+      vDegree = 3;
+
+    // Output spacing super larger because we don't actually use the polydata
+    double uSpacing = 0.8;
+    double vSpacing = 0.8;
+
+    // span types
+    const char *uKnotSpanType       = param->uKnotSpanType.c_str();
+    const char *vKnotSpanType       = param->vKnotSpanType.c_str();
+    const char *uParametricSpanType = param->uParametricSpanType.c_str();
+    const char *vParametricSpanType = param->vParametricSpanType.c_str();
+    vtkNew(vtkSVNURBSSurface, NURBSSurface);
+
+    cvPolyData *dst;
+    if ( sys_geom_loft_solid_with_nurbs(sampledContours, contourNumber,
+                                        uDegree, vDegree, uSpacing,
+                                        vSpacing, uKnotSpanType,
+                                        vKnotSpanType,
+                                        uParametricSpanType,
+                                        vParametricSpanType,
+                                        NURBSSurface,
+                                        &dst ) != SV_OK )
+    {
+        MITK_ERROR << "poly manipulation error ";
+        return SV_ERROR;
+    }
+    delete dst;
+
+    // Get multiplicities, then convert everything to double arrays
+    vtkNew(vtkDoubleArray, USingleKnotArray);
+    vtkNew(vtkIntArray,    UMultArray);
+    NURBSSurface->GetUMultiplicity(UMultArray, USingleKnotArray);
+    vtkNew(vtkDoubleArray, VSingleKnotArray);
+    vtkNew(vtkIntArray,    VMultArray);
+    NURBSSurface->GetVMultiplicity(VMultArray, VSingleKnotArray);
+    vtkSVControlGrid *controlPointGrid = NURBSSurface->GetControlPointGrid();
+
+    // Get all information needed by creation of bspline surface
+    int dims[3];
+    controlPointGrid->GetDimensions(dims);
+    surface.len1 = dims[0];
+    surface.len2 = dims[1];
+    surface.X.resize(dims[0]*dims[1]);
+    surface.Y.resize(dims[0]*dims[1]);
+    surface.Z.resize(dims[0]*dims[1]);
+    for (int i=0; i<dims[0]; i++)
+    {
+      for (int j=0; j<dims[1]; j++)
+      {
+        double pt[3];
+        double w;
+        controlPointGrid->GetControlPoint(i, j, 0, pt, w);
+        surface.X[i*dims[1]+j] = pt[0];
+        surface.Y[i*dims[1]+j] = pt[1];
+        surface.Z[i*dims[1]+j] = pt[2];
+      }
+    }
+
+    // Flipping order!
+    surface.uKnots.resize(VSingleKnotArray->GetNumberOfTuples());
+    for (int i=0; i<surface.uKnots.size(); i++)
+      surface.uKnots[i] = VSingleKnotArray->GetTuple1(i);
+
+    surface.vKnots.resize(USingleKnotArray->GetNumberOfTuples());
+    for (int i=0; i<surface.vKnots.size(); i++)
+      surface.vKnots[i] = USingleKnotArray->GetTuple1(i);
+
+    surface.uMults.resize(VMultArray->GetNumberOfTuples());
+    for (int i=0; i<surface.uMults.size(); i++)
+      surface.uMults[i] = VMultArray->GetTuple1(i);
+
+    surface.vMults.resize(UMultArray->GetNumberOfTuples());
+    for (int i=0; i<surface.vMults.size(); i++)
+      surface.vMults[i] = UMultArray->GetTuple1(i);
+
+    surface.p = vDegree;
+    surface.q = uDegree;
+
+    return SV_OK;
+}
+
+cvOCCTSolidModel* sv4guiModelUtilsOCCT::CreateLoftSurfaceOCCT(std::vector<sv4guiContour*> contourSet, std::string groupName, int numSamplingPts, svLoftingParam *param, int vecFlag, int addCaps)
+{
+    int contourNumber=contourSet.size();
+
+    if(contourNumber==0 || numSamplingPts==0)
+        return NULL;
+
+    if(param==NULL)
+        return NULL;
+
+    cvPolyData **sampledContours=SampleContoursOCCT(contourSet,numSamplingPts,vecFlag);
+    if(sampledContours==NULL)
+        return NULL;
+
+    cvOCCTSolidModel* surfFinal=NULL;
+
+    if (param->method=="nurbs")
+    {
+      cvOCCTSolidModel::BSplineSurfaceData surface;
+      int fitStatus=FitBSplineSurfaceOCCT(sampledContours,contourNumber,numSamplingPts,param,surface);
+      for (int j=0; j<contourNumber; j++)
+        delete sampledContours[j];
+      delete [] sampledContours;
+      if (fitStatus != SV_OK)
+        return NULL;
+
+      std::lock_guard<std::mutex> documentLock(sv4guiOCCTDocumentMutex);
+      surfFinal=new cvOCCTSolidModel();
+      if (cvOCCTSolidModel::CreateBSplineSurfaces(1,&surface,addCaps,&surfFinal) != SV_OK)
+      {
+          MITK_ERROR << "poly manipulation error ";
+          delete surfFinal;
+          return NULL;
+      }
+      if (sv4guiModelUtilsOCCT_SetFaceParents(surfFinal,groupName) != SV_OK)
+      {
+          delete surfFinal;
+          return NULL;
+      }
+      return surfFinal;
+    }
+
+    std::unique_lock<std::mutex> documentLock(sv4guiOCCTDocumentMutex);
+
     cvSolidModel **curveList=new cvSolidModel*[contourNumber];
     int closed=1;
     for(int i=0;i<contourNumber;i++)
@@ -153,195 +332,25 @@ cvOCCTSolidModel* sv4guiModelUtilsOCCT::CreateLoftSurfaceOCCT(std::vector<sv4gui
         curveList[i]=curve;
     }
 
-    cvOCCTSolidModel* surfFinal=NULL;
-
     cvOCCTSolidModel* surf=new cvOCCTSolidModel();
-    if(param->method=="spline")
+    int continuity=2;
+    int partype=0;
+    int smoothing=0;
+    double w1=1.0,w2=1.0,w3=1.0;
+    if ( surf->MakeLoftedSurf(curveList,contourNumber,"dummy_name",continuity,partype,w1,w2,w3,smoothing) != SV_OK )
     {
-      int continuity=2;
-      int partype=0;
-      int smoothing=0;
-      double w1=1.0,w2=1.0,w3=1.0;
-      if ( surf->MakeLoftedSurf(curveList,contourNumber,"dummy_name",continuity,partype,w1,w2,w3,smoothing) != SV_OK )
-      {
-          MITK_ERROR << "error in lofting surface. ";
-          for (int j=0; j<contourNumber; j++)
-          {
-            delete curveList[j];
-            delete sampledContours[j];
-          }
-          delete [] curveList;
-          delete [] sampledContours;
-          delete surf;
-          return NULL;
-      }
-      //delete curveList;
-    }
-    else if (param->method=="nurbs")
-    {
-      // Set degrees
-      int uDegree = param->uDegree;
-      int vDegree = param->vDegree;
-
-      // Need to return if contourNumber is too low
-      if (contourNumber < 3)
-      {
-        MITK_ERROR << "Not enough segmentations provided in group. Need at least 3";
-        return NULL;
-      }
-
-      // Override to maximum possible degree if too large a degree for given number of inputs!
-      if (uDegree > contourNumber)
-        uDegree = contourNumber;
-      if (vDegree > newNumSamplingPts)
-        vDegree = newNumSamplingPts;
-
-      // OpenCASCADE only handles surfaces of deg >= 3 currently
-      if (uDegree < 3)
-        uDegree = 3;
-      if (vDegree < 3)
-        vDegree = 3;
-
-      // Output spacing super larger because we don't actually use the polydata
-      double uSpacing = 0.8;
-      double vSpacing = 0.8;
-
-      // span types
-      const char *uKnotSpanType       = param->uKnotSpanType.c_str();
-      const char *vKnotSpanType       = param->vKnotSpanType.c_str();
-      const char *uParametricSpanType = param->uParametricSpanType.c_str();
-      const char *vParametricSpanType = param->vParametricSpanType.c_str();
-      vtkNew(vtkSVNURBSSurface, NURBSSurface);
-
-      cvPolyData *dst;
-      if ( sys_geom_loft_solid_with_nurbs(sampledContours, contourNumber,
-                                          uDegree, vDegree, uSpacing,
-                                          vSpacing, uKnotSpanType,
-                                          vKnotSpanType,
-                                          uParametricSpanType,
-                                          vParametricSpanType,
-                                          NURBSSurface,
-                                          &dst )
-           != SV_OK )
-      {
-          MITK_ERROR << "poly manipulation error ";
-          for (int j=0; j<contourNumber; j++)
-          {
-            delete curveList[j];
-            delete sampledContours[j];
-          }
-          delete [] curveList;
-          delete sampledContours;
-          delete surf;
-          return NULL;
-      }
-
-      // Get multiplicities, then convert everything to double arrays
-      vtkNew(vtkDoubleArray, USingleKnotArray);
-      vtkNew(vtkIntArray,    UMultArray);
-      NURBSSurface->GetUMultiplicity(UMultArray, USingleKnotArray);
-      vtkNew(vtkDoubleArray, VSingleKnotArray);
-      vtkNew(vtkIntArray,    VMultArray);
-      NURBSSurface->GetVMultiplicity(VMultArray, VSingleKnotArray);
-      vtkSVControlGrid *controlPointGrid = NURBSSurface->GetControlPointGrid();
-
-      // Get all information needed by creation of bspline surface
-      int dims[3];
-      controlPointGrid->GetDimensions(dims);
-      int Xlen1 = dims[0];
-      int Xlen2 = dims[1];
-      double **Xarr = new double*[Xlen1];
-      double **Yarr = new double*[Xlen1];
-      double **Zarr = new double*[Xlen1];
-      for (int i=0; i<Xlen1; i++)
-      {
-        Xarr[i] = new double[Xlen2];
-        Yarr[i] = new double[Xlen2];
-        Zarr[i] = new double[Xlen2];
-        for (int j=0; j<Xlen2; j++)
+        MITK_ERROR << "error in lofting surface. ";
+        for (int j=0; j<contourNumber; j++)
         {
-          double pt[3];
-          double w;
-          controlPointGrid->GetControlPoint(i, j, 0, pt, w);
-          Xarr[i][j] = pt[0];
-          Yarr[i][j] = pt[1];
-          Zarr[i][j] = pt[2];
+          delete curveList[j];
+          delete sampledContours[j];
         }
-      }
-
-      // Get mult information as arrays
-      int uKlen = USingleKnotArray->GetNumberOfTuples();
-      double *uKarr = new double[uKlen];
-      for (int i=0; i<uKlen; i++)
-        uKarr[i] = USingleKnotArray->GetTuple1(i);
-
-      int vKlen = VSingleKnotArray->GetNumberOfTuples();
-      double *vKarr = new double[vKlen];
-      for (int i=0; i<vKlen; i++)
-        vKarr[i] = VSingleKnotArray->GetTuple1(i);
-
-      int uMlen = UMultArray->GetNumberOfTuples();
-      double *uMarr = new double[uMlen];
-      for (int i=0; i<uMlen; i++)
-        uMarr[i] = UMultArray->GetTuple1(i);
-
-      int vMlen = VMultArray->GetNumberOfTuples();
-      double *vMarr = new double[vMlen];
-      for (int i=0; i<vMlen; i++)
-        vMarr[i] = VMultArray->GetTuple1(i);
-
-      // Flipping order!
-      if (surf->CreateBSplineSurface(Xarr, Yarr, Zarr,
-                                     Xlen1, Xlen2,
-                                     vKarr, vKlen,
-                                     uKarr, uKlen,
-                                     vMarr, vMlen,
-                                     uMarr, uMlen,
-                                     vDegree, uDegree) != SV_OK )
-      {
-          MITK_ERROR << "poly manipulation error ";
-          for (int j=0; j<contourNumber; j++)
-          {
-            delete curveList[j];
-            delete sampledContours[j];
-          }
-          delete [] curveList;
-          delete sampledContours;
-          delete surf;
-          //Clean up
-          for (int i=0;i<Xlen1;i++)
-          {
-            delete [] Xarr[i];
-            delete [] Yarr[i];
-            delete [] Zarr[i];
-          }
-          delete [] Xarr;
-          delete [] Yarr;
-          delete [] Zarr;
-
-          delete [] uKarr;
-          delete [] vKarr;
-          delete [] uMarr;
-          delete [] vMarr;
-          return NULL;
-      }
-      //Clean up
-      for (int i=0;i<Xlen1;i++)
-      {
-        delete [] Xarr[i];
-        delete [] Yarr[i];
-        delete [] Zarr[i];
-      }
-      delete [] Xarr;
-      delete [] Yarr;
-      delete [] Zarr;
-
-      delete [] uKarr;
-      delete [] vKarr;
-      delete [] uMarr;
-      delete [] vMarr;
-
+        delete [] curveList;
+        delete [] sampledContours;
+        delete surf;
+        return NULL;
     }
+    //delete curveList;
     surfFinal=surf;
 
     for (int j=0; j<contourNumber; j++)
@@ -350,7 +359,7 @@ cvOCCTSolidModel* sv4guiModelUtilsOCCT::CreateLoftSurfaceOCCT(std::vector<sv4gui
       delete sampledContours[j];
     }
     delete [] curveList;
-    delete sampledContours;
+    delete [] sampledContours;
 
     if(addCaps)
     {
@@ -365,28 +374,19 @@ cvOCCTSolidModel* sv4guiModelUtilsOCCT::CreateLoftSurfaceOCCT(std::vector<sv4gui
         surfFinal=surfCapped;
     }
 
-    int numFaces;
-    int *faces;
-    if(surfFinal->GetFaceIds( &numFaces, &faces) != SV_OK )
+    if (sv4guiModelUtilsOCCT_SetFaceParents(surfFinal,groupName) != SV_OK)
     {
-        MITK_ERROR << "GetFaceIds: error on object";
         delete surf;
         return NULL;
     }
 
-    for(int i=0;i<numFaces;i++)
-    {
-        char* gn=const_cast<char*>(groupName.c_str());
-
-        surfFinal->SetFaceAttribute("parent",faces[i],gn);
-    }
-
     return surfFinal;
 }
 
 sv4guiModelElementOCCT* sv4guiModelUtilsOCCT::CreateModelElementOCCT(std::vector<mitk::DataNode::Pointer> segNodes, int numSamplingPts,svLoftingParam *param, double maxDist, unsigned int t)
 {
-    std::vector<cvOCCTSolidModel*> loftedSolids;
+    std::vector<std::vector<sv4guiContour*> > contourSets;
+    std::vector<svLoftingParam*> usedParams;
     std::vector<std::string> segNames;
 
     for(int i=0;i<segNodes.size();i++)
@@ -395,35 +395,125 @@ sv4guiModelElementOCCT* sv4guiModelUtilsOCCT::CreateModelElementOCCT(std::vector
         sv4guiContourGroup* group = dynamic_cast<sv4guiContourGroup*>(segNode->GetData());
         if(group!=NULL)
         {
-            std::vector<sv4guiContour*> contourSet=group->GetValidContourSet(t);
-            std::string groupName=segNode->GetName();
-            segNames.push_back(groupName);
+            contourSets.push_back(group->GetValidContourSet(t));
+            segNames.push_back(segNode->GetName());
 
             svLoftingParam* usedParam= group->GetLoftingParam();
             if(param!=NULL) usedParam=param;
-
-            cvOCCTSolidModel* solid=CreateLoftSurfaceOCCT(contourSet,groupName,numSamplingPts,usedParam,0,1);
-            loftedSolids.push_back(solid);
-            if (solid == NULL)
-              return NULL;
+            usedParams.push_back(usedParam);
         }
     }
 
-    if(loftedSolids.size()==0)
+    int numVessels=contourSets.size();
+    if(numVessels==0)
         return NULL;
 
-    cvOCCTSolidModel* unionSolid=loftedSolids[0];
+    // Loft the vessels concurrently, CreateLoftSurfaceOCCT only reads the
+    // lofting parameters. NURBS vessels are only fitted here, their OCCT
+    // solids are then built together in one batch.
+    std::vector<cvOCCTSolidModel*> loftedSolids(numVessels,NULL);
+    std::vector<cvOCCTSolidModel::BSplineSurfaceData> nurbsSurfaces(numVessels);
+    std::vector<int> fitStatus(numVessels,SV_ERROR);
+    std::vector<double> seconds(numVessels,0.0);
+    ParallelUtils_For(numVessels, [&](int i)
+    {
+        std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+        if(usedParams[i]->method=="nurbs")
+        {
+            int contourNumber=contourSets[i].size();
+            cvPolyData **sampledContours=SampleContoursOCCT(contourSets[i],numSamplingPts,0);
+            if(sampledContours!=NULL)
+            {
+                fitStatus[i]=FitBSplineSurfaceOCCT(sampledContours,contourNumber,numSamplingPts,usedParams[i],nurbsSurfaces[i]);
+                for (int j=0; j<contourNumber; j++)
+                  delete sampledContours[j];
+                delete [] sampledContours;
+            }
+        }
+        else
+        {
+            loftedSolids[i]=CreateLoftSurfaceOCCT(contourSets[i],segNames[i],numSamplingPts,usedParams[i],0,1);
+        }
+        seconds[i]=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    });
 
-    cvOCCTSolidModel* previousUnionSolid=NULL;
+    std::vector<int> nurbsVessels;
+    for(int i=0;i<numVessels;i++)
+    {
+        if(usedParams[i]->method=="nurbs" && fitStatus[i]==SV_OK)
+            nurbsVessels.push_back(i);
+    }
+    if(nurbsVessels.size()>0)
+    {
+        std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+        std::vector<cvOCCTSolidModel::BSplineSurfaceData> batchSurfaces;
+        std::vector<cvOCCTSolidModel*> batchSolids;
+        for(int i=0;i<nurbsVessels.size();i++)
+        {
+            batchSurfaces.push_back(nurbsSurfaces[nurbsVessels[i]]);
+            batchSolids.push_back(new cvOCCTSolidModel());
+        }
+        if(cvOCCTSolidModel::CreateBSplineSurfaces(batchSurfaces.size(),&batchSurfaces[0],1,&batchSolids[0])==SV_OK)
+        {
+            for(int i=0;i<nurbsVessels.size();i++)
+            {
+                int vessel=nurbsVessels[i];
+                if(sv4guiModelUtilsOCCT_SetFaceParents(batchSolids[i],segNames[vessel])==SV_OK)
+                    loftedSolids[vessel]=batchSolids[i];
+                else
+                    delete batchSolids[i];
+            }
+        }
+        else
+        {
+            MITK_ERROR << "error in creating bspline surfaces ";
+            for(int i=0;i<batchSolids.size();i++)
+                delete batchSolids[i];
+        }
+        MITK_INFO << "Built " << nurbsVessels.size() << " bspline solids in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count() << " s";
+    }
+
+    for(int i=0;i<numVessels;i++)
+    {
+        MITK_INFO << "Lofted vessel " << segNames[i] << " in " << seconds[i] << " s"
+                  << (loftedSolids[i]==NULL ? ", failed" : "");
+    }
+    for(int i=0;i<numVessels;i++)
+    {
+        if (loftedSolids[i] == NULL)
+          return NULL;
+    }
+
+    // Union the vessels as a balanced tree so each fuse works on operands
+    // of similar size instead of growing one solid by a vessel at a time.
+    // The fuses are kept serial since they modify the shared OCCT document.
+    std::chrono::steady_clock::time_point unionStart=std::chrono::steady_clock::now();
+    std::vector<cvOCCTSolidModel*> level=loftedSolids;
     //    SolidModel_SimplifyT smp = SM_Simplify_All;
-    for(int i=1;i<loftedSolids.size();i++)
+    while(level.size()>1)
     {
-        previousUnionSolid=unionSolid;
-        unionSolid=new cvOCCTSolidModel();
-        unionSolid->Union(loftedSolids[i],previousUnionSolid);
-        //        delete previousUnionSolid;
-        //        delete loftedSolids[i];
+        std::vector<cvOCCTSolidModel*> nextLevel;
+        for(int i=0;i+1<level.size();i+=2)
+        {
+            cvOCCTSolidModel* pairUnion=new cvOCCTSolidModel();
+            if(pairUnion->Union(level[i+1],level[i])!=SV_OK)
+            {
+                MITK_ERROR << "Union: error on object";
+                delete pairUnion;
+                return NULL;
+            }
+            nextLevel.push_back(pairUnion);
+            //        delete level[i];
+            //        delete level[i+1];
+        }
+        if(level.size()%2==1)
+            nextLevel.push_back(level.back());
+        level=nextLevel;
     }
+    cvOCCTSolidModel* unionSolid=level[0];
+    MITK_INFO << "Unioned " << numVessels << " vessels in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now()-unionStart).count() << " s";
 
 
     //setup face names
@@ -44,6 +44,10 @@ class SV4GUIMODULEMODELOCCT_EXPORT sv4guiModelUtilsOCCT
 
 public:
 
+    static cvPolyData** SampleContoursOCCT(std::vector<sv4guiContour*> contourSet, int numSamplingPts, int vecFlag);
+
+    static int FitBSplineSurfaceOCCT(cvPolyData **sampledContours, int contourNumber, int numSamplingPts, svLoftingParam *param, cvOCCTSolidModel::BSplineSurfaceData &surface);
+
     static cvOCCTSolidModel* CreateLoftSurfaceOCCT(std::vector<sv4guiContour*> contourSet, std::string groupName, int numSamplingPts, svLoftingParam *param, int vecFlag, int addCaps);
 
     static sv4guiModelElementOCCT* CreateModelElementOCCT(std::vector<mitk::DataNode::Pointer> segNodes, int numSamplingPts, svLoftingParam *param, double maxDist = 20.0, unsigned int t = 0);
@@ -119,7 +119,12 @@ void sv4guiPathIO::Write()
 {
     ValidateOutputLocation();
 
-    const sv4guiPath* path = dynamic_cast<const sv4guiPath*>(this->GetInput());
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
+
+void sv4guiPathIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiPath* path = dynamic_cast<const sv4guiPath*>(data);
     if(!path) return;
     
     TiXmlDocument document;
@@ -153,10 +158,9 @@ void sv4guiPathIO::Write()
 
         sv3::PathElement* svPe=static_cast<sv3::PathElement*>(pe);
 
-        this->sv3::PathIO::WritePath(svPe,timestepElement); 
+        sv3::PathIO().WritePath(svPe,timestepElement);
     }
 
-    std::string fileName=GetOutputLocation();
     if (document.SaveFile(fileName) == false)
     {
         mitkThrow() << "Could not write path to " << fileName;
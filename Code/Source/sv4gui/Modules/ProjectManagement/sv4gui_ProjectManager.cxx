@@ -52,10 +52,19 @@
 #include "sv4gui_MitksvFSIJob.h"
 #include "sv4gui_MitkSimJob1d.h"
 #include "sv4gui_MitkMeshIO.h"
+#include "sv4gui_PathIO.h"
+#include "sv4gui_ContourGroupIO.h"
+#include "sv4gui_MitkSeg3DIO.h"
+#include "sv4gui_ModelIO.h"
+#include "sv4gui_MitkSimJobIO.h"
+#include "sv4gui_MitksvFSIJobIO.h"
+#include "sv4gui_MitkSimJobIO1d.h"
 #include "sv4gui_VtkUtils.h"
+#include "sv_parallel_utils.h"
 
 #include <mitkNodePredicateDataType.h>
 #include <mitkIOUtil.h>
+#include <mitkExceptionMacro.h>
 #include <mitkRenderingManager.h>
 #include <mitkCoreServices.h>
 #include <mitkIMimeTypeProvider.h>
@@ -74,8 +83,16 @@
 #include <QFile>
 #include <QTextStream>
 
+#include <tinyxml.h>
+
+#include <cstdio>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 // The sv4guiProjectManager class is used to manage SimVascular projects. 
 //
@@ -110,6 +127,150 @@
 //     1D Simulations: .s1djb
 //     svFSI: .fsijob
 // 
+//------------------
+// sv4guiProjectFile
+//------------------
+// A plugin file of an existing project. AddProject reads the files on
+// a thread pool and creates their data nodes afterwards, in order.
+//
+struct sv4guiProjectFile
+{
+    std::string filePath;
+    std::string extension;
+    std::string name;
+    mitk::DataNode::Pointer folderNode;
+    mitk::BaseData::Pointer data;
+    std::string error;
+};
+
+static void sv4guiProjectManager_ListFiles(QString projPath, QString folderName, QStringList nameFilters,
+                                           mitk::DataNode::Pointer folderNode, std::vector<sv4guiProjectFile>& projFiles)
+{
+    QDir dir(projPath);
+    dir.cd(folderName);
+    QFileInfoList fileInfoList=dir.entryInfoList(nameFilters, QDir::Files, QDir::Name);
+    for(int i=0;i<fileInfoList.size();i++)
+    {
+        sv4guiProjectFile projFile;
+        projFile.filePath=fileInfoList[i].absoluteFilePath().toStdString();
+        projFile.extension=fileInfoList[i].suffix().toStdString();
+        projFile.folderNode=folderNode;
+        projFiles.push_back(projFile);
+    }
+}
+
+//-------------------------------
+// sv4guiProjectManager_ReadFile
+//-------------------------------
+// Reads the data of a project file from a worker thread.
+//
+// Paths, contour groups, 3D segmentations and meshes are read directly
+// with their IO classes, mesh surfaces and volumes are still only read
+// when a plugin needs them. Models are only read here for PolyData
+// models, other solid kernels keep global state and are read on the
+// calling thread by LoadDataNode, as are simulation jobs. Images are
+// also read on the calling thread: the MITK readers report progress
+// through the global mitk::ProgressBar, a Qt widget. Their extension
+// is set to "image" since images outside the project may be in any
+// format MITK reads.
+//
+static void sv4guiProjectManager_ReadFile(sv4guiProjectFile& projFile)
+{
+    const std::string& filePath=projFile.filePath;
+    const std::string& extension=projFile.extension;
+    std::vector<mitk::BaseData::Pointer> vdata;
+
+    try
+    {
+        if(extension=="pth")
+        {
+            vdata=sv4guiPathIO::ReadFile(filePath);
+        }
+        else if(extension=="ctgr")
+        {
+            vdata=sv4guiContourGroupIO::ReadFile(filePath);
+        }
+        else if(extension=="s3d")
+        {
+            vdata=sv4guiMitkSeg3DIO::ReadFile(filePath);
+        }
+        else if(extension=="msh")
+        {
+            sv4guiMitkMesh::Pointer mitkMesh=sv4guiMitkMeshIO::ReadFromFile(filePath,false,false);
+            if(mitkMesh.IsNotNull())
+                vdata.push_back(mitkMesh.GetPointer());
+        }
+        else if(extension=="mdl")
+        {
+            TiXmlDocument document;
+            std::string modelType="";
+            if(document.LoadFile(filePath) && document.FirstChildElement("model"))
+                document.FirstChildElement("model")->QueryStringAttribute("type",&modelType);
+
+            if(modelType=="PolyData")
+                vdata=sv4guiModelIO::ReadFile(filePath);
+        }
+    }
+    catch(std::exception& e)
+    {
+        projFile.error=e.what();
+        return;
+    }
+    catch(...)
+    {
+        projFile.error="unknown error";
+        return;
+    }
+
+    if(vdata.size()>0)
+        projFile.data=vdata[0];
+}
+
+//---------------------------------------
+// sv4guiProjectManager_CreateDataNode
+//---------------------------------------
+// Creates a data node for data read from filePath, named and with
+// a path property as mitk::IOUtil::LoadDataNode does.
+//
+static mitk::DataNode::Pointer sv4guiProjectManager_CreateDataNode(mitk::BaseData::Pointer baseData, std::string filePath)
+{
+ mitk::DataNode::Pointer node = mitk::DataNode::New();
+ node->SetData(baseData);
+
+ // path
+ mitk::StringProperty::Pointer pathProp = mitk::StringProperty::New(itksys::SystemTools::GetFilenamePath(filePath));
+ node->SetProperty(mitk::StringProperty::PATH, pathProp);
+
+ // name already defined?
+ mitk::StringProperty::Pointer nameProp = dynamic_cast<mitk::StringProperty *>(node->GetProperty("name"));
+ if (nameProp.IsNull() || (strcmp(nameProp->GetValue(), "No Name!") == 0))
+ {
+   // name already defined in BaseData
+   mitk::StringProperty::Pointer baseDataNameProp =
+     dynamic_cast<mitk::StringProperty *>(node->GetData()->GetProperty("name").GetPointer());
+   if (baseDataNameProp.IsNull() || (strcmp(baseDataNameProp->GetValue(), "No Name!") == 0))
+   {
+     // name neither defined in node, nor in BaseData -> name = filename
+     nameProp = mitk::StringProperty::New(itksys::SystemTools::GetFilenameWithoutExtension(filePath));
+     node->SetProperty("name", nameProp);
+   }
+   else
+   {
+     // name defined in BaseData!
+     nameProp = mitk::StringProperty::New(baseDataNameProp->GetValue());
+     node->SetProperty("name", nameProp);
+   }
+ }
+
+ // visibility
+ if (!node->GetProperty("visible"))
+ {
+   node->SetVisibility(true);
+ }
+
+ return node;
+}
+
 //------------
 // AddProject
 //------------
@@ -268,90 +429,121 @@ void sv4guiProjectManager::AddProject(mitk::DataStorage::Pointer dataStorage, QS
 
     // Create the SV Data Manager plugin data nodes for an existing project.
     //
-    // Read in the files stored under plugin directories. 
+    // Read in the files stored under plugin directories. The files are
+    // read concurrently and the data nodes are then added to the data
+    // storage in the order the files were listed.
     //
     if(!newProject)
     {
+        std::vector<sv4guiProjectFile> projFiles;
 
-        // Create Images plugin data nodes.
-        //
         imageFolderNode->SetVisibility(false);
         for(int i=0;i<imageFilePathList.size();i++)
         {
-            std::string imageFilePath=imageFilePathList[i].toStdString();
+            sv4guiProjectFile projFile;
+            projFile.filePath=imageFilePathList[i].toStdString();
+            projFile.extension="image";
+            projFile.name=imageNameList[i].toStdString();
+            projFile.folderNode=imageFolderNode;
+            projFiles.push_back(projFile);
+        }
 
-            try{
-                //mitk::DataNode::Pointer imageNode=mitk::IOUtil::LoadDataNode(imageFilePath);
-                //            imageNode->SetVisibility(false);
-                mitk::DataNode::Pointer imageNode = sv4guiProjectManager::LoadDataNode(imageFilePath);
-                imageNode->SetName(imageNameList[i].toStdString());
+        pathFolderNode->SetVisibility(false);
+        sv4guiProjectManager_ListFiles(projPath, pathFolderName, QStringList("*.pth"), pathFolderNode, projFiles);
 
-                //do image transform stuff
-                mitk::Image* image=dynamic_cast<mitk::Image*>(imageNode->GetData());
-                setTransform(image, projPath.toStdString(), imageNode->GetName());
+        segFolderNode->SetVisibility(false);
+        QStringList segNameFilters;
+        segNameFilters<<"*.ctgr"<<"*.s3d";
+        sv4guiProjectManager_ListFiles(projPath, segFolderName, segNameFilters, segFolderNode, projFiles);
+
+        modelFolderNode->SetVisibility(false);
+        sv4guiProjectManager_ListFiles(projPath, modelFolderName, QStringList("*.mdl"), modelFolderNode, projFiles);
+
+        meshFolderNode->SetVisibility(false);
+        sv4guiProjectManager_ListFiles(projPath, meshFolderName, QStringList("*.msh"), meshFolderNode, projFiles);
 
-                dataStorage->Add(imageNode,imageFolderNode);
+        simFolderNode->SetVisibility(false);
+        sv4guiProjectManager_ListFiles(projPath, simFolderName, QStringList("*.sjb"), simFolderNode, projFiles);
+
+        svFSIFolderNode->SetVisibility(false);
+        sv4guiProjectManager_ListFiles(projPath, svFSIFolderName, QStringList("*.fsijob"), svFSIFolderNode, projFiles);
+
+        sim1dFolderNode->SetVisibility(false);
+        sv4guiProjectManager_ListFiles(projPath, sim1dFolderName, QStringList("*.s1djb"), sim1dFolderNode, projFiles);
+
+        ParallelUtils_For(projFiles.size(), [&](int i)
+        {
+            sv4guiProjectManager_ReadFile(projFiles[i]);
+        });
+
+        bool firstModel=true;
+        for(int i=0;i<projFiles.size();i++)
+        {
+            sv4guiProjectFile& projFile=projFiles[i];
+            const std::string& filePath=projFile.filePath;
+
+            if(projFile.error!="")
+            {
+                MITK_ERROR << "Failed to load file (maybe non-existing or unsupported data type): " << filePath << ": " << projFile.error;
+                continue;
+            }
+
+            mitk::DataNode::Pointer node=NULL;
+            try
+            {
+                if(projFile.data.IsNotNull())
+                    node=sv4guiProjectManager_CreateDataNode(projFile.data, filePath);
+                else
+                    node=LoadDataNode(filePath);
             }
             catch(...)
             {
-                MITK_ERROR << "Failed to load image (maybe non-existing or unsupported data type): " << imageFilePath;
+                node=NULL;
             }
-        }
 
-        // Create Paths plugin data nodes.
-        //
-        pathFolderNode->SetVisibility(false);
-        QDir dir1(projPath);
-        dir1.cd(pathFolderName);
-        QFileInfoList fileInfoList=dir1.entryInfoList(QStringList("*.pth"), QDir::Files, QDir::Name);
-        for(int i=0;i<fileInfoList.size();i++)
-        {
-            //mitk::DataNode::Pointer pathNode=mitk::IOUtil::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            mitk::DataNode::Pointer pathNode = sv4guiProjectManager::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            pathNode->SetVisibility(false);
+            if(node.IsNull())
+            {
+                MITK_ERROR << "Failed to load file (maybe non-existing or unsupported data type): " << filePath;
+                continue;
+            }
 
-            sv4guiPath* path=dynamic_cast<sv4guiPath*>(pathNode->GetData());
-            if(path)
+            if(projFile.extension=="image")
             {
-                auto props=path->GetProps();
-                auto it = props.begin();
-                while(it != props.end())
+                node->SetName(projFile.name);
+
+                //do image transform stuff
+                mitk::Image* image=dynamic_cast<mitk::Image*>(node->GetData());
+                setTransform(image, projPath.toStdString(), node->GetName());
+            }
+            else if(projFile.extension=="pth")
+            {
+                node->SetVisibility(false);
+
+                sv4guiPath* path=dynamic_cast<sv4guiPath*>(node->GetData());
+                if(path)
                 {
-                    if(it->first=="point 2D display size"
-                    || it->first=="point size")
+                    auto props=path->GetProps();
+                    auto it = props.begin();
+                    while(it != props.end())
                     {
-                        if(it->second!="")
+                        if(it->first=="point 2D display size"
+                        || it->first=="point size")
                         {
-                            float value=(float)(std::stod(it->second));
-                            pathNode->SetFloatProperty(it->first.c_str(),value);
+                            if(it->second!="")
+                            {
+                                float value=(float)(std::stod(it->second));
+                                node->SetFloatProperty(it->first.c_str(),value);
+                            }
                         }
+                        it++;
                     }
-                    it++;
                 }
             }
-
-            dataStorage->Add(pathNode,pathFolderNode);
-        }
-
-        // Create Segmentations plugin data nodes.
-        //
-        segFolderNode->SetVisibility(false);
-        QDir dirSeg(projPath);
-        dirSeg.cd(segFolderName);
-        QStringList segNameFilters;
-        segNameFilters<<"*.ctgr"<<"*.s3d";
-        fileInfoList=dirSeg.entryInfoList(segNameFilters, QDir::Files, QDir::Name);
-        for(int i=0;i<fileInfoList.size();i++)
-        {
-            std::string filePath=fileInfoList[i].absoluteFilePath().toStdString();
-
-            try
+            else if(projFile.extension=="ctgr" || projFile.extension=="s3d")
             {
-                //mitk::DataNode::Pointer segNode=mitk::IOUtil::LoadDataNode(filePath);
-                mitk::DataNode::Pointer segNode = sv4guiProjectManager::LoadDataNode(filePath);
-                segNode->SetVisibility(false);
+                node->SetVisibility(false);
 
-                sv4guiContourGroup* group=dynamic_cast<sv4guiContourGroup*>(segNode->GetData());
+                sv4guiContourGroup* group=dynamic_cast<sv4guiContourGroup*>(node->GetData());
                 if(group)
                 {
                     auto props=group->GetProps();
@@ -363,119 +555,30 @@ void sv4guiProjectManager::AddProject(mitk::DataStorage::Pointer dataStorage, QS
                             if(it->first=="point 2D display size")
                             {
                                 float value=(float)(std::stod(it->second));
-                                segNode->SetFloatProperty("point.displaysize",value);
+                                node->SetFloatProperty("point.displaysize",value);
                             }
                             else if(it->first=="point size")
                             {
                                 float value=(float)(std::stod(it->second));
-                                segNode->SetFloatProperty("point.3dsize",value);
+                                node->SetFloatProperty("point.3dsize",value);
                             }
                         }
 
                         it++;
                     }
                 }
-
-                dataStorage->Add(segNode,segFolderNode);
-            }
-            catch(...)
-            {
-                MITK_ERROR << "Failed to load file (maybe unsupported data type): " << filePath;
-            }
-        }
-
-        // Create Model plugin data nodes.
-        //
-        modelFolderNode->SetVisibility(false);
-        QDir dirModel(projPath);
-        dirModel.cd(modelFolderName);
-        fileInfoList=dirModel.entryInfoList(QStringList("*.mdl"), QDir::Files, QDir::Name);
-        bool firstModel=true;
-        for(int i=0;i<fileInfoList.size();i++)
-        {
-            std::string filePath=fileInfoList[i].absoluteFilePath().toStdString();
-
-            try
-            {
-                //mitk::DataNode::Pointer modelNode=mitk::IOUtil::LoadDataNode(filePath);
-                mitk::DataNode::Pointer modelNode = sv4guiProjectManager::LoadDataNode(filePath);
-                if(firstModel)
-                {
-                    modelNode->SetVisibility(true);
-                    firstModel=false;
-                }
-                else
-                    modelNode->SetVisibility(false);
-
-                dataStorage->Add(modelNode,modelFolderNode);
             }
-            catch(...)
+            else if(projFile.extension=="mdl")
             {
-                MITK_ERROR << "Failed to load file (maybe unsupported data type): " << filePath;
+                node->SetVisibility(firstModel);
+                firstModel=false;
             }
-        }
-
-        // Create Meshes plugin data nodes.
-        //
-        meshFolderNode->SetVisibility(false);
-        QDir dirMesh(projPath);
-        dirMesh.cd(meshFolderName);
-        fileInfoList=dirMesh.entryInfoList(QStringList("*.msh"), QDir::Files, QDir::Name);
-        for(int i=0;i<fileInfoList.size();i++)
-        {
-            std::string filePath=fileInfoList[i].absoluteFilePath().toStdString();
-            try
-            {
-            //mitk::DataNode::Pointer meshNode=mitk::IOUtil::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            mitk::DataNode::Pointer meshNode = sv4guiProjectManager::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            meshNode->SetVisibility(false);
-            dataStorage->Add(meshNode,meshFolderNode);
-            }
-            catch(...)
+            else
             {
-                MITK_ERROR << "Failed to load file (maybe unsupported data type): " << filePath;
+                node->SetVisibility(false);
             }
-        }
 
-        // Create Simulations plugin data nodes.
-        //
-        simFolderNode->SetVisibility(false);
-        QDir dirSim(projPath);
-        dirSim.cd(simFolderName);
-        fileInfoList=dirSim.entryInfoList(QStringList("*.sjb"), QDir::Files, QDir::Name);
-        for(int i=0;i<fileInfoList.size();i++)
-        {
-            //mitk::DataNode::Pointer jobNode=mitk::IOUtil::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            mitk::DataNode::Pointer jobNode = sv4guiProjectManager::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            jobNode->SetVisibility(false);
-            dataStorage->Add(jobNode,simFolderNode);
-        }
-
-        // Create svFSI plugin data nodes.
-        //
-        svFSIFolderNode->SetVisibility(false);
-        QDir dirsvFSI(projPath);
-        dirsvFSI.cd(svFSIFolderName);
-        fileInfoList = dirsvFSI.entryInfoList(QStringList("*.fsijob"), QDir::Files, QDir::Name);
-        for(int i=0;i<fileInfoList.size();i++) {
-            //mitk::DataNode::Pointer jobNode=mitk::IOUtil::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            mitk::DataNode::Pointer jobNode = sv4guiProjectManager::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            jobNode->SetVisibility(false);
-            dataStorage->Add(jobNode,svFSIFolderNode);
-        }
-
-        // Create Simulations1d plugin data nodes.
-        //
-        sim1dFolderNode->SetVisibility(false);
-        QDir dirSim1d(projPath);
-        dirSim1d.cd(sim1dFolderName);
-        fileInfoList=dirSim1d.entryInfoList(QStringList("*.s1djb"), QDir::Files, QDir::Name);
-        for(int i=0;i<fileInfoList.size();i++)
-        {
-            //mitk::DataNode::Pointer jobNode=mitk::IOUtil::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            mitk::DataNode::Pointer jobNode = sv4guiProjectManager::LoadDataNode(fileInfoList[i].absoluteFilePath().toStdString());
-            jobNode->SetVisibility(false);
-            dataStorage->Add(jobNode,sim1dFolderNode);
+            dataStorage->Add(node,projFile.folderNode);
         }
     }
 
@@ -483,6 +586,25 @@ void sv4guiProjectManager::AddProject(mitk::DataStorage::Pointer dataStorage, QS
 
 }
 
+//--------------
+// CloseProject
+//--------------
+// Remove a project and its data nodes from the data storage.
+//
+void sv4guiProjectManager::CloseProject(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode)
+{
+    // Finish the pending writes first; failures are kept for
+    // TakeFailedSaves even though their nodes go away.
+    WaitForSaves();
+
+    mitk::DataStorage::SetOfObjects::ConstPointer nodesToRemove=dataStorage->GetDerivations(projFolderNode,nullptr,false);
+    if( !nodesToRemove->empty())
+    {
+        dataStorage->Remove(nodesToRemove);
+    }
+    dataStorage->Remove(projFolderNode);
+}
+
 void sv4guiProjectManager::WriteEmptyConfigFile(QString projConfigFilePath)
 {
     QDomDocument doc;
@@ -781,9 +903,211 @@ void sv4guiProjectManager::setTransform(mitk::Image* image, std::string proj_pat
   }
 }
 
+//-----------------------
+// sv4guiProjectSaveJob
+//-----------------------
+// A file SaveProject writes. The data of background jobs is a copy of
+// the node data, so the GUI can keep changing the node meanwhile. If
+// writing fails, markModified flags the node data again on the GUI
+// thread so that the next save retries it.
+//
+struct sv4guiProjectSaveJob
+{
+    sv4guiProjectSaveJob(mitk::BaseData::Pointer data, QString dirPath, std::string name, std::string extension, std::function<void()> markModified)
+        : data(data), dirPath(dirPath), name(name), extension(extension), markModified(markModified) {}
+
+    mitk::BaseData::Pointer data;
+    QString dirPath;
+    std::string name;
+    std::string extension;
+    std::function<void()> markModified;
+};
+
+struct sv4guiProjectSaveBatch
+{
+    std::vector<sv4guiProjectSaveJob> jobs;
+    QStringList removeFiles;
+};
+
+// Batches are written one after the other, each on the thread pool.
+// The future is declared last so that, at exit, it is destroyed first
+// and waits for the pending writes while the other statics still exist.
+// Failed jobs are taken back on the GUI thread; the files they should
+// have written are kept until TakeFailedSaves reports them.
+static std::mutex sv4guiProjectSaveMutex;
+static std::vector<sv4guiProjectSaveJob> sv4guiProjectFailedSaves;
+static QStringList sv4guiProjectUnreportedSaves;
+static std::shared_future<void> sv4guiProjectSaveFuture;
+
+static bool sv4guiProjectManager_ReplaceFile(const QString& srcPath, const QString& dstPath)
+{
+#ifdef WIN32
+    // rename does not replace existing files on Windows
+    QFile::remove(dstPath);
+    return QFile::rename(srcPath, dstPath);
+#else
+    return std::rename(QFile::encodeName(srcPath).constData(), QFile::encodeName(dstPath).constData())==0;
+#endif
+}
+
+//---------------------------------
+// sv4guiProjectManager_WriteData
+//---------------------------------
+// Writes data with the static WriteFile function of its IO class.
+// mitk::IOUtil::Save is not used since it goes through the MITK writer
+// registry and the global mitk::ProgressBar, a Qt widget, and the jobs
+// are written on worker threads.
+//
+static void sv4guiProjectManager_WriteData(const mitk::BaseData* data, const std::string& extension, const std::string& fileName)
+{
+    if(extension=="pth")
+        sv4guiPathIO::WriteFile(data,fileName);
+    else if(extension=="ctgr")
+        sv4guiContourGroupIO::WriteFile(data,fileName);
+    else if(extension=="s3d")
+        sv4guiMitkSeg3DIO::WriteFile(data,fileName);
+    else if(extension=="mdl")
+        sv4guiModelIO::WriteFile(data,fileName);
+    else if(extension=="msh")
+        sv4guiMitkMeshIO::WriteFile(data,fileName);
+    else if(extension=="sjb")
+        sv4guiMitkSimJobIO::WriteFile(data,fileName);
+    else if(extension=="fsijob")
+        sv4guiMitksvFSIJobIO::WriteFile(data,fileName);
+    else if(extension=="s1djb")
+        sv4guiMitkSimJobIO1d::WriteFile(data,fileName);
+    else
+        mitkThrow() << "No writer for ." << extension << " files";
+}
+
+//---------------------------------
+// sv4guiProjectManager_WriteFile
+//---------------------------------
+// Writes the job data into a scratch directory and then renames the
+// file, and the files its writer put next to it (e.g. .vtp, .vtu or
+// .brep), over the project files. An interrupted save leaves the
+// previous files intact.
+//
+static bool sv4guiProjectManager_WriteFile(const sv4guiProjectSaveJob& job)
+{
+    QString tmpDirName=".svsave/"+QString::fromStdString(job.name);
+    QDir dir(job.dirPath);
+    dir.mkpath(tmpDirName);
+    QDir tmpDir(dir.absoluteFilePath(tmpDirName));
+
+    bool success=true;
+    try
+    {
+        sv4guiProjectManager_WriteData(job.data,job.extension,tmpDir.absoluteFilePath(QString::fromStdString(job.name+"."+job.extension)).toStdString());
+    }
+    catch(std::exception& e)
+    {
+        MITK_ERROR << "Failed to save " << job.name << "." << job.extension << ": " << e.what();
+        success=false;
+    }
+
+    QStringList fileNames=tmpDir.entryList(QDir::Files);
+    for(int i=0;i<fileNames.size();i++)
+    {
+        if(success && !sv4guiProjectManager_ReplaceFile(tmpDir.absoluteFilePath(fileNames[i]), dir.absoluteFilePath(fileNames[i])))
+        {
+            MITK_ERROR << "Failed to replace " << dir.absoluteFilePath(fileNames[i]).toStdString();
+            success=false;
+        }
+        tmpDir.remove(fileNames[i]);
+    }
+    dir.rmdir(tmpDirName);
+    dir.rmdir(".svsave");
+
+    return success;
+}
+
+static void sv4guiProjectManager_SubmitSaves(sv4guiProjectSaveBatch& batch)
+{
+    if(batch.jobs.size()==0 && batch.removeFiles.size()==0)
+        return;
+
+    std::shared_ptr<sv4guiProjectSaveBatch> pending=std::make_shared<sv4guiProjectSaveBatch>();
+    pending->jobs.swap(batch.jobs);
+    pending->removeFiles=batch.removeFiles;
+
+    std::lock_guard<std::mutex> lock(sv4guiProjectSaveMutex);
+    std::shared_future<void> previous=sv4guiProjectSaveFuture;
+    sv4guiProjectSaveFuture=std::async(std::launch::async, [previous,pending]()
+    {
+        if(previous.valid())
+            previous.wait();
+
+        for(int i=0;i<pending->removeFiles.size();i++)
+            QFile::remove(pending->removeFiles[i]);
+
+        ParallelUtils_For(pending->jobs.size(), [&](int i)
+        {
+            if(!sv4guiProjectManager_WriteFile(pending->jobs[i]))
+            {
+                std::lock_guard<std::mutex> failedLock(sv4guiProjectSaveMutex);
+                sv4guiProjectFailedSaves.push_back(pending->jobs[i]);
+            }
+        });
+    }).share();
+}
+
+static void sv4guiProjectManager_MarkFailedSaves()
+{
+    std::vector<sv4guiProjectSaveJob> failedSaves;
+    {
+        std::lock_guard<std::mutex> lock(sv4guiProjectSaveMutex);
+        failedSaves.swap(sv4guiProjectFailedSaves);
+    }
+
+    for(int i=0;i<failedSaves.size();i++)
+    {
+        failedSaves[i].markModified();
+        sv4guiProjectUnreportedSaves<<QDir(failedSaves[i].dirPath).absoluteFilePath(QString::fromStdString(failedSaves[i].name+"."+failedSaves[i].extension));
+    }
+}
+
+//--------------
+// WaitForSaves
+//--------------
+// SaveProject only copies the modified data and returns, the files are
+// written in the background. Wait for them before using the project
+// directory, e.g. to copy it.
+//
+void sv4guiProjectManager::WaitForSaves()
+{
+    std::shared_future<void> pending;
+    {
+        std::lock_guard<std::mutex> lock(sv4guiProjectSaveMutex);
+        pending=sv4guiProjectSaveFuture;
+    }
+
+    if(pending.valid())
+        pending.wait();
+
+    sv4guiProjectManager_MarkFailedSaves();
+}
+
+//-----------------
+// TakeFailedSaves
+//-----------------
+// Returns the files that failed to save since the last call. Their
+// data is flagged modified again, so the next save retries them, but
+// the GUI should tell the user, e.g. after saving or closing a project.
+//
+QStringList sv4guiProjectManager::TakeFailedSaves()
+{
+    sv4guiProjectManager_MarkFailedSaves();
+
+    QStringList failedFiles;
+    failedFiles.swap(sv4guiProjectUnreportedSaves);
+    return failedFiles;
+}
+
 void sv4guiProjectManager::SaveProjectAs(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode, QString saveFilePath)
 {
     SaveProject(dataStorage,projFolderNode);
+    WaitForSaves();
 
     std::string projPath;
     projFolderNode->GetStringProperty("project path",projPath);
@@ -795,6 +1119,11 @@ void sv4guiProjectManager::SaveProjectAs(mitk::DataStorage::Pointer dataStorage,
 
 void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode)
 {
+    // Take back the data of files that failed to save in the background.
+    sv4guiProjectManager_MarkFailedSaves();
+
+    sv4guiProjectSaveBatch batch;
+    std::vector<sv4guiProjectSaveJob> syncJobs;
     std::vector<std::string> removeList;
 
     std::string projPath;
@@ -829,8 +1158,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         if(path==NULL || (!path->IsDataModified() && dir.exists(QString::fromStdString(node->GetName())+".pth")) )
             continue;
 
-        QString	filePath=dir.absoluteFilePath(QString::fromStdString(node->GetName())+".pth");
-        mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+        sv4guiPath::Pointer modifiedPath=path;
+        batch.jobs.push_back(sv4guiProjectSaveJob(path->Clone().GetPointer(), dir.absolutePath(), node->GetName(), "pth",
+                                                  [modifiedPath](){ modifiedPath->SetDataModified(true); }));
 
         node->SetStringProperty("path",dir.absolutePath().toStdString().c_str());
 
@@ -840,7 +1170,7 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
     //delete files using removeList
     for(int i=0;i<removeList.size();i++)
     {
-        dir.remove(QString::fromStdString(removeList[i])+".pth");
+        batch.removeFiles<<dir.absoluteFilePath(QString::fromStdString(removeList[i])+".pth");
     }
     pathFolder->ClearRemoveList();
 
@@ -881,8 +1211,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
             if(!contourGroup->IsDataModified() && dirSeg.exists(QString::fromStdString(node->GetName())+".ctgr") )
                 continue;
 
-            QString	filePath=dirSeg.absoluteFilePath(QString::fromStdString(node->GetName())+".ctgr");
-            mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+            sv4guiContourGroup::Pointer modifiedGroup=contourGroup;
+            batch.jobs.push_back(sv4guiProjectSaveJob(contourGroup->Clone().GetPointer(), dirSeg.absolutePath(), node->GetName(), "ctgr",
+                                                      [modifiedGroup](){ modifiedGroup->SetDataModified(true); }));
             node->SetStringProperty("path",dirSeg.absolutePath().toStdString().c_str());
             contourGroup->SetDataModified(false);
         }
@@ -892,8 +1223,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
             if(!mitkSeg3D->IsDataModified() && dirSeg.exists(QString::fromStdString(node->GetName())+".s3d") )
                 continue;
 
-            QString	filePath=dirSeg.absoluteFilePath(QString::fromStdString(node->GetName())+".s3d");
-            mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+            sv4guiMitkSeg3D::Pointer modifiedSeg3D=mitkSeg3D;
+            batch.jobs.push_back(sv4guiProjectSaveJob(mitkSeg3D->Clone().GetPointer(), dirSeg.absolutePath(), node->GetName(), "s3d",
+                                                      [modifiedSeg3D](){ modifiedSeg3D->SetDataModified(true); }));
             node->SetStringProperty("path",dirSeg.absolutePath().toStdString().c_str());
             mitkSeg3D->SetDataModified(false);
         }
@@ -901,9 +1233,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
 
     for(int i=0;i<removeList.size();i++)
     {
-        dirSeg.remove(QString::fromStdString(removeList[i])+".ctgr");
-        dirSeg.remove(QString::fromStdString(removeList[i])+".s3d");
-        dirSeg.remove(QString::fromStdString(removeList[i])+".vtp");
+        batch.removeFiles<<dirSeg.absoluteFilePath(QString::fromStdString(removeList[i])+".ctgr");
+        batch.removeFiles<<dirSeg.absoluteFilePath(QString::fromStdString(removeList[i])+".s3d");
+        batch.removeFiles<<dirSeg.absoluteFilePath(QString::fromStdString(removeList[i])+".vtp");
     }
     segFolder->ClearRemoveList();
 
@@ -936,8 +1268,15 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         if(model==NULL || (!model->IsDataModified() && dirModel.exists(QString::fromStdString(node->GetName())+".mdl")) )
             continue;
 
-        QString	filePath=dirModel.absoluteFilePath(QString::fromStdString(node->GetName())+".mdl");
-        mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+        // Solid kernel models share the kernel's global state with the
+        // GUI, so only PolyData models are written in the background.
+        sv4guiModel::Pointer modifiedModel=model;
+        if(model->GetType()=="PolyData")
+            batch.jobs.push_back(sv4guiProjectSaveJob(model->Clone().GetPointer(), dirModel.absolutePath(), node->GetName(), "mdl",
+                                                      [modifiedModel](){ modifiedModel->SetDataModified(true); }));
+        else
+            syncJobs.push_back(sv4guiProjectSaveJob(model, dirModel.absolutePath(), node->GetName(), "mdl",
+                                                    [modifiedModel](){ modifiedModel->SetDataModified(true); }));
 
         node->SetStringProperty("path",dirModel.absolutePath().toStdString().c_str());
 
@@ -946,10 +1285,10 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
 
     for(int i=0;i<removeList.size();i++)
     {
-        dirModel.remove(QString::fromStdString(removeList[i])+".mdl");
-        dirModel.remove(QString::fromStdString(removeList[i])+".vtp");
-        dirModel.remove(QString::fromStdString(removeList[i])+".brep");
-        dirModel.remove(QString::fromStdString(removeList[i])+".xmt_txt");
+        batch.removeFiles<<dirModel.absoluteFilePath(QString::fromStdString(removeList[i])+".mdl");
+        batch.removeFiles<<dirModel.absoluteFilePath(QString::fromStdString(removeList[i])+".vtp");
+        batch.removeFiles<<dirModel.absoluteFilePath(QString::fromStdString(removeList[i])+".brep");
+        batch.removeFiles<<dirModel.absoluteFilePath(QString::fromStdString(removeList[i])+".xmt_txt");
     }
     modelFolder->ClearRemoveList();
 
@@ -982,8 +1321,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         if(mitkMesh==NULL || (!mitkMesh->IsDataModified() && dirMesh.exists(QString::fromStdString(node->GetName())+".msh")) )
             continue;
 
-        QString	filePath=dirMesh.absoluteFilePath(QString::fromStdString(node->GetName())+".msh");
-        mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+        sv4guiMitkMesh::Pointer modifiedMesh=mitkMesh;
+        batch.jobs.push_back(sv4guiProjectSaveJob(mitkMesh->Clone().GetPointer(), dirMesh.absolutePath(), node->GetName(), "msh",
+                                                  [modifiedMesh](){ modifiedMesh->SetDataModified(true); }));
 
         node->SetStringProperty("path",dirMesh.absolutePath().toStdString().c_str());
 
@@ -992,10 +1332,10 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
 
     for(int i=0;i<removeList.size();i++)
     {
-        dirMesh.remove(QString::fromStdString(removeList[i])+".msh");
-        dirMesh.remove(QString::fromStdString(removeList[i])+".vtp");
-        dirMesh.remove(QString::fromStdString(removeList[i])+".vtu");
-        dirMesh.remove(QString::fromStdString(removeList[i])+".sms");
+        batch.removeFiles<<dirMesh.absoluteFilePath(QString::fromStdString(removeList[i])+".msh");
+        batch.removeFiles<<dirMesh.absoluteFilePath(QString::fromStdString(removeList[i])+".vtp");
+        batch.removeFiles<<dirMesh.absoluteFilePath(QString::fromStdString(removeList[i])+".vtu");
+        batch.removeFiles<<dirMesh.absoluteFilePath(QString::fromStdString(removeList[i])+".sms");
     }
     meshFolder->ClearRemoveList();
 
@@ -1028,8 +1368,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         if(mitkJob==NULL || (!mitkJob->IsDataModified() && dirSim.exists(QString::fromStdString(node->GetName())+".sjb")) )
             continue;
 
-        QString	filePath=dirSim.absoluteFilePath(QString::fromStdString(node->GetName())+".sjb");
-        mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+        sv4guiMitkSimJob::Pointer modifiedJob=mitkJob;
+        batch.jobs.push_back(sv4guiProjectSaveJob(mitkJob->Clone().GetPointer(), dirSim.absolutePath(), node->GetName(), "sjb",
+                                                  [modifiedJob](){ modifiedJob->SetDataModified(true); }));
 
         node->SetStringProperty("path",dirSim.absolutePath().toStdString().c_str());
 
@@ -1038,7 +1379,7 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
 
     for(int i=0;i<removeList.size();i++)
     {
-        dirSim.remove(QString::fromStdString(removeList[i])+".sjb");
+        batch.removeFiles<<dirSim.absoluteFilePath(QString::fromStdString(removeList[i])+".sjb");
     }
     simFolder->ClearRemoveList();
 
@@ -1070,8 +1411,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         if(mitkJob==NULL || (!mitkJob->IsDataModified() && dir1dSim.exists(QString::fromStdString(node->GetName())+".s1djb")) )
             continue;
 
-        QString	filePath=dir1dSim.absoluteFilePath(QString::fromStdString(node->GetName())+".s1djb");
-        mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+        sv4guiMitkSimJob1d::Pointer modifiedJob=mitkJob;
+        batch.jobs.push_back(sv4guiProjectSaveJob(mitkJob->Clone().GetPointer(), dir1dSim.absolutePath(), node->GetName(), "s1djb",
+                                                  [modifiedJob](){ modifiedJob->SetDataModified(true); }));
 
         node->SetStringProperty("path",dir1dSim.absolutePath().toStdString().c_str());
 
@@ -1080,7 +1422,7 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
 
     for(int i=0;i<removeList.size();i++)
     {
-        dirSim.remove(QString::fromStdString(removeList[i])+".s1djb");
+        batch.removeFiles<<dir1dSim.absoluteFilePath(QString::fromStdString(removeList[i])+".s1djb");
     }
     sim1dFolder->ClearRemoveList();
 
@@ -1114,8 +1456,9 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         if(mitkJob==NULL || (!mitkJob->IsDataModified() && dirFSI.exists(QString::fromStdString(node->GetName())+".fsijob")) )
             continue;
 
-        QString	filePath=dirFSI.absoluteFilePath(QString::fromStdString(node->GetName())+".fsijob");
-        mitk::IOUtil::Save(node->GetData(),filePath.toStdString());
+        sv4guiMitksvFSIJob::Pointer modifiedJob=mitkJob;
+        batch.jobs.push_back(sv4guiProjectSaveJob(mitkJob->Clone().GetPointer(), dirFSI.absolutePath(), node->GetName(), "fsijob",
+                                                  [modifiedJob](){ modifiedJob->SetDataModified(true); }));
 
         node->SetStringProperty("path",dirFSI.absolutePath().toStdString().c_str());
 
@@ -1124,9 +1467,26 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
 
     for(int i=0;i<removeList.size();i++)
     {
-        dirFSI.remove(QString::fromStdString(removeList[i])+".fsijob");
+        batch.removeFiles<<dirFSI.absoluteFilePath(QString::fromStdString(removeList[i])+".fsijob");
     }
     svFSIFolder->ClearRemoveList();
+
+    // Models that must be written on this thread go after the pending
+    // background saves, which may still write files with the same name.
+    if(syncJobs.size()>0)
+    {
+        WaitForSaves();
+        for(int i=0;i<syncJobs.size();i++)
+        {
+            if(!sv4guiProjectManager_WriteFile(syncJobs[i]))
+            {
+                std::lock_guard<std::mutex> lock(sv4guiProjectSaveMutex);
+                sv4guiProjectFailedSaves.push_back(syncJobs[i]);
+            }
+        }
+    }
+
+    sv4guiProjectManager_SubmitSaves(batch);
 }
 
 void sv4guiProjectManager::SaveAllProjects(mitk::DataStorage::Pointer dataStorage)
@@ -1205,43 +1565,7 @@ mitk::DataNode::Pointer sv4guiProjectManager::LoadDataNode(std::string filePath)
    return NULL;
  }
 
- mitk::BaseData::Pointer baseData = baseDataList.front();
-
- mitk::DataNode::Pointer node = mitk::DataNode::New();
- node->SetData(baseData);
-
- // path
- mitk::StringProperty::Pointer pathProp = mitk::StringProperty::New(itksys::SystemTools::GetFilenamePath(filePath));
- node->SetProperty(mitk::StringProperty::PATH, pathProp);
-
- // name already defined?
- mitk::StringProperty::Pointer nameProp = dynamic_cast<mitk::StringProperty *>(node->GetProperty("name"));
- if (nameProp.IsNull() || (strcmp(nameProp->GetValue(), "No Name!") == 0))
- {
-   // name already defined in BaseData
-   mitk::StringProperty::Pointer baseDataNameProp =
-     dynamic_cast<mitk::StringProperty *>(node->GetData()->GetProperty("name").GetPointer());
-   if (baseDataNameProp.IsNull() || (strcmp(baseDataNameProp->GetValue(), "No Name!") == 0))
-   {
-     // name neither defined in node, nor in BaseData -> name = filename
-     nameProp = mitk::StringProperty::New(itksys::SystemTools::GetFilenameWithoutExtension(filePath));
-     node->SetProperty("name", nameProp);
-   }
-   else
-   {
-     // name defined in BaseData!
-     nameProp = mitk::StringProperty::New(baseDataNameProp->GetValue());
-     node->SetProperty("name", nameProp);
-   }
- }
-
- // visibility
- if (!node->GetProperty("visible"))
- {
-   node->SetVisibility(true);
- }
-
- return node;
+ return sv4guiProjectManager_CreateDataNode(baseDataList.front(), filePath);
 }
 
 mitk::DataNode::Pointer sv4guiProjectManager::GetProjectFolderNode(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode)
@@ -1256,6 +1580,39 @@ mitk::DataNode::Pointer sv4guiProjectManager::GetProjectFolderNode(mitk::DataSto
     return projFolderNode;
 }
 
+//-------------------
+// GetCacheDirectory
+//-------------------
+// The geometry cache directory of the project that owns dataNode, the
+// .svcache folder of the project, or an empty string if the node is not
+// in a project. Centerlines, face detection and remeshing run in a
+// cvGeometryCacheScope of this directory so their results are kept with
+// the project they were computed for.
+//
+std::string sv4guiProjectManager::GetCacheDirectory(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode)
+{
+    if(dataNode.IsNull())
+        return "";
+
+    mitk::DataNode::Pointer projFolderNode=dataNode;
+    if(dynamic_cast<sv4guiProjectFolder*>(dataNode->GetData())==NULL)
+        projFolderNode=GetProjectFolderNode(dataStorage,dataNode);
+    if(projFolderNode.IsNull())
+        return "";
+
+    std::string projPath;
+    projFolderNode->GetStringProperty("project path",projPath);
+    if(projPath=="")
+        return "";
+
+    QDir dir(QString::fromStdString(projPath));
+    QString cacheFolderName=".svcache";
+    if(!dir.mkpath(cacheFolderName))
+        return "";
+
+    return dir.absoluteFilePath(cacheFolderName).toStdString();
+}
+
 void sv4guiProjectManager::AddDataNode(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode, mitk::DataNode::Pointer parentNode)
 {
     if(parentNode.IsNull())
@@ -1283,6 +1640,10 @@ void sv4guiProjectManager::RemoveDataNode(mitk::DataStorage::Pointer dataStorage
 
 void sv4guiProjectManager::RenameDataNode(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode, std::string newName)
 {
+    // The files are renamed below, so pending writes of the old files
+    // must finish first.
+    WaitForSaves();
+
     std::string name=dataNode->GetName();
 
     std::string path="";
@@ -1360,6 +1721,7 @@ void sv4guiProjectManager::RenameDataNode(mitk::DataStorage::Pointer dataStorage
 void sv4guiProjectManager::DuplicateProject(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode, QString newName)
 {
     SaveProject(dataStorage,projFolderNode);
+    WaitForSaves();
 
     std::string projPath;
     projFolderNode->GetStringProperty("project path",projPath);
@@ -1392,6 +1754,9 @@ bool sv4guiProjectManager::DuplicateDirRecursively(const QString &srcFilePath, c
         QDir sourceDir(srcFilePath);
         QStringList fileNames = sourceDir.entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
         foreach (const QString &fileName, fileNames) {
+            // The geometry cache stays with the original project
+            if (fileName == ".svcache")
+                continue;
             const QString newSrcFilePath
                     = srcFilePath + QLatin1Char('/') + fileName;
             const QString newTgtFilePath
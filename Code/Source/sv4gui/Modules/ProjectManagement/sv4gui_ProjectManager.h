@@ -41,6 +41,7 @@
 #include <mitkNodePredicateDataType.h>
 
 #include <QString>
+#include <QStringList>
 
 class SV4GUIMODULEPROJECTMANAGEMENT_EXPORT sv4guiProjectManager
 {
@@ -48,12 +49,15 @@ class SV4GUIMODULEPROJECTMANAGEMENT_EXPORT sv4guiProjectManager
 public:
 
     static void AddProject(mitk::DataStorage::Pointer dataStorage, QString projectName, QString projParentDir, bool newProject);
+    static void CloseProject(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode);
     static void WriteEmptyConfigFile(QString projConfigFilePath);
     static void AddImage(mitk::DataStorage::Pointer dataStorage, QString imageFilePath, mitk::DataNode::Pointer imageNode, mitk::DataNode::Pointer imageFolderNode, bool copyIntoProject, double scaleFactor, QString newImageName);
 
     static void SaveProject(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode);
     static void SaveProjectAs(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer projFolderNode, QString saveFilePath);
     static void SaveAllProjects(mitk::DataStorage::Pointer dataStorage);
+    static void WaitForSaves();
+    static QStringList TakeFailedSaves();
 
     static void writeTransformFile(mitk::Image* image, std::string imageParentPath, std::string imageName);
     static void setTransform(mitk::Image* image, std::string proj_path, std::string imageName);
@@ -61,6 +65,7 @@ public:
     static void LoadData(mitk::DataNode::Pointer dataNode);
     static mitk::DataNode::Pointer LoadDataNode(std::string filePath);
     static mitk::DataNode::Pointer GetProjectFolderNode(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode);
+    static std::string GetCacheDirectory(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode);
 
     static void AddDataNode(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer dataNode, mitk::DataNode::Pointer parentNode);
 
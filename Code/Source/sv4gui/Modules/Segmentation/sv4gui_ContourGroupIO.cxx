@@ -37,10 +37,63 @@
 #include "sv4gui_ContourSplinePolygon.h"
 #include "sv4gui_ContourTensionPolygon.h"
 #include "sv4gui_XmlIOUtil.h"
+#include "sv3_XmlIOUtil.h"
 
 #include <mitkCustomMimeType.h>
 #include <mitkIOMimeTypes.h>
 
+// Reads the points of a control_points/contour_points element, either from a
+// base64 array payload or from the per-point elements of older files.
+static std::vector<mitk::Point3D> sv4guiContourGroupIO_GetPoints(TiXmlElement* pointsElement)
+{
+    std::vector<mitk::Point3D> points;
+    if(sv3::XmlIOUtil::IsXMLArrayElement(pointsElement))
+    {
+        std::vector<double> values;
+        if(!sv3::XmlIOUtil::GetArray(pointsElement, 3, values))
+            mitkThrow() << "Invalid point data in " << pointsElement->Value();
+
+        points.resize(values.size()/3);
+        for(size_t i=0;i<points.size();i++)
+            points[i].FillPoint(&values[3*i]);
+
+        return points;
+    }
+
+    for( TiXmlElement* pointElement = pointsElement->FirstChildElement("point");
+         pointElement != nullptr;
+         pointElement = pointElement->NextSiblingElement("point") )
+    {
+        if (pointElement == nullptr)
+            continue;
+
+        points.push_back(sv4guiXmlIOUtil::GetPoint(pointElement));
+    }
+    return points;
+}
+
+static TiXmlElement* sv4guiContourGroupIO_CreatePointsElement(const char* name, const std::vector<mitk::Point3D>& points)
+{
+    if(sv3::XmlIOUtil::GetArrayEncoding())
+    {
+        std::vector<double> values(3*points.size());
+        for(size_t i=0;i<points.size();i++)
+        {
+            values[3*i]=points[i][0];
+            values[3*i+1]=points[i][1];
+            values[3*i+2]=points[i][2];
+        }
+        return sv3::XmlIOUtil::CreateXMLArrayElement(name,values,3);
+    }
+
+    auto  pointsElement = new TiXmlElement(name);
+    for(size_t i=0;i<points.size();i++)
+    {
+        pointsElement->LinkEndChild(sv4guiXmlIOUtil::CreateXMLPointElement("point",(int)i,points[i]));
+    }
+    return pointsElement;
+}
+
 static mitk::CustomMimeType Createsv4guiContourGroupMimeType()
 {
     mitk::CustomMimeType mimeType(mitk::IOMimeTypes::DEFAULT_BASE_NAME() + ".svcontourgroup");
@@ -237,16 +290,7 @@ std::vector<mitk::BaseData::Pointer> sv4guiContourGroupIO::ReadFile(std::string
             TiXmlElement* controlpointsElement = contourElement->FirstChildElement("control_points");
             if(controlpointsElement!=nullptr)
             {
-                std::vector<mitk::Point3D> controlPoints;
-                for( TiXmlElement* pointElement = controlpointsElement->FirstChildElement("point");
-                     pointElement != nullptr;
-                     pointElement = pointElement->NextSiblingElement("point") )
-                {
-                    if (pointElement == nullptr)
-                        continue;
-
-                    controlPoints.push_back(sv4guiXmlIOUtil::GetPoint(pointElement));
-                }
+                std::vector<mitk::Point3D> controlPoints=sv4guiContourGroupIO_GetPoints(controlpointsElement);
                 contour->SetControlPoints(controlPoints,false);
             }
 
@@ -254,16 +298,7 @@ std::vector<mitk::BaseData::Pointer> sv4guiContourGroupIO::ReadFile(std::string
             TiXmlElement* contourpointsElement = contourElement->FirstChildElement("contour_points");
             if(contourpointsElement!=nullptr)
             {
-                std::vector<mitk::Point3D> contourPoints;
-                for( TiXmlElement* pointElement = contourpointsElement->FirstChildElement("point");
-                     pointElement != nullptr;
-                     pointElement = pointElement->NextSiblingElement("point") )
-                {
-                    if (pointElement == nullptr)
-                        continue;
-
-                    contourPoints.push_back(sv4guiXmlIOUtil::GetPoint(pointElement));
-                }
+                std::vector<mitk::Point3D> contourPoints=sv4guiContourGroupIO_GetPoints(contourpointsElement);
                 contour->SetContourPoints(contourPoints,false);
                 contour->ContourPointsChanged(); // Calculate contour center.
             }
@@ -291,7 +326,12 @@ void sv4guiContourGroupIO::Write()
 {
     ValidateOutputLocation();
 
-    const sv4guiContourGroup* group = dynamic_cast<const sv4guiContourGroup*>(this->GetInput());
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
+
+void sv4guiContourGroupIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiContourGroup* group = dynamic_cast<const sv4guiContourGroup*>(data);
     if(!group) return;
 
     TiXmlDocument document;
@@ -380,26 +420,25 @@ void sv4guiContourGroupIO::Write()
             pathpointElement->LinkEndChild(sv4guiXmlIOUtil::CreateXMLVectorElement("rotation",contour->GetPathPoint().rotation));
 
             //control points
-            auto  controlpointsElement = new TiXmlElement("control_points");
-            contourElement->LinkEndChild(controlpointsElement);
+            std::vector<mitk::Point3D> controlPoints(contour->GetControlPointNumber());
             for(int j=0;j<contour->GetControlPointNumber();j++)
             {
-                controlpointsElement->LinkEndChild(sv4guiXmlIOUtil::CreateXMLPointElement("point",j,contour->GetControlPoint(j)));
+                controlPoints[j]=contour->GetControlPoint(j);
             }
+            contourElement->LinkEndChild(sv4guiContourGroupIO_CreatePointsElement("control_points",controlPoints));
 
             //contour points
-            auto  contourpointsElement = new TiXmlElement("contour_points");
-            contourElement->LinkEndChild(contourpointsElement);
+            std::vector<mitk::Point3D> contourPoints(contour->GetContourPointNumber());
             for(int j=0;j<contour->GetContourPointNumber();j++)
             {
-                contourpointsElement->LinkEndChild(sv4guiXmlIOUtil::CreateXMLPointElement("point",j,contour->GetContourPoint(j)));
+                contourPoints[j]=contour->GetContourPoint(j);
             }
+            contourElement->LinkEndChild(sv4guiContourGroupIO_CreatePointsElement("contour_points",contourPoints));
 
         }
 
     }
 
-    std::string fileName=GetOutputLocation();
     if (document.SaveFile(fileName) == false)
     {
         mitkThrow() << "Could not write contourgroup to " << fileName;
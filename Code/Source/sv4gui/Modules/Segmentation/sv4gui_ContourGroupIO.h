@@ -50,6 +50,7 @@ public:
     mitk::IFileIO::ConfidenceLevel GetReaderConfidenceLevel() const override;
 
     void Write() override;
+    static void WriteFile(const mitk::BaseData* data, std::string fileName);
     mitk::IFileIO::ConfidenceLevel GetWriterConfidenceLevel() const override;
 
 private:
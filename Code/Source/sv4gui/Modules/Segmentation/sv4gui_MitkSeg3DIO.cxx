@@ -158,9 +158,12 @@ void sv4guiMitkSeg3DIO::Write()
 {
     ValidateOutputLocation();
 
-    std::string fileName=GetOutputLocation();
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
 
-    const sv4guiMitkSeg3D* mitkSeg3D = dynamic_cast<const sv4guiMitkSeg3D*>(this->GetInput());
+void sv4guiMitkSeg3DIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiMitkSeg3D* mitkSeg3D = dynamic_cast<const sv4guiMitkSeg3D*>(data);
     if(!mitkSeg3D) return;
 
     TiXmlDocument document;
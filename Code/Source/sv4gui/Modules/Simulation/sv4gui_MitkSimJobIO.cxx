@@ -267,9 +267,12 @@ void sv4guiMitkSimJobIO::Write()
 {
     ValidateOutputLocation();
 
-    std::string fileName=GetOutputLocation();
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
 
-    const sv4guiMitkSimJob* mitkSimJob = dynamic_cast<const sv4guiMitkSimJob*>(this->GetInput());
+void sv4guiMitkSimJobIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiMitkSimJob* mitkSimJob = dynamic_cast<const sv4guiMitkSimJob*>(data);
     if(!mitkSimJob) return;
 
     TiXmlDocument document;
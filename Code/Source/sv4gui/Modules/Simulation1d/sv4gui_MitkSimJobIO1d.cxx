@@ -207,9 +207,12 @@ void sv4guiMitkSimJobIO1d::Write()
 {
     ValidateOutputLocation();
 
-    std::string fileName=GetOutputLocation();
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
 
-    const sv4guiMitkSimJob1d* mitkSimJob = dynamic_cast<const sv4guiMitkSimJob1d*>(this->GetInput());
+void sv4guiMitkSimJobIO1d::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiMitkSimJob1d* mitkSimJob = dynamic_cast<const sv4guiMitkSimJob1d*>(data);
     if(!mitkSimJob) return;
 
     TiXmlDocument document;
@@ -375,9 +375,12 @@ void sv4guiMitksvFSIJobIO::Write()
 {
     ValidateOutputLocation();
 
-    std::string fileName=GetOutputLocation();
+    WriteFile(this->GetInput(),GetOutputLocation());
+}
 
-    const sv4guiMitksvFSIJob* mitkSimJob = dynamic_cast<const sv4guiMitksvFSIJob*>(this->GetInput());
+void sv4guiMitksvFSIJobIO::WriteFile(const mitk::BaseData* data, std::string fileName)
+{
+    const sv4guiMitksvFSIJob* mitkSimJob = dynamic_cast<const sv4guiMitksvFSIJob*>(data);
     if(!mitkSimJob) return;
 
     TiXmlDocument document;
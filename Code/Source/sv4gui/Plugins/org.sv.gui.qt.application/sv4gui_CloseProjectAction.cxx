@@ -148,18 +148,15 @@ void sv4guiCloseProjectAction::Run()
           mitk::StatusBar::GetInstance()->DisplayText("Closing SV project...");
           QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
 
-          mitk::DataStorage::SetOfObjects::ConstPointer nodesToRemove=dataStorage->GetDerivations(selectedNode,nullptr,false);
-
-          if( !nodesToRemove->empty())
-          {
-              dataStorage->Remove(nodesToRemove);
-          }
-
-          dataStorage->Remove(selectedNode);
+          sv4guiProjectManager::CloseProject(dataStorage, selectedNode);
 
           mitk::ProgressBar::GetInstance()->Progress(2);
           mitk::StatusBar::GetInstance()->DisplayText("SV project closed.");
           QApplication::restoreOverrideCursor();
+
+          QStringList failedFiles=sv4guiProjectManager::TakeFailedSaves();
+          if(failedFiles.size()>0)
+              QMessageBox::warning(NULL,"Save Failed","The following project files could not be saved:\n"+failedFiles.join("\n"));
         }
 
     }
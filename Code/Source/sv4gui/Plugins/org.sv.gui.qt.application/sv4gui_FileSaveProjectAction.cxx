@@ -112,6 +112,10 @@ void sv4guiFileSaveProjectAction::Run()
         mitk::ProgressBar::GetInstance()->Progress(2);
         mitk::StatusBar::GetInstance()->DisplayText("SV projects saved.");
         QApplication::restoreOverrideCursor();
+
+        QStringList failedFiles=sv4guiProjectManager::TakeFailedSaves();
+        if(failedFiles.size()>0)
+            QMessageBox::warning(NULL,"Save Failed","The following project files could not be saved:\n"+failedFiles.join("\n"));
     }
     catch (std::exception& e)
     {
@@ -191,6 +191,10 @@ void sv4guiFileSaveProjectAsAction::Run()
           mitk::StatusBar::GetInstance()->DisplayText("SV project saved.");
           QApplication::restoreOverrideCursor();
 
+          QStringList failedFiles=sv4guiProjectManager::TakeFailedSaves();
+          if(failedFiles.size()>0)
+              QMessageBox::warning(NULL,"Save Failed","The following project files could not be saved:\n"+failedFiles.join("\n"));
+
         }
 
     }
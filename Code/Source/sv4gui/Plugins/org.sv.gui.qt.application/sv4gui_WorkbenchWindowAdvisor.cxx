@@ -1689,6 +1689,10 @@ void sv4guiWorkbenchWindowAdvisor::RenameSelectedNode( bool )
 
             sv4guiProjectManager::RenameDataNode(dataStorage,node,newName.toStdString());
 
+            QStringList failedFiles=sv4guiProjectManager::TakeFailedSaves();
+            if(failedFiles.size()>0)
+                QMessageBox::warning(NULL,"Save Failed","The following project files could not be saved:\n"+failedFiles.join("\n"));
+
         }
     }
 }
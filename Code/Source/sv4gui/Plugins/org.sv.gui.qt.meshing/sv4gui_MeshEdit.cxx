@@ -47,6 +47,8 @@
 
 #include "sv4gui_DataNodeOperation.h"
 
+#include "sv_geometry_cache.h"
+
 #include <berryIPreferencesService.h>
 #include <berryIPreferences.h>
 #include <berryPlatform.h>
@@ -764,6 +766,10 @@ void sv4guiMeshEdit::RunCommands(bool fromGUI)
         cmds=originalMesh->GetCommandHistory();
     }
 
+    // Remeshing and face detection results go to the cache of the project
+    // the mesh belongs to
+    cvGeometryCacheScope cacheScope(sv4guiProjectManager::GetCacheDirectory(GetDataStorage(),m_MeshNode));
+
     std::string msg;
     if(!newMesh->ExecuteCommands(cmds, msg))
     {
@@ -40,8 +40,10 @@
 #include "sv4gui_ModelElementAnalytic.h"
 #include "sv4gui_ModelExtractPathsAction.h"
 #include "sv4gui_QmitkDataManagerView.h"
+#include "sv4gui_ProjectManager.h"
 
 #include "sv_polydatasolid_utils.h"
+#include "sv_geometry_cache.h"
 
 #include <QmitkStdMultiWidgetEditor.h>
 #include <mitkNodePredicateDataType.h>
@@ -2046,6 +2048,8 @@ void sv4guiModelEdit::ModelOperate(int operationType)
     mitk::ProgressBar::GetInstance()->Progress();
     WaitCursorOn();
 
+    cvGeometryCacheScope cacheScope(sv4guiProjectManager::GetCacheDirectory(GetDataStorage(),m_ModelNode));
+
     switch(operationType)
     {
     case DELETE_FACES:
@@ -36,6 +36,8 @@
 #include "sv4gui_Model.h"
 #include "sv4gui_Path.h"
 #include "sv4gui_DataNodeOperation.h"
+#include "sv4gui_ProjectManager.h"
+#include "sv_geometry_cache.h"
 
 #include <mitkNodePredicateDataType.h>
 #include <mitkStatusBar.h>
@@ -133,7 +135,8 @@ void sv4guiModelExtractPathsAction::Run(const QList<mitk::DataNode::Pointer> &se
     }
 
     mitk::StatusBar::GetInstance()->DisplayText("Extracting paths from the model... ( may take several minutes or more)");
-    m_Thread=new WorkThread(m_DataStorage,selectedNode,m_SourceCapIds);
+    std::string cacheDir=sv4guiProjectManager::GetCacheDirectory(m_DataStorage,m_ProjFolderNode);
+    m_Thread=new WorkThread(m_DataStorage,selectedNode,m_SourceCapIds,cacheDir);
 
     connect(m_Thread, SIGNAL(finished()), this, SLOT(UpdateStatus()));
 
@@ -147,10 +150,11 @@ void sv4guiModelExtractPathsAction::SetDataStorage(mitk::DataStorage *dataStorag
     m_DataStorage = dataStorage;
 }
 
-sv4guiModelExtractPathsAction::WorkThread::WorkThread(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer selectedNode, std::vector<int> sourceCapIds)
+sv4guiModelExtractPathsAction::WorkThread::WorkThread(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer selectedNode, std::vector<int> sourceCapIds, std::string cacheDir)
 {
     this->mm_DataStorage=dataStorage;
     this->m_SelectedNode=selectedNode;
+    this->mm_CacheDir=cacheDir;
     this->mm_SourceCapIds.clear();
     for (int i=0; i<sourceCapIds.size(); i++)
       this->mm_SourceCapIds.push_back(sourceCapIds[i]);
@@ -179,6 +183,7 @@ void sv4guiModelExtractPathsAction::WorkThread::run()
         for (int i=0; i<this->mm_SourceCapIds.size(); i++)
           sourceCapIds->InsertNextId(this->mm_SourceCapIds[i]);
 
+        cvGeometryCacheScope cacheScope(mm_CacheDir);
         vtkSmartPointer<vtkPolyData> centerlinesPd = sv4guiModelUtils::CreateCenterlines(modelElement, sourceCapIds);
         vtkSmartPointer<vtkPolyData> mergedCenterlinesPD = sv4guiModelUtils::MergeCenterlines(centerlinesPd);
 
@@ -80,7 +80,7 @@ private:
         //      Q_OBJECT
     public:
         WorkThread(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer selectedNode,
-                   std::vector<int> sourceCapIds);
+                   std::vector<int> sourceCapIds, std::string cacheDir);
 
         QString GetStatus(){return m_Status;}
 
@@ -113,6 +113,8 @@ private:
 
         mitk::DataNode::Pointer m_MergedCenterlinesModelNode;
 
+        std::string mm_CacheDir;
+
         std::vector<int> mm_SourceCapIds;
 
     };
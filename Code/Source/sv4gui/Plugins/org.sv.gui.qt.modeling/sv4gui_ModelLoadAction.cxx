@@ -36,6 +36,8 @@
 #include "sv4gui_ModelIO.h"
 #include "sv4gui_ModelElementFactory.h"
 #include "sv4gui_ModelUtils.h"
+#include "sv4gui_ProjectManager.h"
+#include "sv_geometry_cache.h"
 
 #include <mitkNodePredicateDataType.h>
 #include <mitkStatusBar.h>
@@ -213,6 +215,7 @@ void sv4guiModelLoadAction::Run(const QList<mitk::DataNode::Pointer> &selectedNo
                                                                            tr("Separation Angle:"), 50, 0, 90, 0, &ok);
                                         if(ok)
                                         {
+                                            cvGeometryCacheScope cacheScope(sv4guiProjectManager::GetCacheDirectory(m_DataStorage,selectedNode));
                                             bool success=mepd->ExtractFaces(angle);
                                             if(!success)
                                                 msg+=" Failed in face extraction.";
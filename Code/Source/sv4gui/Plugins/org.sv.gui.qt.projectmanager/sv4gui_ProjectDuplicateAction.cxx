@@ -86,6 +86,10 @@ void sv4guiProjectDuplicateAction::Run(const QList<mitk::DataNode::Pointer> &sel
     try
     {
         sv4guiProjectManager::DuplicateProject(m_DataStorage, selectedNode, newName);
+
+        QStringList failedFiles=sv4guiProjectManager::TakeFailedSaves();
+        if(failedFiles.size()>0)
+            QMessageBox::warning(NULL,"Save Failed","The following project files could not be saved:\n"+failedFiles.join("\n"));
     }
     catch(std::exception& e)
     {
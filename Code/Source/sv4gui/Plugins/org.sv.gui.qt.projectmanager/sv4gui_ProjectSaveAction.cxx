@@ -57,6 +57,10 @@ void sv4guiProjectSaveAction::Run(const QList<mitk::DataNode::Pointer> &selected
     try
     {
         sv4guiProjectManager::SaveProject(m_DataStorage,selectedNode);
+
+        QStringList failedFiles=sv4guiProjectManager::TakeFailedSaves();
+        if(failedFiles.size()>0)
+            QMessageBox::warning(NULL,"Save Failed","The following project files could not be saved:\n"+failedFiles.join("\n"));
     }
     catch(std::exception& e)
     {
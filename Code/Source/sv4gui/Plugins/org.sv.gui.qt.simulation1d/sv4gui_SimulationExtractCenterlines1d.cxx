@@ -37,6 +37,8 @@
 #include "sv4gui_Model.h"
 #include "sv4gui_Path.h"
 #include "sv4gui_DataNodeOperation.h"
+#include "sv4gui_ProjectManager.h"
+#include "sv_geometry_cache.h"
 
 #include <mitkNodePredicateDataType.h>
 #include <mitkStatusBar.h>
@@ -163,7 +165,8 @@ void sv4guiSimulationExtractCenterlines1d::Run(const QList<mitk::DataNode::Point
     MITK_INFO << msg << "Extracting centerlines"; 
     mitk::StatusBar::GetInstance()->DisplayText("Extracting centerlines from the surface model.");
 
-    m_Thread = new WorkThread(m_DataStorage, selectedNode, m_SourceCapIds);
+    std::string cacheDir = sv4guiProjectManager::GetCacheDirectory(m_DataStorage, m_ProjFolderNode);
+    m_Thread = new WorkThread(m_DataStorage, selectedNode, m_SourceCapIds, cacheDir);
     m_Thread->m_JobNode = m_JobNode; 
     m_Thread->m_CenterlinesFileName = m_CenterlinesFileName; 
 
@@ -187,10 +190,11 @@ void sv4guiSimulationExtractCenterlines1d::SetDataStorage(mitk::DataStorage *dat
 //------------------------
 //
 sv4guiSimulationExtractCenterlines1d::WorkThread::WorkThread(mitk::DataStorage::Pointer dataStorage, 
-    mitk::DataNode::Pointer selectedNode, std::vector<int> sourceCapIds)
+    mitk::DataNode::Pointer selectedNode, std::vector<int> sourceCapIds, std::string cacheDir)
 {
     this->mm_DataStorage = dataStorage;
     this->m_SelectedNode = selectedNode;
+    this->mm_CacheDir = cacheDir;
     this->mm_SourceCapIds.clear();
     this->m_JobNode = nullptr;
 
@@ -241,6 +245,7 @@ void sv4guiSimulationExtractCenterlines1d::WorkThread::run()
           sourceCapIds->InsertNextId(this->mm_SourceCapIds[i]);
         }
 
+        cvGeometryCacheScope cacheScope(mm_CacheDir);
         m_CenterlineGeometry = sv4guiModelUtils::CreateCenterlines(modelElement, sourceCapIds);
 
         // Add Centerlines Data Node.
@@ -86,7 +86,7 @@ class SV_QT_SIMULATION1D sv4guiSimulationExtractCenterlines1d : public QObject,
     {
       public:
         WorkThread(mitk::DataStorage::Pointer dataStorage, mitk::DataNode::Pointer selectedNode,
-                   std::vector<int> sourceCapIds);
+                   std::vector<int> sourceCapIds, std::string cacheDir);
 
         QString GetStatus(){return m_Status;}
         mitk::DataNode::Pointer GetPathFolderNode(){return m_PathFolderNode;}
@@ -107,6 +107,7 @@ class SV_QT_SIMULATION1D sv4guiSimulationExtractCenterlines1d : public QObject,
         mitk::DataNode::Pointer m_CenterlinesModelNode;
         mitk::DataNode::Pointer m_MergedCenterlinesModelNode;
         std::vector<int> mm_SourceCapIds;
+        std::string mm_CacheDir;
 
         void run();
     };
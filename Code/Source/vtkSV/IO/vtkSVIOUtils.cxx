@@ -31,9 +31,18 @@
 
 #include "vtkSVIOUtils.h"
 
+#include "vtkByteSwap.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
 #include "vtkDataArray.h"
+#include "vtkFieldData.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMetaImageWriter.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkSTLReader.h"
 #include "vtkSVGlobals.h"
@@ -50,7 +59,473 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
-struct stat info;
+#if defined(_WIN32) && !defined(__CYGWIN__)
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Read-only mapping of a whole file.
+struct vtkSVIOUtilsMappedFile
+{
+  const char *Data;
+  size_t Size;
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  HANDLE File;
+  HANDLE Mapping;
+#endif
+};
+
+int vtkSVIOUtilsMapFile(const char *filename, vtkSVIOUtilsMappedFile &mapped)
+{
+  mapped.Data = NULL;
+  mapped.Size = 0;
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  mapped.File = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (mapped.File == INVALID_HANDLE_VALUE)
+    return SV_ERROR;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(mapped.File, &fileSize) || fileSize.QuadPart == 0)
+  {
+    CloseHandle(mapped.File);
+    return SV_ERROR;
+  }
+  mapped.Size = (size_t) fileSize.QuadPart;
+  mapped.Mapping = CreateFileMappingA(mapped.File, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapped.Mapping != NULL)
+    mapped.Data = (const char *) MapViewOfFile(mapped.Mapping, FILE_MAP_READ, 0, 0, 0);
+  if (mapped.Data == NULL)
+  {
+    if (mapped.Mapping != NULL)
+      CloseHandle(mapped.Mapping);
+    CloseHandle(mapped.File);
+    return SV_ERROR;
+  }
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return SV_ERROR;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return SV_ERROR;
+  }
+  mapped.Size = st.st_size;
+  void *data = mmap(NULL, mapped.Size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return SV_ERROR;
+  mapped.Data = (const char *) data;
+#endif
+
+  return SV_OK;
+}
+
+void vtkSVIOUtilsUnmapFile(vtkSVIOUtilsMappedFile &mapped)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  UnmapViewOfFile(mapped.Data);
+  CloseHandle(mapped.Mapping);
+  CloseHandle(mapped.File);
+#else
+  munmap((void *) mapped.Data, mapped.Size);
+#endif
+  mapped.Data = NULL;
+}
+
+const char vtkSVIOUtilsRawMagic[8] = {'S','V','R','A','W','B','I','N'};
+
+inline bool vtkSVIOUtilsIsBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool vtkSVIOUtilsIsSpace(char c)
+{
+  return vtkSVIOUtilsIsBlank(c) || c == '\n';
+}
+
+inline const char *vtkSVIOUtilsSkipBlanks(const char *p, const char *end)
+{
+  while (p < end && vtkSVIOUtilsIsBlank(*p))
+    p++;
+  return p;
+}
+
+// Parses an integer token. Returns NULL if there is none.
+inline const char *vtkSVIOUtilsParseId(const char *p, const char *end, vtkIdType &value)
+{
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    p++;
+  }
+  const char *digits = p;
+  vtkIdType v = 0;
+  while (p < end && *p >= '0' && *p <= '9')
+  {
+    v = 10*v + (*p - '0');
+    p++;
+  }
+  if (p == digits || (p < end && !vtkSVIOUtilsIsSpace(*p)))
+    return NULL;
+  value = negative ? -v : v;
+  return p;
+}
+
+// Parses a floating point token. Plain decimals with at most 15 significant
+// digits are converted exactly with a single multiply or divide by a power of
+// ten; anything else (exponents, long mantissas) goes through strtod.
+inline const char *vtkSVIOUtilsParseDouble(const char *p, const char *end, double &value)
+{
+  static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  const char *start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    p++;
+  }
+
+  unsigned long long mantissa = 0;
+  int numDigits = 0, exponent = 0;
+  bool anyDigits = false;
+  while (p < end && *p >= '0' && *p <= '9')
+  {
+    if (numDigits < 19)
+    {
+      mantissa = 10*mantissa + (*p - '0');
+      if (mantissa != 0)
+        numDigits++;
+    }
+    else
+      exponent++;
+    anyDigits = true;
+    p++;
+  }
+  if (p < end && *p == '.')
+  {
+    p++;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+      if (numDigits < 19)
+      {
+        mantissa = 10*mantissa + (*p - '0');
+        if (mantissa != 0)
+          numDigits++;
+        exponent--;
+      }
+      anyDigits = true;
+      p++;
+    }
+  }
+
+  if (anyDigits && numDigits <= 15 && exponent >= -22 && exponent <= 22 &&
+      (p == end || vtkSVIOUtilsIsSpace(*p)))
+  {
+    double v = (double) mantissa;
+    v = exponent < 0 ? v/powersOfTen[-exponent] : v*powersOfTen[exponent];
+    value = negative ? -v : v;
+    return p;
+  }
+
+  // The mapped file is not null terminated, so copy the token.
+  char token[64];
+  int length = 0;
+  for (p = start; p < end && !vtkSVIOUtilsIsSpace(*p) && length < 63; p++)
+    token[length++] = *p;
+  token[length] = '\0';
+  if (length == 0 || (p < end && !vtkSVIOUtilsIsSpace(*p)))
+    return NULL;
+  char *tokenEnd;
+  value = strtod(token, &tokenEnd);
+  if (tokenEnd != token + length)
+    return NULL;
+  return p;
+}
+
+// Returns the start of the line following p.
+inline const char *vtkSVIOUtilsNextLine(const char *p, const char *end)
+{
+  const char *newline = (const char *) memchr(p, '\n', end - p);
+  return newline == NULL ? end : newline + 1;
+}
+
+// Counts the lines in each chunk of the file body.
+class vtkSVIOUtilsCountLinesFunctor
+{
+public:
+  const char *Data;
+  const char *End;
+  const vtkIdType *ChunkStarts;
+  vtkIdType *ChunkLines;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType c=begin; c<end; c++)
+    {
+      const char *p = this->Data + this->ChunkStarts[c];
+      const char *chunkEnd = this->Data + this->ChunkStarts[c+1];
+      vtkIdType numLines = 0;
+      while (p < chunkEnd)
+      {
+        p = vtkSVIOUtilsNextLine(p, chunkEnd);
+        numLines++;
+      }
+      this->ChunkLines[c] = numLines;
+    }
+  }
+};
+
+// Parses the point and cell lines of each chunk straight into the output
+// arrays. The global line number of a chunk's first line gives the index of
+// the point or cell it starts with.
+class vtkSVIOUtilsParseRawFunctor
+{
+public:
+  const char *Data;
+  const vtkIdType *ChunkStarts;
+  const vtkIdType *ChunkFirstLine;
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  int CellSize;
+  float *Points;
+  vtkIdType *Cells;
+  int *ChunkStatus;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType c=begin; c<end; c++)
+      this->ChunkStatus[c] = this->ParseChunk(c);
+  }
+
+  int ParseChunk(vtkIdType c)
+  {
+    const char *p = this->Data + this->ChunkStarts[c];
+    const char *chunkEnd = this->Data + this->ChunkStarts[c+1];
+    vtkIdType lastLine = this->NumberOfPoints + this->NumberOfCells;
+    for (vtkIdType line = this->ChunkFirstLine[c]; p < chunkEnd && line < lastLine; line++)
+    {
+      const char *lineEnd = (const char *) memchr(p, '\n', chunkEnd - p);
+      if (lineEnd == NULL)
+        lineEnd = chunkEnd;
+
+      if (line < this->NumberOfPoints)
+      {
+        float *x = this->Points + 3*line;
+        for (int i=0; i<3; i++)
+        {
+          double value;
+          p = vtkSVIOUtilsParseDouble(vtkSVIOUtilsSkipBlanks(p, lineEnd), lineEnd, value);
+          if (p == NULL)
+            return SV_ERROR;
+          x[i] = (float) value;
+        }
+      }
+      else
+      {
+        vtkIdType *cell = this->Cells + (line - this->NumberOfPoints)*(this->CellSize+1);
+        cell[0] = this->CellSize;
+        int numIds = 0;
+        for (p = vtkSVIOUtilsSkipBlanks(p, lineEnd); p < lineEnd; p = vtkSVIOUtilsSkipBlanks(p, lineEnd))
+        {
+          if (numIds == this->CellSize)
+            return SV_ERROR;
+          p = vtkSVIOUtilsParseId(p, lineEnd, cell[++numIds]);
+          if (p == NULL)
+            return SV_ERROR;
+        }
+        if (numIds != this->CellSize)
+          return SV_ERROR;
+      }
+
+      p = lineEnd + 1;
+    }
+    return SV_OK;
+  }
+};
+
+// Calls task(i) for every file on a bounded number of threads, handing out
+// one file at a time, and records how long each file took.
+int vtkSVIOUtilsForEachFile(int numFiles, const std::function<int(int)> &task,
+                            std::vector<double> *times, int maxThreads)
+{
+  std::vector<int> status(numFiles, SV_OK);
+  std::vector<double> elapsed(numFiles, 0.0);
+
+  int numThreads = maxThreads;
+  if (numThreads < 1)
+  {
+    const char *env = getenv("SV_NUM_THREADS");
+    numThreads = env != NULL ? atoi(env) : 0;
+    if (numThreads < 1)
+      numThreads = (int) std::thread::hardware_concurrency();
+  }
+  numThreads = std::max(1, std::min(numThreads, numFiles));
+
+  std::atomic<int> next(0);
+  auto worker = [&]()
+  {
+    for (int i = next++; i < numFiles; i = next++)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      status[i] = task(i);
+      elapsed[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+  };
+
+  // The calling thread is one of the workers
+  std::vector<std::thread> threads;
+  for (int i=1; i<numThreads; i++)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (size_t i=0; i<threads.size(); i++)
+    threads[i].join();
+
+  if (times != NULL)
+    *times = elapsed;
+
+  for (int i=0; i<numFiles; i++)
+  {
+    if (status[i] != SV_OK)
+      return SV_ERROR;
+  }
+  return SV_OK;
+}
+
+// Appends the arrays of a data set's points, cells and attributes.
+void vtkSVIOUtilsGetArrays(vtkDataSet *ds, std::vector<vtkAbstractArray*> &arrays)
+{
+  vtkPointSet *ps = vtkPointSet::SafeDownCast(ds);
+  if (ps != NULL && ps->GetPoints() != NULL)
+    arrays.push_back(ps->GetPoints()->GetData());
+
+  vtkPolyData *pd = vtkPolyData::SafeDownCast(ds);
+  if (pd != NULL)
+  {
+    vtkCellArray *cells[4] = {pd->GetVerts(), pd->GetLines(), pd->GetPolys(), pd->GetStrips()};
+    for (int i=0; i<4; i++)
+    {
+      if (cells[i] != NULL)
+        arrays.push_back(cells[i]->GetData());
+    }
+  }
+  vtkUnstructuredGrid *ug = vtkUnstructuredGrid::SafeDownCast(ds);
+  if (ug != NULL && ug->GetCells() != NULL)
+  {
+    arrays.push_back(ug->GetCells()->GetData());
+    arrays.push_back(ug->GetCellTypesArray());
+    arrays.push_back(ug->GetCellLocationsArray());
+  }
+
+  vtkFieldData *fields[3] = {ds->GetPointData(), ds->GetCellData(), ds->GetFieldData()};
+  for (int i=0; i<3; i++)
+  {
+    for (int j=0; j<fields[i]->GetNumberOfArrays(); j++)
+      arrays.push_back(fields[i]->GetAbstractArray(j));
+  }
+}
+
+// Copies the inputs of writers that run on separate threads. vtkXMLWriter
+// caches the range of each array it writes in the array's information,
+// so an input that shares any array with an earlier input is deep copied
+// and the others are shallow copied.
+template <class T>
+void vtkSVIOUtilsCopyWriterInputs(const std::vector<T*> &inputs,
+                                  std::vector<vtkSmartPointer<T> > &copies)
+{
+  std::set<vtkAbstractArray*> seen;
+  copies.resize(inputs.size());
+  for (size_t i=0; i<inputs.size(); i++)
+  {
+    std::vector<vtkAbstractArray*> arrays;
+    vtkSVIOUtilsGetArrays(inputs[i], arrays);
+
+    int shared = 0;
+    for (size_t j=0; j<arrays.size(); j++)
+    {
+      if (arrays[j] != NULL && !seen.insert(arrays[j]).second)
+        shared = 1;
+    }
+
+    copies[i] = vtkSmartPointer<T>::New();
+    if (shared)
+      copies[i]->DeepCopy(inputs[i]);
+    else
+      copies[i]->ShallowCopy(inputs[i]);
+  }
+}
+
+// Reads a file written by WriteBinaryRawFileData.
+int vtkSVIOUtilsReadBinaryRaw(const vtkSVIOUtilsMappedFile &mapped, vtkPoints *points,
+                              vtkCellArray *cells, int minCellSize, int maxCellSize)
+{
+  if (mapped.Size < 32)
+    return SV_ERROR;
+
+  vtkTypeInt64 header[3];
+  memcpy(header, mapped.Data + 8, sizeof(header));
+  vtkByteSwap::Swap8LERange(header, 3);
+  vtkTypeInt64 numPts = header[0], numCells = header[1], cellSize = header[2];
+  if (numPts < 0 || numCells < 0 || cellSize < minCellSize || cellSize > maxCellSize ||
+      (vtkTypeUInt64) mapped.Size != 32 + 24*(vtkTypeUInt64) numPts + 8*(vtkTypeUInt64) (numCells*cellSize))
+    return SV_ERROR;
+
+  const char *data = mapped.Data + 32;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numPts);
+  if (numPts > 0)
+  {
+    double *x = (double *) points->GetVoidPointer(0);
+    memcpy(x, data, 24*numPts);
+    vtkByteSwap::Swap8LERange(x, 3*numPts);
+  }
+  data += 24*numPts;
+
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(numCells*(cellSize+1));
+  vtkIdType *cellIds = connectivity->GetPointer(0);
+  std::vector<vtkTypeInt64> ids(cellSize);
+  for (vtkIdType i=0; i<numCells; i++)
+  {
+    memcpy(&ids[0], data + 8*cellSize*i, 8*cellSize);
+    vtkByteSwap::Swap8LERange(&ids[0], cellSize);
+    vtkIdType *cell = cellIds + i*(cellSize+1);
+    cell[0] = cellSize;
+    for (int j=0; j<cellSize; j++)
+      cell[j+1] = ids[j];
+  }
+  cells->SetCells(numCells, connectivity);
+
+  return SV_OK;
+}
+}
+
 // ----------------------
 // CheckDirectoryExists
 // ----------------------
@@ -58,6 +533,7 @@ int vtkSVIOUtils::CheckDirectoryExists(std::string dirname)
 {
   if (dirname.empty() || dirname == "" || dirname == "/0")
     return SV_OK;
+  struct stat info;
   if (stat(dirname.c_str(), &info) == 0)
     return SV_OK;
 
@@ -69,6 +545,7 @@ int vtkSVIOUtils::CheckDirectoryExists(std::string dirname)
 // ----------------------
 int vtkSVIOUtils::CheckFileExists(std::string filename)
 {
+  struct stat info;
   if (stat(filename.c_str(), &info) == 0)
     return SV_OK;
 
@@ -197,6 +674,42 @@ int vtkSVIOUtils::ReadVTUFile(std::string inputFilename, vtkUnstructuredGrid *gr
   return SV_OK;
 }
 
+// ----------------------
+// ReadVTPFiles
+// ----------------------
+int vtkSVIOUtils::ReadVTPFiles(const std::vector<std::string> &inputFilenames,
+                               std::vector<vtkSmartPointer<vtkPolyData> > &polydatas,
+                               std::vector<double> *times, int maxThreads)
+{
+  int numFiles = inputFilenames.size();
+  polydatas.resize(numFiles);
+  for (int i=0; i<numFiles; i++)
+    polydatas[i] = vtkSmartPointer<vtkPolyData>::New();
+
+  return vtkSVIOUtilsForEachFile(numFiles, [&](int i)
+    {
+      return vtkSVIOUtils::ReadVTPFile(inputFilenames[i], polydatas[i]);
+    }, times, maxThreads);
+}
+
+// ----------------------
+// ReadVTUFiles
+// ----------------------
+int vtkSVIOUtils::ReadVTUFiles(const std::vector<std::string> &inputFilenames,
+                               std::vector<vtkSmartPointer<vtkUnstructuredGrid> > &grids,
+                               std::vector<double> *times, int maxThreads)
+{
+  int numFiles = inputFilenames.size();
+  grids.resize(numFiles);
+  for (int i=0; i<numFiles; i++)
+    grids[i] = vtkSmartPointer<vtkUnstructuredGrid>::New();
+
+  return vtkSVIOUtilsForEachFile(numFiles, [&](int i)
+    {
+      return vtkSVIOUtils::ReadVTUFile(inputFilenames[i], grids[i]);
+    }, times, maxThreads);
+}
+
 // ----------------------
 // ReadPolyDataRawFile
 // ----------------------
@@ -241,6 +754,147 @@ int vtkSVIOUtils::ReadUnstructuredGridRawFile(std::string inputFilename, vtkUnst
   return SV_OK;
 }
 
+// ----------------------
+// IsBinaryRawFile
+// ----------------------
+int vtkSVIOUtils::IsBinaryRawFile(std::string inputFilename)
+{
+  FILE *fp = fopen(inputFilename.c_str(), "rb");
+  if (fp == NULL)
+    return 0;
+
+  char magic[8];
+  int isBinary = fread(magic, 1, 8, fp) == 8 && memcmp(magic, vtkSVIOUtilsRawMagic, 8) == 0;
+  fclose(fp);
+  return isBinary;
+}
+
+// ----------------------
+// ReadRawFileData
+// ----------------------
+/** \details The body of a text file is split into chunks at line boundaries.
+ *  The lines of each chunk are counted in parallel, which gives the global
+ *  line number each chunk starts at, and then the chunks are parsed in
+ *  parallel into the preallocated point and connectivity arrays. */
+int vtkSVIOUtils::ReadRawFileData(std::string inputFilename, vtkPoints *points, vtkCellArray *cells,
+                                  int minCellSize, int maxCellSize)
+{
+  vtkSVIOUtilsMappedFile mapped;
+  if (vtkSVIOUtilsMapFile(inputFilename.c_str(), mapped) != SV_OK)
+    return SV_ERROR;
+
+  if (mapped.Size >= 8 && memcmp(mapped.Data, vtkSVIOUtilsRawMagic, 8) == 0)
+  {
+    int status = vtkSVIOUtilsReadBinaryRaw(mapped, points, cells, minCellSize, maxCellSize);
+    vtkSVIOUtilsUnmapFile(mapped);
+    return status;
+  }
+
+  const char *data = mapped.Data;
+  const char *end = mapped.Data + mapped.Size;
+
+  // Header with the number of points and cells
+  vtkIdType numPts, numCells;
+  const char *p = vtkSVIOUtilsSkipBlanks(data, end);
+  p = vtkSVIOUtilsParseId(p, end, numPts);
+  if (p != NULL)
+    p = vtkSVIOUtilsParseId(vtkSVIOUtilsSkipBlanks(p, end), end, numCells);
+  if (p == NULL || numPts < 0 || numCells < 0)
+  {
+    vtkSVIOUtilsUnmapFile(mapped);
+    return SV_ERROR;
+  }
+  while (p < end && vtkSVIOUtilsIsSpace(*p))
+    p++;
+
+  // Split the body into chunks of a few megabytes at line starts
+  vtkIdType bodyStart = p - data;
+  vtkIdType bodySize = mapped.Size - bodyStart;
+  vtkIdType numChunks = std::max<vtkIdType>(1, bodySize/(1 << 22));
+  std::vector<vtkIdType> chunkStarts(numChunks+1);
+  chunkStarts[0] = bodyStart;
+  for (vtkIdType c=1; c<numChunks; c++)
+  {
+    const char *start = data + std::max(chunkStarts[c-1], bodyStart + c*(bodySize/numChunks));
+    chunkStarts[c] = vtkSVIOUtilsNextLine(start, end) - data;
+  }
+  chunkStarts[numChunks] = mapped.Size;
+
+  std::vector<vtkIdType> chunkLines(numChunks);
+  vtkSVIOUtilsCountLinesFunctor counter;
+  counter.Data        = data;
+  counter.End         = end;
+  counter.ChunkStarts = &chunkStarts[0];
+  counter.ChunkLines  = &chunkLines[0];
+  vtkSMPTools::For(0, numChunks, 1, counter);
+
+  std::vector<vtkIdType> chunkFirstLine(numChunks+1, 0);
+  for (vtkIdType c=0; c<numChunks; c++)
+    chunkFirstLine[c+1] = chunkFirstLine[c] + chunkLines[c];
+  if (chunkFirstLine[numChunks] < numPts + numCells)
+  {
+    vtkSVIOUtilsUnmapFile(mapped);
+    return SV_ERROR;
+  }
+
+  // The number of ids per cell comes from the first cell line
+  int cellSize = minCellSize;
+  if (numCells > 0)
+  {
+    vtkIdType c = 0;
+    while (chunkFirstLine[c+1] <= numPts)
+      c++;
+    p = data + chunkStarts[c];
+    for (vtkIdType line = chunkFirstLine[c]; line < numPts; line++)
+      p = vtkSVIOUtilsNextLine(p, end);
+    const char *lineEnd = vtkSVIOUtilsNextLine(p, end);
+    cellSize = 0;
+    for (p = vtkSVIOUtilsSkipBlanks(p, lineEnd); p < lineEnd && *p != '\n'; p = vtkSVIOUtilsSkipBlanks(p, lineEnd))
+    {
+      while (p < lineEnd && !vtkSVIOUtilsIsSpace(*p))
+        p++;
+      cellSize++;
+    }
+  }
+  if (cellSize < minCellSize || cellSize > maxCellSize)
+  {
+    vtkSVIOUtilsUnmapFile(mapped);
+    return SV_ERROR;
+  }
+
+  vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+  coords->SetNumberOfComponents(3);
+  coords->SetNumberOfTuples(numPts);
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(numCells*(cellSize+1));
+
+  std::vector<int> chunkStatus(numChunks, SV_OK);
+  vtkSVIOUtilsParseRawFunctor parser;
+  parser.Data           = data;
+  parser.ChunkStarts    = &chunkStarts[0];
+  parser.ChunkFirstLine = &chunkFirstLine[0];
+  parser.NumberOfPoints = numPts;
+  parser.NumberOfCells  = numCells;
+  parser.CellSize       = cellSize;
+  parser.Points         = coords->GetPointer(0);
+  parser.Cells          = connectivity->GetPointer(0);
+  parser.ChunkStatus    = &chunkStatus[0];
+  vtkSMPTools::For(0, numChunks, 1, parser);
+
+  vtkSVIOUtilsUnmapFile(mapped);
+
+  for (vtkIdType c=0; c<numChunks; c++)
+  {
+    if (chunkStatus[c] != SV_OK)
+      return SV_ERROR;
+  }
+
+  points->SetData(coords);
+  cells->SetCells(numCells, connectivity);
+
+  return SV_OK;
+}
+
 // ----------------------
 // ReadInputFile
 // ----------------------
@@ -383,6 +1037,58 @@ int vtkSVIOUtils::WriteVTUFile(std::string inputFilename,vtkUnstructuredGrid *wr
   return SV_OK;
 }
 
+// ----------------------
+// WriteVTPFiles
+// ----------------------
+/** \details The writers run on separate threads and cache array ranges in
+ *  the arrays they write, so inputs that share arrays with an earlier input,
+ *  including a data set listed for several files, are deep copied before the
+ *  threads start. */
+int vtkSVIOUtils::WriteVTPFiles(const std::vector<std::string> &outputFilenames,
+                                const std::vector<vtkPolyData*> &polydatas,
+                                std::vector<double> *times, int maxThreads)
+{
+  if (outputFilenames.size() != polydatas.size())
+  {
+    fprintf(stderr,"Number of file names and data sets do not match\n");
+    return SV_ERROR;
+  }
+
+  std::vector<vtkSmartPointer<vtkPolyData> > inputs;
+  vtkSVIOUtilsCopyWriterInputs(polydatas, inputs);
+
+  return vtkSVIOUtilsForEachFile(outputFilenames.size(), [&](int i)
+    {
+      return vtkSVIOUtils::WriteVTPFile(outputFilenames[i], inputs[i]);
+    }, times, maxThreads);
+}
+
+// ----------------------
+// WriteVTUFiles
+// ----------------------
+/** \details The writers run on separate threads and cache array ranges in
+ *  the arrays they write, so inputs that share arrays with an earlier input,
+ *  including a data set listed for several files, are deep copied before the
+ *  threads start. */
+int vtkSVIOUtils::WriteVTUFiles(const std::vector<std::string> &outputFilenames,
+                                const std::vector<vtkUnstructuredGrid*> &grids,
+                                std::vector<double> *times, int maxThreads)
+{
+  if (outputFilenames.size() != grids.size())
+  {
+    fprintf(stderr,"Number of file names and data sets do not match\n");
+    return SV_ERROR;
+  }
+
+  std::vector<vtkSmartPointer<vtkUnstructuredGrid> > inputs;
+  vtkSVIOUtilsCopyWriterInputs(grids, inputs);
+
+  return vtkSVIOUtilsForEachFile(outputFilenames.size(), [&](int i)
+    {
+      return vtkSVIOUtils::WriteVTUFile(outputFilenames[i], inputs[i]);
+    }, times, maxThreads);
+}
+
 // ----------------------
 // WriteVTSFile
 // ----------------------
@@ -510,3 +1216,78 @@ int vtkSVIOUtils::WriteRawFile(std::string inputFilename,vtkPolyData *writePolyD
   writer->Write();
   return SV_OK;
 }
+
+// ----------------------
+// WriteBinaryRawFileData
+// ----------------------
+int vtkSVIOUtils::WriteBinaryRawFileData(std::string outputFilename, vtkPoints *points, vtkCellArray *cells)
+{
+  vtkIdType numPts = points->GetNumberOfPoints();
+  vtkIdType numCells = cells->GetNumberOfCells();
+
+  vtkIdType cellSize = 0;
+  vtkIdType npts, *pts;
+  for (cells->InitTraversal(); cells->GetNextCell(npts, pts);)
+  {
+    if (cellSize == 0)
+      cellSize = npts;
+    if (npts != cellSize)
+    {
+      fprintf(stderr,"Binary raw file requires all cells to have the same number of points\n");
+      return SV_ERROR;
+    }
+  }
+
+  FILE *fp = fopen(outputFilename.c_str(), "wb");
+  if (fp == NULL)
+  {
+    fprintf(stderr,"Couldn't open file %s\n", outputFilename.c_str());
+    return SV_ERROR;
+  }
+
+  vtkTypeInt64 header[3] = {numPts, numCells, cellSize};
+  vtkByteSwap::Swap8LERange(header, 3);
+  fwrite(vtkSVIOUtilsRawMagic, 1, 8, fp);
+  fwrite(header, sizeof(vtkTypeInt64), 3, fp);
+
+  // Points and ids are converted and written in blocks
+  const vtkIdType blockSize = 1 << 16;
+  std::vector<double> coords(3*blockSize);
+  for (vtkIdType start=0; start<numPts; start+=blockSize)
+  {
+    vtkIdType count = std::min(blockSize, numPts - start);
+    for (vtkIdType i=0; i<count; i++)
+      points->GetPoint(start+i, &coords[3*i]);
+    vtkByteSwap::Swap8LERange(&coords[0], 3*count);
+    fwrite(&coords[0], sizeof(double), 3*count, fp);
+  }
+
+  std::vector<vtkTypeInt64> ids;
+  ids.reserve(blockSize*cellSize);
+  for (cells->InitTraversal(); cells->GetNextCell(npts, pts);)
+  {
+    for (vtkIdType j=0; j<npts; j++)
+      ids.push_back(pts[j]);
+    if ((vtkIdType) ids.size() >= blockSize*cellSize)
+    {
+      vtkByteSwap::Swap8LERange(&ids[0], ids.size());
+      fwrite(&ids[0], sizeof(vtkTypeInt64), ids.size(), fp);
+      ids.clear();
+    }
+  }
+  if (!ids.empty())
+  {
+    vtkByteSwap::Swap8LERange(&ids[0], ids.size());
+    fwrite(&ids[0], sizeof(vtkTypeInt64), ids.size(), fp);
+  }
+
+  if (fflush(fp) || ferror(fp))
+  {
+    fclose(fp);
+    fprintf(stderr,"Error writing file %s\n", outputFilename.c_str());
+    return SV_ERROR;
+  }
+  fclose(fp);
+
+  return SV_OK;
+}
@@ -48,12 +48,17 @@
 #include "vtkImageData.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnstructuredGrid.h"
 
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <vector>
+
+class vtkCellArray;
+class vtkPoints;
 
 class VTKSVIO_EXPORT vtkSVIOUtils : public vtkObject
 {
@@ -87,6 +92,34 @@ public:
 
   /** \brief read a raw file. */
   static int ReadUnstructuredGridRawFile(std::string inputFilename, vtkUnstructuredGrid *unstructuredgrid);
+
+  /** \brief read the points and cells of a raw file. Text files are memory
+   *  mapped and parsed in parallel chunks directly into the point and
+   *  connectivity arrays; binary files written by vtkSVRawWriter are copied in
+   *  bulk. Every cell must have the same number of ids, between minCellSize
+   *  and maxCellSize. Returns SV_ERROR if the file cannot be read this way,
+   *  e.g. if it mixes cell sizes. */
+  static int ReadRawFileData(std::string inputFilename, vtkPoints *points, vtkCellArray *cells,
+                             int minCellSize, int maxCellSize);
+
+  /** \brief returns 1 if the file starts with the binary raw file magic
+   *  string written by WriteBinaryRawFileData, 0 otherwise. */
+  static int IsBinaryRawFile(std::string inputFilename);
+
+  //@{
+  /** \brief read several files concurrently. Output i is read from file i.
+   *  At most maxThreads files are read at once; if maxThreads is less than 1,
+   *  SV_NUM_THREADS or the hardware concurrency is used. If times is given, it
+   *  receives the seconds spent on each file. All files are attempted; returns
+   *  SV_ERROR if any of them failed. */
+  static int ReadVTPFiles(const std::vector<std::string> &inputFilenames,
+                          std::vector<vtkSmartPointer<vtkPolyData> > &polydatas,
+                          std::vector<double> *times = NULL, int maxThreads = 0);
+  static int ReadVTUFiles(const std::vector<std::string> &inputFilenames,
+                          std::vector<vtkSmartPointer<vtkUnstructuredGrid> > &grids,
+                          std::vector<double> *times = NULL, int maxThreads = 0);
+  //@}
+
   /** \brief read an stl or polydata file. */
   static int ReadInputFile(std::string inputFilename, vtkPolyData *polydata);
 
@@ -102,6 +135,18 @@ public:
   static int WriteVTUFile(std::string inputFilename, vtkUnstructuredGrid *writeUnstructuredGrid,std::string attachName);
   //@}
 
+  //@{
+  /** \brief write several files concurrently, data i to file i, with the
+   *  default compressed appended format of the single file writers. Threads
+   *  and times are as for ReadVTPFiles. */
+  static int WriteVTPFiles(const std::vector<std::string> &outputFilenames,
+                           const std::vector<vtkPolyData*> &polydatas,
+                           std::vector<double> *times = NULL, int maxThreads = 0);
+  static int WriteVTUFiles(const std::vector<std::string> &outputFilenames,
+                           const std::vector<vtkUnstructuredGrid*> &grids,
+                           std::vector<double> *times = NULL, int maxThreads = 0);
+  //@}
+
   //@{
   /** \brief write a vts file. */
   static int WriteVTSFile(std::string outputFilename, vtkStructuredGrid *writeStructuredGrid);
@@ -120,6 +165,12 @@ public:
   static int WriteRawFile(std::string inputFilename,vtkPolyData *writePolyData,std::string attachName);
   //@}
 
+  /** \brief write points and cells in the binary raw format. All cells must have
+   *  the same number of ids. The file holds the magic string "SVRAWBIN", the
+   *  number of points, cells and ids per cell as 64 bit integers, the points as
+   *  doubles and the cell ids as 64 bit integers, all little-endian. */
+  static int WriteBinaryRawFileData(std::string outputFilename, vtkPoints *points, vtkCellArray *cells);
+
 protected:
   vtkSVIOUtils();
   ~vtkSVIOUtils();
@@ -46,6 +46,7 @@
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkSVGlobals.h"
+#include "vtkSVIOUtils.h"
 
 #include <algorithm>
 #include <cctype>
@@ -118,12 +119,30 @@ int vtkSVPolyDataRawReader::RequestData(
   vtkPoints *newPts = vtkPoints::New();
   vtkCellArray *newPolys = vtkCellArray::New();
 
-  newPts->Allocate(5000);
-  newPolys->Allocate(10000);
-  if (!this->ReadRawFile(fp, newPts, newPolys))
+  // Parse the mapped file in bulk; text files it does not accept are read
+  // line by line, which also reports where the file is malformed.
+  if (vtkSVIOUtils::ReadRawFileData(this->FileName, newPts, newPolys, 2, 3) != SV_OK)
   {
-    fclose(fp);
-    return 0;
+    if (vtkSVIOUtils::IsBinaryRawFile(this->FileName))
+    {
+      vtkErrorMacro(<< "Binary raw file " << this->FileName << " is malformed or has the wrong cell size");
+      this->SetErrorCode(vtkErrorCode::FileFormatError);
+      fclose(fp);
+      newPts->Delete();
+      newPolys->Delete();
+      return 0;
+    }
+    newPts->Initialize();
+    newPolys->Initialize();
+    newPts->Allocate(5000);
+    newPolys->Allocate(10000);
+    if (!this->ReadRawFile(fp, newPts, newPolys))
+    {
+      fclose(fp);
+      newPts->Delete();
+      newPolys->Delete();
+      return 0;
+    }
   }
 
   vtkDebugMacro(<< "Read: "
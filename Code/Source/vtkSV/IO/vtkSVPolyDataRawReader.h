@@ -31,7 +31,7 @@
 
 /**
  * \class   vtkSVPolyDataRawReader
- * \brief   read ASCII raw file
+ * \brief   read ASCII or binary raw file
 */
 
 #ifndef vtkSVPolyDataRawReader_h
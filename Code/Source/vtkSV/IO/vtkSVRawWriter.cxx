@@ -42,6 +42,7 @@
 #include "vtkTriangle.h"
 #include "vtkTriangleStrip.h"
 #include "vtkSVGlobals.h"
+#include "vtkSVIOUtils.h"
 
 #if !defined(_WIN32) || defined(__CYGWIN__)
 # include <unistd.h> /* unlink */
@@ -62,6 +63,7 @@ static char header[]="Visualization Toolkit generated SLA File
 vtkSVRawWriter::vtkSVRawWriter()
 {
   this->FileName = NULL;
+  this->FileType = VTK_ASCII;
 }
 
 // ----------------------
@@ -102,7 +104,19 @@ void vtkSVRawWriter::WriteData()
     return;
   }
 
-  this->WriteRawFile(pts,cells);
+  if (this->FileType == VTK_BINARY)
+  {
+    if (vtkSVIOUtils::WriteBinaryRawFileData(this->FileName, pts, cells) != SV_OK)
+    {
+      vtkErrorMacro(<< "Couldn't write binary raw file: " << this->FileName);
+      this->SetErrorCode(vtkErrorCode::FileFormatError);
+      return;
+    }
+  }
+  else
+  {
+    this->WriteRawFile(pts,cells);
+  }
   if (this->ErrorCode == vtkErrorCode::OutOfDiskSpaceError)
   {
     vtkErrorMacro("Ran out of disk space; deleting file: "
@@ -189,6 +203,8 @@ void vtkSVRawWriter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "FileName: "
      << ((this->GetFileName() == NULL) ?
          "(none)" : this->GetFileName()) << std::endl;
+  os << indent << "FileType: "
+     << (this->FileType == VTK_BINARY ? "Binary" : "ASCII") << std::endl;
   os << indent << "Input: " << this->GetInput() << std::endl;
 }
 
@@ -31,7 +31,7 @@
 
 /**
  * \class   vtkSVRawWriter
- * \brief   write ASCII raw file
+ * \brief   write ASCII or binary raw file
 */
 
 #ifndef vtkSVRawWriter_h
@@ -67,6 +67,17 @@ public:
   vtkGetStringMacro(FileName);
   //@}
 
+  //@{
+  /**
+   * Specify file type (ASCII or BINARY) for the raw file. The binary format
+   * is read back by vtkSVPolyDataRawReader without text parsing.
+   */
+  vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
+  vtkGetMacro(FileType,int);
+  void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
+  void SetFileTypeToBinary() {this->SetFileType(VTK_BINARY);};
+  //@}
+
 protected:
   vtkSVRawWriter();
   ~vtkSVRawWriter()
@@ -80,6 +91,7 @@ protected:
     vtkPoints *pts, vtkCellArray *cells);
 
   char* FileName;
+  int FileType;
 
   int FillInputPortInformation(int port, vtkInformation *info) override;
 
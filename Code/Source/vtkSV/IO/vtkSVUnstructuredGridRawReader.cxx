@@ -45,6 +45,7 @@
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkSVGlobals.h"
+#include "vtkSVIOUtils.h"
 #include "vtkUnstructuredGrid.h"
 
 #include <algorithm>
@@ -120,12 +121,30 @@ int vtkSVUnstructuredGridRawReader::RequestData(
   vtkPoints *newPts = vtkPoints::New();
   vtkCellArray *newCells = vtkCellArray::New();
 
-  newPts->Allocate(5000);
-  newCells->Allocate(10000);
-  if (!this->ReadRawFile(fp, newPts, newCells))
+  // Parse the mapped file in bulk; text files it does not accept are read
+  // line by line, which also reports where the file is malformed.
+  if (vtkSVIOUtils::ReadRawFileData(this->FileName, newPts, newCells, 8, 8) != SV_OK)
   {
-    fclose(fp);
-    return 0;
+    if (vtkSVIOUtils::IsBinaryRawFile(this->FileName))
+    {
+      vtkErrorMacro(<< "Binary raw file " << this->FileName << " is malformed or has the wrong cell size");
+      this->SetErrorCode(vtkErrorCode::FileFormatError);
+      fclose(fp);
+      newPts->Delete();
+      newCells->Delete();
+      return 0;
+    }
+    newPts->Initialize();
+    newCells->Initialize();
+    newPts->Allocate(5000);
+    newCells->Allocate(10000);
+    if (!this->ReadRawFile(fp, newPts, newCells))
+    {
+      fclose(fp);
+      newPts->Delete();
+      newCells->Delete();
+      return 0;
+    }
   }
 
   vtkDebugMacro(<< "Read: "
@@ -31,7 +31,7 @@
 
 /**
  * \class   vtkSVUnstructuredGridRawReader
- * \brief   read ASCII raw file
+ * \brief   read ASCII or binary raw file
 */
 
 #ifndef vtkSVUnstructuredGridRawReader_h
@@ -59,6 +59,8 @@
 #include "vtkPoints.h"
 #include "vtkPolyDataNormals.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSortDataArray.h"
 #include "vtkSmartPointer.h"
 #include "vtkSVGlobals.h"
@@ -68,8 +70,11 @@
 #include "vtkTransformPolyDataFilter.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
 #include <list>
 #include <map>
+#include <utility>
+#include <vector>
 
 //----------------------------------------------------------------------------
 // Helper typedefs and data structures.
@@ -93,6 +98,123 @@ struct simPolygon
   int orientation; // their orientation
 };
 
+// ----------------------
+// simTriangleIntersection
+// ----------------------
+struct simTriangleIntersection
+{
+  vtkIdType nodePair;  // OBB node pair in which it was found
+  vtkIdType order;     // order within that node pair
+  vtkIdType cellId[2]; // intersecting triangle of each input
+  double pt[2][3];     // end points of the intersection line
+  double surfaceId[2]; // surface on which each end point lies
+};
+
+// ----------------------
+// simTriangleIntersectionLess
+// ----------------------
+bool simTriangleIntersectionLess(const simTriangleIntersection &a,
+                                 const simTriangleIntersection &b)
+{
+  if (a.nodePair != b.nodePair)
+    {
+    return a.nodePair < b.nodePair;
+    }
+  return a.order < b.order;
+}
+
+// ----------------------
+// simTriangleIntersectionFunctor
+// ----------------------
+/// \brief Runs the exact triangle-triangle tests for a range of OBB node
+/// pairs. Only reads the meshes and the OBB tree; the intersections found
+/// go into a per-thread buffer and are tagged with their node pair and order
+/// so they can be merged in the same order as the serial search.
+class simTriangleIntersectionFunctor
+{
+public:
+  vtkPolyData  *Mesh[2];
+  vtkOBBTree   *OBBTree1;
+  vtkMatrix4x4 *Transform;
+  std::vector<std::pair<vtkOBBNode*, vtkOBBNode*> > *NodePairs;
+  double       Tolerance;
+
+  vtkSMPThreadLocal<std::vector<simTriangleIntersection> > Intersections;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<simTriangleIntersection> &intersections =
+      this->Intersections.Local();
+
+    for (vtkIdType nodePair = begin; nodePair < end; nodePair++)
+      {
+      vtkOBBNode *node0 = (*this->NodePairs)[nodePair].first;
+      vtkOBBNode *node1 = (*this->NodePairs)[nodePair].second;
+      vtkIdType order = 0;
+
+      int numCells0 = node0->Cells->GetNumberOfIds();
+      for (vtkIdType id0 = 0; id0 < numCells0; id0++)
+        {
+        vtkIdType cellId0 = node0->Cells->GetId(id0);
+        if (this->Mesh[0]->GetCellType(cellId0) != VTK_TRIANGLE)
+          {
+          continue;
+          }
+        vtkIdType npts0, *triPtIds0;
+        this->Mesh[0]->GetCellPoints(cellId0, npts0, triPtIds0);
+        double triPts0[3][3];
+        for (vtkIdType id = 0; id < npts0; id++)
+          {
+          this->Mesh[0]->GetPoint(triPtIds0[id], triPts0[id]);
+          }
+
+        if (!this->OBBTree1->TriangleIntersectsNode
+            (node1, triPts0[0], triPts0[1], triPts0[2], this->Transform))
+          {
+          continue;
+          }
+
+        int numCells1 = node1->Cells->GetNumberOfIds();
+        for (vtkIdType id1 = 0; id1 < numCells1; id1++)
+          {
+          vtkIdType cellId1 = node1->Cells->GetId(id1);
+          if (this->Mesh[1]->GetCellType(cellId1) != VTK_TRIANGLE)
+            {
+            continue;
+            }
+          vtkIdType npts1, *triPtIds1;
+          this->Mesh[1]->GetCellPoints(cellId1, npts1, triPtIds1);
+          double triPts1[3][3];
+          for (vtkIdType id = 0; id < npts1; id++)
+            {
+            this->Mesh[1]->GetPoint(triPtIds1[id], triPts1[id]);
+            }
+
+          simTriangleIntersection intersection;
+          int coplanar = 0;
+          int intersects =
+            vtkSVLoopIntersectionPolyDataFilter::TriangleTriangleIntersection
+            (triPts0[0], triPts0[1], triPts0[2],
+             triPts1[0], triPts1[1], triPts1[2],
+             coplanar, intersection.pt[0], intersection.pt[1],
+             intersection.surfaceId, this->Tolerance);
+
+          // Coplanar triangle intersection is not handled, same as the
+          // serial search.
+          if (intersects && !coplanar)
+            {
+            intersection.nodePair  = nodePair;
+            intersection.order     = order++;
+            intersection.cellId[0] = cellId0;
+            intersection.cellId[1] = cellId1;
+            intersections.push_back(intersection);
+            }
+          }
+        }
+      }
+  }
+};
+
 }
 
 // ----------------------
@@ -130,6 +252,22 @@ public:
   static int FindTriangleIntersections(vtkOBBNode *node0, vtkOBBNode *node1,
                                        vtkMatrix4x4 *transform, void *arg);
 
+  /// \brief Collects the overlapping OBB node pairs of the two input trees
+  /// for the two-phase intersection search
+  static int CollectNodePairs(vtkOBBNode *node0, vtkOBBNode *node1,
+                              vtkMatrix4x4 *transform, void *arg);
+
+  /// \brief Runs the triangle tests for the collected node pairs across
+  /// threads and merges the intersections in traversal order
+  int FindTriangleIntersectionsInParallel();
+
+  /// \brief Adds a single triangle-triangle intersection line to the
+  /// intersection output and updates the point, edge and cell maps
+  int AddIntersection(vtkIdType cellId0, vtkIdType cellId1,
+                      vtkIdType *triPtIds0, vtkIdType *triPtIds1,
+                      double outpt0[3], double outpt1[3],
+                      double surfaceid[2]);
+
   /// \brief Temporarily moving here to try some stuff out
   static int IntersectPlaneWithLine(double p1[3], double p2[3], double n[3],
                                     double p0[3], double& t, double x[3]);
@@ -227,6 +365,11 @@ public:
   /// cell, and the ID of the line.
   PointEdgeMapType    *PointEdgeMap[2];
 
+  /// \brief Overlapping OBB node pairs in traversal order and the transform
+  /// between the trees, used by the two-phase intersection search.
+  std::vector<std::pair<vtkOBBNode*, vtkOBBNode*> > NodePairs;
+  vtkMatrix4x4        *NodeTransform;
+
   /// \brief vtkPolyData to hold current splitting cell. Used to double check area
   /// of small area cells
   vtkPolyData *SplittingPD;
@@ -246,7 +389,8 @@ protected:
 // Impl Constructor
 // ----------------------
 vtkSVLoopIntersectionPolyDataFilter::Impl::Impl() :
-  OBBTree1(0), IntersectionLines(0), SurfaceId(0), PointMerger(0)
+  OBBTree1(0), IntersectionLines(0), SurfaceId(0), PointMerger(0),
+  NodeTransform(0)
 {
   for (int i = 0; i < 2; i++)
     {
@@ -291,11 +435,6 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
   vtkPolyData     *mesh0                 = info->Mesh[0];
   vtkPolyData     *mesh1                 = info->Mesh[1];
   vtkOBBTree      *obbTree1              = info->OBBTree1;
-  vtkCellArray    *intersectionLines     = info->IntersectionLines;
-  vtkIdTypeArray  *intersectionSurfaceId = info->SurfaceId;
-  vtkIdTypeArray  *intersectionCellIds0  = info->CellIds[0];
-  vtkIdTypeArray  *intersectionCellIds1  = info->CellIds[1];
-  vtkPointLocator *pointMerger           = info->PointMerger;
   double tolerance                       = info->Tolerance;
 
   //The number of cells in OBBTree
@@ -361,178 +500,264 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
             //and surface maps!
             if (intersects)
               {
-              vtkIdType lineId = intersectionLines->GetNumberOfCells();
+              info->AddIntersection(cellId0, cellId1, triPtIds0, triPtIds1,
+                                    outpt0, outpt1, surfaceid);
+              }
+            }
+          }
+        }
+      }
+    }
 
-              vtkIdType ptId0, ptId1;
-              int unique[2];
-              unique[0] = pointMerger->InsertUniquePoint(outpt0, ptId0);
-              unique[1] = pointMerger->InsertUniquePoint(outpt1, ptId1);
+  return SV_OK;
+}
 
-              int addline = 1;
-              if (ptId0 == ptId1)
-                {
-                addline = 0;
-                }
+// ----------------------
+// Impl::CollectNodePairs
+// ----------------------
+int vtkSVLoopIntersectionPolyDataFilter::Impl
+::CollectNodePairs(vtkOBBNode *node0, vtkOBBNode *node1,
+                   vtkMatrix4x4 *transform, void *arg)
+{
+  vtkSVLoopIntersectionPolyDataFilter::Impl *info =
+    reinterpret_cast<vtkSVLoopIntersectionPolyDataFilter::Impl*>(arg);
 
-              if (ptId0 == ptId1 && surfaceid[0] != surfaceid[1])
-                {
-                intersectionSurfaceId->InsertValue(ptId0, 3);
-                }
-              else
-                {
-                if (unique[0])
-                  {
-                  intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
-                  }
-                else
-                  {
-                  if (intersectionSurfaceId->GetValue(ptId0) != 3)
-                    {
-                    intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
-                    }
-                  }
-                if (unique[1])
-                  {
-                  intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
-                  }
-                else
-                  {
-                  if (intersectionSurfaceId->GetValue(ptId1) != 3)
-                    {
-                    intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
-                    }
-                  }
-                }
+  info->NodePairs.push_back(std::make_pair(node0, node1));
+  info->NodeTransform = transform;
 
-              info->IntersectionPtsMap[0]->
-                insert(std::make_pair(ptId0, cellId0));
-              info->IntersectionPtsMap[1]->
-                insert(std::make_pair(ptId0, cellId1));
-              info->IntersectionPtsMap[0]->
-                insert(std::make_pair(ptId1, cellId0));
-              info->IntersectionPtsMap[1]->
-                insert(std::make_pair(ptId1, cellId1));
-
-              //Check to see if duplicate line. Line can only be a duplicate
-              //line if both points are not unique and they don't
-              //equal eachother
-              if (!unique[0] && !unique[1] && ptId0 != ptId1)
-                {
-                vtkNew(vtkPolyData, lineTest);
-                lineTest->SetPoints(pointMerger->GetPoints());
-                lineTest->SetLines(intersectionLines);
-                lineTest->BuildLinks();
-                int newLine = info->CheckLine(lineTest, ptId0, ptId1);
-                if (newLine == 0)
-                  {
-                  addline = 0;
-                  }
-                }
-              if (addline)
-                {
-                //If the line is new and does not consist of two identical
-                //points, add the line to the intersection and update
-                //mapping information
-                intersectionLines->InsertNextCell(2);
-                intersectionLines->InsertCellPoint(ptId0);
-                intersectionLines->InsertCellPoint(ptId1);
-
-                intersectionCellIds0->InsertNextValue(cellId0);
-                intersectionCellIds1->InsertNextValue(cellId1);
-
-                info->PointCellIds[0]->InsertValue(ptId0, cellId0);
-                info->PointCellIds[0]->InsertValue(ptId1, cellId0);
-                info->PointCellIds[1]->InsertValue(ptId0, cellId1);
-                info->PointCellIds[1]->InsertValue(ptId1, cellId1);
-
-                info->IntersectionMap[0]->
-                  insert(std::make_pair(cellId0, lineId));
-                info->IntersectionMap[1]->
-                  insert(std::make_pair(cellId1, lineId));
-
-                // Check which edges of cellId0 and cellId1 outpt0 and
-                // outpt1 are on, if any.
-                int isOnEdge=0;
-                int m0p0=0, m0p1=0, m1p0=0, m1p1=0;
-                for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
-                  {
-                  isOnEdge = info->AddToPointEdgeMap(0, ptId0, outpt0,
-                      mesh0, cellId0, edgeId, lineId, triPtIds0);
-                  if (isOnEdge != -1)
-                    {
-                    m0p0++;
-                    }
-                  isOnEdge = info->AddToPointEdgeMap(0, ptId1, outpt1,
-                      mesh0, cellId0, edgeId, lineId, triPtIds0);
-                  if (isOnEdge != -1)
-                    {
-                    m0p1++;
-                    }
-                  isOnEdge = info->AddToPointEdgeMap(1, ptId0, outpt0,
-                      mesh1, cellId1, edgeId, lineId, triPtIds1);
-                  if (isOnEdge != -1)
-                    {
-                    m1p0++;
-                    }
-                  isOnEdge = info->AddToPointEdgeMap(1, ptId1, outpt1,
-                      mesh1, cellId1, edgeId, lineId, triPtIds1);
-                  if (isOnEdge != -1)
-                    {
-                    m1p1++;
-                    }
-                  }
-                //Special cases caught by tolerance and not from the Point
-                //Merger
-                if (m0p0 > 0 && m1p0 > 0)
-                  {
-                  intersectionSurfaceId->InsertValue(ptId0, 3);
-                  }
-                if (m0p1 > 0 && m1p1 > 0)
-                  {
-                  intersectionSurfaceId->InsertValue(ptId1, 3);
-                  }
-                }
-              //Add information about origin surface to std::maps for
-              //checks later
-              if (intersectionSurfaceId->GetValue(ptId0) == 1)
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId0, cellId0));
-                }
-              else if (intersectionSurfaceId->GetValue(ptId0) == 2)
-                {
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId0, cellId1));
-                }
-              else
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId0, cellId0));
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId0, cellId1));
-                }
-              if (intersectionSurfaceId->GetValue(ptId1) == 1)
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId1, cellId0));
-                }
-              else if (intersectionSurfaceId->GetValue(ptId1) == 2)
-                {
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId1, cellId1));
-                }
-              else
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId1, cellId0));
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId1, cellId1));
-                }
-              }
-            }
-          }
+  return SV_OK;
+}
+
+// ----------------------
+// Impl::FindTriangleIntersectionsInParallel
+// ----------------------
+int vtkSVLoopIntersectionPolyDataFilter::Impl
+::FindTriangleIntersectionsInParallel()
+{
+  // The OBB trees already built the cell structures of both meshes, so the
+  // triangle tests only read from them.
+  simTriangleIntersectionFunctor findIntersections;
+  findIntersections.Mesh[0]   = this->Mesh[0];
+  findIntersections.Mesh[1]   = this->Mesh[1];
+  findIntersections.OBBTree1  = this->OBBTree1;
+  findIntersections.Transform = this->NodeTransform;
+  findIntersections.NodePairs = &this->NodePairs;
+  findIntersections.Tolerance = this->Tolerance;
+  vtkSMPTools::For(0, this->NodePairs.size(), findIntersections);
+
+  std::vector<simTriangleIntersection> intersections;
+  vtkSMPThreadLocal<std::vector<simTriangleIntersection> >::iterator threadIter;
+  for (threadIter = findIntersections.Intersections.begin();
+       threadIter != findIntersections.Intersections.end(); ++threadIter)
+    {
+    intersections.insert(intersections.end(), threadIter->begin(),
+                         threadIter->end());
+    }
+
+  // The point merger and line checks depend on insertion order, so merge
+  // in the order the serial search would have found the intersections.
+  std::sort(intersections.begin(), intersections.end(),
+            simTriangleIntersectionLess);
+
+  for (size_t i = 0; i < intersections.size(); i++)
+    {
+    simTriangleIntersection &intersection = intersections[i];
+    vtkIdType npts0, *triPtIds0;
+    this->Mesh[0]->GetCellPoints(intersection.cellId[0], npts0, triPtIds0);
+    vtkIdType npts1, *triPtIds1;
+    this->Mesh[1]->GetCellPoints(intersection.cellId[1], npts1, triPtIds1);
+
+    this->AddIntersection(intersection.cellId[0], intersection.cellId[1],
+                          triPtIds0, triPtIds1,
+                          intersection.pt[0], intersection.pt[1],
+                          intersection.surfaceId);
+    }
+
+  return SV_OK;
+}
+
+// ----------------------
+// Impl::AddIntersection
+// ----------------------
+int vtkSVLoopIntersectionPolyDataFilter::Impl
+::AddIntersection(vtkIdType cellId0, vtkIdType cellId1,
+                  vtkIdType *triPtIds0, vtkIdType *triPtIds1,
+                  double outpt0[3], double outpt1[3], double surfaceid[2])
+{
+  vtkPolyData     *mesh0                 = this->Mesh[0];
+  vtkPolyData     *mesh1                 = this->Mesh[1];
+  vtkCellArray    *intersectionLines     = this->IntersectionLines;
+  vtkIdTypeArray  *intersectionSurfaceId = this->SurfaceId;
+  vtkIdTypeArray  *intersectionCellIds0  = this->CellIds[0];
+  vtkIdTypeArray  *intersectionCellIds1  = this->CellIds[1];
+  vtkPointLocator *pointMerger           = this->PointMerger;
+
+  vtkIdType lineId = intersectionLines->GetNumberOfCells();
+
+  vtkIdType ptId0, ptId1;
+  int unique[2];
+  unique[0] = pointMerger->InsertUniquePoint(outpt0, ptId0);
+  unique[1] = pointMerger->InsertUniquePoint(outpt1, ptId1);
+
+  int addline = 1;
+  if (ptId0 == ptId1)
+    {
+    addline = 0;
+    }
+
+  if (ptId0 == ptId1 && surfaceid[0] != surfaceid[1])
+    {
+    intersectionSurfaceId->InsertValue(ptId0, 3);
+    }
+  else
+    {
+    if (unique[0])
+      {
+      intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
+      }
+    else
+      {
+      if (intersectionSurfaceId->GetValue(ptId0) != 3)
+        {
+        intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
+        }
+      }
+    if (unique[1])
+      {
+      intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
+      }
+    else
+      {
+      if (intersectionSurfaceId->GetValue(ptId1) != 3)
+        {
+        intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
+        }
+      }
+    }
+
+  this->IntersectionPtsMap[0]->
+    insert(std::make_pair(ptId0, cellId0));
+  this->IntersectionPtsMap[1]->
+    insert(std::make_pair(ptId0, cellId1));
+  this->IntersectionPtsMap[0]->
+    insert(std::make_pair(ptId1, cellId0));
+  this->IntersectionPtsMap[1]->
+    insert(std::make_pair(ptId1, cellId1));
+
+  //Check to see if duplicate line. Line can only be a duplicate
+  //line if both points are not unique and they don't
+  //equal eachother
+  if (!unique[0] && !unique[1] && ptId0 != ptId1)
+    {
+    vtkNew(vtkPolyData, lineTest);
+    lineTest->SetPoints(pointMerger->GetPoints());
+    lineTest->SetLines(intersectionLines);
+    lineTest->BuildLinks();
+    int newLine = this->CheckLine(lineTest, ptId0, ptId1);
+    if (newLine == 0)
+      {
+      addline = 0;
+      }
+    }
+  if (addline)
+    {
+    //If the line is new and does not consist of two identical
+    //points, add the line to the intersection and update
+    //mapping information
+    intersectionLines->InsertNextCell(2);
+    intersectionLines->InsertCellPoint(ptId0);
+    intersectionLines->InsertCellPoint(ptId1);
+
+    intersectionCellIds0->InsertNextValue(cellId0);
+    intersectionCellIds1->InsertNextValue(cellId1);
+
+    this->PointCellIds[0]->InsertValue(ptId0, cellId0);
+    this->PointCellIds[0]->InsertValue(ptId1, cellId0);
+    this->PointCellIds[1]->InsertValue(ptId0, cellId1);
+    this->PointCellIds[1]->InsertValue(ptId1, cellId1);
+
+    this->IntersectionMap[0]->
+      insert(std::make_pair(cellId0, lineId));
+    this->IntersectionMap[1]->
+      insert(std::make_pair(cellId1, lineId));
+
+    // Check which edges of cellId0 and cellId1 outpt0 and
+    // outpt1 are on, if any.
+    int isOnEdge=0;
+    int m0p0=0, m0p1=0, m1p0=0, m1p1=0;
+    for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
+      {
+      isOnEdge = this->AddToPointEdgeMap(0, ptId0, outpt0,
+          mesh0, cellId0, edgeId, lineId, triPtIds0);
+      if (isOnEdge != -1)
+        {
+        m0p0++;
+        }
+      isOnEdge = this->AddToPointEdgeMap(0, ptId1, outpt1,
+          mesh0, cellId0, edgeId, lineId, triPtIds0);
+      if (isOnEdge != -1)
+        {
+        m0p1++;
+        }
+      isOnEdge = this->AddToPointEdgeMap(1, ptId0, outpt0,
+          mesh1, cellId1, edgeId, lineId, triPtIds1);
+      if (isOnEdge != -1)
+        {
+        m1p0++;
         }
+      isOnEdge = this->AddToPointEdgeMap(1, ptId1, outpt1,
+          mesh1, cellId1, edgeId, lineId, triPtIds1);
+      if (isOnEdge != -1)
+        {
+        m1p1++;
+        }
+      }
+    //Special cases caught by tolerance and not from the Point
+    //Merger
+    if (m0p0 > 0 && m1p0 > 0)
+      {
+      intersectionSurfaceId->InsertValue(ptId0, 3);
       }
+    if (m0p1 > 0 && m1p1 > 0)
+      {
+      intersectionSurfaceId->InsertValue(ptId1, 3);
+      }
+    }
+  //Add information about origin surface to std::maps for
+  //checks later
+  if (intersectionSurfaceId->GetValue(ptId0) == 1)
+    {
+    this->IntersectionPtsMap[0]->
+      insert(std::make_pair(ptId0, cellId0));
+    }
+  else if (intersectionSurfaceId->GetValue(ptId0) == 2)
+    {
+    this->IntersectionPtsMap[1]->
+      insert(std::make_pair(ptId0, cellId1));
+    }
+  else
+    {
+    this->IntersectionPtsMap[0]->
+      insert(std::make_pair(ptId0, cellId0));
+    this->IntersectionPtsMap[1]->
+      insert(std::make_pair(ptId0, cellId1));
+    }
+  if (intersectionSurfaceId->GetValue(ptId1) == 1)
+    {
+    this->IntersectionPtsMap[0]->
+      insert(std::make_pair(ptId1, cellId0));
+    }
+  else if (intersectionSurfaceId->GetValue(ptId1) == 2)
+    {
+    this->IntersectionPtsMap[1]->
+      insert(std::make_pair(ptId1, cellId1));
+    }
+  else
+    {
+    this->IntersectionPtsMap[0]->
+      insert(std::make_pair(ptId1, cellId0));
+    this->IntersectionPtsMap[1]->
+      insert(std::make_pair(ptId1, cellId1));
     }
 
   return SV_OK;
@@ -2035,6 +2260,7 @@ vtkSVLoopIntersectionPolyDataFilter::vtkSVLoopIntersectionPolyDataFilter()
   this->CheckInput = 0;
   this->Status = 1;
   this->ComputeIntersectionPointArray = 0;
+  this->ParallelIntersection = 1;
   this->Tolerance = 1e-6;
 }
 
@@ -2059,6 +2285,8 @@ void vtkSVLoopIntersectionPolyDataFilter::PrintSelf(ostream &os, vtkIndent inden
   os << indent << "Status: " << this->CheckMesh << "\n";
   os << indent << "ComputeIntersectionPointArray: " <<
           this->ComputeIntersectionPointArray << "\n";
+  os << indent << "ParallelIntersection: " <<
+          this->ParallelIntersection << "\n";
   os << indent << "Tolerance: " <<
           this->Tolerance << "\n";
 }
@@ -2499,9 +2727,19 @@ int vtkSVLoopIntersectionPolyDataFilter::RequestData(
   impl->PointMerger = pointMerger;
 
   // This performs the triangle intersection search
-  obbTree0->IntersectWithOBBTree
-    (obbTree1, 0, vtkSVLoopIntersectionPolyDataFilter::
-     Impl::FindTriangleIntersections, impl);
+  if (this->ParallelIntersection)
+    {
+    obbTree0->IntersectWithOBBTree
+      (obbTree1, 0, vtkSVLoopIntersectionPolyDataFilter::
+       Impl::CollectNodePairs, impl);
+    impl->FindTriangleIntersectionsInParallel();
+    }
+  else
+    {
+    obbTree0->IntersectWithOBBTree
+      (obbTree1, 0, vtkSVLoopIntersectionPolyDataFilter::
+       Impl::FindTriangleIntersections, impl);
+    }
 
   int rawLines = outputIntersection->GetNumberOfLines();
 
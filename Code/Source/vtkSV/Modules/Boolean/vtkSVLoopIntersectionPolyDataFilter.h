@@ -145,6 +145,17 @@ public:
   vtkGetMacro(Status, int);
   //@}
 
+  //@{
+  /// \brief If on, the triangle-triangle intersection search is done in two
+  /// phases: the overlapping OBB node pairs are collected first, the exact
+  /// triangle tests are then run across threads, and the resulting lines are
+  /// merged in traversal order so the output matches the serial search.
+  /// Default: ON
+  vtkGetMacro(ParallelIntersection, int);
+  vtkSetMacro(ParallelIntersection, int);
+  vtkBooleanMacro(ParallelIntersection, int);
+  //@}
+
   //@{
   /// \brief The tolerance for geometric tests in the filter
   vtkGetMacro(Tolerance, double);
@@ -190,6 +201,7 @@ protected:
   int CheckMesh;
   int CheckInput;
   int Status;
+  int ParallelIntersection;
   double Tolerance;
 
 private:
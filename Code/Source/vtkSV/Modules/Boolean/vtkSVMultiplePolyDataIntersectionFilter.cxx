@@ -49,6 +49,75 @@
 #include "vtkIdList.h"
 #include "vtkIntArray.h"
 #include "vtkAppendPolyData.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// ----------------------
+// vtkSVUnionCluster
+// ----------------------
+/// \brief A partial result of the tree union and the inputs it holds
+struct vtkSVUnionCluster
+{
+  vtkSmartPointer<vtkPolyData> Surface;
+  std::vector<int> Inputs;
+  int Active;
+  int NumberOfIntersections;
+};
+
+// ----------------------
+// vtkSVUnionPairFunctor
+// ----------------------
+/// \brief Unions one round of matched partial results. Each result is in
+/// at most one pair so the pairs share no data. Status is 1 for a union,
+/// 0 if the pair does not actually intersect, -1 on failure.
+class vtkSVUnionPairFunctor
+{
+public:
+  std::vector<vtkSVUnionCluster> *Clusters;
+  std::vector<std::pair<int, int> > *Pairs;
+  std::vector<vtkSmartPointer<vtkPolyData> > *Results;
+  std::vector<int> *Statuses;
+  double Tolerance;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType p = begin; p < end; p++)
+    {
+      vtkPolyData *surface0 = (*this->Clusters)[(*this->Pairs)[p].first].Surface;
+      vtkPolyData *surface1 = (*this->Clusters)[(*this->Pairs)[p].second].Surface;
+      try
+      {
+        vtkNew(vtkSVLoopBooleanPolyDataFilter, boolean);
+        boolean->SetInputData(0, surface0);
+        boolean->SetInputData(1, surface1);
+        boolean->SetTolerance(this->Tolerance);
+        boolean->SetOperationToUnion();
+        boolean->Update();
+        if (boolean->GetStatus() != 1)
+        {
+          (*this->Statuses)[p] = -1;
+          continue;
+        }
+        if (boolean->GetNumberOfIntersectionPoints() == 0 ||
+            boolean->GetNumberOfIntersectionLines() == 0)
+        {
+          (*this->Statuses)[p] = 0;
+          continue;
+        }
+        (*this->Results)[p] = vtkSmartPointer<vtkPolyData>::New();
+        (*this->Results)[p]->DeepCopy(boolean->GetOutput());
+        (*this->Statuses)[p] = 1;
+      }
+      catch (...)
+      {
+        (*this->Statuses)[p] = -1;
+      }
+    }
+  }
+};
 
 // ----------------------
 // StandardNewMacro
@@ -65,6 +134,7 @@ vtkSVMultiplePolyDataIntersectionFilter::vtkSVMultiplePolyDataIntersectionFilter
   this->NoIntersectionOutput = 1;
   this->PassInfoAsGlobal = 0;
   this->AssignSurfaceIds = 0;
+  this->TreeReduction = 1;
 
   this->BooleanObject = vtkPolyData::New();
   this->IntersectionTable = NULL;
@@ -299,6 +369,162 @@ int vtkSVMultiplePolyDataIntersectionFilter::ExecuteIntersection(
   return SV_OK;
 }
 
+// ----------------------
+// ExecuteTreeIntersection
+// ----------------------
+/// \details Every input starts as its own partial result. Each round the
+/// partial results that still have an untried pair of overlapping inputs
+/// (from the IntersectionTable) are matched up, smallest first, and the
+/// matched pairs are unioned in parallel. A pair that turns out not to
+/// intersect is marked as tried and kept apart. Rounds continue until no
+/// candidate pairs are left. The result holding input 0 becomes the
+/// BooleanObject and the rest are left in TreeResults.
+int vtkSVMultiplePolyDataIntersectionFilter::ExecuteTreeIntersection(
+    vtkPolyData* inputs[], int numInputs)
+{
+  std::vector<vtkSVUnionCluster> clusters(numInputs);
+  for (int i = 0; i < numInputs; i++)
+    {
+    clusters[i].Surface = vtkSmartPointer<vtkPolyData>::New();
+    clusters[i].Surface->DeepCopy(inputs[i]);
+    clusters[i].Inputs.push_back(i);
+    clusters[i].Active = 1;
+    clusters[i].NumberOfIntersections = 0;
+    }
+
+  while (true)
+    {
+    // Find every pair of partial results with an untried overlap
+    std::vector<std::pair<vtkIdType, std::pair<int, int> > > candidates;
+    for (int a = 0; a < numInputs; a++)
+      {
+      if (!clusters[a].Active)
+        continue;
+      for (int b = a+1; b < numInputs; b++)
+        {
+        if (!clusters[b].Active)
+          continue;
+        int overlap = 0;
+        for (size_t ia = 0; ia < clusters[a].Inputs.size() && !overlap; ia++)
+          {
+          for (size_t ib = 0; ib < clusters[b].Inputs.size() && !overlap; ib++)
+            {
+            if (this->IntersectionTable[clusters[a].Inputs[ia]][clusters[b].Inputs[ib]] == 1)
+              overlap = 1;
+            }
+          }
+        if (overlap)
+          {
+          vtkIdType cost = clusters[a].Surface->GetNumberOfCells() +
+                           clusters[b].Surface->GetNumberOfCells();
+          candidates.push_back(std::make_pair(cost, std::make_pair(a, b)));
+          }
+        }
+      }
+    if (candidates.empty())
+      break;
+
+    // Smallest pairs first keeps the tree balanced
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<int> matched(numInputs, 0);
+    std::vector<std::pair<int, int> > pairs;
+    for (size_t c = 0; c < candidates.size(); c++)
+      {
+      int a = candidates[c].second.first;
+      int b = candidates[c].second.second;
+      if (matched[a] || matched[b])
+        continue;
+      matched[a] = matched[b] = 1;
+      pairs.push_back(std::make_pair(a, b));
+      }
+
+    if (this->PassInfoAsGlobal)
+      {
+      for (size_t p = 0; p < pairs.size(); p++)
+        {
+        vtkPolyData *surfaces[2] = {clusters[pairs[p].first].Surface,
+                                    clusters[pairs[p].second].Surface};
+        for (int s = 0; s < 2; s++)
+          {
+          if (!surfaces[s]->GetPointData()->HasArray("GlobalBoundaryPoints"))
+            this->PreSetGlobalArrays(surfaces[s]);
+          }
+        }
+      }
+
+    std::vector<vtkSmartPointer<vtkPolyData> > results(pairs.size());
+    std::vector<int> statuses(pairs.size(), -1);
+    vtkSVUnionPairFunctor unionPairs;
+    unionPairs.Clusters = &clusters;
+    unionPairs.Pairs = &pairs;
+    unionPairs.Results = &results;
+    unionPairs.Statuses = &statuses;
+    unionPairs.Tolerance = this->Tolerance;
+    vtkSMPTools::For(0, pairs.size(), 1, unionPairs);
+
+    for (size_t p = 0; p < pairs.size(); p++)
+      {
+      vtkSVUnionCluster &clusterA = clusters[pairs[p].first];
+      vtkSVUnionCluster &clusterB = clusters[pairs[p].second];
+      if (statuses[p] == -1)
+        {
+        vtkErrorMacro("Union of inputs " << clusterA.Inputs[0] << " and " <<
+                      clusterB.Inputs[0] << " failed");
+        return SV_ERROR;
+        }
+      else if (statuses[p] == 0)
+        {
+        std::cout<<"NO INTERSECTION FOR OBJECTS "<<clusterA.Inputs[0]<<
+          " AND "<<clusterB.Inputs[0]<<endl;
+        for (size_t ia = 0; ia < clusterA.Inputs.size(); ia++)
+          {
+          for (size_t ib = 0; ib < clusterB.Inputs.size(); ib++)
+            {
+            this->IntersectionTable[clusterA.Inputs[ia]][clusterB.Inputs[ib]] = -1;
+            this->IntersectionTable[clusterB.Inputs[ib]][clusterA.Inputs[ia]] = -1;
+            }
+          }
+        }
+      else
+        {
+        std::cout<<"UNIONED "<<clusterA.Inputs.size()<<" AND "<<
+          clusterB.Inputs.size()<<" INPUTS"<<endl;
+        clusterA.Surface = results[p];
+        clusterA.Inputs.insert(clusterA.Inputs.end(),
+                               clusterB.Inputs.begin(), clusterB.Inputs.end());
+        std::sort(clusterA.Inputs.begin(), clusterA.Inputs.end());
+        clusterA.NumberOfIntersections += clusterB.NumberOfIntersections + 1;
+        clusterB.Active = 0;
+        clusterB.Surface = NULL;
+        clusterB.Inputs.clear();
+        if (this->PassInfoAsGlobal)
+          this->MergeGlobalArrays(clusterA.Surface);
+        }
+      }
+    }
+
+  // Input 0 is always in the first active result since inputs are merged
+  // into the lower index
+  this->TreeResults.clear();
+  for (int i = 0; i < numInputs; i++)
+    {
+    if (!clusters[i].Active)
+      continue;
+    if (clusters[i].NumberOfIntersections > 0)
+      {
+      for (size_t j = 0; j < clusters[i].Inputs.size(); j++)
+        this->inResult[clusters[i].Inputs[j]] = 1;
+      }
+    if (i == 0)
+      this->BooleanObject->DeepCopy(clusters[i].Surface);
+    else
+      this->TreeResults.push_back(clusters[i].Surface);
+    }
+  this->inResult[0] = 1;
+
+  return SV_OK;
+}
+
 // ----------------------
 // PreSetGlobalArrays
 // ----------------------
@@ -389,6 +615,53 @@ void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
   }
 }
 
+// ----------------------
+// MergeGlobalArrays
+// ----------------------
+/// \details Add the boundary of the latest union in object to its global
+/// boundary arrays. Missing global arrays are treated as all zero.
+void vtkSVMultiplePolyDataIntersectionFilter::MergeGlobalArrays(
+    vtkPolyData *object)
+{
+  vtkIntArray *currentPointArray = vtkIntArray::SafeDownCast(
+    object->GetPointData()->GetArray("BoundaryPoints"));
+  vtkIntArray *currentCellArray = vtkIntArray::SafeDownCast(
+    object->GetCellData()->GetArray("BoundaryCells"));
+  vtkIntArray *globalPointArray = vtkIntArray::SafeDownCast(
+    object->GetPointData()->GetArray("GlobalBoundaryPoints"));
+  vtkIntArray *globalCellArray = vtkIntArray::SafeDownCast(
+    object->GetCellData()->GetArray("GlobalBoundaryCells"));
+  if (currentPointArray == NULL || currentCellArray == NULL)
+    return;
+
+  int numPts = object->GetNumberOfPoints();
+  vtkNew(vtkIntArray, newPointArray);
+  newPointArray->SetNumberOfTuples(numPts);
+  for (int i = 0; i < numPts; i++)
+  {
+    int value = currentPointArray->GetValue(i) == 1 ||
+      (globalPointArray != NULL && globalPointArray->GetValue(i) == 1);
+    newPointArray->SetValue(i, value);
+  }
+
+  int numCells = object->GetNumberOfCells();
+  vtkNew(vtkIntArray, newCellArray);
+  newCellArray->SetNumberOfTuples(numCells);
+  for (int i = 0; i < numCells; i++)
+  {
+    int value = currentCellArray->GetValue(i) == 1 ||
+      (globalCellArray != NULL && globalCellArray->GetValue(i) == 1);
+    newCellArray->SetValue(i, value);
+  }
+
+  object->GetPointData()->RemoveArray("GlobalBoundaryPoints");
+  newPointArray->SetName("GlobalBoundaryPoints");
+  object->GetPointData()->AddArray(newPointArray);
+  object->GetCellData()->RemoveArray("GlobalBoundaryCells");
+  newCellArray->SetName("GlobalBoundaryCells");
+  object->GetCellData()->AddArray(newCellArray);
+}
+
 // ----------------------
 // SetSurfaceId
 // ----------------------
@@ -464,8 +737,16 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
     vtkGenericWarningMacro( << "No intersections!");
   //this->PrintTable(numInputs);
 
-  this->BooleanObject->DeepCopy(inputs[0]);
-  int retVal = this->ExecuteIntersection(inputs,numInputs,0);
+  int retVal;
+  if (this->TreeReduction)
+    {
+    retVal = this->ExecuteTreeIntersection(inputs,numInputs);
+    }
+  else
+    {
+    this->BooleanObject->DeepCopy(inputs[0]);
+    retVal = this->ExecuteIntersection(inputs,numInputs,0);
+    }
   if (retVal == 0)
   {
     this->Status = 0;
@@ -480,7 +761,16 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
   }
   vtkNew(vtkAppendPolyData, appender);
   vtkNew(vtkPolyData, tmp);
-  if (this->NoIntersectionOutput)
+  if (this->NoIntersectionOutput && this->TreeReduction)
+  {
+    tmp->DeepCopy(this->BooleanObject);
+    appender->AddInputData(tmp);
+    for (size_t i = 0; i < this->TreeResults.size(); i++)
+      appender->AddInputData(this->TreeResults[i]);
+    appender->Update();
+    this->BooleanObject->DeepCopy(appender->GetOutput());
+  }
+  else if (this->NoIntersectionOutput)
   {
     tmp->DeepCopy(this->BooleanObject);
     appender->AddInputData(tmp);
@@ -513,6 +803,7 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
   }
 
   output->DeepCopy(this->BooleanObject);
+  this->TreeResults.clear();
 
   for (int idx = 0; idx < numInputs; ++idx)
     {
@@ -616,6 +907,7 @@ void vtkSVMultiplePolyDataIntersectionFilter::PrintSelf(ostream& os,
   os << "UserManagedInputs:" << (this->UserManagedInputs?"On":"Off") << endl;
   os << "AssignSurfaceIds:" << (this->AssignSurfaceIds?"On":"Off") << endl;
   os << "PassInfoAsGlobal:" << (this->PassInfoAsGlobal?"On":"Off") << endl;
+  os << "TreeReduction:" << (this->TreeReduction?"On":"Off") << endl;
 }
 
 // ----------------------
@@ -46,6 +46,9 @@
 
 #include "vtkPolyData.h"
 #include "vtkPolyDataAlgorithm.h"
+#include "vtkSmartPointer.h"
+
+#include <vector>
 
 class VTKSVBOOLEAN_EXPORT vtkSVMultiplePolyDataIntersectionFilter : public vtkPolyDataAlgorithm
 {
@@ -132,6 +135,17 @@ public:
   vtkGetMacro(AssignSurfaceIds,int);
   //@}
 
+  //@{
+  /// \brief Set/get boolean to union the inputs as a balanced tree. Each
+  /// round pairs up partial results whose inputs' bounding boxes overlap
+  /// and unions the pairs in parallel, so no boolean works on the full
+  /// model until the last rounds. With a value of 0, the inputs are folded
+  /// one at a time into a single growing object. On by default.
+  vtkSetMacro(TreeReduction,int);
+  vtkGetMacro(TreeReduction,int);
+  vtkBooleanMacro(TreeReduction,int);
+  //@}
+
   //@{
   /// \brief Check the status of the filter after update. If the status is zero,
   /// there was an error in the operation. If status is one, everything
@@ -164,10 +178,12 @@ protected:
   int NoIntersectionOutput;
   int PassInfoAsGlobal;
   int AssignSurfaceIds;
+  int TreeReduction;
 
   int **IntersectionTable;
   int *inResult;
   vtkPolyData *BooleanObject;
+  std::vector<vtkSmartPointer<vtkPolyData> > TreeResults;
   int Status;
   double Tolerance;
 
@@ -175,9 +191,12 @@ protected:
   int BuildIntersectionTable(vtkPolyData* inputs[], int numInputs);
   //Function to run the intersection on intersecting polydatas
   int ExecuteIntersection(vtkPolyData *inputs[],int numInputs,int start);
+  //Function to union all intersecting polydatas as a balanced tree
+  int ExecuteTreeIntersection(vtkPolyData *inputs[],int numInputs);
   //Function to set the boundary point information as global information
   void PreSetGlobalArrays(vtkPolyData *input);
   void PostSetGlobalArrays(int numIntersections);
+  void MergeGlobalArrays(vtkPolyData *object);
   //Function to set surface id
   void SetSurfaceId(vtkPolyData *input,int surfaceid);
 
@@ -35,12 +35,108 @@
 #include "vtkCleanPolyData.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkSparseArray.h"
 
 #include "vtkSVGlobals.h"
 #include "vtkSVNURBSUtils.h"
 
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Evaluates the grid one u sample at a time. The weighted control net is
+// first contracted with the u basis functions into a row over all v control
+// points, and that row is then contracted for every v sample. All tables are
+// contiguous so the inner loops are straight multiply-adds.
+class vtkSVNURBSSurfaceGridFunctor
+{
+public:
+  const double *Pw;
+  int NumVCon;
+  int P, Q;
+  int NumUEvals, NumVEvals;
+  const int *UFirst, *VFirst;
+  const double *UBasis, *VBasis;
+  const double *UDBasis, *VDBasis;
+  double *Points, *UDerivs, *VDerivs;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int rowSize = 4*this->NumVCon;
+    int computeDerivs = this->UDBasis != NULL;
+    std::vector<double> row(rowSize), rowDu(computeDerivs ? rowSize : 0);
+
+    for (vtkIdType a=begin; a<end; a++)
+    {
+      const double *Nu  = this->UBasis + a*(this->P+1);
+      const double *Pwa = this->Pw + this->UFirst[a]*rowSize;
+      std::fill(row.begin(), row.end(), 0.0);
+      for (int m=0; m<this->P+1; m++)
+      {
+        const double *Pwm = Pwa + m*rowSize;
+        for (int l=0; l<rowSize; l++)
+          row[l] += Nu[m]*Pwm[l];
+      }
+      if (computeDerivs)
+      {
+        const double *dNu = this->UDBasis + a*(this->P+1);
+        std::fill(rowDu.begin(), rowDu.end(), 0.0);
+        for (int m=0; m<this->P+1; m++)
+        {
+          const double *Pwm = Pwa + m*rowSize;
+          for (int l=0; l<rowSize; l++)
+            rowDu[l] += dNu[m]*Pwm[l];
+        }
+      }
+
+      for (int b=0; b<this->NumVEvals; b++)
+      {
+        const double *Nv = this->VBasis + b*(this->Q+1);
+        int offset = 4*this->VFirst[b];
+        double A[4] = {0.0, 0.0, 0.0, 0.0};
+        for (int l=0; l<this->Q+1; l++)
+        {
+          for (int c=0; c<4; c++)
+            A[c] += Nv[l]*row[offset + 4*l + c];
+        }
+
+        vtkIdType ptId = a + b*this->NumUEvals;
+        double *pt = this->Points + 3*ptId;
+        for (int c=0; c<3; c++)
+          pt[c] = A[c]/A[3];
+
+        if (!computeDerivs)
+          continue;
+
+        // Rational derivative, S' = (A' - w'S)/w
+        const double *dNv = this->VDBasis + b*(this->Q+1);
+        double Au[4] = {0.0, 0.0, 0.0, 0.0};
+        double Av[4] = {0.0, 0.0, 0.0, 0.0};
+        for (int l=0; l<this->Q+1; l++)
+        {
+          for (int c=0; c<4; c++)
+          {
+            Au[c] += Nv[l]*rowDu[offset + 4*l + c];
+            Av[c] += dNv[l]*row[offset + 4*l + c];
+          }
+        }
+        for (int c=0; c<3; c++)
+        {
+          if (this->UDerivs != NULL)
+            this->UDerivs[3*ptId + c] = (Au[c] - Au[3]*pt[c])/A[3];
+          if (this->VDerivs != NULL)
+            this->VDerivs[3*ptId + c] = (Av[c] - Av[3]*pt[c])/A[3];
+        }
+      }
+    }
+  }
+};
+}
+
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -572,118 +668,30 @@ int vtkSVNURBSSurface::GeneratePolyDataRepresentation(const double uSpacing,
     return SV_ERROR;
   }
 
-  // Using clamped formula for degree of curve
-  int p = nUKnot - nUCon - 1;
-  int q = nVKnot - nVCon - 1;
-
-  //If nCon - 1 < p, not possible with clamping
-  //If nCon - 1 = p, bezier with clamping
-  //If nCon - 1 > p, fantastic
-
-  // U direction!
-  // -----------------------------------------------------------------------
+  // Sample the parameter space in both directions
   int numUDiv = ceil(1.0/uSpacing);
   vtkNew(vtkDoubleArray, uEvals);
   vtkSVNURBSUtils::LinSpace(0, 1, numUDiv, uEvals);
 
-  // Get sparse array for Nu
-  vtkNew(vtkSparseArray<double>, Nus);
-  Nus->Resize(numUDiv, p+2);
-
-  // Get sparse array for basis functions
-  vtkNew(vtkSparseArray<double>, NUfinal);
-  NUfinal->Resize(numUDiv, nUCon);
-
-  // Loop through control points
-  for (int i=0; i<nUCon; i++)
-  {
-    if (vtkSVNURBSUtils::BasisEvaluationVec(this->UKnotVector, p,
-                                       i, uEvals, Nus) != SV_OK)
-    {
-      return SV_ERROR;
-    }
-    // for each sampling get the final basis functions
-    for (int j=0; j<numUDiv; j++)
-    {
-      NUfinal->SetValue(j, i, Nus->GetValue(j, 0));
-    }
-  }
-
-  // Last value should be 1
-  NUfinal->SetValue(numUDiv-1, nUCon-1, 1.0);
-
-  // V direction!
-  // -----------------------------------------------------------------------
   int numVDiv = ceil(1.0/vSpacing);
   vtkNew(vtkDoubleArray, vEvals);
   vtkSVNURBSUtils::LinSpace(0, 1, numVDiv, vEvals);
 
-  // Get sparse array for Nv
-  vtkNew(vtkSparseArray<double>, Nvs);
-  Nvs->Resize(numVDiv, q+2);
-
-  // Get sparse array for basis functions
-  vtkNew(vtkSparseArray<double>, NVfinal);
-  NVfinal->Resize(numVDiv, nVCon);
-
-  // Loop through control points
-  for (int i=0; i<nVCon; i++)
-  {
-    // Evaluate the basis functions
-    if (vtkSVNURBSUtils::BasisEvaluationVec(this->VKnotVector, q,
-                                       i, vEvals, Nvs) != SV_OK)
-    {
-      return SV_ERROR;
-    }
-    // for each sampling get the final basis functions
-    double ratVal = 0.0;
-    for (int j=0; j<numVDiv; j++)
-    {
-      NVfinal->SetValue(j, i, Nvs->GetValue(j, 0));
-    }
-  }
-
-  // Last value should be 1
-  NVfinal->SetValue(numVDiv-1, nVCon-1, 1.0);
-
-  vtkNew(vtkSparseArray<double>, NVfinalT);
-  vtkSVNURBSUtils::MatrixTranspose(NVfinal, 0, NVfinalT);
   //Get the physical points on the surface!
   // -----------------------------------------------------------------------
-  // When dealing with the rational of NURBS, need to multiply points by
-  // weights when sending through matrix multiplication. However, still need
-  // fourth spot in point, weight vector because in the end, we will need
-  // to divide by the total weight
-  vtkNew(vtkDenseArray<double>, tmpControlGrid);
-  vtkSVNURBSUtils::ControlGridToTypedArraySPECIAL(this->ControlPointGrid, tmpControlGrid);
-
-  // Do first matrix multiply with u basis functions
-  vtkNew(vtkDenseArray<double>, tmpUGrid);
-  if (vtkSVNURBSUtils::MatrixMatrixMultiply(NUfinal, 0, 1, tmpControlGrid, 1, 4, tmpUGrid) != SV_OK)
-  {
-    vtkErrorMacro("Error in matrix multiply");
-    return SV_ERROR;
-  }
-  // Do second matrix multiply with v basis functions
-  vtkNew(vtkDenseArray<double>, tmpVGrid);
-  if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpUGrid, 1, 4, NVfinalT, 0, 1, tmpVGrid) != SV_OK)
+  vtkNew(vtkPoints, surfacePoints);
+  if (this->EvaluateGrid(uEvals, vEvals, surfacePoints) != SV_OK)
   {
-    vtkErrorMacro("Error in matrix multiply");
+    vtkErrorMacro("Error evaluating surface");
     return SV_ERROR;
   }
 
-  // Set up final grid of points
-  vtkNew(vtkStructuredGrid, finalGrid);
-  vtkNew(vtkPoints, tmpVPoints);
-  finalGrid->SetPoints(tmpVPoints);
-  vtkSVNURBSUtils::TypedArrayToStructuredGridRational(tmpVGrid, finalGrid);
-
   // Get grid connectivity for pointset
   vtkNew(vtkCellArray, surfaceCells);
   this->GetStructuredGridConnectivity(numUDiv, numVDiv, surfaceCells);
 
   // Update the surface representation
-  this->SurfaceRepresentation->SetPoints(finalGrid->GetPoints());
+  this->SurfaceRepresentation->SetPoints(surfacePoints);
   this->SurfaceRepresentation->SetPolys(surfaceCells);
 
   // Clean the surface in case of duplicate points (closed surface)
@@ -699,6 +707,115 @@ int vtkSVNURBSSurface::GeneratePolyDataRepresentation(const double uSpacing,
   return SV_OK;
 }
 
+// ----------------------
+// EvaluateGrid
+// ----------------------
+int vtkSVNURBSSurface::EvaluateGrid(vtkDoubleArray *uEvals,
+                                    vtkDoubleArray *vEvals,
+                                    vtkPoints *points,
+                                    vtkDoubleArray *uDerivs,
+                                    vtkDoubleArray *vDerivs)
+{
+  // Get number of control points and knots
+  int dim[3];
+  this->ControlPointGrid->GetDimensions(dim);
+  int nUCon  = dim[0];
+  int nVCon  = dim[1];
+  int nUKnot = this->UKnotVector->GetNumberOfTuples();
+  int nVKnot = this->VKnotVector->GetNumberOfTuples();
+  if (nUCon == 0 || nVCon == 0)
+  {
+    vtkErrorMacro("No control points");
+    return SV_ERROR;
+  }
+  if (nUKnot == 0 || nVKnot == 0)
+  {
+    vtkErrorMacro("No knot points");
+    return SV_ERROR;
+  }
+  if (this->ControlPointGrid->GetPointData()->GetArray("Weights") == NULL)
+  {
+    vtkErrorMacro("No weights on control point grid");
+    return SV_ERROR;
+  }
+
+  // Using clamped formula for degree of curve
+  int p = nUKnot - nUCon - 1;
+  int q = nVKnot - nVCon - 1;
+
+  // Tabulate the basis functions once per direction
+  int computeDerivs = uDerivs != NULL || vDerivs != NULL;
+  vtkNew(vtkIntArray, uFirst);
+  vtkNew(vtkDoubleArray, uBasis);
+  vtkNew(vtkDoubleArray, uDBasis);
+  if (vtkSVNURBSUtils::GetBasisTable(this->UKnotVector, p, uEvals, uFirst, uBasis,
+                                     computeDerivs ? uDBasis.GetPointer() : NULL) != SV_OK)
+  {
+    vtkErrorMacro("Error getting u basis functions");
+    return SV_ERROR;
+  }
+  vtkNew(vtkIntArray, vFirst);
+  vtkNew(vtkDoubleArray, vBasis);
+  vtkNew(vtkDoubleArray, vDBasis);
+  if (vtkSVNURBSUtils::GetBasisTable(this->VKnotVector, q, vEvals, vFirst, vBasis,
+                                     computeDerivs ? vDBasis.GetPointer() : NULL) != SV_OK)
+  {
+    vtkErrorMacro("Error getting v basis functions");
+    return SV_ERROR;
+  }
+
+  // Weighted control net (x*w, y*w, z*w, w) with v varying fastest
+  std::vector<double> Pw(4*nUCon*nVCon);
+  for (int i=0; i<nUCon; i++)
+  {
+    for (int j=0; j<nVCon; j++)
+    {
+      double pw[4];
+      this->ControlPointGrid->GetControlPoint(i, j, 0, pw);
+      double *dst = &Pw[4*(i*nVCon + j)];
+      for (int c=0; c<3; c++)
+        dst[c] = pw[c]*pw[3];
+      dst[3] = pw[3];
+    }
+  }
+
+  int numUEvals = uEvals->GetNumberOfTuples();
+  int numVEvals = vEvals->GetNumberOfTuples();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numUEvals*numVEvals);
+  if (uDerivs != NULL)
+  {
+    uDerivs->SetNumberOfComponents(3);
+    uDerivs->SetNumberOfTuples(numUEvals*numVEvals);
+  }
+  if (vDerivs != NULL)
+  {
+    vDerivs->SetNumberOfComponents(3);
+    vDerivs->SetNumberOfTuples(numUEvals*numVEvals);
+  }
+
+  vtkSVNURBSSurfaceGridFunctor functor;
+  functor.Pw        = Pw.data();
+  functor.NumVCon   = nVCon;
+  functor.P         = p;
+  functor.Q         = q;
+  functor.NumUEvals = numUEvals;
+  functor.NumVEvals = numVEvals;
+  functor.UFirst    = uFirst->GetPointer(0);
+  functor.VFirst    = vFirst->GetPointer(0);
+  functor.UBasis    = uBasis->GetPointer(0);
+  functor.VBasis    = vBasis->GetPointer(0);
+  functor.UDBasis   = computeDerivs ? uDBasis->GetPointer(0) : NULL;
+  functor.VDBasis   = computeDerivs ? vDBasis->GetPointer(0) : NULL;
+  functor.Points    = vtkDoubleArray::SafeDownCast(points->GetData())->GetPointer(0);
+  functor.UDerivs   = uDerivs != NULL ? uDerivs->GetPointer(0) : NULL;
+  functor.VDerivs   = vDerivs != NULL ? vDerivs->GetPointer(0) : NULL;
+
+  vtkSMPTools::For(0, numUEvals, functor);
+
+  return SV_OK;
+}
+
 // ----------------------
 // GetUMultiplicity
 // ----------------------
@@ -116,6 +116,19 @@ public:
    *  \param vSpacing Sets the spacing to sample the NURBS at in the v parameter direction. */
   int GeneratePolyDataRepresentation(const double uSpacing, const double vSpacing);
 
+  /** \brief Evaluates the surface on the tensor grid of the given parameter
+   *  values. Basis functions are tabulated once per direction and the grid
+   *  rows are evaluated in parallel.
+   *  \param uEvals Parameter values to evaluate at in the u direction.
+   *  \param vEvals Parameter values to evaluate at in the v direction.
+   *  \param points Output points, u index varies fastest.
+   *  \param uDerivs Optional output of the partial derivatives in u.
+   *  \param vDerivs Optional output of the partial derivatives in v. */
+  int EvaluateGrid(vtkDoubleArray *uEvals, vtkDoubleArray *vEvals,
+                   vtkPoints *points,
+                   vtkDoubleArray *uDerivs = NULL,
+                   vtkDoubleArray *vDerivs = NULL);
+
   //Functions to set control points/knots/etc.
   void SetControlPoints(vtkStructuredGrid *points2d);
   void SetKnotVector(vtkDoubleArray *knotVector, const int dim);
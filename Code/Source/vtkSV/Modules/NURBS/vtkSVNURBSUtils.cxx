@@ -46,9 +46,11 @@
 #include "vtkSVNURBSCurve.h"
 #include "vtkSVNURBSSurface.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <string>
+#include <vector>
 
 // ----------------------
 // StandardNewMacro
@@ -371,83 +373,194 @@ int vtkSVNURBSUtils::GetPBasisFunctions(vtkDoubleArray *U, vtkDoubleArray *knots
 {
   int nCon  = U->GetNumberOfTuples();
   int nKnot = knots->GetNumberOfTuples();
-
-  //Get zero order basis function first
-  vtkNew(vtkSparseArray<double>, N0);
-  N0->Resize(nCon, nKnot-1);
-  if (vtkSVNURBSUtils::GetZeroBasisFunctions(U, knots, N0) != SV_OK)
+  int nBasis = nKnot - p - 1;
+  if (nBasis < 1)
   {
+    fprintf(stderr,"Not enough knots for degree %d basis functions\n", p);
     return SV_ERROR;
   }
 
-  //Set original size to the size of the zero basis function set
-  //The size will reduce by one each iteration through the basis until
-  //the correct degree basis functions are met
-  vtkNew(vtkDoubleArray, sub0);
-  vtkNew(vtkDoubleArray, sub1);
-  vtkNew(vtkDoubleArray, term0);
-  vtkNew(vtkDoubleArray, term1);
+  double *knotVals = knots->GetPointer(0);
 
-  double **tmpN = new double*[nCon];
-  for (int i=0; i<nCon; i++)
+  // Only the p+1 functions of the knot span containing u can be non-zero, so
+  // each row is evaluated with the Cox-de Boor recursion restricted to that
+  // span. Entries are computed with the same terms as the full recursion;
+  // a zero denominator drops its term and u outside of [k_0, k_m) gives a
+  // zero row.
+  double *N = new double[p+1];
+
+  vtkSparseArray<double> *sparseNP = vtkSparseArray<double>::SafeDownCast(NP);
+  NP->Resize(nCon, nBasis);
+  if (sparseNP != NULL)
   {
-    tmpN[i] = new double[nKnot-1];
-    for (int j=0; j<nKnot-1; j++)
-      tmpN[i][j] =  N0->GetValue(i, j);
+    sparseNP->Clear();
+  }
+  else
+  {
+    for (int i=0; i<nCon; i++)
+    {
+      for (int j=0; j<nBasis; j++)
+        NP->SetValue(i, j, 0.0);
+    }
   }
 
-  int blength = nKnot;
-  for (int i=1; i<p+1; i++)
+  for (int i=0; i<nCon; i++)
   {
-    blength -= 1;
-    for (int j=0; j<blength-1; j++)
+    double u = U->GetTuple1(i);
+
+    // Zero degree function that is one at u, if any
+    int span = -1;
+    for (int j=0; j<nKnot-1; j++)
     {
-      double k0 = knots->GetTuple1(i+j);
-      double k1 = knots->GetTuple1(j);
-      double k2 = knots->GetTuple1(i+j+1);
-      double k3 = knots->GetTuple1(j+1);
-      double denom0  = k0 - k1;
-      double denom1  = k2 - k3;
-      if (denom0 != 0.0)
+      if (knotVals[j] <= u && u < knotVals[j+1])
       {
-        vtkSVNURBSUtils::AddVal1D(U, k1, -1.0, sub0);
-        vtkSVNURBSUtils::MultiplyVal1D(sub0, 1.0/(denom0), term0);
+        span = j;
+        break;
       }
-      else
+    }
+    if (span == -1)
+    {
+      continue;
+    }
+
+    // N[m] holds N_{span-p+m, d}
+    for (int m=0; m<p; m++)
+      N[m] = 0.0;
+    N[p] = 1.0;
+
+    for (int d=1; d<p+1; d++)
+    {
+      for (int m=0; m<p+1; m++)
       {
-        term0->SetNumberOfTuples(blength-1);
-        term0->FillComponent(0, 0.0);
+        int j = span - p + m;
+        if (j < 0 || j > nKnot - d - 2)
+        {
+          N[m] = 0.0;
+          continue;
+        }
+        double next = m < p ? N[m+1] : 0.0;
+
+        double k0 = knotVals[j+d];
+        double k1 = knotVals[j];
+        double k2 = knotVals[j+d+1];
+        double k3 = knotVals[j+1];
+        double denom0 = k0 - k1;
+        double denom1 = k2 - k3;
+
+        double final0 = 0.0, final1 = 0.0;
+        if (denom0 != 0.0)
+          final0 = ((u - k1) * (1.0/denom0)) * N[m];
+        if (denom1 != 0.0)
+          final1 = ((k2 - u) * (1.0/denom1)) * next;
+        N[m] = final0 + final1;
       }
-      if (denom1 != 0.0)
+    }
+
+    for (int m=0; m<p+1; m++)
+    {
+      int j = span - p + m;
+      if (j >= 0 && j < nBasis && N[m] != 0.0)
+        NP->SetValue(i, j, N[m]);
+    }
+  }
+
+  delete [] N;
+  return SV_OK;
+}
+
+// ----------------------
+// GetBasisTable
+// ----------------------
+int vtkSVNURBSUtils::GetBasisTable(vtkDoubleArray *knots, const int p,
+                                   vtkDoubleArray *U, vtkIntArray *firstBasis,
+                                   vtkDoubleArray *basis,
+                                   vtkDoubleArray *derivs)
+{
+  int nKnot = knots->GetNumberOfTuples();
+  int nCon  = nKnot - p - 1;
+  int numEvals = U->GetNumberOfTuples();
+  if (p < 0 || nCon < p + 1)
+  {
+    fprintf(stderr,"Not enough knots for degree %d basis functions\n", p);
+    return SV_ERROR;
+  }
+
+  double *knotVals = knots->GetPointer(0);
+  double uMin = knotVals[p];
+  double uMax = knotVals[nCon];
+
+  firstBasis->SetNumberOfComponents(1);
+  firstBasis->SetNumberOfTuples(numEvals);
+  basis->SetNumberOfComponents(p+1);
+  basis->SetNumberOfTuples(numEvals);
+  if (derivs != NULL)
+  {
+    derivs->SetNumberOfComponents(p+1);
+    derivs->SetNumberOfTuples(numEvals);
+  }
+
+  // Triangular scheme of the NURBS book (A2.2), N[r] holds N_{span-p+r, j}
+  // after step j. The degree p-1 values are kept for the derivatives.
+  std::vector<double> left(p+1), right(p+1), N(p+1), Nm1(p+1);
+  for (int i=0; i<numEvals; i++)
+  {
+    double u = U->GetTuple1(i);
+    if (u < uMin)
+      u = uMin;
+    if (u > uMax)
+      u = uMax;
+
+    int span;
+    vtkSVNURBSUtils::FindSpan(p, u, knots, span);
+
+    N[0] = 1.0;
+    for (int j=1; j<p+1; j++)
+    {
+      if (j == p)
+        std::copy(N.begin(), N.begin() + p, Nm1.begin());
+
+      left[j]  = u - knotVals[span+1-j];
+      right[j] = knotVals[span+j] - u;
+      double saved = 0.0;
+      for (int r=0; r<j; r++)
       {
-        vtkSVNURBSUtils::AddVal1D(k2, U, -1.0, sub1);
-        vtkSVNURBSUtils::MultiplyVal1D(sub1, 1.0/(denom1), term1);
+        double denom = right[r+1] + left[j-r];
+        double temp  = denom != 0.0 ? N[r]/denom : 0.0;
+        N[r]  = saved + right[r+1]*temp;
+        saved = left[j-r]*temp;
       }
-      else
+      N[j] = saved;
+    }
+
+    firstBasis->SetValue(i, span - p);
+    double *basisRow = basis->GetPointer(i*(p+1));
+    for (int m=0; m<p+1; m++)
+      basisRow[m] = N[m];
+
+    if (derivs == NULL)
+      continue;
+
+    // N'_{k,p} = p/(k_{k+p}-k_k) N_{k,p-1} - p/(k_{k+p+1}-k_{k+1}) N_{k+1,p-1}
+    double *derivRow = derivs->GetPointer(i*(p+1));
+    for (int m=0; m<p+1; m++)
+    {
+      double dN = 0.0;
+      if (m > 0)
       {
-        term1->SetNumberOfTuples(blength-1);
-        term1->FillComponent(0, 0.0);
+        double denom = knotVals[span+m] - knotVals[span-p+m];
+        if (denom != 0.0)
+          dN += Nm1[m-1]/denom;
       }
-      for (int k=0; k<nCon; k++)
+      if (m < p)
       {
-        double final0 = term0->GetTuple1(k) * (tmpN[k][j]);
-        double final1 = term1->GetTuple1(k) * (tmpN[k][j+1]);
-        tmpN[k][j] = final0 + final1;
+        double denom = knotVals[span+m+1] - knotVals[span-p+m+1];
+        if (denom != 0.0)
+          dN -= Nm1[m]/denom;
       }
-    }
-  }
-  NP->Resize(nCon, blength-1);
-  for (int i=0; i<nCon; i++)
-  {
-    for (int j=0; j<blength-1; j++)
-    {
-      NP->SetValue(i, j, tmpN[i][j]);
+      derivRow[m] = p*dN;
     }
   }
 
-  for (int i=0; i<nCon; i++)
-    delete [] tmpN[i];
-  delete [] tmpN;
   return SV_OK;
 }
 
@@ -488,14 +601,10 @@ int vtkSVNURBSUtils::GetControlPointsOfCurve(vtkPoints *points, vtkDoubleArray *
     vtkSVNURBSUtils::DeepCopy(pointArrayTmp, pointArrayFinal);
   }
 
-  vtkNew(vtkSparseArray<double>, NPinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPFinal, NPinv) != SV_OK)
-  {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
-  if (vtkSVNURBSUtils::MatrixVecMultiply(NPinv, 0, pointArrayFinal, 1, cPointArray) != SV_OK)
+  vtkSVNURBSUtils::DeepCopy(pointArrayFinal, cPointArray);
+  if (vtkSVNURBSUtils::SolveBandedSystem(NPFinal, 0, cPointArray) != SV_OK)
   {
+    fprintf(stderr,"System could not be solved\n");
     return SV_ERROR;
   }
 
@@ -2192,52 +2301,21 @@ int vtkSVNURBSUtils::GetControlPointsOfSurface(vtkStructuredGrid *points, vtkDou
     vtkSVNURBSUtils::DeepCopy(pointMatTmp, pointMatFinal);
   }
 
-  int nUCon = pointMatFinal->GetExtents()[0].GetSize();
-  int nVCon = pointMatFinal->GetExtents()[1].GetSize();
-
-  //fprintf(stdout,"Basis functions U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUFinal);
-  vtkNew(vtkSparseArray<double>, NPUinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPUFinal, NPUinv) != SV_OK)
+  // Solve the banded collocation systems along u and then v in place
+  if (vtkSVNURBSUtils::SolveBandedSystem(NPUFinal, 0, pointMatFinal) != SV_OK)
   {
-    fprintf(stderr,"System could not be inverted\n");
+    fprintf(stderr,"System could not be solved\n");
     return SV_ERROR;
   }
-
-  //fprintf(stdout,"Basis functions V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVFinal);
-  vtkNew(vtkSparseArray<double>, NPVinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPVFinal, NPVinv) != SV_OK)
+  if (vtkSVNURBSUtils::SolveBandedSystem(NPVFinal, 1, pointMatFinal) != SV_OK)
   {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
-
-
-  //fprintf(stdout,"Inverted system U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUinv);
-  //fprintf(stdout,"Inverted system V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVinv);
-  vtkNew(vtkDenseArray<double>, tmpUGrid);
-  if (vtkSVNURBSUtils::MatrixMatrixMultiply(NPUinv, 0, 1, pointMatFinal, 1, 3, tmpUGrid) != SV_OK)
-  {
-    fprintf(stderr, "Error in matrix multiply\n");
-    return SV_ERROR;
-  }
-  vtkNew(vtkDenseArray<double>, tmpUGridT);
-  vtkSVNURBSUtils::MatrixTranspose(tmpUGrid, 1, tmpUGridT);
-  vtkNew(vtkDenseArray<double>, tmpVGrid);
-  if (vtkSVNURBSUtils::MatrixMatrixMultiply(NPVinv, 0, 1, tmpUGridT, 1, 3, tmpVGrid) != SV_OK)
-  {
-    fprintf(stderr, "Error in matrix multiply\n");
+    fprintf(stderr,"System could not be solved\n");
     return SV_ERROR;
   }
 
   vtkNew(vtkPoints, finalPoints);
   cPoints->SetPoints(finalPoints);
-  vtkNew(vtkDenseArray<double>, tmpVGridT);
-  vtkSVNURBSUtils::MatrixTranspose(tmpVGrid, 1, tmpVGridT);
-  vtkSVNURBSUtils::TypedArrayToStructuredGrid(tmpVGridT, cPoints);
+  vtkSVNURBSUtils::TypedArrayToStructuredGrid(pointMatFinal, cPoints);
   //fprintf(stdout,"Final structured grid of control points\n");
   //vtkSVNURBSUtils::PrintStructuredGrid(cPoints);
 
@@ -2328,111 +2406,18 @@ int vtkSVNURBSUtils::GetControlPointsOfVolume(vtkStructuredGrid *points,
     vtkSVNURBSUtils::DeepCopy(pointMatTmp, pointMatFinal);
   }
 
-  int nUCon = pointMatFinal->GetExtents()[0].GetSize();
-  int nVCon = pointMatFinal->GetExtents()[1].GetSize();
-  int nWCon = pointMatFinal->GetExtents()[2].GetSize();
-
-  //fprintf(stdout,"Basis functions U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUFinal);
-  vtkNew(vtkSparseArray<double>, NPUinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPUFinal, NPUinv) != SV_OK)
-  {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
-
-  //fprintf(stdout,"Basis functions V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVFinal);
-  vtkNew(vtkSparseArray<double>, NPVinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPVFinal, NPVinv) != SV_OK)
-  {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
-
-  //fprintf(stdout,"Basis functions W:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPWFinal);
-  vtkNew(vtkSparseArray<double>, NPWinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPWFinal, NPWinv) != SV_OK)
+  // Solve the banded collocation systems along u, v and w in place
+  if (vtkSVNURBSUtils::SolveBandedSystem(NPUFinal, 0, pointMatFinal) != SV_OK ||
+      vtkSVNURBSUtils::SolveBandedSystem(NPVFinal, 1, pointMatFinal) != SV_OK ||
+      vtkSVNURBSUtils::SolveBandedSystem(NPWFinal, 2, pointMatFinal) != SV_OK)
   {
-    fprintf(stderr,"System could not be inverted\n");
+    fprintf(stderr,"System could not be solved\n");
     return SV_ERROR;
   }
 
-  //fprintf(stdout,"Inverted system U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUinv);
-  //fprintf(stdout,"Inverted system V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVinv);
-  //fprintf(stdout,"Inverted system W:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPWinv);
-
-  vtkNew(vtkSparseArray<double>, NPVinvT);
-  vtkSVNURBSUtils::MatrixTranspose(NPVinv, 0, NPVinvT);
-
-  vtkNew(vtkSparseArray<double>, NPWinvT);
-  vtkSVNURBSUtils::MatrixTranspose(NPWinv, 0, NPWinvT);
-
-  int numUDiv = NPUinv->GetExtents()[0].GetSize();
-  int numVDiv = NPVinv->GetExtents()[0].GetSize();
-  int numWDiv = NPWinv->GetExtents()[0].GetSize();
-
-  vtkArrayExtents size;
-  size.SetDimensions(4);
-  size.SetExtent(0, vtkArrayRange(0, numUDiv));
-  size.SetExtent(1, vtkArrayRange(0, numVDiv));
-  size.SetExtent(2, vtkArrayRange(0, nWCon));
-  size.SetExtent(3, vtkArrayRange(0, 3));
-  vtkNew(vtkDenseArray<double>, tmpW);
-  tmpW->Resize(size);
-
-  for (int i=0; i<nWCon; i++)
-  {
-    vtkNew(vtkDenseArray<double>, tmpWMat);
-    vtkSVNURBSUtils::GetMatrixOfDim4Grid(pointMatFinal, 0, 1, 2, i, 3, tmpWMat);
-
-
-    vtkNew(vtkDenseArray<double>, tmpUGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(NPUinv, 0, 1, tmpWMat, 1, 3, tmpUGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-    vtkNew(vtkDenseArray<double>, tmpVGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpUGrid, 1, 3, NPVinvT, 0, 1, tmpVGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-
-    vtkSVNURBSUtils::SetMatrixOfDim4Grid(tmpVGrid, tmpW, 0, 1, 2, i, 3);
-  }
-
-  size.SetExtent(0, vtkArrayRange(0, numUDiv));
-  size.SetExtent(1, vtkArrayRange(0, numVDiv));
-  size.SetExtent(2, vtkArrayRange(0, numWDiv));
-  size.SetExtent(3, vtkArrayRange(0, 3));
-  vtkNew(vtkDenseArray<double>, fullGrid);
-  fullGrid->Resize(size);
-
-  for (int i=0; i<numUDiv; i++)
-  {
-    vtkNew(vtkDenseArray<double>, tmpWGrid);
-    vtkSVNURBSUtils::GetMatrixOfDim4Grid(tmpW, 1, 2, 0, i, 3, tmpWGrid);
-
-    // Do second matrix multiply with v basis functions
-    vtkNew(vtkDenseArray<double>, tmpVWGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpWGrid, 1, 3, NPWinvT, 0, 1, tmpVWGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-
-    vtkSVNURBSUtils::SetMatrixOfDim4Grid(tmpVWGrid, fullGrid, 1, 2, 0, i, 3);
-  }
-
   vtkNew(vtkPoints, finalPoints);
   cPoints->SetPoints(finalPoints);
-  vtkSVNURBSUtils::TypedArrayToStructuredGrid(fullGrid, cPoints);
+  vtkSVNURBSUtils::TypedArrayToStructuredGrid(pointMatFinal, cPoints);
   //fprintf(stdout,"Final structured grid of control points\n");
   //vtkSVNURBSUtils::PrintStructuredGrid(cPoints);
 
@@ -5015,6 +5000,149 @@ int vtkSVNURBSUtils::InvertSystem(vtkTypedArray<double> *NP, vtkTypedArray<doubl
   return SV_OK;
 }
 
+// ----------------------
+// SolveBandedSystem
+// ----------------------
+int vtkSVNURBSUtils::SolveBandedSystem(vtkTypedArray<double> *NP, const int dim,
+                                       vtkTypedArray<double> *grid)
+{
+  int nr = NP->GetExtents()[0].GetSize();
+  int nc = NP->GetExtents()[1].GetSize();
+  if (nr != nc)
+  {
+    fprintf(stderr,"Matrix is not square, can't solve\n");
+    return SV_ERROR;
+  }
+  int dims = grid->GetDimensions();
+  if (dim < 0 || dim >= dims || grid->GetExtents()[dim].GetSize() != nr)
+  {
+    fprintf(stderr,"Matrix and grid sizes do not match\n");
+    return SV_ERROR;
+  }
+  int n = nr;
+
+  // Lower and upper bandwidth from the non-null entries
+  int kl = 0, ku = 0;
+  vtkArrayCoordinates coords;
+  vtkArray::SizeT numEntries = NP->GetNonNullSize();
+  for (vtkArray::SizeT e=0; e<numEntries; e++)
+  {
+    if (NP->GetValueN(e) == 0.0)
+      continue;
+    NP->GetCoordinatesN(e, coords);
+    int diff = coords[0] - coords[1];
+    if (diff > kl)
+      kl = diff;
+    if (-diff > ku)
+      ku = -diff;
+  }
+
+  // Row i holds columns [i-kl, i+kl+ku], room for the fill from row swaps
+  int width = 2*kl + ku + 1;
+  std::vector<double> band(n*width, 0.0);
+  for (vtkArray::SizeT e=0; e<numEntries; e++)
+  {
+    if (NP->GetValueN(e) == 0.0)
+      continue;
+    NP->GetCoordinatesN(e, coords);
+    band[coords[0]*width + coords[1] - coords[0] + kl] = NP->GetValueN(e);
+  }
+
+  // Gather the grid with the solve dimension as rows and all other
+  // dimensions and components flattened into right hand side columns
+  vtkArrayExtents extents = grid->GetExtents();
+  int numRHS = 1;
+  for (int d=0; d<dims; d++)
+  {
+    if (d != dim)
+      numRHS *= extents[d].GetSize();
+  }
+  std::vector<double> rhs(n*numRHS);
+  vtkArray::SizeT numGridEntries = grid->GetNonNullSize();
+  if (numGridEntries != (vtkArray::SizeT) n*numRHS)
+  {
+    fprintf(stderr,"Grid must be dense to solve\n");
+    return SV_ERROR;
+  }
+  std::vector<int> rhsLoc(numGridEntries);
+  for (vtkArray::SizeT e=0; e<numGridEntries; e++)
+  {
+    grid->GetCoordinatesN(e, coords);
+    int col = 0;
+    for (int d=0; d<dims; d++)
+    {
+      if (d != dim)
+        col = col*extents[d].GetSize() + coords[d];
+    }
+    rhsLoc[e] = coords[dim]*numRHS + col;
+    rhs[rhsLoc[e]] = grid->GetValueN(e);
+  }
+
+  // LU with partial pivoting within the band, applied to the right hand
+  // sides as it goes
+  for (int k=0; k<n; k++)
+  {
+    int lastRow = std::min(n-1, k+kl);
+    int lastCol = std::min(n-1, k+kl+ku);
+
+    int pivot = k;
+    double pivotVal = fabs(band[k*width + kl]);
+    for (int i=k+1; i<=lastRow; i++)
+    {
+      double val = fabs(band[i*width + k - i + kl]);
+      if (val > pivotVal)
+      {
+        pivot = i;
+        pivotVal = val;
+      }
+    }
+    if (pivotVal == 0.0)
+    {
+      fprintf(stderr,"Banded system is singular\n");
+      return SV_ERROR;
+    }
+    if (pivot != k)
+    {
+      for (int j=k; j<=lastCol; j++)
+        std::swap(band[k*width + j - k + kl], band[pivot*width + j - pivot + kl]);
+      for (int c=0; c<numRHS; c++)
+        std::swap(rhs[k*numRHS + c], rhs[pivot*numRHS + c]);
+    }
+
+    double diag = band[k*width + kl];
+    for (int i=k+1; i<=lastRow; i++)
+    {
+      double factor = band[i*width + k - i + kl] / diag;
+      if (factor == 0.0)
+        continue;
+      band[i*width + k - i + kl] = 0.0;
+      for (int j=k+1; j<=lastCol; j++)
+        band[i*width + j - i + kl] -= factor * band[k*width + j - k + kl];
+      for (int c=0; c<numRHS; c++)
+        rhs[i*numRHS + c] -= factor * rhs[k*numRHS + c];
+    }
+  }
+
+  // Back substitution
+  for (int i=n-1; i>=0; i--)
+  {
+    int lastCol = std::min(n-1, i+kl+ku);
+    double diag = band[i*width + kl];
+    for (int c=0; c<numRHS; c++)
+    {
+      double sum = rhs[i*numRHS + c];
+      for (int j=i+1; j<=lastCol; j++)
+        sum -= band[i*width + j - i + kl] * rhs[j*numRHS + c];
+      rhs[i*numRHS + c] = sum / diag;
+    }
+  }
+
+  for (vtkArray::SizeT e=0; e<numGridEntries; e++)
+    grid->SetValueN(e, rhs[rhsLoc[e]]);
+
+  return SV_OK;
+}
+
 // ----------------------
 // BasisEvaluation
 // ----------------------
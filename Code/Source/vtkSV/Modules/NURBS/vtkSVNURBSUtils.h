@@ -137,6 +137,9 @@ public:
 
   /** \brief Computes the values of p degree basis functions for a given knot
    *  span and an array of input parameter values.
+   *  \details Each row only evaluates the p+1 functions that are non-zero in
+   *  the knot span of its parameter value. If N is a vtkSparseArray only the
+   *  non-zero entries are stored.
    *  \param U The array of input parameter values.
    *  \param knots The knots for the basis functions to be evaluated at.
    *  \return N Returns the p order basis functions. */
@@ -144,6 +147,25 @@ public:
                                 const int p,
                                 vtkTypedArray<double> *N);
 
+  /** \brief Tabulates the p+1 non-zero basis functions of degree p, and
+   *  optionally their first derivatives, at each of the parameter values.
+   *  \details The tables are stored contiguously with p+1 components per
+   *  parameter value so that a sampling grid can be evaluated without any
+   *  further basis function evaluations. Parameter values outside of the
+   *  knot range are clamped to it.
+   *  \param knots The knots for the basis functions to be evaluated at.
+   *  \param p Degree of the basis functions.
+   *  \param U The array of input parameter values.
+   *  \return firstBasis Index of the first non-zero basis function at each
+   *  parameter value.
+   *  \return basis Values of the non-zero basis functions.
+   *  \return derivs First derivatives of the non-zero basis functions, only
+   *  computed if given. */
+  static int GetBasisTable(vtkDoubleArray *knots, const int p,
+                           vtkDoubleArray *U, vtkIntArray *firstBasis,
+                           vtkDoubleArray *basis,
+                           vtkDoubleArray *derivs = NULL);
+
   // Arbitrary nurbs modification functions
   /** \brief Inserts a given knot into a nurbs object a given number of times.
    *  \param controlPoints Control points of surface.
@@ -566,6 +588,17 @@ public:
                       vtkDoubleArray *knots);
   static int InvertSystem(vtkTypedArray<double> *NP, vtkTypedArray<double> *NPinv);
 
+  /** \brief Solves NP * X = B in place along one dimension of a dense grid,
+   *  i.e. for every line of grid values along dim. NP is factored as a band
+   *  matrix with partial pivoting, so B-spline collocation systems with
+   *  bandwidth p+1 cost linear time in the number of control points instead
+   *  of forming the explicit inverse.
+   *  \param NP Square matrix, bandwidth is taken from its non-zero entries.
+   *  \param dim Dimension of grid that NP is applied along.
+   *  \param grid Dense array holding B on input and X on output. */
+  static int SolveBandedSystem(vtkTypedArray<double> *NP, const int dim,
+                               vtkTypedArray<double> *grid);
+
   static int BasisEvaluation(vtkDoubleArray *knots, int p, int kEval, double uEval,
                              vtkDoubleArray *Nu);
   static int BasisEvaluationVec(vtkDoubleArray *knots, int p, int kEval, vtkDoubleArray *uEvals,
@@ -38,12 +38,115 @@
 #include "vtkCleanPolyData.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkSparseArray.h"
 
 #include "vtkSVCleanUnstructuredGrid.h"
 #include "vtkSVGlobals.h"
 #include "vtkSVNURBSUtils.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Evaluates the grid one u sample at a time. The weighted control net is
+// contracted with the u basis functions into a plane over all v, w control
+// points, the plane with the v basis functions into a line over all w control
+// points, and the line with the w basis functions for every w sample.
+class vtkSVNURBSVolumeGridFunctor
+{
+public:
+  const double *Pw;
+  int NumVCon, NumWCon;
+  int P, Q, R;
+  int NumUEvals, NumVEvals, NumWEvals;
+  const int *UFirst, *VFirst, *WFirst;
+  const double *UBasis, *VBasis, *WBasis;
+  const double *UDBasis, *VDBasis, *WDBasis;
+  double *Points, *UDerivs, *VDerivs, *WDerivs;
+
+  // out[l] = sum_m N[m]*in[(first+m)*size + l]
+  static void Contract(const double *N, const int numBasis, const int first,
+                       const double *in, const int size, double *out)
+  {
+    std::fill(out, out + size, 0.0);
+    for (int m=0; m<numBasis; m++)
+    {
+      const double *inm = in + (first+m)*size;
+      for (int l=0; l<size; l++)
+        out[l] += N[m]*inm[l];
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int lineSize  = 4*this->NumWCon;
+    int planeSize = lineSize*this->NumVCon;
+    int computeDerivs = this->UDBasis != NULL;
+    std::vector<double> plane(planeSize), line(lineSize);
+    std::vector<double> planeDu(computeDerivs ? planeSize : 0);
+    std::vector<double> lineDu(computeDerivs ? lineSize : 0);
+    std::vector<double> lineDv(computeDerivs ? lineSize : 0);
+
+    for (vtkIdType a=begin; a<end; a++)
+    {
+      const double *Nu = this->UBasis + a*(this->P+1);
+      Contract(Nu, this->P+1, this->UFirst[a], this->Pw, planeSize, plane.data());
+      if (computeDerivs)
+      {
+        const double *dNu = this->UDBasis + a*(this->P+1);
+        Contract(dNu, this->P+1, this->UFirst[a], this->Pw, planeSize, planeDu.data());
+      }
+
+      for (int b=0; b<this->NumVEvals; b++)
+      {
+        const double *Nv = this->VBasis + b*(this->Q+1);
+        Contract(Nv, this->Q+1, this->VFirst[b], plane.data(), lineSize, line.data());
+        if (computeDerivs)
+        {
+          const double *dNv = this->VDBasis + b*(this->Q+1);
+          Contract(Nv, this->Q+1, this->VFirst[b], planeDu.data(), lineSize, lineDu.data());
+          Contract(dNv, this->Q+1, this->VFirst[b], plane.data(), lineSize, lineDv.data());
+        }
+
+        for (int c=0; c<this->NumWEvals; c++)
+        {
+          const double *Nw = this->WBasis + c*(this->R+1);
+          double A[4];
+          Contract(Nw, this->R+1, this->WFirst[c], line.data(), 4, A);
+
+          vtkIdType ptId = a + b*this->NumUEvals + c*this->NumUEvals*this->NumVEvals;
+          double *pt = this->Points + 3*ptId;
+          for (int l=0; l<3; l++)
+            pt[l] = A[l]/A[3];
+
+          if (!computeDerivs)
+            continue;
+
+          // Rational derivative, S' = (A' - w'S)/w
+          const double *dNw = this->WDBasis + c*(this->R+1);
+          double Au[4], Av[4], Aw[4];
+          Contract(Nw, this->R+1, this->WFirst[c], lineDu.data(), 4, Au);
+          Contract(Nw, this->R+1, this->WFirst[c], lineDv.data(), 4, Av);
+          Contract(dNw, this->R+1, this->WFirst[c], line.data(), 4, Aw);
+          for (int l=0; l<3; l++)
+          {
+            if (this->UDerivs != NULL)
+              this->UDerivs[3*ptId + l] = (Au[l] - Au[3]*pt[l])/A[3];
+            if (this->VDerivs != NULL)
+              this->VDerivs[3*ptId + l] = (Av[l] - Av[3]*pt[l])/A[3];
+            if (this->WDerivs != NULL)
+              this->WDerivs[3*ptId + l] = (Aw[l] - Aw[3]*pt[l])/A[3];
+          }
+        }
+      }
+    }
+  }
+};
+}
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -306,182 +409,32 @@ int vtkSVNURBSVolume::GenerateVolumeRepresentation(const double uSpacing,
     return SV_ERROR;
   }
 
-  // Using clamped formula for degree of curve
-  int p = nUKnot - nUCon - 1;
-  int q = nVKnot - nVCon - 1;
-  int r = nWKnot - nWCon - 1;
-
-  //If nCon - 1 < p, not possible with clamping
-  //If nCon - 1 = p, bezier with clamping
-  //If nCon - 1 > p, fantastic
-
-  // U direction!
-  // -----------------------------------------------------------------------
+  // Sample the parameter space in all directions
   int numUDiv = ceil(1.0/uSpacing);
   vtkNew(vtkDoubleArray, uEvals);
   vtkSVNURBSUtils::LinSpace(0, 1, numUDiv, uEvals);
 
-  // Get sparse array for Nu
-  vtkNew(vtkSparseArray<double>, Nus);
-  Nus->Resize(numUDiv, p+2);
-
-  // Get sparse array for basis functions
-  vtkNew(vtkSparseArray<double>, NUfinal);
-  NUfinal->Resize(numUDiv, nUCon);
-
-  // Loop through control points
-  for (int i=0; i<nUCon; i++)
-  {
-    if (vtkSVNURBSUtils::BasisEvaluationVec(this->UKnotVector, p,
-                                       i, uEvals, Nus) != SV_OK)
-    {
-      return SV_ERROR;
-    }
-    // for each sampling get the final basis functions
-    for (int j=0; j<numUDiv; j++)
-    {
-      NUfinal->SetValue(j, i, Nus->GetValue(j, 0));
-    }
-  }
-
-  // Last value should be 1
-  NUfinal->SetValue(numUDiv-1, nUCon-1, 1.0);
-
-  // V direction!
-  // -----------------------------------------------------------------------
   int numVDiv = ceil(1.0/vSpacing);
   vtkNew(vtkDoubleArray, vEvals);
   vtkSVNURBSUtils::LinSpace(0, 1, numVDiv, vEvals);
 
-  // Get sparse array for Nv
-  vtkNew(vtkSparseArray<double>, Nvs);
-  Nvs->Resize(numVDiv, q+2);
-
-  // Get sparse array for basis functions
-  vtkNew(vtkSparseArray<double>, NVfinal);
-  NVfinal->Resize(numVDiv, nVCon);
-
-  // Loop through control points
-  for (int i=0; i<nVCon; i++)
-  {
-    // Evaluate the basis functions
-    if (vtkSVNURBSUtils::BasisEvaluationVec(this->VKnotVector, q,
-                                       i, vEvals, Nvs) != SV_OK)
-    {
-      return SV_ERROR;
-    }
-    // for each sampling get the final basis functions
-    double ratVal = 0.0;
-    for (int j=0; j<numVDiv; j++)
-    {
-      NVfinal->SetValue(j, i, Nvs->GetValue(j, 0));
-    }
-  }
-
-  // Last value should be 1
-  NVfinal->SetValue(numVDiv-1, nVCon-1, 1.0);
-
-  // W direction!
-  // -----------------------------------------------------------------------
   int numWDiv = ceil(1.0/wSpacing);
   vtkNew(vtkDoubleArray, wEvals);
   vtkSVNURBSUtils::LinSpace(0, 1, numWDiv, wEvals);
 
-  // Get sparse array for Nw
-  vtkNew(vtkSparseArray<double>, Nws);
-  Nws->Resize(numWDiv, r+2);
-
-  // Get sparse array for basis functions
-  vtkNew(vtkSparseArray<double>, NWfinal);
-  NWfinal->Resize(numWDiv, nWCon);
-
-  // Loop through control points
-  for (int i=0; i<nWCon; i++)
-  {
-    if (vtkSVNURBSUtils::BasisEvaluationVec(this->WKnotVector, r,
-                                       i, wEvals, Nws) != SV_OK)
-    {
-      return SV_ERROR;
-    }
-    // for each sampling get the final basis functions
-    for (int j=0; j<numWDiv; j++)
-    {
-      NWfinal->SetValue(j, i, Nws->GetValue(j, 0));
-    }
-  }
-
-  // Last value should be 1
-  NWfinal->SetValue(numWDiv-1, nWCon-1, 1.0);
-
-  vtkNew(vtkSparseArray<double>, NVfinalT);
-  vtkSVNURBSUtils::MatrixTranspose(NVfinal, 0, NVfinalT);
-
-  vtkNew(vtkSparseArray<double>, NWfinalT);
-  vtkSVNURBSUtils::MatrixTranspose(NWfinal, 0, NWfinalT);
-  //Get the physical points on the surface!
+  //Get the physical points in the volume!
   // -----------------------------------------------------------------------
-  // When dealing with the rational of NURBS, need to multiply points by
-  // weights when sending through matrix multiplication. However, still need
-  // fourth spot in point, weight vector because in the end, we will need
-  // to divide by the total weight
-  vtkArrayExtents size;
-  size.SetDimensions(4);
-  size.SetExtent(0, vtkArrayRange(0, numUDiv));
-  size.SetExtent(1, vtkArrayRange(0, numVDiv));
-  size.SetExtent(2, vtkArrayRange(0, nWCon));
-  size.SetExtent(3, vtkArrayRange(0, 4));
-  vtkNew(vtkDenseArray<double>, tmpW);
-  tmpW->Resize(size);
-
-  for (int i=0; i<nWCon; i++)
+  vtkNew(vtkPoints, volumePoints);
+  if (this->EvaluateGrid(uEvals, vEvals, wEvals, volumePoints) != SV_OK)
   {
-    vtkNew(vtkDenseArray<double>, tmpControlGrid);
-    vtkSVNURBSUtils::ControlGridToTypedArraySPECIAL(this->ControlPointGrid, 0, 1, 2, i, tmpControlGrid);
-
-    // Do first matrix multiply with u basis functions
-    vtkNew(vtkDenseArray<double>, tmpUGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(NUfinal, 0, 1, tmpControlGrid, 1, 4, tmpUGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-    // Do second matrix multiply with v basis functions
-    vtkNew(vtkDenseArray<double>, tmpVGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpUGrid, 1, 4, NVfinalT, 0, 1, tmpVGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-
-    vtkSVNURBSUtils::SetMatrixOfDim4Grid(tmpVGrid, tmpW, 0, 1, 2, i, 4);
+    vtkErrorMacro("Error evaluating volume");
+    return SV_ERROR;
   }
 
-  size.SetExtent(0, vtkArrayRange(0, numUDiv));
-  size.SetExtent(1, vtkArrayRange(0, numVDiv));
-  size.SetExtent(2, vtkArrayRange(0, numWDiv));
-  size.SetExtent(3, vtkArrayRange(0, 4));
-  vtkNew(vtkDenseArray<double>, fullGrid);
-  fullGrid->Resize(size);
-  for (int i=0; i<numUDiv; i++)
-  {
-    vtkNew(vtkDenseArray<double>, tmpWGrid);
-    vtkSVNURBSUtils::GetMatrixOfDim4Grid(tmpW, 1, 2, 0, i, 4, tmpWGrid);
-
-    // Do second matrix multiply with v basis functions
-    vtkNew(vtkDenseArray<double>, tmpVWGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpWGrid, 1, 4, NWfinalT, 0, 1, tmpVWGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-
-    vtkSVNURBSUtils::SetMatrixOfDim4Grid(tmpVWGrid, fullGrid, 1, 2, 0, i, 4);
-  }
   // Set up final grid of points
   vtkNew(vtkStructuredGrid, finalGrid);
-  vtkNew(vtkPoints, tmpVPoints);
-  finalGrid->SetPoints(tmpVPoints);
-  vtkSVNURBSUtils::TypedArrayToStructuredGridRational(fullGrid, finalGrid);
+  finalGrid->SetDimensions(numUDiv, numVDiv, numWDiv);
+  finalGrid->SetPoints(volumePoints);
 
   // Get grid connectivity for pointset
   vtkNew(vtkAppendFilter, converter);
@@ -499,3 +452,137 @@ int vtkSVNURBSVolume::GenerateVolumeRepresentation(const double uSpacing,
 
   return SV_OK;
 }
+
+// ----------------------
+// EvaluateGrid
+// ----------------------
+int vtkSVNURBSVolume::EvaluateGrid(vtkDoubleArray *uEvals,
+                                   vtkDoubleArray *vEvals,
+                                   vtkDoubleArray *wEvals,
+                                   vtkPoints *points,
+                                   vtkDoubleArray *uDerivs,
+                                   vtkDoubleArray *vDerivs,
+                                   vtkDoubleArray *wDerivs)
+{
+  // Get number of control points and knots
+  int dim[3];
+  this->ControlPointGrid->GetDimensions(dim);
+  int nUCon  = dim[0];
+  int nVCon  = dim[1];
+  int nWCon  = dim[2];
+  int nUKnot = this->UKnotVector->GetNumberOfTuples();
+  int nVKnot = this->VKnotVector->GetNumberOfTuples();
+  int nWKnot = this->WKnotVector->GetNumberOfTuples();
+  if (nUCon == 0 || nVCon == 0 || nWCon == 0)
+  {
+    vtkErrorMacro("No control points");
+    return SV_ERROR;
+  }
+  if (nUKnot == 0 || nVKnot == 0 || nWKnot == 0)
+  {
+    vtkErrorMacro("No knot points");
+    return SV_ERROR;
+  }
+  if (this->ControlPointGrid->GetPointData()->GetArray("Weights") == NULL)
+  {
+    vtkErrorMacro("No weights on control point grid");
+    return SV_ERROR;
+  }
+
+  // Using clamped formula for degree of curve
+  int p = nUKnot - nUCon - 1;
+  int q = nVKnot - nVCon - 1;
+  int r = nWKnot - nWCon - 1;
+
+  // Tabulate the basis functions once per direction
+  int computeDerivs = uDerivs != NULL || vDerivs != NULL || wDerivs != NULL;
+  vtkNew(vtkIntArray, uFirst);
+  vtkNew(vtkDoubleArray, uBasis);
+  vtkNew(vtkDoubleArray, uDBasis);
+  if (vtkSVNURBSUtils::GetBasisTable(this->UKnotVector, p, uEvals, uFirst, uBasis,
+                                     computeDerivs ? uDBasis.GetPointer() : NULL) != SV_OK)
+  {
+    vtkErrorMacro("Error getting u basis functions");
+    return SV_ERROR;
+  }
+  vtkNew(vtkIntArray, vFirst);
+  vtkNew(vtkDoubleArray, vBasis);
+  vtkNew(vtkDoubleArray, vDBasis);
+  if (vtkSVNURBSUtils::GetBasisTable(this->VKnotVector, q, vEvals, vFirst, vBasis,
+                                     computeDerivs ? vDBasis.GetPointer() : NULL) != SV_OK)
+  {
+    vtkErrorMacro("Error getting v basis functions");
+    return SV_ERROR;
+  }
+  vtkNew(vtkIntArray, wFirst);
+  vtkNew(vtkDoubleArray, wBasis);
+  vtkNew(vtkDoubleArray, wDBasis);
+  if (vtkSVNURBSUtils::GetBasisTable(this->WKnotVector, r, wEvals, wFirst, wBasis,
+                                     computeDerivs ? wDBasis.GetPointer() : NULL) != SV_OK)
+  {
+    vtkErrorMacro("Error getting w basis functions");
+    return SV_ERROR;
+  }
+
+  // Weighted control net (x*w, y*w, z*w, w) with w varying fastest
+  std::vector<double> Pw(4*nUCon*nVCon*nWCon);
+  for (int i=0; i<nUCon; i++)
+  {
+    for (int j=0; j<nVCon; j++)
+    {
+      for (int k=0; k<nWCon; k++)
+      {
+        double pw[4];
+        this->ControlPointGrid->GetControlPoint(i, j, k, pw);
+        double *dst = &Pw[4*((i*nVCon + j)*nWCon + k)];
+        for (int c=0; c<3; c++)
+          dst[c] = pw[c]*pw[3];
+        dst[3] = pw[3];
+      }
+    }
+  }
+
+  int numUEvals = uEvals->GetNumberOfTuples();
+  int numVEvals = vEvals->GetNumberOfTuples();
+  int numWEvals = wEvals->GetNumberOfTuples();
+  int numPoints = numUEvals*numVEvals*numWEvals;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numPoints);
+  vtkDoubleArray *derivArrays[3] = {uDerivs, vDerivs, wDerivs};
+  for (int i=0; i<3; i++)
+  {
+    if (derivArrays[i] != NULL)
+    {
+      derivArrays[i]->SetNumberOfComponents(3);
+      derivArrays[i]->SetNumberOfTuples(numPoints);
+    }
+  }
+
+  vtkSVNURBSVolumeGridFunctor functor;
+  functor.Pw        = Pw.data();
+  functor.NumVCon   = nVCon;
+  functor.NumWCon   = nWCon;
+  functor.P         = p;
+  functor.Q         = q;
+  functor.R         = r;
+  functor.NumUEvals = numUEvals;
+  functor.NumVEvals = numVEvals;
+  functor.NumWEvals = numWEvals;
+  functor.UFirst    = uFirst->GetPointer(0);
+  functor.VFirst    = vFirst->GetPointer(0);
+  functor.WFirst    = wFirst->GetPointer(0);
+  functor.UBasis    = uBasis->GetPointer(0);
+  functor.VBasis    = vBasis->GetPointer(0);
+  functor.WBasis    = wBasis->GetPointer(0);
+  functor.UDBasis   = computeDerivs ? uDBasis->GetPointer(0) : NULL;
+  functor.VDBasis   = computeDerivs ? vDBasis->GetPointer(0) : NULL;
+  functor.WDBasis   = computeDerivs ? wDBasis->GetPointer(0) : NULL;
+  functor.Points    = vtkDoubleArray::SafeDownCast(points->GetData())->GetPointer(0);
+  functor.UDerivs   = uDerivs != NULL ? uDerivs->GetPointer(0) : NULL;
+  functor.VDerivs   = vDerivs != NULL ? vDerivs->GetPointer(0) : NULL;
+  functor.WDerivs   = wDerivs != NULL ? wDerivs->GetPointer(0) : NULL;
+
+  vtkSMPTools::For(0, numUEvals, functor);
+
+  return SV_OK;
+}
@@ -120,6 +120,22 @@ public:
    *  \param vSpacing Sets the spacing to sample the NURBS at in the v parameter direction. */
   int GenerateVolumeRepresentation(const double uSpacing, const double vSpacing, const double wSpacing);
 
+  /** \brief Evaluates the volume on the tensor grid of the given parameter
+   *  values. Basis functions are tabulated once per direction and the grid
+   *  slabs are evaluated in parallel.
+   *  \param uEvals Parameter values to evaluate at in the u direction.
+   *  \param vEvals Parameter values to evaluate at in the v direction.
+   *  \param wEvals Parameter values to evaluate at in the w direction.
+   *  \param points Output points, u index varies fastest and w slowest.
+   *  \param uDerivs Optional output of the partial derivatives in u.
+   *  \param vDerivs Optional output of the partial derivatives in v.
+   *  \param wDerivs Optional output of the partial derivatives in w. */
+  int EvaluateGrid(vtkDoubleArray *uEvals, vtkDoubleArray *vEvals,
+                   vtkDoubleArray *wEvals, vtkPoints *points,
+                   vtkDoubleArray *uDerivs = NULL,
+                   vtkDoubleArray *vDerivs = NULL,
+                   vtkDoubleArray *wDerivs = NULL);
+
   //Functions to set control points/knots/etc.
   void SetControlPoints(vtkStructuredGrid *points3d);
   void SetKnotVector(vtkDoubleArray *knotVector, const int dim);
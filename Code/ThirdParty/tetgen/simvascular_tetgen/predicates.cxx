@@ -116,6 +116,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <mutex>
 #ifdef CPU86
 #include <float.h>
 #endif /* CPU86 */
@@ -384,14 +385,20 @@ static REAL isperrboundA, isperrboundB, isperrboundC;
 
 // Options to choose types of geometric computtaions.
 // Added by H. Si, 2012-08-23.
-static int  _use_inexact_arith; // -X option.
-static int  _use_static_filter; // Default option, disable it by -X1
+// SIMVASCULAR_CHANGE: the options and static filters below depend on the
+//   arguments of each tetrahedralize() call and are kept per thread, so
+//   that several meshes can be generated concurrently. The constants
+//   above are only computed once, see exactinit().
+static thread_local int  _use_inexact_arith; // -X option.
+static thread_local int  _use_static_filter; // Default option, disable it by -X1
 
 // Static filters for orient3d() and insphere().
 // They are pre-calcualted and set in exactinit().
 // Added by H. Si, 2012-08-23.
-static REAL o3dstaticfilter;
-static REAL ispstaticfilter;
+static thread_local REAL o3dstaticfilter;
+static thread_local REAL ispstaticfilter;
+
+static std::once_flag exactinit_once;
 
 
 
@@ -544,8 +551,6 @@ void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
                REAL maxz)
 {
   REAL half;
-  REAL check, lastcheck;
-  int every_other;
 #ifdef LINUX
   int cword;
 #endif /* LINUX */
@@ -580,6 +585,14 @@ void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
   }
 #endif // USE_CGAL_PREDICATES
 
+  // SIMVASCULAR_CHANGE: the machine constants are computed by the first
+  //   call only; later, possibly concurrent, calls just read them.
+  std::call_once(exactinit_once, [verbose]()
+  {
+  REAL half;
+  REAL check, lastcheck;
+  int every_other;
+
 #ifdef SINGLE
   test_float(verbose);
 #else
@@ -620,6 +633,7 @@ void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
   isperrboundA = (16.0 + 224.0 * epsilon) * epsilon;
   isperrboundB = (5.0 + 72.0 * epsilon) * epsilon;
   isperrboundC = (71.0 + 1408.0 * epsilon) * epsilon * epsilon;
+  });
 
   // Set TetGen options.  Added by H. Si, 2012-08-23.
   _use_inexact_arith = noexact;
@@ -17,6 +17,8 @@
 
 #include "tetgen.h"
 
+#include <mutex>
+
 //// io_cxx ///////////////////////////////////////////////////////////////////
 ////                                                                       ////
 ////                                                                       ////
@@ -4508,7 +4510,10 @@ void tetgenmesh::initializepools()
     printf("  tetrahedron per block: %d.\n", b->tetrahedraperblock);
   }
 
-  inittables();
+  // SIMVASCULAR_CHANGE: the look-up tables are static and shared by all
+  //   tetgenmesh objects, so they are only filled by the first call.
+  static std::once_flag inittables_once;
+  std::call_once(inittables_once, [this]() { inittables(); });
 
   // There are three input point lists available, which are in, addin,
   //   and bgm->in. These point lists may have different number of